@@ -33,7 +33,9 @@
 #include "globals.h"
 #include "keys.h"
 
+#include "get_capabilities.h"
 #include "get_git_commit.h"
+#include "get_profile.h"
 #include "get_pubkey.h"
 #include "get_version.h"
 #include "sign.h"
@@ -47,10 +49,20 @@
 #define INS_SIGN              0x04
 #define INS_GIT               0x09
 #define INS_SIGN_WITH_HASH    0x0F
+#define INS_SIGN_BATCH        0x10
+#define INS_GET_PUBLIC_KEYS   0x11
+#ifdef MAVRYK_PROFILE
+#define INS_GET_PROFILE       0x12  /// Only in profiling builds
+#endif
+#define INS_SIGN_HASH         0x13
+#define INS_GET_CAPABILITIES  0x14
 
 /// Packet indexes
 #define P1_FIRST       0x00u  /// First packet
 #define P1_NEXT        0x01u  /// Other packet
+#define P1_SIGNATURE   0x02u  /// Batch signature request
+#define P1_HASH_ONLY   0x03u  /// First packet, the message is only hashed
+#define P1_KEY         0x04u  /// Additional key, before the message
 #define P1_LAST_MARKER 0x80u  /// Last packet
 
 /// Parameters parser helpers
@@ -94,8 +106,26 @@ dispatch_sign_instruction(const command_t *cmd)
         READ_P2_DERIVATION_TYPE(cmd, derivation_type);
         READ_DATA(cmd, buf);
 
-        MV_CHECK(
-            handle_signing_key_setup(&buf, derivation_type, return_hash));
+        MV_CHECK(handle_signing_key_setup(&buf, derivation_type,
+                                          return_hash, false));
+    } else if ((cmd->p1 & ~P1_LAST_MARKER) == P1_HASH_ONLY) {
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+
+        READ_P2_DERIVATION_TYPE(cmd, derivation_type);
+        READ_DATA(cmd, buf);
+
+        MV_CHECK(handle_signing_key_setup(&buf, derivation_type,
+                                          return_hash, true));
+    } else if ((cmd->p1 & ~P1_LAST_MARKER) == P1_KEY) {
+        MV_ASSERT(EXC_WRONG_PARAM, cmd->p1 == P1_KEY);
+        // A swap only signs with the key of its first packet
+        MV_ASSERT(EXC_UNEXPECTED_STATE, (global.step == ST_BLIND_SIGN)
+                                            || (global.step == ST_CLEAR_SIGN));
+
+        READ_P2_DERIVATION_TYPE(cmd, derivation_type);
+        READ_DATA(cmd, buf);
+
+        MV_CHECK(handle_signing_key_add(&buf, derivation_type));
     } else {
         MV_ASSERT(EXC_UNEXPECTED_STATE,
                   (global.step == ST_BLIND_SIGN)
@@ -103,6 +133,9 @@ dispatch_sign_instruction(const command_t *cmd)
                       || (global.step == ST_SUMMARY_SIGN)
                       || (global.step == ST_SWAP_SIGN));
 
+        MV_ASSERT(EXC_UNEXPECTED_STATE,
+                  global.keys.apdu.sign.batch.nb_operations == 0);
+
         bool last = (cmd->p1 & P1_LAST_MARKER) != 0;
 
         READ_DATA(cmd, buf);
@@ -113,11 +146,75 @@ dispatch_sign_instruction(const command_t *cmd)
     MV_POSTAMBLE;
 }
 
+/**
+ * @brief Read the APDU of the batch signing command and choose the next
+ * action to take.
+ *
+ * The first packet sets up the session, the next ones carry the
+ * operations, each one ending with `P1_LAST_MARKER`. Once the batch has
+ * been accepted, the signatures are requested one by one with
+ * `P1_SIGNATURE`.
+ *
+ * @param cmd: command containg APDU received
+ */
+static void
+dispatch_sign_batch_instruction(const command_t *cmd)
+{
+    MV_PREAMBLE(("cmd=0x%p"));
+
+    MV_ASSERT(EXC_UNEXPECTED_STATE, cmd->ins == INS_SIGN_BATCH);
+
+    switch (cmd->p1 & ~P1_LAST_MARKER) {
+    case P1_FIRST: {
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+
+        READ_P2_DERIVATION_TYPE(cmd, derivation_type);
+        READ_DATA(cmd, buf);
+
+        MV_CHECK(handle_batch_signing_key_setup(&buf, derivation_type));
+        break;
+    }
+    case P1_NEXT: {
+        ASSERT_GLOBAL_STEP(ST_SUMMARY_SIGN);
+        MV_ASSERT(EXC_UNEXPECTED_STATE,
+                  global.keys.apdu.sign.batch.nb_operations != 0);
+
+        bool last = (cmd->p1 & P1_LAST_MARKER) != 0;
+
+        READ_DATA(cmd, buf);
+
+        MV_CHECK(handle_sign(&buf, last, false));
+        break;
+    }
+    case P1_SIGNATURE:
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+        MV_ASSERT(EXC_UNEXPECTED_STATE, batch_signing_pending());
+        ASSERT_NO_P2(cmd);
+        ASSERT_NO_DATA(cmd);
+
+        MV_CHECK(handle_batch_get_signature());
+        break;
+    default:
+        MV_FAIL(EXC_WRONG_PARAM);
+    }
+
+    MV_POSTAMBLE;
+}
+
 void
 dispatch(const command_t *cmd)
 {
     MV_PREAMBLE(("cmd=0x%p"));
 
+    // Any command but a well-formed signature request ends an accepted
+    // batch
+    if (batch_signing_pending()
+        && ((cmd->cla != CLA) || (cmd->ins != INS_SIGN_BATCH)
+            || (cmd->p1 != P1_SIGNATURE) || (cmd->p2 != 0u)
+            || (cmd->data != NULL))) {
+        end_batch_signing();
+    }
+
     if (cmd->cla != CLA) {
         MV_FAIL(EXC_CLASS);
     }
@@ -157,11 +254,59 @@ dispatch(const command_t *cmd)
 
         break;
     }
+    case INS_GET_PUBLIC_KEYS: {
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+
+        ASSERT_NO_P1(cmd);
+        READ_P2_DERIVATION_TYPE(cmd, derivation_type);
+        READ_DATA(cmd, buf);
+
+        // same as INS_GET_PUBLIC_KEY
+        MV_ASSERT(EXC_HID_REQUIRED, G_io_apdu_media != IO_APDU_MEDIA_U2F);
+
+        MV_CHECK(handle_get_public_keys(&buf, derivation_type));
+
+        break;
+    }
     case INS_SIGN:
     case INS_SIGN_WITH_HASH: {
         MV_CHECK(dispatch_sign_instruction(cmd));
         break;
     }
+    case INS_SIGN_BATCH: {
+        MV_CHECK(dispatch_sign_batch_instruction(cmd));
+        break;
+    }
+    case INS_SIGN_HASH: {
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+
+        ASSERT_NO_P1(cmd);
+        READ_P2_DERIVATION_TYPE(cmd, derivation_type);
+        READ_DATA(cmd, buf);
+
+        MV_CHECK(handle_sign_hash(&buf, derivation_type));
+        break;
+    }
+    case INS_GET_CAPABILITIES:
+
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+        MV_ASSERT(EXC_WRONG_PARAM, (cmd->p1 & ~CAPABILITY_WINDOWED) == 0u);
+        ASSERT_NO_P2(cmd);
+
+        handle_get_capabilities(cmd->p1);
+
+        break;
+#ifdef MAVRYK_PROFILE
+    case INS_GET_PROFILE:
+
+        ASSERT_GLOBAL_STEP(ST_IDLE);
+        ASSERT_NO_P2(cmd);
+        MV_ASSERT(EXC_WRONG_PARAM, cmd->p1 <= 1u);
+
+        handle_get_profile(cmd->p1 == 1u);
+
+        break;
+#endif
     default:
         PRINTF("[ERROR] invalid instruction 0x%02x\n", cmd->ins);
         MV_FAIL(EXC_INVALID_INS);
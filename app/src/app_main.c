@@ -36,6 +36,7 @@ void
 app_exit(void)
 {
     PRINTF("[DEBUG] Trying to exit the app. \n");
+    clear_derived_key_cache();
     os_sched_exit(-1);
 }
 
@@ -75,6 +76,7 @@ app_main(void)
     int       input_len = 0;
 
     app_stack_canary = 0xDEADBEEFu;
+    MV_PROFILE_STACK_PAINT();
     FUNC_ENTER(("void"));
 
     print_memory_layout();
@@ -93,6 +95,8 @@ app_main(void)
                G_called_from_swap, global.step);
 #endif
         if (global.step == ST_ERROR) {
+            // The flow in error may have left a private key derived
+            clear_derived_key_cache();
             global.step = ST_IDLE;
             ui_home_init();
         }
@@ -103,6 +107,13 @@ app_main(void)
             PRINTF("=> io_recv_command failure\n");
             return;
         }
+        MV_PROFILE_STACK_RECORD();
+
+        if (global.deferred_sw != 0) {
+            io_send_sw(global.deferred_sw);
+            global.deferred_sw = 0;
+            continue;
+        }
 
         if (!apdu_parser(&cmd, G_io_apdu_buffer, input_len)) {
             PRINTF("[ERROR] Bad length: %d\n", input_len);
@@ -114,7 +125,9 @@ app_main(void)
             "CData=%.*H\n",
             cmd.cla, cmd.ins, cmd.p1, cmd.p2, cmd.lc, cmd.lc, cmd.data);
 
+        MV_PROFILE_STACK_FLOW();
         MV_CHECK(dispatch(&cmd));
+        MV_PROFILE_STACK_FLOW();
 
         MV_POSTAMBLE;
     }
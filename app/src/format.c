@@ -21,11 +21,12 @@
 #include <format.h>
 
 #include "format.h"
+#include "parser/formatting.h"
 
 bool
 mv_mumav_to_string(char *obuf, size_t olen, uint64_t amount)
 {
-    if (!format_fpu64_trimmed(obuf, olen, amount, 6 /*DECIMALS*/)) {
+    if (mv_format_mumav(amount, obuf, olen)) {
         memset(obuf, '\0', olen);
         return false;
     }
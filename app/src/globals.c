@@ -31,12 +31,22 @@ const settings_t N_settings_real;
 void
 init_globals(void)
 {
+    clear_derived_key_cache();
     memset(&global, 0, sizeof(global));
     memset(G_io_seproxyhal_spi_buffer, 0, sizeof(G_io_seproxyhal_spi_buffer));
     memset(&G_ux, 0, sizeof(G_ux));
     memset(&G_ux_params, 0, sizeof(G_ux_params));
 }
 
+void
+claim_keys(keys_flow_t flow)
+{
+    if (global.keys_flow != flow) {
+        memset(&global.keys, 0, sizeof(global.keys));
+        global.keys_flow = flow;
+    }
+}
+
 void
 toggle_expert_mode(void)
 {
@@ -32,6 +32,7 @@
 #define MV_SCREEN_LINES_11PX 5
 #endif
 
+#include "get_pubkey.h"
 #include "sign.h"
 #include "exception.h"
 #include "keys.h"
@@ -72,6 +73,16 @@ typedef enum {
 #define NB_MAX_SCREEN_ALLOWED 12
 #endif
 
+/**
+ * @brief Flow owning the per-flow states of `keys`
+ *
+ */
+typedef enum {
+    KEYS_FLOW_NONE,    /// Cleared, owned by no flow
+    KEYS_FLOW_SIGN,    /// Owned by the signing flows
+    KEYS_FLOW_PUBKEY,  /// Owned by the public key flows
+} keys_flow_t;
+
 #ifdef HAVE_NBGL
 typedef enum {
     REASON_NONE          = 0,
@@ -95,18 +106,25 @@ typedef struct {
             pubkey;  /// UX and UI information related to public key
     } ui;
     bip32_path_with_curve_t path_with_curve;  /// Derivation path
+    derived_key_cache_t     derived_key;  /// Key derived from the path
+    /// Per-flow states: only the states of the flow in `keys_flow` are
+    /// valid, they are claimed with `claim_keys`.
     union {
         struct {
             apdu_hash_state_t hash;  /// Transaction hash
             apdu_sign_state_t sign;  ///  state of sign operation.
         } apdu;
-        /** Warning: Use this pubkey only when apdu-hash/sign
-         * is not being used.
-         * Only being used in apdu_pubkey.c : handle_apdu_get_public_key
-         * currently.
-         * */
-        cx_ecfp_public_key_t pubkey;
+        struct {
+            pubkey_cache_t cache;  /// Recently derived public keys, kept
+                                   /// until another flow claims `keys`.
+            union {
+                cx_ecfp_public_key_t pubkey;   /// Public key to send.
+                apdu_pubkeys_state_t pubkeys;  /// state of public keys
+                                               /// export.
+            } u;
+        } pubkey;
     } keys;
+    keys_flow_t keys_flow;  /// Flow owning `keys`.
     /// Buffer to store incoming data.
     char line_buf[MV_UI_STREAM_CONTENTS_SIZE + 1];
 
@@ -115,7 +133,13 @@ typedef struct {
          blindsign_reason;  /// Blindsigning flow Summary or parsing error.
     char error_code[ERROR_CODE_SIZE];  /// Error code for parsing error.
 #endif
-    main_step_t step;  /// Current operational state of app.
+    main_step_t step;         /// Current operational state of app.
+    bool        windowed;     /// Whether the host opted in the windowed
+                              /// mode with `INS_GET_CAPABILITIES`.
+    uint16_t    deferred_sw;  /// Status to reply to the next command, set
+                              /// in the windowed mode when a signing ends
+                              /// while the host sends a packet already
+                              /// acknowledged.
 } globals_t;
 
 /* Settings */
@@ -142,6 +166,16 @@ extern unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
  */
 void init_globals(void);
 
+/**
+ * @brief Claim the per-flow states of `keys` for a flow.
+ *
+ * The states are cleared if another flow owned them, so the signing
+ * flows and the public key flows never pay for each other's states.
+ *
+ * @param flow: flow claiming `keys`
+ */
+void claim_keys(keys_flow_t flow);
+
 /// Toggles the persisted expert_mode setting
 void toggle_expert_mode(void);
 
@@ -33,12 +33,10 @@
 #include "utils.h"
 
 #include "parser/num_parser.h"
+#include "parser/operation_parser.h"
 
 // based on app-exchange
-#define TICKER           "MVRK"
-#define ADDRESS_MAX_SIZE 63
-/* the smallest unit is microtez */
-#define DECIMALS         6
+#define TICKER "MVRK"
 
 /* Check check_address_parameters_t.address_to_check against specified
  * parameters.
@@ -70,10 +68,8 @@ swap_handle_check_address(check_address_parameters_t *params)
                                .offset = 0u};
 
     MV_LIB_CHECK(read_bip32_path(&bip32_path, &cdata));
-    cx_ecfp_public_key_t pubkey;
-    MV_LIB_CHECK(derive_pk(&pubkey, derivation_type, &bip32_path));
-    MV_LIB_CHECK(
-        derive_pkh(&pubkey, derivation_type, address, sizeof(address)));
+    MV_LIB_CHECK(derive_path_pkh(derivation_type, &bip32_path, address,
+                                 sizeof(address)));
     if (strcmp(params->address_to_check, address) != 0) {
         PRINTF("[ERROR] Check address fail: %s !=  %s\n",
                params->address_to_check, address);
@@ -104,9 +100,8 @@ swap_handle_get_printable_amount(get_printable_amount_parameters_t *params)
         goto error;
     }
 
-    if (!format_fpu64_trimmed(params->printable_amount,
-                              sizeof(params->printable_amount), amount,
-                              DECIMALS)) {
+    if (mv_format_mumav(amount, params->printable_amount,
+                        sizeof(params->printable_amount))) {
         PRINTF("[ERROR] Fail to print amount\n");
         goto error;
     }
@@ -123,13 +118,9 @@ error:
     FUNC_LEAVE();
 }
 
-typedef struct {
-    uint64_t amount;
-    uint64_t fee;  /// Contains transaction fees plus reveal fees, if any.
-    char     destination_address[ADDRESS_MAX_SIZE];
-} swap_transaction_parameters_t;
-
-static swap_transaction_parameters_t G_swap_params;
+/// Transaction expected, its fee contains the transaction fees plus
+/// the reveal fees, if any.
+static mv_operation_expected G_swap_params;
 
 static uint8_t *G_swap_transaction_result;
 
@@ -142,7 +133,7 @@ swap_copy_transaction_parameters(create_transaction_parameters_t *params)
 {
     FUNC_ENTER(("params=%p", params));
 
-    swap_transaction_parameters_t params_copy;
+    mv_operation_expected params_copy;
     memset(&params_copy, 0, sizeof(params_copy));
 
     if (!swap_str_to_u64(params->amount, params->amount_length,
@@ -162,11 +153,9 @@ swap_copy_transaction_parameters(create_transaction_parameters_t *params)
         goto error;
     }
 
-    strlcpy(params_copy.destination_address, params->destination_address,
-            sizeof(params_copy.destination_address));
-    if (params_copy
-            .destination_address[sizeof(params_copy.destination_address) - 1]
-        != '\0') {
+    if (strlcpy(params_copy.destination, params->destination_address,
+                sizeof(params_copy.destination))
+        >= sizeof(params_copy.destination)) {
         PRINTF("[ERROR] Fail to copy destination address\n");
         goto error;
     }
@@ -185,12 +174,18 @@ error:
     return false;
 }
 
+const mv_operation_expected *
+swap_expected_operation(void)
+{
+    return &G_swap_params;
+}
+
 void
 swap_check_validity(void)
 {
     mv_operation_state *op
         = &global.keys.apdu.sign.u.clear.parser_state.operation;
-    char dstaddr[ADDRESS_MAX_SIZE];
+    uint16_t nb_reveal;
     MV_PREAMBLE((""));
 
     if (!G_called_from_swap) {
@@ -202,20 +197,18 @@ swap_check_validity(void)
     }
     G_swap_response_ready = true;
 
-    PRINTF("[DEBUG] batch_index = %u, nb_reveal=%d, tag=%d\n",
-           op->batch_index, op->nb_reveal, op->last_tag);
-    MV_ASSERT(EXC_REJECT, op->nb_reveal <= 1);
-    MV_ASSERT(EXC_REJECT, (op->batch_index - op->nb_reveal) == 1);
+    nb_reveal = mv_operation_summary_nb_kind(&op->summary,
+                                             MV_OPERATION_TAG_REVEAL);
+    PRINTF("[DEBUG] nb_operations = %u, nb_reveal=%d, tag=%d\n",
+           op->summary.nb_operations, nb_reveal, op->last_tag);
+    MV_ASSERT(EXC_REJECT, nb_reveal <= 1);
+    MV_ASSERT(EXC_REJECT, (op->summary.nb_operations - nb_reveal) == 1);
     MV_ASSERT(EXC_REJECT, op->last_tag == MV_OPERATION_TAG_TRANSACTION);
-    MV_ASSERT(EXC_REJECT, op->total_amount == G_swap_params.amount);
-    MV_ASSERT(EXC_REJECT, op->total_fee == G_swap_params.fee);
-
-    mv_format_address(op->destination, 22, dstaddr, sizeof(dstaddr));
-
-    PRINTF("[DEBUG] dstaddr=\"%s\"\n", dstaddr);
-    PRINTF("[DEBUG] G...dstaddr=\"%s\"\n", G_swap_params.destination_address);
-    MV_ASSERT(EXC_REJECT,
-              !strcmp(dstaddr, G_swap_params.destination_address));
+    MV_ASSERT(EXC_REJECT, op->summary.total_amount == G_swap_params.amount);
+    MV_ASSERT(EXC_REJECT, op->summary.total_fee == G_swap_params.fee);
+    // The parser has already matched the destination and these totals
+    // as they were read, see mv_operation_parser_set_expected: the
+    // checks above only fail on an incomplete operation
 
     MV_POSTAMBLE;
 }
@@ -22,6 +22,18 @@
 
 #pragma once
 
+#include "parser/operation_state.h"
+
+#ifdef HAVE_SWAP
+/**
+ * @brief Get the transaction expected by the swap, from the swap params
+ *        communicated by swap_copy_transaction_parameters
+ *
+ * @return const mv_operation_expected*: transaction expected
+ */
+const mv_operation_expected *swap_expected_operation(void);
+#endif  // HAVE_SWAP
+
 /**
  * @brief Called to check the validity of swap params previously communicated
  * by swap_copy_transaction_parameters which is called from Ledger SDK.
@@ -0,0 +1,89 @@
+/* Tezos Ledger application - Handler for getting the capabilities
+
+   Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <stdint.h>
+
+#include <io.h>
+#include <os_io_seproxyhal.h>  // G_io_apdu_media
+
+#include "get_capabilities.h"
+
+#include "exception.h"
+#include "globals.h"
+#include "sign.h"
+#include "utils.h"
+
+/**
+ * @brief Get the largest data packet accepted on a transport
+ *
+ * @param media: transport
+ * @return uint8_t: size of the data, 0 if the transport is not available
+ */
+static uint8_t
+max_packet_size(io_apdu_media_t media)
+{
+    switch (media) {
+    case IO_APDU_MEDIA_USB_HID:
+        return SIGN_PACKET_MAX_SIZE;
+#ifdef HAVE_BLE
+    case IO_APDU_MEDIA_BLE:
+        return SIGN_PACKET_MAX_SIZE;
+#endif
+    case IO_APDU_MEDIA_U2F:
+        return SIGN_PACKET_MAX_SIZE_U2F;
+    default:
+        return 0;
+    }
+}
+
+void
+handle_get_capabilities(uint8_t requested_modes)
+{
+    uint8_t response[12];
+    uint8_t modes
+        = CAPABILITY_BATCH | CAPABILITY_WINDOWED | CAPABILITY_MULTI_KEY;
+
+    FUNC_ENTER(("requested_modes=0x%x", requested_modes));
+
+    global.windowed = (requested_modes & CAPABILITY_WINDOWED) != 0;
+    if (N_settings.blindsigning) {
+        modes |= CAPABILITY_PRE_HASHED;
+    }
+
+    response[0] = CAPABILITIES_VERSION;
+    response[1] = max_packet_size(G_io_apdu_media);
+    response[2] = max_packet_size(IO_APDU_MEDIA_USB_HID);
+#ifdef HAVE_BLE
+    response[3] = max_packet_size(IO_APDU_MEDIA_BLE);
+#else
+    response[3] = 0;
+#endif
+    response[4] = max_packet_size(IO_APDU_MEDIA_U2F);
+    response[5] = modes;
+    response[6] = MAX_BATCH_OPERATIONS;
+#ifndef TARGET_NANOS
+    response[7] = SIGN_STAGING_NB_PACKETS;
+    U2BE_ENCODE(response, 8, SIGN_STAGING_SIZE);
+    U2BE_ENCODE(response, 10, SIGN_HASH_PENDING_SIZE);
+#else
+    response[7] = 0;
+    U2BE_ENCODE(response, 8, 0);
+    U2BE_ENCODE(response, 10, 0);
+#endif
+    io_send_response_pointer(response, sizeof(response), SW_OK);
+
+    FUNC_LEAVE();
+}
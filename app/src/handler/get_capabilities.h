@@ -0,0 +1,43 @@
+/* Tezos Ledger application - Handler for getting the capabilities
+
+   Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+/// Version of the format of the capabilities
+#define CAPABILITIES_VERSION 1
+
+/// Fast signing modes
+#define CAPABILITY_BATCH      0x01u  /// INS_SIGN_BATCH
+#define CAPABILITY_WINDOWED   0x02u  /// Packets acknowledged before they
+                                     /// are parsed, once requested
+#define CAPABILITY_PRE_HASHED 0x04u  /// INS_SIGN_HASH and the hash-only
+                                     /// signing, blind signing enabled
+#define CAPABILITY_MULTI_KEY  0x08u  /// Several keys signing the same
+                                     /// message, see SIGN_MAX_KEYS
+
+/**
+ * @brief Handle capabilities request.
+ * Send APDU response containing the largest data packet accepted on
+ * each transport, the fast signing modes and the sizes of the buffers
+ * of the signing flows, for the host to choose how to send a message.
+ *
+ * The windowed mode changes the responses to the signing APDUs, so it
+ * is only used once requested, until the next capabilities request.
+ *
+ * @param requested_modes: fast signing modes requested by the host,
+ *                         only `CAPABILITY_WINDOWED` may be set
+ */
+void handle_get_capabilities(uint8_t requested_modes);
@@ -0,0 +1,59 @@
+/* Tezos Ledger application - Handler for getting the profiling counters
+
+   Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#ifdef MAVRYK_PROFILE
+
+#include <string.h>
+
+#include <io.h>
+
+#include "get_profile.h"
+
+#include "exception.h"
+#include "profile.h"
+#include "utils.h"
+
+void
+handle_get_profile(bool reset)
+{
+    uint8_t response[((MV_PROFILE_NB_SECTIONS * 2) + 1 + MV_PROFILE_NB_FLOWS)
+                     * sizeof(uint32_t)];
+    size_t  ofs = 0;
+    size_t  i;
+
+    FUNC_ENTER(("reset=%d", reset));
+
+    for (i = 0; i < MV_PROFILE_NB_SECTIONS; i++) {
+        U4BE_ENCODE(response, ofs, mv_profile[i].calls);
+        U4BE_ENCODE(response, ofs + 4, mv_profile[i].units);
+        ofs += 8;
+    }
+    U4BE_ENCODE(response, ofs, mv_profile_stack_size());
+    ofs += 4;
+    for (i = 0; i < MV_PROFILE_NB_FLOWS; i++) {
+        U4BE_ENCODE(response, ofs, mv_profile_stack[i]);
+        ofs += 4;
+    }
+    if (reset) {
+        memset(mv_profile, 0, sizeof(mv_profile));
+        memset(mv_profile_stack, 0, sizeof(mv_profile_stack));
+    }
+    io_send_response_pointer(response, sizeof(response), SW_OK);
+
+    FUNC_LEAVE();
+}
+
+#endif
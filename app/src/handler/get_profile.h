@@ -0,0 +1,31 @@
+/* Tezos Ledger application - Handler for getting the profiling counters
+
+   Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#ifdef MAVRYK_PROFILE
+
+#include <stdbool.h>
+
+/**
+ * @brief Handle profiling counters request.
+ * Send APDU response containing the counters of every profiled section.
+ *
+ * @param reset: whether to reset the counters once sent
+ */
+void handle_get_profile(bool reset);
+
+#endif
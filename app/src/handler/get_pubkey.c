@@ -47,11 +47,11 @@ send_pubkey_response(bool confirm)
 
     if (confirm) {
         buffer_t bufs[2] = {
-            {.ptr    = (const uint8_t *)&global.keys.pubkey.W_len,
+            {.ptr    = (const uint8_t *)&global.keys.pubkey.u.pubkey.W_len,
              .size   = 1,
              .offset = 0u},
-            {.ptr    = global.keys.pubkey.W,
-             .size   = global.keys.pubkey.W_len,
+            {.ptr    = global.keys.pubkey.u.pubkey.W,
+             .size   = global.keys.pubkey.u.pubkey.W_len,
              .offset = 0u},
         };
         io_send_response_buffers(bufs, 2, SW_OK);
@@ -59,7 +59,7 @@ send_pubkey_response(bool confirm)
         io_send_sw(EXC_REJECT);
     }
 
-    memset(&global.keys, 0, sizeof(global.keys));
+    memset(&global.keys.pubkey.u, 0, sizeof(global.keys.pubkey.u));
 
     FUNC_LEAVE();
 }
@@ -74,13 +74,13 @@ handle_get_public_key(buffer_t *cdata, derivation_type_t derivation_type,
     global.path_with_curve.derivation_type = derivation_type;
     MV_LIB_CHECK(read_bip32_path(&global.path_with_curve.bip32_path, cdata));
 
-    // Derive public key and store it on global.keys.pubkey
-    MV_LIB_CHECK(derive_pk(&global.keys.pubkey,
+    // Derive public key and store it on global.keys.pubkey.u.pubkey
+    MV_LIB_CHECK(derive_pk(&global.keys.pubkey.u.pubkey,
                            global.path_with_curve.derivation_type,
                            &global.path_with_curve.bip32_path));
 
     if (prompt) {
-        ui_pubkey_review(&global.keys.pubkey,
+        ui_pubkey_review(&global.keys.pubkey.u.pubkey,
                          global.path_with_curve.derivation_type,
                          &send_pubkey_response);
     } else {
@@ -89,3 +89,84 @@ handle_get_public_key(buffer_t *cdata, derivation_type_t derivation_type,
 
     MV_POSTAMBLE;
 }
+
+/**
+ * @brief Write the public keys of the children of a parent path in the
+ *        response of the public keys export
+ *
+ * @param len: output length of the response
+ * @param derivation_type: derivation_type of the keys
+ * @param bip32_path: parent path
+ * @param index: index of the first child
+ * @param count: number of keys requested
+ * @return mv_exc return success/failure using error code
+ */
+static mv_exc
+write_public_keys(size_t *len, derivation_type_t derivation_type,
+                  const bip32_path_t *bip32_path, uint32_t index,
+                  uint8_t count)
+{
+    apdu_pubkeys_state_t *pubkeys  = &global.keys.pubkey.u.pubkeys;
+    size_t                key_size = 1u;
+    size_t                ofs      = 1u;
+    uint8_t               nb_keys;
+    uint8_t               i;
+
+    MV_PREAMBLE(("derivation_type=%d, index=%u, count=%u", derivation_type,
+                 index, count));
+
+    if ((derivation_type == DERIVATION_TYPE_ED25519)
+        || (derivation_type == DERIVATION_TYPE_BIP32_ED25519)) {
+        key_size += 33u;
+    } else {
+        key_size += 65u;
+    }
+    nb_keys = MIN(count, (sizeof(pubkeys->response) - 1u) / key_size);
+
+    for (i = 0; i < nb_keys; i++) {
+        MV_LIB_CHECK(derive_child_pk(&pubkeys->pubkey, derivation_type,
+                                     bip32_path, index + i));
+        pubkeys->response[ofs] = pubkeys->pubkey.W_len;
+        memcpy(pubkeys->response + ofs + 1u, pubkeys->pubkey.W,
+               pubkeys->pubkey.W_len);
+        ofs += 1u + pubkeys->pubkey.W_len;
+    }
+    pubkeys->response[0] = nb_keys;
+    *len                 = ofs;
+
+    MV_LIB_POSTAMBLE;
+}
+
+void
+handle_get_public_keys(buffer_t *cdata, derivation_type_t derivation_type)
+{
+    uint32_t     index = 0;
+    uint8_t      count = 0;
+    size_t       len   = 0;
+    bip32_path_t bip32_path;
+    buffer_t     path_buf;
+
+    MV_PREAMBLE(("cdata=%p, derivation_type=%d", cdata, derivation_type));
+
+    MV_ASSERT(EXC_WRONG_LENGTH_FOR_INS,
+              buffer_read_u32(cdata, &index, BE)
+                  && buffer_read_u8(cdata, &count));
+    MV_ASSERT(EXC_WRONG_VALUES, count != 0u);
+    // Assert the index of the last child does not overflow
+    MV_ASSERT(EXC_WRONG_VALUES, index <= UINT32_MAX - (count - 1u));
+
+    path_buf.ptr    = cdata->ptr + cdata->offset;
+    path_buf.size   = cdata->size - cdata->offset;
+    path_buf.offset = 0u;
+    MV_LIB_CHECK(read_bip32_path(&bip32_path, &path_buf));
+
+    claim_keys(KEYS_FLOW_PUBKEY);
+    MV_LIB_CHECK(
+        write_public_keys(&len, derivation_type, &bip32_path, index, count));
+
+    io_send_response_pointer(global.keys.pubkey.u.pubkeys.response, len,
+                             SW_OK);
+    memset(&global.keys.pubkey.u, 0, sizeof(global.keys.pubkey.u));
+
+    MV_POSTAMBLE;
+}
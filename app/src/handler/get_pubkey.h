@@ -28,6 +28,17 @@
 
 #include "keys.h"
 
+#define PUBKEYS_RESPONSE_SIZE 235  /// Same as MAX_APDU_SIZE
+
+/**
+ * @brief Struct to track state/info about a public keys export.
+ *
+ */
+typedef struct {
+    cx_ecfp_public_key_t pubkey;  /// Public key being derived.
+    uint8_t response[PUBKEYS_RESPONSE_SIZE];  /// Response being built.
+} apdu_pubkeys_state_t;
+
 /**
  * @brief Handle public key request.
  * If successfully parse BIP32 path, send APDU response containing the public
@@ -42,3 +53,24 @@
  */
 void handle_get_public_key(buffer_t *cdata, derivation_type_t derivation_type,
                            bool prompt);
+
+/**
+ * @brief Handle public keys request.
+ * If successfully parse the start index, the number of keys and the
+ * BIP32 parent path, send APDU response containing the public keys of
+ * the children of the parent path, from the start index.
+ *
+ * The keys are sent in a single response of PUBKEYS_RESPONSE_SIZE
+ * bytes, so at most 6 ED25519 or BIP32_ED25519 keys and at most 3
+ * SECP256K1 or SECP256R1 keys are sent, the next ones must be requested
+ * again from the next index.
+ *
+ * Each public key is derived from the seed, as for a single public key,
+ * so this is not faster than a public key request per child.
+ *
+ * @param cdata: buffer containing the start index, the number of keys
+ *               and the BIP32 parent path
+ * @param derivation_type: derivation_type of the keys
+ */
+void handle_get_public_keys(buffer_t         *cdata,
+                            derivation_type_t derivation_type);
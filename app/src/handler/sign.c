@@ -38,6 +38,7 @@
 #include "globals.h"
 #include "handle_swap.h"
 #include "keys.h"
+#include "profile.h"
 #include "sign.h"
 #include "ui_stream.h"
 
@@ -51,17 +52,33 @@
 /* Prototypes */
 
 static void sign_packet(void);
+static void send_error(mv_exc error_code);
 static void send_reject(int error_code);
 static void send_continue(void);
+static void send_early_continue(void);
+static void send_staged_continue(void);
+static void stage_packet(buffer_t *cdata);
 static void send_cancel(void);
 static void refill(void);
 static void refill_all(void);
+#ifdef HAVE_NBGL
+static void refill_page(void);
+#endif
+#ifdef MV_UI_STREAM_PREFETCH
+static void prefetch_review(void);
+#endif
 static void stream_cb(mv_ui_cb_type_t cb_type);
 static void start_displaying_signature_review(void);
 static void init_blind_stream(void);
+static void init_hash(void);
+static void update_hash(buffer_t *cdata, bool last);
 static void handle_data_apdu_clear(buffer_t *cdata, bool last);
 static void handle_data_apdu_blind(void);
 static void pass_from_clear_to_summary(void);
+static void init_review_parser(void);
+#ifndef TARGET_NANOS
+static bool check_first_packet(buffer_t *cdata, bool last);
+#endif
 #ifdef HAVE_BAGL
 static void init_too_many_screens_stream(void);
 #endif
@@ -70,6 +87,11 @@ static void continue_blindsign_cb(void);
 static void pass_from_summary_to_blind(void);
 #endif
 static void init_summary_stream(void);
+static void start_batch_operation(void);
+static void batch_operation_done(void);
+static void send_batch_signature(void);
+static void sign_with_keys(const uint8_t *hash, size_t hashlen, uint8_t *sigs,
+                           size_t *size);
 
 /* Macros */
 
@@ -136,6 +158,25 @@ mv_ui_stream_push_warning_not_trusted(const char *title_reason,
     FUNC_LEAVE();
 }
 
+/**
+ * @brief Warn that expressions displayed by their size were not expanded.
+ */
+static void
+mv_ui_stream_push_warning_folded(void)
+{
+    FUNC_ENTER(("void"));
+#ifdef TARGET_NANOS
+    mv_ui_stream_push(MV_UI_STREAM_CB_NOCB, "Some values",
+                      "were not shown.", MV_UI_LAYOUT_HOME_B,
+                      MV_UI_ICON_NONE);
+#else
+    mv_ui_stream_push(MV_UI_STREAM_CB_NOCB, "Some values",
+                      "were not shown.", MV_UI_LAYOUT_HOME_PB,
+                      MV_UI_ICON_WARNING);
+#endif
+    FUNC_LEAVE();
+}
+
 void
 mv_ui_stream_push_learn_more(void)
 {
@@ -151,21 +192,33 @@ static void
 sign_packet(void)
 {
     buffer_t bufs[2] = {0};
-    uint8_t  sig[MAX_SIGNATURE_SIZE];
+    uint8_t  sig[SIGN_MAX_KEYS * (1 + SIGN_KEY_SIGNATURE_MAX_SIZE)];
     MV_PREAMBLE(("void"));
 
     APDU_SIGN_ASSERT_STEP(SIGN_ST_WAIT_USER_INPUT);
     APDU_SIGN_ASSERT(global.keys.apdu.sign.received_last_msg);
 
+    if (global.keys.apdu.sign.batch.nb_operations != 0) {
+        MV_CHECK(send_batch_signature());
+        MV_SUCCEED();
+    }
+
     MV_CHECK(swap_check_validity());
 
     bufs[0].ptr  = global.keys.apdu.hash.final_hash;
     bufs[0].size = sizeof(global.keys.apdu.hash.final_hash);
     bufs[1].ptr  = sig;
     bufs[1].size = sizeof(sig);
-    MV_CHECK(sign(global.path_with_curve.derivation_type,
-                  &global.path_with_curve.bip32_path, bufs[0].ptr,
-                  bufs[0].size, sig, &bufs[1].size));
+    if (global.keys.apdu.sign.nb_extra_keys != 0) {
+        MV_CHECK(
+            sign_with_keys(bufs[0].ptr, bufs[0].size, sig, &bufs[1].size));
+    } else {
+        MV_CHECK(sign(global.path_with_curve.derivation_type,
+                      &global.path_with_curve.bip32_path, bufs[0].ptr,
+                      bufs[0].size, sig, &bufs[1].size));
+    }
+    // The private key only outlives a signature within a batch
+    clear_derived_key_cache();
 
     /* If we aren't returning the hash, zero its buffer. */
     if (!global.keys.apdu.sign.return_hash) {
@@ -178,13 +231,37 @@ sign_packet(void)
     MV_POSTAMBLE;
 }
 
+/**
+ * @brief Fail with an error code.
+ *
+ * If the host has already been asked for the next packet, the error is
+ * the response to that packet instead.
+ *
+ * @param error_code: error code to reply
+ */
+static void
+send_error(mv_exc error_code)
+{
+    MV_PREAMBLE(("error_code=0x%x", error_code));
+
+    clear_derived_key_cache();
+    if (global.keys.apdu.sign.u.clear.acknowledged) {
+        global.deferred_sw = error_code;
+        global.step        = ST_ERROR;
+        MV_SUCCEED();
+    }
+    MV_FAIL(error_code);
+
+    MV_POSTAMBLE;
+}
+
 static void
 send_reject(int error_code)
 {
     MV_PREAMBLE(("void"));
 
     APDU_SIGN_ASSERT_STEP(SIGN_ST_WAIT_USER_INPUT);
-    MV_FAIL(error_code);
+    MV_CHECK(send_error(error_code));
     MV_POSTAMBLE;
 }
 
@@ -199,7 +276,9 @@ send_continue(void)
 
     if (global.keys.apdu.sign.u.clear.received_msg) {
         global.keys.apdu.sign.u.clear.received_msg = false;
-        io_send_sw(SW_OK);
+        if (!global.keys.apdu.sign.u.clear.acknowledged) {
+            io_send_sw(SW_OK);
+        }
     }
 
     global.keys.apdu.sign.step = SIGN_ST_WAIT_DATA;
@@ -207,6 +286,86 @@ send_continue(void)
     MV_POSTAMBLE;
 }
 
+/**
+ * @brief Acknowledge the packet being handled before parsing it.
+ *
+ * The status is transmitted at once, instead of when the handler
+ * returns, so that the host sends the next packet while this one is
+ * parsed. The packet has been staged or, on Nano S, stays in the APDU
+ * buffer, which is only overwritten when the next one is received.
+ *
+ * Only in the windowed mode, for the flows without display: a parsing
+ * error is then handled with the last packet.
+ */
+static void
+send_early_continue(void)
+{
+    io_send_sw(SW_OK);
+    global.keys.apdu.sign.u.clear.acknowledged = true;
+}
+
+/**
+ * @brief Acknowledge the last packet received while it is still staged.
+ *
+ * During a review in the windowed mode, the host is asked for the next
+ * packet as soon as the staging buffer can hold it, without waiting for
+ * the parser to reach the end of the packets already received.
+ */
+static void
+send_staged_continue(void)
+{
+#ifndef TARGET_NANOS
+    mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+
+    if (global.windowed && (global.step == ST_CLEAR_SIGN)
+        && global.keys.apdu.sign.u.clear.received_msg
+        && !global.keys.apdu.sign.received_last_msg
+        && !global.keys.apdu.sign.u.clear.invalid
+        && ((st->regs.ilen + SIGN_PACKET_MAX_SIZE) <= SIGN_STAGING_SIZE)) {
+        global.keys.apdu.sign.u.clear.received_msg = false;
+        global.keys.apdu.sign.u.clear.acknowledged = true;
+        io_send_sw(SW_OK);
+    }
+#endif
+}
+
+/**
+ * @brief Give a packet to the parser.
+ *
+ * The packet is appended to the input not parsed yet, which is first
+ * moved to the start of the staging buffer. On Nano S, there is no
+ * staging buffer so the previous packets must have been fully parsed
+ * and the packet is parsed from the APDU buffer.
+ *
+ * @param cdata: packet received
+ */
+static void
+stage_packet(buffer_t *cdata)
+{
+    mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+
+    MV_PREAMBLE(("cdata=0x%p", cdata));
+
+#ifdef TARGET_NANOS
+    // check we consume all input before asking for more
+    MV_ASSERT(EXC_UNEXPECTED_SIGN_STATE, st->regs.ilen == 0);
+    mv_parser_refill(st, cdata->ptr, cdata->size);
+#else
+    uint8_t *staging = global.keys.apdu.sign.u.clear.staging;
+    size_t   unread  = st->regs.ilen;
+
+    MV_ASSERT(EXC_UNEXPECTED_SIGN_STATE,
+              (unread + cdata->size) <= SIGN_STAGING_SIZE);
+    if (unread != 0) {
+        memmove(staging, st->regs.ibuf + st->regs.iofs, unread);
+    }
+    memcpy(staging + unread, cdata->ptr, cdata->size);
+    mv_parser_refill(st, staging, unread + cdata->size);
+#endif
+
+    MV_POSTAMBLE;
+}
+
 static void
 refill_blo_im_full(void)
 {
@@ -258,6 +417,18 @@ refill_blo_im_full(void)
     wrote = mv_ui_stream_push(MV_UI_STREAM_CB_NOCB, st->field_info.field_name,
                               global.line_buf, MV_UI_LAYOUT_BN,
                               MV_UI_ICON_NONE);
+    if (st->field_info.is_field_folded) {
+        // The expression is only read, unless the user asks to see it
+        global.keys.apdu.sign.u.clear.nb_folded++;
+#ifdef TARGET_NANOS
+        mv_ui_stream_push(MV_UI_STREAM_CB_EXPAND, "Show value", "",
+                          MV_UI_LAYOUT_HOME_PB, MV_UI_ICON_EYE);
+#else
+        mv_ui_stream_push(MV_UI_STREAM_CB_EXPAND, "Show",
+                          st->field_info.field_name, MV_UI_LAYOUT_HOME_PB,
+                          MV_UI_ICON_EYE);
+#endif
+    }
 
 #elif HAVE_NBGL
     PRINTF("[DEBUG] field=%s complex=%d\n", st->field_info.field_name,
@@ -310,12 +481,24 @@ refill_blo_done(void)
         MV_SUCCEED();
     }
 
+    if (global.keys.apdu.sign.batch.nb_operations != 0) {
+        MV_CHECK(batch_operation_done());
+        MV_SUCCEED();
+    }
+
 #ifdef HAVE_BAGL
     if (global.step == ST_SUMMARY_SIGN) {
         init_too_many_screens_stream();
         MV_SUCCEED();
     }
-    mv_ui_stream_push_accept_reject();
+    if (global.keys.apdu.sign.u.clear.nb_folded != 0) {
+        // The expressions left folded can no longer be expanded
+        mv_ui_stream_push_warning_folded();
+        mv_ui_stream_push_risky_accept_reject(MV_UI_STREAM_CB_ACCEPT,
+                                              MV_UI_STREAM_CB_REJECT);
+    } else {
+        mv_ui_stream_push_accept_reject();
+    }
 #endif
 
 #ifdef HAVE_NBGL
@@ -336,12 +519,28 @@ refill_error(void)
     MV_PREAMBLE(("void"));
 
     global.keys.apdu.sign.step = SIGN_ST_WAIT_USER_INPUT;
+    // The status of the packet has already been sent in the windowed
+    // mode: the error will be handled with the last packet
+    if (global.keys.apdu.sign.u.clear.acknowledged) {
+        global.keys.apdu.sign.u.clear.received_msg = false;
+        global.keys.apdu.sign.u.clear.parse_error  = true;
+        global.keys.apdu.sign.step                 = SIGN_ST_WAIT_DATA;
+        MV_SUCCEED();
+    }
 #ifdef HAVE_SWAP
     if (G_called_from_swap) {
         global.keys.apdu.sign.u.clear.received_msg = false;
+        if (st->errno == MV_ERR_UNEXPECTED) {
+            MV_FAIL(EXC_REJECT);
+        }
         MV_FAIL(EXC_PARSE_ERROR);
     }
 #endif
+    // No blind signing fallback for a batch
+    if (global.keys.apdu.sign.batch.nb_operations != 0) {
+        global.keys.apdu.sign.u.clear.received_msg = false;
+        MV_FAIL(EXC_PARSE_ERROR);
+    }
 
     // clang-format off
 #ifdef HAVE_BAGL
@@ -395,19 +594,39 @@ refill_error(void)
     MV_POSTAMBLE;
 }
 
+/**
+ * @brief Get what the parser does with a full output: only the clear
+ * review displays the fields.
+ *
+ * @return mv_operation_run_policy: policy of the parser driver
+ */
+static mv_operation_run_policy
+run_policy(void)
+{
+#ifdef HAVE_SWAP
+    if (G_called_from_swap) {
+        return MV_OPERATION_RUN_DISCARD;
+    }
+#endif
+    if (global.step == ST_SUMMARY_SIGN) {
+        return MV_OPERATION_RUN_DISCARD;
+    }
+    return MV_OPERATION_RUN_DISPLAY;
+}
+
 static void
 refill(void)
 {
     mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
     MV_PREAMBLE(("void"));
 
-    while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
-        // Loop while the result is successful and not blocking
-    }
+    MV_PROFILE_CALL(MV_PROFILE_PARSE);
+    mv_operation_parser_run(st, run_policy(), NULL, 0);
     PRINTF("[DEBUG] refill(errno: %s)\n", mv_parser_result_name(st->errno));
     // clang-format off
     switch (st->errno) {
     case MV_BLO_IM_FULL: MV_CHECK(refill_blo_im_full());
+        send_staged_continue();
         break;
     case MV_BLO_FEED_ME: MV_CHECK(send_continue());
         break;
@@ -440,6 +659,128 @@ refill_all(void)
     MV_POSTAMBLE;
 }
 
+#ifdef MV_UI_STREAM_PREFETCH
+/**
+ * @brief Parse the next screen of the review while the user reads the
+ * current one.
+ *
+ * Only a screen is pushed, or the next packet asked for with
+ * `send_continue`. The end of the operation, the parsing errors and the
+ * switch to the summary change the review, and the parser must not go
+ * past a folded expression the user may ask to see: these are left for
+ * `refill`, once the user reaches the last screen pushed.
+ */
+static void
+prefetch_review(void)
+{
+    mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+    MV_PREAMBLE(("void"));
+
+    if ((global.step != ST_CLEAR_SIGN)
+        || (global.keys.apdu.sign.step != SIGN_ST_WAIT_USER_INPUT)
+        || st->field_info.is_field_folded
+        || (N_settings.blindsigning
+            && (SCREEN_DISPLAYED >= NB_MAX_SCREEN_ALLOWED))) {
+        MV_SUCCEED();
+    }
+
+    MV_PROFILE_CALL(MV_PROFILE_PARSE);
+    mv_operation_parser_run(st, MV_OPERATION_RUN_DISPLAY, NULL, 0);
+    // clang-format off
+    switch (st->errno) {
+    case MV_BLO_IM_FULL: MV_CHECK(refill_blo_im_full());
+        send_staged_continue();
+        break;
+    case MV_BLO_FEED_ME: MV_CHECK(send_continue());
+        break;
+    default:
+        break;
+    }
+    // clang-format on
+    MV_POSTAMBLE;
+}
+#endif
+
+#ifdef HAVE_NBGL
+/**
+ * @brief Fill the page under construction in one go.
+ *
+ * The chunks of the parser output are pushed until the page is
+ * complete, instead of going back through the navigation callback
+ * after each chunk of a pair. It stops early when more data, a user
+ * input or an error handling is needed.
+ */
+static void
+refill_page(void)
+{
+    mv_parser_state *st    = &global.keys.apdu.sign.u.clear.parser_state;
+    int16_t          total = global.ui.stream.total;
+
+    MV_PREAMBLE(("void"));
+
+    do {
+        MV_CHECK(refill());
+    } while ((total == global.ui.stream.total) && !global.ui.stream.full
+             && (global.step == ST_CLEAR_SIGN)
+             && (global.keys.apdu.sign.step == SIGN_ST_WAIT_USER_INPUT)
+             && (st->errno == MV_BLO_IM_FULL));
+
+    MV_POSTAMBLE;
+}
+#endif
+
+#ifndef TARGET_NANOS
+/**
+ * @brief Check the first packet before it is acknowledged.
+ *
+ * The first packet holds the magic byte, and the tags and sizes of the
+ * first operations. It is parsed at once in validate-only mode, and the
+ * parser is then reset so that the packet can be parsed again for real.
+ *
+ * @param cdata: first packet of the operation
+ * @param last: whether the packet is the last one
+ * @return bool: whether the packet parsed without error
+ */
+static bool
+check_first_packet(buffer_t *cdata, bool last)
+{
+    mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+    bool             valid;
+
+    mv_operation_parser_init(st, MV_UNKNOWN_SIZE, false);
+    mv_operation_parser_set_validate_only(st, true);
+    mv_parser_refill(st, cdata->ptr, cdata->size);
+    if (last) {
+        mv_operation_parser_set_size(st, cdata->size);
+    }
+    mv_parser_flush(st, global.line_buf, MV_UI_STREAM_CONTENTS_SIZE);
+
+    valid = !MV_IS_ERR(
+        mv_operation_parser_run(st, MV_OPERATION_RUN_DISCARD, NULL, 0));
+
+    init_review_parser();
+
+    return valid;
+}
+#endif
+
+/**
+ * @brief Reset the parser for the review of an operation.
+ */
+static void
+init_review_parser(void)
+{
+    mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+
+    mv_operation_parser_init(st, MV_UNKNOWN_SIZE, false);
+#if defined(HAVE_BAGL) && defined(MAVRYK_COLLAPSE)
+    // The large expressions are only displayed by their size at first
+    mv_operation_parser_set_collapse(st, N_settings.expert_mode);
+#endif
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, global.line_buf, MV_UI_STREAM_CONTENTS_SIZE);
+}
+
 static void
 pass_from_clear_to_summary(void)
 {
@@ -449,6 +790,9 @@ pass_from_clear_to_summary(void)
 
     global.step                = ST_SUMMARY_SIGN;
     global.keys.apdu.sign.step = SIGN_ST_WAIT_DATA;
+    // The summary only displays the totals: stop formatting the fields
+    mv_operation_parser_set_validate_only(
+        &global.keys.apdu.sign.u.clear.parser_state, true);
 #ifdef HAVE_NBGL
     init_blind_stream();
 #endif
@@ -466,19 +810,20 @@ send_cancel(void)
     global.keys.apdu.sign.step = SIGN_ST_IDLE;
 
     switch (st->errno) {
-    case MV_ERR_INVALID_STATE:
-        MV_FAIL(EXC_UNEXPECTED_STATE);
-        break;
     case MV_ERR_INVALID_TAG:
     case MV_ERR_INVALID_OP:
     case MV_ERR_INVALID_DATA:
     case MV_ERR_UNSUPPORTED:
     case MV_ERR_TOO_LARGE:
     case MV_ERR_TOO_DEEP:
-        MV_FAIL(EXC_PARSE_ERROR);
+        MV_CHECK(send_error(EXC_PARSE_ERROR));
+        break;
+    case MV_ERR_UNEXPECTED:
+        MV_CHECK(send_error(EXC_REJECT));
         break;
+    case MV_ERR_INVALID_STATE:
     default:
-        MV_FAIL(EXC_UNEXPECTED_STATE);
+        MV_CHECK(send_error(EXC_UNEXPECTED_STATE));
     }
 
     MV_POSTAMBLE;
@@ -509,12 +854,22 @@ stream_cb(mv_ui_cb_type_t cb_type)
     // clang-format off
     switch (cb_type) {
     case MV_UI_STREAM_CB_ACCEPT:           MV_CHECK(sign_packet());                break;
+#ifdef HAVE_BAGL
     case MV_UI_STREAM_CB_REFILL:           MV_CHECK(refill());                     break;
+#else  // HAVE_NBGL
+    case MV_UI_STREAM_CB_REFILL:           MV_CHECK(refill_page());                break;
+#endif
     case MV_UI_STREAM_CB_REJECT:           send_reject(EXC_REJECT);                break;
     case MV_UI_STREAM_CB_BLINDSIGN_REJECT: send_reject(EXC_PARSE_ERROR);           break;
     case MV_UI_STREAM_CB_CANCEL:           MV_CHECK(send_cancel());                break;
 #ifdef HAVE_BAGL
     case MV_UI_STREAM_CB_BLINDSIGN:        MV_CHECK(pass_from_clear_to_blind());   break;
+    case MV_UI_STREAM_CB_EXPAND:
+        if (mv_operation_parser_expand(
+                &global.keys.apdu.sign.u.clear.parser_state)) {
+            global.keys.apdu.sign.u.clear.nb_folded--;
+        }
+        break;
 #else  // HAVE_NBGL
     case MV_UI_STREAM_CB_BLINDSIGN:
         if (global.step == ST_CLEAR_SIGN) {
@@ -534,17 +889,50 @@ stream_cb(mv_ui_cb_type_t cb_type)
     MV_POSTAMBLE;
 }
 
+/// Largest title of the summary of an operation of a batch
+#define BATCH_OPERATION_TITLE_SIZE sizeof("Operation 255/255")
+/// Largest summary of an operation of a batch: its amount and its fee
+#define BATCH_OPERATION_VALUE_SIZE \
+    (2 * (MV_DECIMAL_BUFFER_SIZE(MV_NUM_BUFFER_SIZE / 8) + 5) + 5)
+
+/**
+ * @brief Format the summary of an operation of the batch.
+ *
+ * @param index: index of the operation in the batch
+ * @param title: output buffer of at least `BATCH_OPERATION_TITLE_SIZE`
+ *               bytes
+ * @param value: output buffer of at least `BATCH_OPERATION_VALUE_SIZE`
+ *               bytes
+ */
+static void
+format_batch_operation(uint8_t index, char *title, char *value)
+{
+    apdu_sign_batch_state_t *batch = &global.keys.apdu.sign.batch;
+    char amount[MV_DECIMAL_BUFFER_SIZE(MV_NUM_BUFFER_SIZE / 8) + 5] = {0};
+    char fee[MV_DECIMAL_BUFFER_SIZE(MV_NUM_BUFFER_SIZE / 8) + 5]    = {0};
+
+    snprintf(title, BATCH_OPERATION_TITLE_SIZE, "Operation %d/%d",
+             index + 1, batch->nb_operations);
+    mv_mumav_to_string(amount, sizeof(amount), batch->amounts[index]);
+    mv_mumav_to_string(fee, sizeof(fee), batch->fees[index]);
+    snprintf(value, BATCH_OPERATION_VALUE_SIZE, "%s\nFee %s", amount, fee);
+}
+
 #ifdef HAVE_BAGL
 static void
 push_next_summary_screen(void)
 {
-#define FINAL_HASH       global.keys.apdu.hash.final_hash
-#define SUMMARYSIGN_STEP global.keys.apdu.sign.u.summary.step
+#define FINAL_HASH        global.keys.apdu.hash.final_hash
+#define SUMMARYSIGN_STEP  global.keys.apdu.sign.u.summary.step
+#define SUMMARYSIGN_INDEX global.keys.apdu.sign.u.summary.batch_index
 
     char num_buffer[MV_DECIMAL_BUFFER_SIZE(MV_NUM_BUFFER_SIZE / 8)] = {0};
     char hash_buffer[MV_BASE58_BUFFER_SIZE(sizeof(FINAL_HASH))]     = {0};
+    char title[BATCH_OPERATION_TITLE_SIZE]                          = {0};
+    char value[BATCH_OPERATION_VALUE_SIZE]                          = {0};
     mv_operation_state *op
         = &global.keys.apdu.sign.u.clear.parser_state.operation;
+    uint8_t nb_operations = global.keys.apdu.sign.batch.nb_operations;
 
     MV_PREAMBLE(("void"));
 
@@ -552,35 +940,52 @@ push_next_summary_screen(void)
     case SUMMARYSIGN_ST_OPERATION:
         SUMMARYSIGN_STEP = SUMMARYSIGN_ST_NB_TX;
 
-        snprintf(num_buffer, sizeof(num_buffer), "%d", op->batch_index);
+        snprintf(num_buffer, sizeof(num_buffer), "%d",
+                 op->summary.nb_operations);
         mv_ui_stream_push(MV_UI_STREAM_CB_NOCB, "Number of Tx", num_buffer,
                           MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
         break;
     case SUMMARYSIGN_ST_NB_TX:
         SUMMARYSIGN_STEP = SUMMARYSIGN_ST_AMOUNT;
 
-        mv_mumav_to_string(num_buffer, sizeof(num_buffer), op->total_amount);
+        mv_mumav_to_string(num_buffer, sizeof(num_buffer),
+                           op->summary.total_amount);
         mv_ui_stream_push(MV_UI_STREAM_CB_NOCB, "Total amount", num_buffer,
                           MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
         break;
     case SUMMARYSIGN_ST_AMOUNT:
         SUMMARYSIGN_STEP = SUMMARYSIGN_ST_FEE;
 
-        mv_mumav_to_string(num_buffer, sizeof(num_buffer), op->total_fee);
+        mv_mumav_to_string(num_buffer, sizeof(num_buffer),
+                           op->summary.total_fee);
         mv_ui_stream_push(MV_UI_STREAM_CB_NOCB, "Total fee", num_buffer,
                           MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
         break;
     case SUMMARYSIGN_ST_FEE:
-        SUMMARYSIGN_STEP = SUMMARYSIGN_ST_HASH;
+        SUMMARYSIGN_STEP  = SUMMARYSIGN_ST_HASH;
+        SUMMARYSIGN_INDEX = 0;
 
         if (mv_format_base58(FINAL_HASH, sizeof(FINAL_HASH), hash_buffer,
                              sizeof(hash_buffer))) {
             MV_FAIL(EXC_UNKNOWN);
         }
-        mv_ui_stream_push_all(MV_UI_STREAM_CB_NOCB, "Hash", hash_buffer,
-                              MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
+        mv_ui_stream_push_all(MV_UI_STREAM_CB_NOCB,
+                              (nb_operations != 0) ? "Batch hash" : "Hash",
+                              hash_buffer, MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
         break;
     case SUMMARYSIGN_ST_HASH:
+    case SUMMARYSIGN_ST_BATCH_OPERATION:
+        // Then each operation of a batch
+        if (SUMMARYSIGN_INDEX < nb_operations) {
+            SUMMARYSIGN_STEP = SUMMARYSIGN_ST_BATCH_OPERATION;
+
+            format_batch_operation(SUMMARYSIGN_INDEX, title, value);
+            SUMMARYSIGN_INDEX++;
+            mv_ui_stream_push_all(MV_UI_STREAM_CB_NOCB, title, value,
+                                  MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
+            break;
+        }
+
         SUMMARYSIGN_STEP = SUMMARYSIGN_ST_ACCEPT_REJECT;
 
         mv_ui_stream_push_accept_reject();
@@ -593,6 +998,7 @@ push_next_summary_screen(void)
 
     MV_POSTAMBLE;
 
+#undef SUMMARYSIGN_INDEX
 #undef SUMMARYSIGN_STEP
 #undef FINAL_HASH
 }
@@ -734,31 +1140,43 @@ bs_stream_cb(mv_ui_cb_type_t cb_type)
 
 void
 handle_signing_key_setup(buffer_t *cdata, derivation_type_t derivation_type,
-                         bool return_hash)
+                         bool return_hash, bool hash_only)
 {
-    MV_PREAMBLE(("cdata=%p, derivation_type=%d, return_hash=%d", cdata,
-                 derivation_type, return_hash));
+    MV_PREAMBLE(("cdata=%p, derivation_type=%d, return_hash=%d, "
+                 "hash_only=%d",
+                 cdata, derivation_type, return_hash, hash_only));
 
     MV_ASSERT_NOTNULL(cdata);
+    // Only the hash is displayed, as in blind signing
+    MV_ASSERT(EXC_SECURITY, !hash_only || N_settings.blindsigning);
 
-    memset(&global.keys, 0, sizeof(global.keys));
+    claim_keys(KEYS_FLOW_SIGN);
+    memset(&global.keys.apdu, 0, sizeof(global.keys.apdu));
     global.keys.apdu.sign.return_hash = return_hash;
 
     MV_LIB_CHECK(read_bip32_path(&global.path_with_curve.bip32_path, cdata));
     global.path_with_curve.derivation_type = derivation_type;
+    check_derived_key_cache(&global.path_with_curve);
 
-    CX_CHECK(cx_blake2b_init_no_throw(&global.keys.apdu.hash.state,
-                                      SIGN_HASH_SIZE * 8));
+    MV_CHECK(init_hash());
     /*
      * We set the tag to zero here which indicates that it is unset.
      * The first data packet will set it to the first byte.
      */
     global.keys.apdu.sign.tag = 0;
 
-    MV_CHECK(start_displaying_signature_review());
+    if (hash_only) {
+        // The message is only hashed: the parser is never initialized
+        global.step                        = ST_BLIND_SIGN;
+        global.keys.apdu.sign.u.blind.step = BLINDSIGN_ST_OPERATION;
+        init_blind_stream();
+    } else {
+        MV_CHECK(start_displaying_signature_review());
+    }
 
     MV_ASSERT(EXC_UNEXPECTED_STATE, (global.step == ST_CLEAR_SIGN)
-                                        || (global.step == ST_SWAP_SIGN));
+                                        || (global.step == ST_SWAP_SIGN)
+                                        || (global.step == ST_BLIND_SIGN));
 
     io_send_sw(SW_OK);
     global.keys.apdu.sign.step = SIGN_ST_WAIT_DATA;
@@ -766,11 +1184,75 @@ handle_signing_key_setup(buffer_t *cdata, derivation_type_t derivation_type,
     MV_POSTAMBLE;
 }
 
+void
+handle_signing_key_add(buffer_t *cdata, derivation_type_t derivation_type)
+{
+    bip32_path_with_curve_t *key;
+
+    MV_PREAMBLE(("cdata=%p, derivation_type=%d", cdata, derivation_type));
+
+    MV_ASSERT_NOTNULL(cdata);
+    // The keys are all known before the message is hashed
+    APDU_SIGN_ASSERT_STEP(SIGN_ST_WAIT_DATA);
+    APDU_SIGN_ASSERT(global.keys.apdu.sign.packet_index == 0);
+    MV_ASSERT(EXC_WRONG_VALUES,
+              global.keys.apdu.sign.nb_extra_keys < SIGN_MAX_KEYS - 1);
+
+    key = &global.keys.apdu.sign
+               .extra_keys[global.keys.apdu.sign.nb_extra_keys];
+    MV_LIB_CHECK(read_bip32_path(&key->bip32_path, cdata));
+    key->derivation_type = derivation_type;
+    global.keys.apdu.sign.nb_extra_keys++;
+
+    io_send_sw(SW_OK);
+
+    MV_POSTAMBLE;
+}
+
+/**
+ * @brief Sign a hash with the first key and each key added.
+ *
+ * @param hash: hash to sign
+ * @param hashlen: size of the hash
+ * @param sigs: buffer receiving the signatures, each one preceded by its
+ *              length
+ * @param size: size of `sigs`, updated to the size of the signatures
+ */
+static void
+sign_with_keys(const uint8_t *hash, size_t hashlen, uint8_t *sigs,
+               size_t *size)
+{
+    const bip32_path_with_curve_t *key    = &global.path_with_curve;
+    size_t                         offset = 0;
+    size_t                         sig_size;
+
+    MV_PREAMBLE(("hash=%p, hashlen=%u, sigs=%p, size=%u", hash, hashlen,
+                 sigs, *size));
+
+    for (uint8_t i = 0; i <= global.keys.apdu.sign.nb_extra_keys; i++) {
+        if (i > 0) {
+            key = &global.keys.apdu.sign.extra_keys[i - 1];
+        }
+        MV_ASSERT(EXC_MEMORY_ERROR,
+                  offset + 1 + SIGN_KEY_SIGNATURE_MAX_SIZE <= *size);
+        sig_size = SIGN_KEY_SIGNATURE_MAX_SIZE;
+        MV_CHECK(sign(key->derivation_type, &key->bip32_path, hash, hashlen,
+                      &sigs[offset + 1], &sig_size));
+        sigs[offset] = (uint8_t)sig_size;
+        offset += 1 + sig_size;
+    }
+    *size = offset;
+
+    MV_POSTAMBLE;
+}
+
 static void
 start_displaying_signature_review(void)
 {
     MV_PREAMBLE(("global.step=%d", global.step));
+#ifdef HAVE_SWAP
     mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+#endif
 
     global.keys.apdu.sign.u.clear.received_msg = false;
     // NO ui display during swap.
@@ -778,6 +1260,9 @@ start_displaying_signature_review(void)
     if (!G_called_from_swap) {
 #endif
         mv_ui_stream_init(stream_cb);
+#ifdef MV_UI_STREAM_PREFETCH
+        mv_ui_stream_set_prefetch(prefetch_review);
+#endif
         global.step = ST_CLEAR_SIGN;
 
 #ifdef HAVE_BAGL
@@ -795,9 +1280,15 @@ start_displaying_signature_review(void)
                global.step);
     }
 #endif
-    mv_operation_parser_init(st, MV_UNKNOWN_SIZE, false);
-    mv_parser_refill(st, NULL, 0);
-    mv_parser_flush(st, global.line_buf, MV_UI_STREAM_CONTENTS_SIZE);
+    init_review_parser();
+#ifdef HAVE_SWAP
+    // The swap only checks the destination and the totals, and stops
+    // at the first field not matching its transaction
+    mv_operation_parser_set_validate_only(st, G_called_from_swap);
+    if (G_called_from_swap) {
+        mv_operation_parser_set_expected(st, swap_expected_operation());
+    }
+#endif
 
     MV_POSTAMBLE;
 }
@@ -812,6 +1303,252 @@ init_blind_stream(void)
 #endif
 }
 
+void
+handle_batch_signing_key_setup(buffer_t         *cdata,
+                               derivation_type_t derivation_type)
+{
+    uint8_t  nb_operations = 0;
+    buffer_t path_buf;
+
+    MV_PREAMBLE(("cdata=%p, derivation_type=%d", cdata, derivation_type));
+
+    MV_ASSERT_NOTNULL(cdata);
+    MV_ASSERT(EXC_WRONG_LENGTH_FOR_INS, buffer_read_u8(cdata, &nb_operations));
+    MV_ASSERT(EXC_WRONG_VALUES, (nb_operations > 0)
+                                    && (nb_operations <= MAX_BATCH_OPERATIONS));
+    // Only a summary of the batch is displayed, as in summary signing
+    MV_ASSERT(EXC_SECURITY, N_settings.blindsigning);
+
+    claim_keys(KEYS_FLOW_SIGN);
+    memset(&global.keys.apdu, 0, sizeof(global.keys.apdu));
+    global.keys.apdu.sign.return_hash         = false;
+    global.keys.apdu.sign.batch.nb_operations = nb_operations;
+
+    // The path follows the number of operations
+    path_buf.ptr    = cdata->ptr + cdata->offset;
+    path_buf.size   = cdata->size - cdata->offset;
+    path_buf.offset = 0u;
+    MV_LIB_CHECK(
+        read_bip32_path(&global.path_with_curve.bip32_path, &path_buf));
+    global.path_with_curve.derivation_type = derivation_type;
+    check_derived_key_cache(&global.path_with_curve);
+
+    global.step = ST_SUMMARY_SIGN;
+    MV_CHECK(start_batch_operation());
+#ifdef HAVE_NBGL
+    init_blind_stream();
+#endif
+
+    io_send_sw(SW_OK);
+    global.keys.apdu.sign.step = SIGN_ST_WAIT_DATA;
+
+    MV_POSTAMBLE;
+}
+
+void
+handle_batch_get_signature(void)
+{
+    MV_PREAMBLE(("void"));
+
+    MV_CHECK(send_batch_signature());
+
+    MV_POSTAMBLE;
+}
+
+/**
+ * @brief Reset the hash and the parser to receive the next operation of
+ *        the batch.
+ */
+static void
+start_batch_operation(void)
+{
+    mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
+
+    MV_PREAMBLE(("nb_received=%d", global.keys.apdu.sign.batch.nb_received));
+
+    MV_CHECK(init_hash());
+    global.keys.apdu.sign.tag                  = 0;
+    global.keys.apdu.sign.received_last_msg    = false;
+    global.keys.apdu.sign.u.clear.received_msg = false;
+    global.keys.apdu.sign.u.clear.total_length = 0;
+
+    mv_operation_parser_init(st, MV_UNKNOWN_SIZE, false);
+    // Only a summary of the batch is displayed
+    mv_operation_parser_set_validate_only(st, true);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, global.line_buf, MV_UI_STREAM_CONTENTS_SIZE);
+
+    MV_POSTAMBLE;
+}
+
+/**
+ * @brief Record the hash and the totals of the operation just parsed.
+ *
+ * Ask for the next operation or, once the last one has been received,
+ * hash the hashes of the operations and display the summary of the
+ * whole batch.
+ */
+static void
+batch_operation_done(void)
+{
+    apdu_sign_batch_state_t *batch = &global.keys.apdu.sign.batch;
+    mv_operation_state      *op
+        = &global.keys.apdu.sign.u.clear.parser_state.operation;
+
+    MV_PREAMBLE(("nb_received=%d", batch->nb_received));
+
+    APDU_SIGN_ASSERT(global.keys.apdu.sign.received_last_msg);
+    APDU_SIGN_ASSERT(batch->nb_received < batch->nb_operations);
+    MV_ASSERT(EXC_WRONG_VALUES,
+              mv_operation_summary_merge(&batch->summary, &op->summary));
+
+    memcpy(batch->hashes[batch->nb_received],
+           global.keys.apdu.hash.final_hash, SIGN_HASH_SIZE);
+    batch->amounts[batch->nb_received] = op->summary.total_amount;
+    batch->fees[batch->nb_received]    = op->summary.total_fee;
+    batch->nb_received++;
+
+    if (batch->nb_received < batch->nb_operations) {
+        MV_CHECK(start_batch_operation());
+        io_send_sw(SW_OK);
+        global.keys.apdu.sign.step = SIGN_ST_WAIT_DATA;
+        MV_SUCCEED();
+    }
+
+    // The summary screens display the totals and the hash of the whole
+    // batch
+    memcpy(&op->summary, &batch->summary, sizeof(op->summary));
+    CX_CHECK(cx_blake2b_init_no_throw(&global.keys.apdu.hash.state,
+                                      SIGN_HASH_SIZE * 8));
+    CX_CHECK(cx_hash_no_throw(
+        (cx_hash_t *)&global.keys.apdu.hash.state, CX_LAST,
+        (uint8_t *)batch->hashes, batch->nb_operations * SIGN_HASH_SIZE,
+        global.keys.apdu.hash.final_hash, SIGN_HASH_SIZE));
+
+    MV_CHECK(init_summary_stream());
+
+    MV_POSTAMBLE;
+}
+
+/**
+ * @brief Sign the next operation of an accepted batch and send the
+ *        signature.
+ */
+static void
+send_batch_signature(void)
+{
+    apdu_sign_batch_state_t *batch = &global.keys.apdu.sign.batch;
+    uint8_t                  sig[MAX_SIGNATURE_SIZE];
+    size_t                   sig_size = sizeof(sig);
+
+    MV_PREAMBLE(("nb_signed=%d", batch->nb_signed));
+
+    APDU_SIGN_ASSERT(batch->nb_received == batch->nb_operations);
+    APDU_SIGN_ASSERT(batch->nb_signed < batch->nb_operations);
+
+    MV_CHECK(sign(global.path_with_curve.derivation_type,
+                  &global.path_with_curve.bip32_path,
+                  batch->hashes[batch->nb_signed], SIGN_HASH_SIZE, sig,
+                  &sig_size));
+    batch->nb_signed++;
+
+    // The next signatures are requested from the idle state
+    if (batch->nb_signed == batch->nb_operations) {
+        end_batch_signing();
+    }
+    global.step = ST_IDLE;
+
+    io_send_response_pointer(sig, sig_size, SW_OK);
+
+    MV_POSTAMBLE;
+}
+
+bool
+batch_signing_pending(void)
+{
+    return (global.keys_flow == KEYS_FLOW_SIGN)
+           && (global.keys.apdu.sign.batch.nb_signed != 0);
+}
+
+void
+end_batch_signing(void)
+{
+    FUNC_ENTER(("void"));
+
+    memset(&global.keys.apdu.sign.batch, 0,
+           sizeof(global.keys.apdu.sign.batch));
+    clear_derived_key_cache();
+
+    FUNC_LEAVE();
+}
+
+/**
+ * @brief Reset the hash of the data to sign.
+ */
+static void
+init_hash(void)
+{
+    MV_PREAMBLE(("void"));
+
+    CX_CHECK(cx_blake2b_init_no_throw(&global.keys.apdu.hash.state,
+                                      SIGN_HASH_SIZE * 8));
+#ifndef TARGET_NANOS
+    global.keys.apdu.hash.pending_len = 0;
+#endif
+
+    MV_POSTAMBLE;
+}
+
+/**
+ * @brief Hash a data packet.
+ *
+ * Except on Nano S, the packets are kept until `SIGN_HASH_NB_PACKETS`
+ * of them can be hashed at once, as each hash update has a fixed cost.
+ * The last one flushes them and sets the final hash.
+ *
+ * @param cdata: data packet
+ * @param last: whether the packet is the last one or not
+ */
+static void
+update_hash(buffer_t *cdata, bool last)
+{
+    MV_PREAMBLE(("cdata=0x%p, last=%d", cdata, last));
+
+#ifndef TARGET_NANOS
+    apdu_hash_state_t *hash = &global.keys.apdu.hash;
+
+    MV_ASSERT(EXC_WRONG_LENGTH, cdata->size <= sizeof(hash->pending));
+    if (!last
+        && ((hash->pending_len + cdata->size) <= sizeof(hash->pending))) {
+        memcpy(hash->pending + hash->pending_len, cdata->ptr, cdata->size);
+        hash->pending_len += cdata->size;
+        MV_SUCCEED();
+    }
+    if (hash->pending_len > 0) {
+        MV_PROFILE_CALL(MV_PROFILE_HASH);
+        MV_PROFILE_UNITS(MV_PROFILE_HASH, hash->pending_len);
+        CX_CHECK(cx_hash_no_throw((cx_hash_t *)&hash->state, 0,
+                                  hash->pending, hash->pending_len, NULL,
+                                  0));
+        hash->pending_len = 0;
+    }
+    if (!last) {
+        memcpy(hash->pending, cdata->ptr, cdata->size);
+        hash->pending_len = cdata->size;
+        MV_SUCCEED();
+    }
+#endif
+
+    MV_PROFILE_CALL(MV_PROFILE_HASH);
+    MV_PROFILE_UNITS(MV_PROFILE_HASH, cdata->size);
+    CX_CHECK(cx_hash_no_throw((cx_hash_t *)&global.keys.apdu.hash.state,
+                              last ? CX_LAST : 0, cdata->ptr, cdata->size,
+                              global.keys.apdu.hash.final_hash,
+                              sizeof(global.keys.apdu.hash.final_hash)));
+
+    MV_POSTAMBLE;
+}
+
 void
 handle_sign(buffer_t *cdata, bool last, bool return_hash)
 {
@@ -819,16 +1556,16 @@ handle_sign(buffer_t *cdata, bool last, bool return_hash)
                  cdata, last, return_hash, global.step));
 
     MV_ASSERT_NOTNULL(cdata);
-    APDU_SIGN_ASSERT_STEP(SIGN_ST_WAIT_DATA);
+    APDU_SIGN_ASSERT((global.keys.apdu.sign.step == SIGN_ST_WAIT_DATA)
+                     || global.keys.apdu.sign.u.clear.acknowledged);
     MV_ASSERT(EXC_INVALID_INS,
               return_hash == global.keys.apdu.sign.return_hash);
 
+    global.keys.apdu.sign.u.clear.acknowledged = false;
+
     global.keys.apdu.sign.packet_index++;  // XXX drop or check
 
-    CX_CHECK(cx_hash_no_throw((cx_hash_t *)&global.keys.apdu.hash.state,
-                              last ? CX_LAST : 0, cdata->ptr, cdata->size,
-                              global.keys.apdu.hash.final_hash,
-                              sizeof(global.keys.apdu.hash.final_hash)));
+    MV_CHECK(update_hash(cdata, last));
 
     if (last) {
         global.keys.apdu.sign.received_last_msg = true;
@@ -838,6 +1575,11 @@ handle_sign(buffer_t *cdata, bool last, bool return_hash)
         MV_ASSERT(EXC_PARSE_ERROR, buffer_can_read(cdata, 1));
 
         global.keys.apdu.sign.tag = cdata->ptr[0];
+
+        // Only manager operations can be batched
+        MV_ASSERT(EXC_PARSE_ERROR,
+                  (global.keys.apdu.sign.batch.nb_operations == 0)
+                      || (global.keys.apdu.sign.tag == 0x03));
     }
 
     switch (global.step) {
@@ -847,6 +1589,7 @@ handle_sign(buffer_t *cdata, bool last, bool return_hash)
         MV_CHECK(handle_data_apdu_clear(cdata, last));
         break;
     case ST_BLIND_SIGN:
+        global.keys.apdu.sign.u.clear.received_msg = true;
         MV_CHECK(handle_data_apdu_blind());
         break;
     default:
@@ -866,14 +1609,37 @@ handle_data_apdu_clear(buffer_t *cdata, bool last)
 
     mv_parser_state *st = &global.keys.apdu.sign.u.clear.parser_state;
 
-    // check we consume all input before asking for more
-    MV_ASSERT(EXC_UNEXPECTED_SIGN_STATE, st->regs.ilen == 0);
+    // A packet acknowledged in the windowed mode failed to parse: the
+    // next ones are only hashed, up to the last one
+    if (global.keys.apdu.sign.u.clear.parse_error) {
+        if (!last) {
+            io_send_sw(SW_OK);
+            MV_SUCCEED();
+        }
+        global.keys.apdu.sign.u.clear.parse_error = false;
+        MV_CHECK(refill_error());
+        MV_SUCCEED();
+    }
+
+#ifndef TARGET_NANOS
+    // An operation failing to parse in its first packet is not
+    // acknowledged before its review reaches the error, so that the host
+    // does not stream the rest of it
+    if ((global.step == ST_CLEAR_SIGN)
+        && (global.keys.apdu.sign.u.clear.total_length == 0)) {
+        global.keys.apdu.sign.u.clear.invalid
+            = !check_first_packet(cdata, last);
+    }
+#endif
+    bool first = (global.keys.apdu.sign.u.clear.total_length == 0);
+
+    // the parser may still be on the previous packets of a review
+    MV_CHECK(stage_packet(cdata));
 
     global.keys.apdu.sign.u.clear.received_msg = true;
 
     global.keys.apdu.sign.u.clear.total_length += cdata->size;
 
-    mv_parser_refill(st, cdata->ptr, cdata->size);
     if (last) {
         mv_operation_parser_set_size(
             st, global.keys.apdu.sign.u.clear.total_length);
@@ -881,6 +1647,12 @@ handle_data_apdu_clear(buffer_t *cdata, bool last)
 
     switch (global.step) {
     case ST_CLEAR_SIGN:
+        if (global.keys.apdu.sign.step == SIGN_ST_WAIT_USER_INPUT) {
+            // the packet will be parsed once the user has reviewed the
+            // previous ones
+            send_staged_continue();
+            break;
+        }
         MV_CHECK(refill());
         if (global.keys.apdu.sign.step == SIGN_ST_WAIT_USER_INPUT) {
             mv_ui_stream();
@@ -888,6 +1660,13 @@ handle_data_apdu_clear(buffer_t *cdata, bool last)
         break;
     case ST_SWAP_SIGN:
     case ST_SUMMARY_SIGN:
+        // Nothing to display: in the windowed mode, let the host send the
+        // next packet while this one is parsed, but for the first one, so
+        // that an operation failing on its magic byte or first tags is
+        // rejected at once
+        if (global.windowed && !last && !first) {
+            send_early_continue();
+        }
         MV_CHECK(refill_all());
         break;
     default:
@@ -929,6 +1708,47 @@ get_blindsign_type(char *type, size_t type_size)
     MV_POSTAMBLE;
 }
 
+void
+handle_sign_hash(buffer_t *cdata, derivation_type_t derivation_type)
+{
+    buffer_t path_buf;
+
+    MV_PREAMBLE(("cdata=%p, derivation_type=%d", cdata, derivation_type));
+
+    MV_ASSERT_NOTNULL(cdata);
+    // Only the hash is displayed, as in blind signing
+    MV_ASSERT(EXC_SECURITY, N_settings.blindsigning);
+
+    claim_keys(KEYS_FLOW_SIGN);
+    memset(&global.keys.apdu, 0, sizeof(global.keys.apdu));
+    global.keys.apdu.sign.return_hash = false;
+    // Nothing tells what the host has hashed: no type is displayed
+    global.keys.apdu.sign.pre_hashed = true;
+
+    MV_ASSERT(EXC_WRONG_LENGTH_FOR_INS,
+              buffer_can_read(cdata, SIGN_HASH_SIZE));
+    memcpy(global.keys.apdu.hash.final_hash, cdata->ptr + cdata->offset,
+           SIGN_HASH_SIZE);
+    buffer_seek_cur(cdata, SIGN_HASH_SIZE);
+
+    path_buf.ptr    = cdata->ptr + cdata->offset;
+    path_buf.size   = cdata->size - cdata->offset;
+    path_buf.offset = 0u;
+    MV_LIB_CHECK(
+        read_bip32_path(&global.path_with_curve.bip32_path, &path_buf));
+    global.path_with_curve.derivation_type = derivation_type;
+    check_derived_key_cache(&global.path_with_curve);
+
+    // The hash is the whole message: go straight to its review
+    global.step                             = ST_BLIND_SIGN;
+    global.keys.apdu.sign.received_last_msg = true;
+    global.keys.apdu.sign.u.blind.step      = BLINDSIGN_ST_OPERATION;
+    init_blind_stream();
+    MV_CHECK(handle_data_apdu_blind());
+
+    MV_POSTAMBLE;
+}
+
 #ifdef HAVE_NBGL
 static void
 pass_from_summary_to_blind(void)
@@ -1002,6 +1822,9 @@ getTagValuePair(uint8_t pairIndex)
         if (pairIndex < SUMMARY_INDEX_TOTAL_FEES) {
             pairIndex += SUMMARY_INDEX_TYPE;
         }
+    } else if (global.step == ST_BLIND_SIGN
+               && useCaseTagValueList.nbPairs == 1) {
+        pairIndex += SUMMARY_INDEX_HASH;
     }
 
     char num_buffer[DECIMAL_SIZE]        = {0};
@@ -1014,14 +1837,16 @@ getTagValuePair(uint8_t pairIndex)
     case SUMMARY_INDEX_NB_OF_TX: {
         pair.item = "Number of Tx";
 
-        snprintf(num_buffer, sizeof(num_buffer), "%d", op->batch_index);
+        snprintf(num_buffer, sizeof(num_buffer), "%d",
+                 op->summary.nb_operations);
         ui_strings_push(num_buffer, strlen(num_buffer),
                         (char **)&(pair.value));
     } break;
     case SUMMARY_INDEX_TOTAL_AMOUNT: {
         pair.item = "Total amount";
 
-        mv_mumav_to_string(num_buffer, sizeof(num_buffer), op->total_amount);
+        mv_mumav_to_string(num_buffer, sizeof(num_buffer),
+                           op->summary.total_amount);
         ui_strings_push(num_buffer, strlen(num_buffer),
                         (char **)&(pair.value));
 
@@ -1029,7 +1854,8 @@ getTagValuePair(uint8_t pairIndex)
     case SUMMARY_INDEX_TOTAL_FEES: {
         pair.item = "Total Fees";
 
-        mv_mumav_to_string(num_buffer, sizeof(num_buffer), op->total_fee);
+        mv_mumav_to_string(num_buffer, sizeof(num_buffer),
+                           op->summary.total_fee);
         ui_strings_push(num_buffer, strlen(num_buffer),
                         (char **)&(pair.value));
     } break;
@@ -1046,10 +1872,25 @@ getTagValuePair(uint8_t pairIndex)
             MV_FAIL(EXC_UNKNOWN);
         }
 
-        pair.item = "Hash";
+        pair.item = (global.keys.apdu.sign.batch.nb_operations != 0)
+                        ? "Batch hash"
+                        : "Hash";
         ui_strings_push(hash, strlen(hash), (char **)&(pair.value));
     } break;
     default:
+        // Then each operation of a batch
+        if ((pairIndex - SUMMARY_INDEX_MAX)
+            < global.keys.apdu.sign.batch.nb_operations) {
+            char title[BATCH_OPERATION_TITLE_SIZE] = {0};
+            char value[BATCH_OPERATION_VALUE_SIZE] = {0};
+
+            format_batch_operation(pairIndex - SUMMARY_INDEX_MAX, title,
+                                   value);
+            pair.item = NULL;
+            ui_strings_push(title, strlen(title), (char **)&(pair.item));
+            ui_strings_push(value, strlen(value), (char **)&(pair.value));
+            break;
+        }
         return NULL;
     }
 
@@ -1074,7 +1915,12 @@ continue_blindsign_cb(void)
         PRINTF("[DEBUG] SUMMARY_SIGN start_index %d\n",
                useCaseTagValueList.startIndex);
         useCaseTagValueList.startIndex = 0;
-        useCaseTagValueList.nbPairs    = 5;
+        useCaseTagValueList.nbPairs
+            = SUMMARY_INDEX_MAX + global.keys.apdu.sign.batch.nb_operations;
+    } else if (global.keys.apdu.sign.pre_hashed) {
+        // Only the hash, the type of the message is unknown
+        useCaseTagValueList.startIndex = SUMMARY_INDEX_HASH;
+        useCaseTagValueList.nbPairs    = 1;
     }
     PRINTF("[DEBUG] SIGN Status: %d,  start_index %d Number of pairs:%d ",
            global.step, useCaseTagValueList.startIndex,
@@ -1095,23 +1941,33 @@ handle_data_apdu_blind(void)
 {
     MV_PREAMBLE(("void"));
 
-    if (global.keys.apdu.sign.u.clear.received_msg) {
-        global.keys.apdu.sign.u.clear.received_msg = false;
-    }
-
     if (!global.keys.apdu.sign.received_last_msg) {
-        io_send_sw(SW_OK);
+        // unless the packet was acknowledged while staged
+        if (global.keys.apdu.sign.u.clear.received_msg) {
+            io_send_sw(SW_OK);
+        }
+        global.keys.apdu.sign.u.clear.received_msg = false;
         MV_SUCCEED();
     }
+    global.keys.apdu.sign.u.clear.received_msg = false;
 
     global.keys.apdu.sign.step = SIGN_ST_WAIT_USER_INPUT;
 
 #ifdef HAVE_BAGL
 
-    char type[OPERATION_TYPE_STR_LENGTH] = "Unknown type";
-    get_blindsign_type(type, sizeof(type));
-    mv_ui_stream_push_all(MV_UI_STREAM_CB_NOCB, "Sign Hash", type,
-                          MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
+    if (global.keys.apdu.sign.pre_hashed) {
+#ifdef TARGET_NANOS
+        mv_ui_stream_push_warning_not_trusted(NULL, NULL);
+#else
+        mv_ui_stream_push_warning_not_trusted("Only its hash",
+                                              "has been sent.");
+#endif
+    } else {
+        char type[OPERATION_TYPE_STR_LENGTH] = "Unknown type";
+        get_blindsign_type(type, sizeof(type));
+        mv_ui_stream_push_all(MV_UI_STREAM_CB_NOCB, "Sign Hash", type,
+                              MV_UI_LAYOUT_BN, MV_UI_ICON_NONE);
+    }
 
     mv_ui_stream();
 #elif HAVE_NBGL
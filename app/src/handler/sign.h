@@ -29,6 +29,21 @@
 #include "keys.h"
 #include "parser/parser_state.h"
 
+/// Largest data packet accepted, the data of a short APDU: hosts may
+/// send larger packets than MAX_APDU_SIZE, up to what their transport
+/// allows, see `handle_get_capabilities`
+#define SIGN_PACKET_MAX_SIZE 255
+/// Largest data packet over U2F, whose APDU is the key handle of a
+/// request, of at most 255 bytes
+#define SIGN_PACKET_MAX_SIZE_U2F (255 - 5)
+
+#ifndef TARGET_NANOS
+/// Number of data packets hashed at once
+#define SIGN_HASH_NB_PACKETS 4
+#define SIGN_HASH_PENDING_SIZE \
+    (SIGN_HASH_NB_PACKETS * SIGN_PACKET_MAX_SIZE)
+#endif
+
 /**
  * @brief Save hash of the transaction to be signed.
  *
@@ -37,6 +52,11 @@ typedef struct {
     cx_blake2b_t state;  /// Ledger-sdk blake2b state containing hash header
                          /// and blake2b state info.
     uint8_t final_hash[SIGN_HASH_SIZE];  /// Final hash of the transaction.
+#ifndef TARGET_NANOS
+    uint8_t  pending[SIGN_HASH_PENDING_SIZE];  /// Data received but not
+                                               /// hashed yet.
+    uint16_t pending_len;                      /// Length of `pending`.
+#endif
 } apdu_hash_state_t;
 
 /**
@@ -69,9 +89,53 @@ typedef enum {
     SUMMARYSIGN_ST_AMOUNT,
     SUMMARYSIGN_ST_FEE,
     SUMMARYSIGN_ST_HASH,
+    SUMMARYSIGN_ST_BATCH_OPERATION,
     SUMMARYSIGN_ST_ACCEPT_REJECT,
 } summarysign_step_t;
 
+#ifdef TARGET_NANOS
+#define MAX_BATCH_OPERATIONS 4
+#else
+#define MAX_BATCH_OPERATIONS 8
+#endif
+
+/// Number of keys signing the same message, the first one included
+#ifdef TARGET_NANOS
+#define SIGN_MAX_KEYS 2
+#else
+#define SIGN_MAX_KEYS 3
+#endif
+/// Largest signature of a key, a DER encoded ECDSA signature
+#define SIGN_KEY_SIGNATURE_MAX_SIZE 72
+
+#ifndef TARGET_NANOS
+/// Number of data packets the parser can be late on during a review
+#ifdef HAVE_NBGL
+#define SIGN_STAGING_NB_PACKETS 4
+#else
+#define SIGN_STAGING_NB_PACKETS 3
+#endif
+#define SIGN_STAGING_SIZE \
+    (SIGN_STAGING_NB_PACKETS * SIGN_PACKET_MAX_SIZE)
+#endif
+
+/**
+ * @brief Struct to track the operations of a batch signing session.
+ *
+ * The operations are parsed one after the other in the summary flow,
+ * only their hashes, amounts and fees are kept to produce a single
+ * review, along with the hash of the batch: the hash of their hashes.
+ */
+typedef struct {
+    uint8_t nb_operations;         /// Number of operations announced.
+    uint8_t nb_received;           /// Number of operations fully received.
+    uint8_t nb_signed;             /// Number of signatures already sent.
+    mv_operation_summary summary;  /// Aggregates of all operations.
+    uint8_t hashes[MAX_BATCH_OPERATIONS][SIGN_HASH_SIZE];  /// Hashes.
+    uint64_t amounts[MAX_BATCH_OPERATIONS];  /// Amount of each operation.
+    uint64_t fees[MAX_BATCH_OPERATIONS];     /// Fee of each operation.
+} apdu_sign_batch_state_t;
+
 /**
  * @brief Struct to track state/info about current sign operation.
  *
@@ -81,8 +145,16 @@ typedef struct {
 
     sign_step_t step;  /// Current step of the sign operation.
     bool return_hash;  /// Whether to return the hash of the transaction.
+    bool pre_hashed;   /// Whether the hash has been computed by the host:
+                       /// the type of the message is then unknown.
     bool received_last_msg;  /// Whether the last message has been received.
     uint8_t tag;             /// Type of mavryk operation to sign.
+    apdu_sign_batch_state_t
+        batch;  /// Batch signing session, unused if `nb_operations` is 0.
+    uint8_t nb_extra_keys;  /// Number of keys added to the first one.
+    bip32_path_with_curve_t
+        extra_keys[SIGN_MAX_KEYS - 1];  /// Keys added with
+                                        /// `handle_signing_key_add`.
 
     union {
         /// @brief clear signing state info.
@@ -92,8 +164,22 @@ typedef struct {
             uint8_t         last_field_index;
 #ifdef HAVE_BAGL
             uint8_t screen_displayed;
+            uint8_t nb_folded;  /// Expressions displayed by their size
+                                /// and not expanded.
+#endif
+#ifndef TARGET_NANOS
+            uint8_t staging[SIGN_STAGING_SIZE];  /// Packets received but
+                                                 /// not parsed yet.
 #endif
             bool received_msg;
+            bool acknowledged;  /// Whether the last packet received has
+                                /// already been acknowledged.
+            bool parse_error;   /// Whether an acknowledged packet failed
+                                /// to parse.
+#ifndef TARGET_NANOS
+            bool invalid;  /// Whether the first packet failed to parse,
+                           /// no packet is then acknowledged while staged.
+#endif
             bool displayed_expert_warning;
         } clear;
         /// @brief blindsigning state info.
@@ -102,6 +188,8 @@ typedef struct {
         } blind;
         struct {
             summarysign_step_t step;
+            uint8_t batch_index;  /// Next operation of the batch to
+                                  /// display.
         } summary;
     } u;
 } apdu_sign_state_t;
@@ -111,13 +199,33 @@ typedef struct {
  * If successfully parse BIP32 path, set up the key as the signing key,
  * initialize the signing state and send validation APDU response.
  *
+ * If `hash_only` is set, the message will only be hashed, and its hash
+ * displayed as in blind signing, without ever being parsed.
+ *
  * @param cdata: data containing the BIP32 path of the key
  * @param derivation_type: derivation_type of the key
  * @param return_hash: whether the hash of the message is requested or not
+ * @param hash_only: whether the message is only hashed or not
  */
 void handle_signing_key_setup(buffer_t         *cdata,
                               derivation_type_t derivation_type,
-                              bool              return_hash);
+                              bool              return_hash,
+                              bool              hash_only);
+
+/**
+ * @brief Handle additional signing key request.
+ * If successfully parse BIP32 path, add the key to the keys signing the
+ * message and send validation APDU response.
+ *
+ * The keys are added after the first packet and before any data: the
+ * message is then streamed, hashed and reviewed once, and signed with
+ * each key.
+ *
+ * @param cdata: data containing the BIP32 path of the key
+ * @param derivation_type: derivation_type of the key
+ */
+void handle_signing_key_add(buffer_t         *cdata,
+                            derivation_type_t derivation_type);
 
 /**
  * @brief Handle operation/micheline expression signature request.
@@ -133,3 +241,52 @@ void handle_signing_key_setup(buffer_t         *cdata,
  * @param with_hash: whether the hash of the message is requested or not
  */
 void handle_sign(buffer_t *cdata, bool last, bool return_hash);
+
+/**
+ * @brief Handle batch signing key setup request.
+ *
+ * Same as `handle_signing_key_setup` but the operations to sign will
+ * be parsed in summary mode until `nb_operations` operations have been
+ * received. They will be reviewed at once.
+ *
+ * @param cdata: data containing the number of operations and the BIP32
+ *               path of the key
+ * @param derivation_type: derivation_type of the key
+ */
+void handle_batch_signing_key_setup(buffer_t         *cdata,
+                                    derivation_type_t derivation_type);
+
+/**
+ * @brief Handle the signature request of a hash computed by the host.
+ *
+ * Only the hash is displayed, after the blind signing warning: the
+ * message itself is never sent to the device, which cannot tell its
+ * type. The hash is signed directly after confirmation.
+ *
+ * @param cdata: data containing the BLAKE2b hash of the message and the
+ *               BIP32 path of the key
+ * @param derivation_type: derivation_type of the key
+ */
+void handle_sign_hash(buffer_t *cdata, derivation_type_t derivation_type);
+
+/**
+ * @brief Handle the request of the next signature of an accepted batch.
+ *
+ * Sign the hash of the next operation of the batch and send an APDU
+ * response containing the signature.
+ */
+void handle_batch_get_signature(void);
+
+/**
+ * @brief Whether an accepted batch still has signatures to send.
+ *
+ * @return bool: whether the next signature of a batch is expected
+ */
+bool batch_signing_pending(void);
+
+/**
+ * @brief End a batch signing session.
+ *
+ * The signatures not sent yet are dropped and the key is wiped.
+ */
+void end_batch_signing(void);
@@ -29,12 +29,31 @@
 #include "exception.h"
 #include "keys.h"
 #include "globals.h"
+#include "profile.h"
 
 static mv_exc public_key_hash(uint8_t *hash_out, size_t hash_out_size,
                               cx_ecfp_public_key_t       *compressed_out,
                               derivation_type_t           derivation_type,
                               const cx_ecfp_public_key_t *public_key);
 
+static int
+derivation_type_to_mode(derivation_type_t derivation_type)
+{
+    if (derivation_type == DERIVATION_TYPE_ED25519) {
+        return HDW_ED25519_SLIP10;
+    }
+    return HDW_NORMAL;
+}
+
+static bool
+bip32_path_equal(const bip32_path_t *a, const bip32_path_t *b)
+{
+    return (a->length == b->length)
+           && (memcmp(a->components, b->components,
+                      a->length * sizeof(a->components[0]))
+               == 0);
+}
+
 static cx_curve_t
 derivation_type_to_cx_curve(derivation_type_t derivation_type)
 {
@@ -64,9 +83,10 @@ read_bip32_path(bip32_path_t *out, buffer_t *in)
     MV_LIB_POSTAMBLE;
 }
 
-mv_exc
-derive_pk(cx_ecfp_public_key_t *public_key, derivation_type_t derivation_type,
-          const bip32_path_t *bip32_path)
+static mv_exc
+derive_pk_from_seed(cx_ecfp_public_key_t *public_key,
+                    derivation_type_t     derivation_type,
+                    const bip32_path_t   *bip32_path)
 {
     MV_PREAMBLE(("public_key=%p, derivation_type=%d, bip32_path=%p",
                  public_key, derivation_type, bip32_path));
@@ -74,14 +94,10 @@ derive_pk(cx_ecfp_public_key_t *public_key, derivation_type_t derivation_type,
     public_key->W_len = 65;
     public_key->curve = derivation_type_to_cx_curve(derivation_type);
 
-    int derivation_mode = HDW_NORMAL;
-    if (derivation_type == DERIVATION_TYPE_ED25519) {
-        derivation_mode = HDW_ED25519_SLIP10;
-    }
-
     CX_CHECK(bip32_derive_with_seed_get_pubkey_256(
-        derivation_mode, public_key->curve, bip32_path->components,
-        bip32_path->length, public_key->W, NULL, CX_SHA512, NULL, 0));
+        derivation_type_to_mode(derivation_type), public_key->curve,
+        bip32_path->components, bip32_path->length, public_key->W, NULL,
+        CX_SHA512, NULL, 0));
 
     if (public_key->curve == CX_CURVE_Ed25519) {
         CX_CHECK(cx_edwards_compress_point_no_throw(
@@ -93,25 +109,148 @@ derive_pk(cx_ecfp_public_key_t *public_key, derivation_type_t derivation_type,
 }
 
 mv_exc
-derive_pkh(cx_ecfp_public_key_t *pubkey, derivation_type_t derivation_type,
-           char *buffer, size_t len)
+derive_child_pk(cx_ecfp_public_key_t *public_key,
+                derivation_type_t     derivation_type,
+                const bip32_path_t *parent_path, uint32_t index)
 {
-    uint8_t hash[21];
-    MV_PREAMBLE(("buffer=%p, len=%u", buffer, len));
-    MV_ASSERT_NOTNULL(buffer);
+    bip32_path_t child_path;
+
+    MV_PREAMBLE(("public_key=%p, derivation_type=%d, index=%u", public_key,
+                 derivation_type, index));
+    MV_ASSERT_NOTNULL(public_key);
+    MV_ASSERT_NOTNULL(parent_path);
+    // The path of a child must fit in a `bip32_path_t`
+    MV_ASSERT(EXC_WRONG_LENGTH_FOR_INS, parent_path->length < MAX_BIP32_LEN);
+
+    memcpy(&child_path, parent_path, sizeof(child_path));
+    child_path.components[child_path.length] = index;
+    child_path.length++;
     MV_LIB_CHECK(
-        public_key_hash(hash + 1, 20, NULL, derivation_type, pubkey));
+        derive_pk_from_seed(public_key, derivation_type, &child_path));
+
+    MV_LIB_POSTAMBLE;
+}
+
+static mv_exc
+pkh_of_pubkey(uint8_t *pkh, derivation_type_t derivation_type,
+              const cx_ecfp_public_key_t *pubkey)
+{
+    MV_PREAMBLE(("pkh=%p, derivation_type=%d", pkh, derivation_type));
+    MV_LIB_CHECK(public_key_hash(pkh + 1, PKH_SIZE - 1, NULL,
+                                 derivation_type, pubkey));
     // clang-format off
     switch (derivation_type) {
-    case DERIVATION_TYPE_SECP256K1: hash[0] = 1; break;
-    case DERIVATION_TYPE_SECP256R1: hash[0] = 2; break;
+    case DERIVATION_TYPE_SECP256K1: pkh[0] = 1; break;
+    case DERIVATION_TYPE_SECP256R1: pkh[0] = 2; break;
     case DERIVATION_TYPE_ED25519:
-    case DERIVATION_TYPE_BIP32_ED25519: hash[0] = 0; break;
+    case DERIVATION_TYPE_BIP32_ED25519: pkh[0] = 0; break;
     default: MV_FAIL(EXC_WRONG_PARAM); break;
     }
     // clang-format on
+    MV_LIB_POSTAMBLE;
+}
+
+/**
+ * @brief Find the public key of a path in the public key cache, derive
+ * it and add it to the cache otherwise.
+ *
+ * @param entry: output entry holding the public key
+ * @param derivation_type: derivation type of the key
+ * @param bip32_path: path of the key
+ * @return mv_exc return success/failure using error code
+ */
+static mv_exc
+load_pubkey(pubkey_cache_entry_t **entry, derivation_type_t derivation_type,
+            const bip32_path_t *bip32_path)
+{
+    pubkey_cache_t       *cache = &global.keys.pubkey.cache;
+    pubkey_cache_entry_t *e     = NULL;
+    uint8_t               i;
+
+    MV_PREAMBLE(("derivation_type=%d, bip32_path=%p", derivation_type,
+                 bip32_path));
+
+    claim_keys(KEYS_FLOW_PUBKEY);
+
+    for (i = 0; i < cache->count; i++) {
+        if ((cache->entries[i].path_with_curve.derivation_type
+             == derivation_type)
+            && bip32_path_equal(&cache->entries[i].path_with_curve.bip32_path,
+                                bip32_path)) {
+            e = &cache->entries[i];
+            goto found;
+        }
+    }
+
+    if (cache->count < PUBKEY_CACHE_SIZE) {
+        e = &cache->entries[cache->count];
+        cache->count++;
+    } else {
+        e = &cache->entries[0];
+        for (i = 1; i < PUBKEY_CACHE_SIZE; i++) {
+            if (cache->entries[i].last_use < e->last_use) {
+                e = &cache->entries[i];
+            }
+        }
+    }
+
+    // Does not match any path until completely set
+    e->path_with_curve.derivation_type = DERIVATION_TYPE_MAX;
+    MV_LIB_CHECK(
+        derive_pk_from_seed(&e->pubkey, derivation_type, bip32_path));
+    MV_LIB_CHECK(pkh_of_pubkey(e->pkh, derivation_type, &e->pubkey));
+    memcpy(&e->path_with_curve.bip32_path, bip32_path, sizeof(*bip32_path));
+    e->path_with_curve.derivation_type = derivation_type;
+
+found:
+    cache->clock++;
+    e->last_use = cache->clock;
+    *entry      = e;
+
+    MV_LIB_POSTAMBLE;
+}
+
+mv_exc
+derive_pk(cx_ecfp_public_key_t *public_key, derivation_type_t derivation_type,
+          const bip32_path_t *bip32_path)
+{
+    pubkey_cache_entry_t *entry = NULL;
+
+    MV_PREAMBLE(("public_key=%p, derivation_type=%d, bip32_path=%p",
+                 public_key, derivation_type, bip32_path));
+
+    MV_LIB_CHECK(load_pubkey(&entry, derivation_type, bip32_path));
+    memcpy(public_key, &entry->pubkey, sizeof(*public_key));
+
+    MV_LIB_POSTAMBLE;
+}
 
-    if (mv_format_pkh(hash, 21, buffer, len)) {
+mv_exc
+derive_pkh(cx_ecfp_public_key_t *pubkey, derivation_type_t derivation_type,
+           char *buffer, size_t len)
+{
+    uint8_t hash[PKH_SIZE];
+    MV_PREAMBLE(("buffer=%p, len=%u", buffer, len));
+    MV_ASSERT_NOTNULL(buffer);
+    MV_LIB_CHECK(pkh_of_pubkey(hash, derivation_type, pubkey));
+
+    if (mv_format_pkh(hash, PKH_SIZE, buffer, len)) {
+        MV_FAIL(EXC_UNKNOWN);
+    }
+
+    MV_LIB_POSTAMBLE;
+}
+
+mv_exc
+derive_path_pkh(derivation_type_t derivation_type,
+                const bip32_path_t *bip32_path, char *buffer, size_t len)
+{
+    pubkey_cache_entry_t *entry = NULL;
+    MV_PREAMBLE(("buffer=%p, len=%u", buffer, len));
+    MV_ASSERT_NOTNULL(buffer);
+    MV_LIB_CHECK(load_pubkey(&entry, derivation_type, bip32_path));
+
+    if (mv_format_pkh(entry->pkh, PKH_SIZE, buffer, len)) {
         MV_FAIL(EXC_UNKNOWN);
     }
 
@@ -164,10 +303,70 @@ public_key_hash(uint8_t *hash_out, size_t hash_out_size,
     MV_LIB_POSTAMBLE;
 }
 
+void
+clear_derived_key_cache(void)
+{
+    explicit_bzero(&global.derived_key, sizeof(global.derived_key));
+}
+
+void
+check_derived_key_cache(const bip32_path_with_curve_t *path_with_curve)
+{
+    derived_key_cache_t *cache = &global.derived_key;
+
+    if (cache->is_set
+        && ((cache->path_with_curve.derivation_type
+             != path_with_curve->derivation_type)
+            || !bip32_path_equal(&cache->path_with_curve.bip32_path,
+                                 &path_with_curve->bip32_path))) {
+        clear_derived_key_cache();
+    }
+}
+
+/**
+ * @brief Load the private key of the path in the derived key cache.
+ *
+ * The key is only derived from the seed if the cache holds the key of
+ * another path or curve.
+ *
+ * @param derivation_type: derivation type of the key
+ * @param path: path of the key
+ */
+static void
+load_derived_key(derivation_type_t derivation_type, const bip32_path_t *path)
+{
+    derived_key_cache_t *cache = &global.derived_key;
+
+    MV_PREAMBLE(("derivation_type=%d, path=%p", derivation_type, path));
+
+    if (cache->is_set
+        && (cache->path_with_curve.derivation_type == derivation_type)
+        && bip32_path_equal(&cache->path_with_curve.bip32_path, path)) {
+        MV_SUCCEED();
+    }
+
+    clear_derived_key_cache();
+    CX_CHECK(bip32_derive_with_seed_init_privkey_256(
+        derivation_type_to_mode(derivation_type),
+        derivation_type_to_cx_curve(derivation_type), path->components,
+        path->length, &cache->private_key, NULL, NULL, 0));
+    memcpy(&cache->path_with_curve.bip32_path, path, sizeof(*path));
+    cache->path_with_curve.derivation_type = derivation_type;
+    cache->is_set                          = true;
+
+    MV_POSTAMBLE;
+}
+
+#define ED25519_SIGNATURE_SIZE 64
+
 /**
  * @brief   Sign a hash with eddsa using the device seed derived from the
  * specified bip32 path and seed key.
  *
+ * The derived private key is kept in `global.derived_key` for the next
+ * signatures of the signing flow with the same path and curve, the flow
+ * wipes it once it ends.
+ *
  * @param[in]  derivation_type Derivation type, ex. ED25519
  *
  * @param[in]  path            Bip32 path to use for derivation.
@@ -185,9 +384,8 @@ void
 sign(derivation_type_t derivation_type, const bip32_path_t *path,
      const uint8_t *hash, size_t hashlen, uint8_t *sig, size_t *siglen)
 {
-    unsigned   derivation_mode;
-    uint32_t   info;
-    cx_curve_t curve = derivation_type_to_cx_curve(derivation_type);
+    uint32_t                   info;
+    cx_ecfp_256_private_key_t *private_key = &global.derived_key.private_key;
     MV_PREAMBLE(
         ("sig=%p, siglen=%u, derivation_type=%d, "
          "path=%p, hash=%p, hashlen=%u",
@@ -197,22 +395,25 @@ sign(derivation_type_t derivation_type, const bip32_path_t *path,
     MV_ASSERT_NOTNULL(sig);
     MV_ASSERT_NOTNULL(siglen);
 
+    MV_ASSERT(EXC_WRONG_VALUES, DERIVATION_TYPE_IS_SET(derivation_type));
+    MV_CHECK(load_derived_key(derivation_type, path));
+
+    MV_PROFILE_CALL(MV_PROFILE_SIGN);
+    MV_PROFILE_UNITS(MV_PROFILE_SIGN, hashlen);
+
     switch (derivation_type) {
     case DERIVATION_TYPE_BIP32_ED25519:
     case DERIVATION_TYPE_ED25519:
-        derivation_mode = HDW_NORMAL;
-        if (derivation_type == DERIVATION_TYPE_ED25519) {
-            derivation_mode = HDW_ED25519_SLIP10;
-        }
-        CX_CHECK(bip32_derive_with_seed_eddsa_sign_hash_256(
-            derivation_mode, curve, path->components, path->length, CX_SHA512,
-            hash, hashlen, sig, siglen, NULL, 0));
+        MV_ASSERT(EXC_WRONG_LENGTH, *siglen >= ED25519_SIGNATURE_SIZE);
+        CX_CHECK(cx_eddsa_sign_no_throw(private_key, CX_SHA512, hash,
+                                        hashlen, sig, *siglen));
+        *siglen = ED25519_SIGNATURE_SIZE;
         break;
     case DERIVATION_TYPE_SECP256K1:
     case DERIVATION_TYPE_SECP256R1:
-        CX_CHECK(bip32_derive_ecdsa_sign_hash_256(
-            curve, path->components, path->length, CX_RND_RFC6979 | CX_LAST,
-            CX_SHA256, hash, hashlen, sig, siglen, &info));
+        CX_CHECK(cx_ecdsa_sign_no_throw(private_key, CX_RND_RFC6979 | CX_LAST,
+                                        CX_SHA256, hash, hashlen, sig, siglen,
+                                        &info));
         if (info & CX_ECCINFO_PARITY_ODD) {
             sig[0] |= 0x01;
         }
@@ -32,6 +32,17 @@
 
 #define MAX_BIP32_LEN  10
 #define SIGN_HASH_SIZE 32
+#define PKH_SIZE       21  /// Tag and hash of a public key
+
+/// The cache shares `global.keys` with the signing states: it is sized
+/// to never make the public key flows larger than the signing ones.
+#ifdef TARGET_NANOS
+#define PUBKEY_CACHE_SIZE 5
+#elif defined(HAVE_BAGL)
+#define PUBKEY_CACHE_SIZE 10
+#else
+#define PUBKEY_CACHE_SIZE 12
+#endif
 
 /**
  * @brief The derivation type values in the following enum are from the
@@ -59,6 +70,48 @@ typedef struct {
     derivation_type_t derivation_type;
 } bip32_path_with_curve_t;
 
+/**
+ * @brief Private key derived by the last signature, kept to sign again
+ * with the same key without deriving it from the seed.
+ *
+ * It is only kept within a signing flow, such as the signatures of a
+ * batch: the flow wipes it when it ends, whether the signature has been
+ * sent, rejected or has failed.
+ *
+ */
+typedef struct {
+    bool is_set;  /// Whether `private_key` has been derived.
+    bip32_path_with_curve_t
+        path_with_curve;  /// Path and curve `private_key` is derived from.
+    cx_ecfp_256_private_key_t private_key;  /// Derived private key.
+} derived_key_cache_t;
+
+/**
+ * @brief Public key derived from a path.
+ *
+ */
+typedef struct {
+    bip32_path_with_curve_t
+        path_with_curve;          /// Path and curve of the public key.
+    cx_ecfp_public_key_t pubkey;  /// Public key, as returned by `derive_pk`.
+    uint8_t              pkh[PKH_SIZE];  /// Hash of the public key.
+    uint32_t             last_use;       /// Value of the cache clock at the
+                                         /// last use of the entry.
+} pubkey_cache_entry_t;
+
+/**
+ * @brief Public keys recently derived, to answer repeated requests
+ * without any curve operation.
+ *
+ */
+typedef struct {
+    uint32_t clock;  /// Incremented on each use of an entry.
+    uint8_t  count;  /// Number of entries set.
+    pubkey_cache_entry_t
+        entries[PUBKEY_CACHE_SIZE];  /// The least recently used entry is
+                                     /// replaced once the cache is full.
+} pubkey_cache_t;
+
 /**
  * @brief Read a BIP32 path from a buffer.
  *
@@ -90,5 +143,50 @@ mv_exc derive_pk(cx_ecfp_public_key_t *public_key,
 mv_exc derive_pkh(cx_ecfp_public_key_t *pubkey,
                   derivation_type_t derivation_type, char *buffer,
                   size_t len);
+/**
+ * @brief Derive the base58check formatted hash of the public key of a
+ * path.
+ *
+ * Same as `derive_pk` followed by `derive_pkh` but the hash is taken
+ * from the public key cache when possible.
+ *
+ * @param derivation_type Derivation type to be used.
+ * @param bip32_path Path to derive public key from.
+ * @param buffer The hash of public key, output is stored in this buffer.
+ * @param len Size of the buffer.
+ * @return mv_exc return Error code
+ */
+mv_exc derive_path_pkh(derivation_type_t   derivation_type,
+                       const bip32_path_t *bip32_path, char *buffer,
+                       size_t len);
+/**
+ * @brief Derive the public key of a child of a path.
+ *
+ * Same as `derive_pk` on the path of the child, but the public key
+ * cache is left untouched.
+ *
+ * @param public_key Public key derived is stored in this struct.
+ * @param derivation_type Derivation type to be used.
+ * @param parent_path Path of the parent.
+ * @param index Index of the child.
+ * @return mv_exc return Error code
+ */
+mv_exc derive_child_pk(cx_ecfp_public_key_t *public_key,
+                       derivation_type_t     derivation_type,
+                       const bip32_path_t   *parent_path, uint32_t index);
 void   sign(derivation_type_t derivation_type, const bip32_path_t *path,
             const uint8_t *hash, size_t hashlen, uint8_t *sig, size_t *siglen);
+
+/**
+ * @brief Wipe the cached private key.
+ *
+ */
+void clear_derived_key_cache(void);
+
+/**
+ * @brief Wipe the cached private key if it has not been derived from the
+ * given path and curve.
+ *
+ * @param path_with_curve: path and curve of the next signatures
+ */
+void check_derived_key_cache(const bip32_path_with_curve_t *path_with_curve);
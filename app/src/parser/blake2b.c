@@ -0,0 +1,175 @@
+/* Mavryk Embedded C parser for Ledger - Portable BLAKE2b
+
+   Copyright 2023 Nomadic Labs <contact@nomadic-labs.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "blake2b.h"
+
+static const uint64_t blake2b_iv[8] = {
+    0x6A09E667F3BCC908ULL, 0xBB67AE8584CAA73BULL, 0x3C6EF372FE94F82BULL,
+    0xA54FF53A5F1D36F1ULL, 0x510E527FADE682D1ULL, 0x9B05688C2B3E6C1FULL,
+    0x1F83D9ABFB41BD6BULL, 0x5BE0CD19137E2179ULL,
+};
+
+static const uint8_t blake2b_sigma[12][16] = {
+    {0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15},
+    {14, 10, 4,  8,  9,  15, 13, 6,  1,  12, 0,  2,  11, 7,  5,  3 },
+    {11, 8,  12, 0,  5,  2,  15, 13, 10, 14, 3,  6,  7,  1,  9,  4 },
+    {7,  9,  3,  1,  13, 12, 11, 14, 2,  6,  5,  10, 4,  0,  15, 8 },
+    {9,  0,  5,  7,  2,  4,  10, 15, 14, 1,  11, 12, 6,  8,  3,  13},
+    {2,  12, 6,  10, 0,  11, 8,  3,  4,  13, 7,  5,  15, 14, 1,  9 },
+    {12, 5,  1,  15, 14, 13, 4,  10, 0,  7,  6,  3,  9,  2,  8,  11},
+    {13, 11, 7,  14, 12, 1,  3,  9,  5,  0,  15, 4,  8,  6,  2,  10},
+    {6,  15, 14, 9,  11, 3,  0,  8,  12, 2,  13, 7,  1,  4,  10, 5 },
+    {10, 2,  8,  4,  7,  6,  1,  5,  15, 11, 9,  14, 3,  12, 13, 0 },
+    {0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15},
+    {14, 10, 4,  8,  9,  15, 13, 6,  1,  12, 0,  2,  11, 7,  5,  3 },
+};
+
+static uint64_t
+rotr64(uint64_t x, unsigned int n)
+{
+    return (x >> n) | (x << (64 - n));
+}
+
+static uint64_t
+load64(const uint8_t *p)
+{
+    uint64_t x = 0;
+    int      i;
+
+    for (i = 7; i >= 0; i--) {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+#define G(a, b, c, d, x, y)              \
+    do {                                 \
+        v[a] = v[a] + v[b] + (x);        \
+        v[d] = rotr64(v[d] ^ v[a], 32);  \
+        v[c] = v[c] + v[d];              \
+        v[b] = rotr64(v[b] ^ v[c], 24);  \
+        v[a] = v[a] + v[b] + (y);        \
+        v[d] = rotr64(v[d] ^ v[a], 16);  \
+        v[c] = v[c] + v[d];              \
+        v[b] = rotr64(v[b] ^ v[c], 63);  \
+    } while (0)
+
+/**
+ * @brief Compress the pending block
+ *
+ * @param state: hash state
+ * @param last: whether the block is the last one or not
+ */
+static void
+compress(mv_blake2b_state *state, bool last)
+{
+    uint64_t v[16];
+    uint64_t m[16];
+    int      i;
+
+    for (i = 0; i < 16; i++) {
+        m[i] = load64(state->buf + (8 * i));
+    }
+    for (i = 0; i < 8; i++) {
+        v[i]     = state->h[i];
+        v[i + 8] = blake2b_iv[i];
+    }
+    v[12] ^= state->t[0];
+    v[13] ^= state->t[1];
+    if (last) {
+        v[14] = ~v[14];
+    }
+
+    for (i = 0; i < 12; i++) {
+        const uint8_t *s = blake2b_sigma[i];
+
+        G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+        G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+        G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+        G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+        G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+        G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+        G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+        G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+
+    for (i = 0; i < 8; i++) {
+        state->h[i] ^= v[i] ^ v[i + 8];
+    }
+}
+
+static void
+increment(mv_blake2b_state *state, size_t len)
+{
+    state->t[0] += len;
+    if (state->t[0] < len) {
+        state->t[1]++;
+    }
+}
+
+void
+mv_blake2b_init(mv_blake2b_state *state, size_t out_len)
+{
+    int i;
+
+    memset(state, 0, sizeof(*state));
+    for (i = 0; i < 8; i++) {
+        state->h[i] = blake2b_iv[i];
+    }
+    // Parameter block: digest length, no key, fanout and depth of 1
+    state->h[0] ^= 0x01010000ULL ^ out_len;
+    state->out_len = out_len;
+}
+
+void
+mv_blake2b_update(mv_blake2b_state *state, const uint8_t *in, size_t len)
+{
+    while (len > 0) {
+        size_t chunk;
+
+        // The last block is only compressed by the finalization
+        if (state->buf_len == MV_BLAKE2B_BLOCK_SIZE) {
+            increment(state, MV_BLAKE2B_BLOCK_SIZE);
+            compress(state, false);
+            state->buf_len = 0;
+        }
+        chunk = MV_BLAKE2B_BLOCK_SIZE - state->buf_len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(state->buf + state->buf_len, in, chunk);
+        state->buf_len += chunk;
+        in += chunk;
+        len -= chunk;
+    }
+}
+
+void
+mv_blake2b_final(mv_blake2b_state *state, uint8_t *out)
+{
+    size_t i;
+
+    increment(state, state->buf_len);
+    memset(state->buf + state->buf_len, 0,
+           MV_BLAKE2B_BLOCK_SIZE - state->buf_len);
+    compress(state, true);
+    for (i = 0; i < state->out_len; i++) {
+        out[i] = (uint8_t)(state->h[i / 8] >> (8 * (i % 8)));
+    }
+}
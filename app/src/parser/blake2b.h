@@ -0,0 +1,64 @@
+/* Mavryk Embedded C parser for Ledger - Portable BLAKE2b
+
+   Copyright 2023 Nomadic Labs <contact@nomadic-labs.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MV_BLAKE2B_BLOCK_SIZE 128
+#define MV_BLAKE2B_MAX_SIZE   64
+
+/**
+ * @brief This struct represents the state of an unkeyed BLAKE2b hash,
+ *        as specified by RFC 7693
+ *
+ *        Only used off the device, where the hash engine of the SDK is
+ *        not available.
+ */
+typedef struct {
+    uint64_t h[8];                        /// chained state
+    uint64_t t[2];                        /// number of bytes hashed
+    uint8_t  buf[MV_BLAKE2B_BLOCK_SIZE];  /// pending input
+    size_t   buf_len;                     /// length of the pending input
+    size_t   out_len;                     /// length of the digest
+} mv_blake2b_state;
+
+/**
+ * @brief Initialize a hash
+ *
+ * @param state: hash state
+ * @param out_len: length of the digest, from 1 to MV_BLAKE2B_MAX_SIZE
+ */
+void mv_blake2b_init(mv_blake2b_state *state, size_t out_len);
+
+/**
+ * @brief Hash some input
+ *
+ * @param state: hash state
+ * @param in: input
+ * @param len: length of the input
+ */
+void mv_blake2b_update(mv_blake2b_state *state, const uint8_t *in,
+                       size_t len);
+
+/**
+ * @brief Write the digest of the input hashed
+ *
+ * @param state: hash state
+ * @param out: output, of `out_len` bytes
+ */
+void mv_blake2b_final(mv_blake2b_state *state, uint8_t *out);
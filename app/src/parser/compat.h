@@ -31,7 +31,10 @@
 #include "os.h"
 #include "os_io_seproxyhal.h"
 #include "cx.h"
+#include "profile.h"
 #else
+#define MV_PROFILE_CALL(section)
+#define MV_PROFILE_UNITS(section, nb_units)
 #include <stdio.h>
 #define PIC(x) ((void *)x)
 #ifdef MAVRYK_DEBUG
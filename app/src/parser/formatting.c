@@ -14,179 +14,42 @@
    See the License for the specific language governing permissions and
    limitations under the License. */
 
+#include <stddef.h>
+
 #include "formatting.h"
 
 /**
- * @brief Ordered array of names for michelson primitives
- *
- * Should be kept in sync with the last protocol update, including
- * order, currently defined in the `michelson_v1_primitives.ml` file
- * in the Mavryk protocol code.
+ * @brief Names of the michelson primitives, packed one after the
+ *        other with their null terminator
+ */
+typedef struct {
+#define MV_MICHELSON_NAME_FIELD(name) char mv_##name[sizeof(#name)];
+    MV_MICHELSON_PRIMITIVES(MV_MICHELSON_NAME_FIELD)
+#undef MV_MICHELSON_NAME_FIELD
+} mv_michelson_names_t;
+
+static const mv_michelson_names_t mv_michelson_names = {
+#define MV_MICHELSON_NAME(name) #name,
+    MV_MICHELSON_PRIMITIVES(MV_MICHELSON_NAME)
+#undef MV_MICHELSON_NAME
+};
+
+/**
+ * @brief Offsets of the names of the michelson primitives in
+ *        `mv_michelson_names`, indexed by operation code
  *
- * NEVER REORDER elements of this array as the index is used as a
- * selector by `michelson_op_name`.
+ *        The last offset is the one of the end of the names: the length
+ *        of a name is the distance to the next one without the null
+ *        terminator.
  */
-const char *const mv_michelson_op_names_ordered[MV_LAST_MICHELSON_OPCODE + 1]
+static const uint16_t
+    mv_michelson_name_offsets[MV_LAST_MICHELSON_OPCODE + 2]
     = {
-        "parameter",                       // 0
-        "storage",                         // 1
-        "code",                            // 2
-        "False",                           // 3
-        "Elt",                             // 4
-        "Left",                            // 5
-        "None",                            // 6
-        "Pair",                            // 7
-        "Right",                           // 8
-        "Some",                            // 9
-        "True",                            // 10
-        "Unit",                            // 11
-        "PACK",                            // 12
-        "UNPACK",                          // 13
-        "BLAKE2B",                         // 14
-        "SHA256",                          // 15
-        "SHA512",                          // 16
-        "ABS",                             // 17
-        "ADD",                             // 18
-        "AMOUNT",                          // 19
-        "AND",                             // 20
-        "BALANCE",                         // 21
-        "CAR",                             // 22
-        "CDR",                             // 23
-        "CHECK_SIGNATURE",                 // 24
-        "COMPARE",                         // 25
-        "CONCAT",                          // 26
-        "CONS",                            // 27
-        "CREATE_ACCOUNT",                  // 28
-        "CREATE_CONTRACT",                 // 29
-        "IMPLICIT_ACCOUNT",                // 30
-        "DIP",                             // 31
-        "DROP",                            // 32
-        "DUP",                             // 33
-        "EDIV",                            // 34
-        "EMPTY_MAP",                       // 35
-        "EMPTY_SET",                       // 36
-        "EQ",                              // 37
-        "EXEC",                            // 38
-        "FAILWITH",                        // 39
-        "GE",                              // 40
-        "GET",                             // 41
-        "GT",                              // 42
-        "HASH_KEY",                        // 43
-        "IF",                              // 44
-        "IF_CONS",                         // 45
-        "IF_LEFT",                         // 46
-        "IF_NONE",                         // 47
-        "INT",                             // 48
-        "LAMBDA",                          // 49
-        "LE",                              // 50
-        "LEFT",                            // 51
-        "LOOP",                            // 52
-        "LSL",                             // 53
-        "LSR",                             // 54
-        "LT",                              // 55
-        "MAP",                             // 56
-        "MEM",                             // 57
-        "MUL",                             // 58
-        "NEG",                             // 59
-        "NEQ",                             // 60
-        "NIL",                             // 61
-        "NONE",                            // 62
-        "NOT",                             // 63
-        "NOW",                             // 64
-        "OR",                              // 65
-        "PAIR",                            // 66
-        "PUSH",                            // 67
-        "RIGHT",                           // 68
-        "SIZE",                            // 69
-        "SOME",                            // 70
-        "SOURCE",                          // 71
-        "SENDER",                          // 72
-        "SELF",                            // 73
-        "STEPS_TO_QUOTA",                  // 74 [DEPRECATED]
-        "SUB",                             // 75
-        "SWAP",                            // 76
-        "TRANSFER_TOKENS",                 // 77
-        "SET_DELEGATE",                    // 78
-        "UNIT",                            // 79
-        "UPDATE",                          // 80
-        "XOR",                             // 81
-        "ITER",                            // 82
-        "LOOP_LEFT",                       // 83
-        "ADDRESS",                         // 84
-        "CONTRACT",                        // 85
-        "ISNAT",                           // 86
-        "CAST",                            // 87
-        "RENAME",                          // 88
-        "bool",                            // 89
-        "contract",                        // 90
-        "int",                             // 91
-        "key",                             // 92
-        "key_hash",                        // 93
-        "lambda",                          // 94
-        "list",                            // 95
-        "map",                             // 96
-        "big_map",                         // 97
-        "nat",                             // 98
-        "option",                          // 99
-        "or",                              // 100
-        "pair",                            // 101
-        "set",                             // 102
-        "signature",                       // 103
-        "string",                          // 104
-        "bytes",                           // 105
-        "mumav",                           // 106
-        "timestamp",                       // 107
-        "unit",                            // 108
-        "operation",                       // 109
-        "address",                         // 110
-        "SLICE",                           // 111
-        "DIG",                             // 112
-        "DUG",                             // 113
-        "EMPTY_BIG_MAP",                   // 114
-        "APPLY",                           // 115
-        "chain_id",                        // 116
-        "CHAIN_ID",                        // 117
-        "LEVEL",                           // 118
-        "SELF_ADDRESS",                    // 119
-        "never",                           // 120
-        "NEVER",                           // 121
-        "UNPAIR",                          // 122
-        "VOTING_POWER",                    // 123
-        "TOTAL_VOTING_POWER",              // 124
-        "KECCAK",                          // 125
-        "SHA3",                            // 126
-        "PAIRING_CHECK",                   // 127
-        "bls12_381_g1",                    // 128
-        "bls12_381_g2",                    // 129
-        "bls12_381_fr",                    // 130
-        "sapling_state",                   // 131
-        "sapling_transaction_deprecated",  // 132 [DEPRECATED]
-        "SAPLING_EMPTY_STATE",             // 133
-        "SAPLING_VERIFY_UPDATE",           // 134
-        "ticket",                          // 135
-        "TICKET_DEPRECATED",               // 136
-        "READ_TICKET",                     // 137
-        "SPLIT_TICKET",                    // 138
-        "JOIN_TICKETS",                    // 139
-        "GET_AND_UPDATE",                  // 140
-        "chest",                           // 141
-        "chest_key",                       // 142
-        "OPEN_CHEST",                      // 143
-        "VIEW",                            // 144
-        "view",                            // 145
-        "constant",                        // 146
-        "SUB_MUMAV",                       // 147
-        "tx_rollup_l2_address",            // 148
-        "MIN_BLOCK_TIME",                  // 149
-        "sapling_transaction",             // 150
-        "EMIT",                            // 151
-        "Lambda_rec",                      // 152
-        "LAMBDA_REC",                      // 153
-        "TICKET",                          // 154
-        "BYTES",                           // 155
-        "NAT",                             // 156
-        "Ticket",                          // 157
-};
+#define MV_MICHELSON_NAME_OFFSET(name) \
+    offsetof(mv_michelson_names_t, mv_##name),
+        MV_MICHELSON_PRIMITIVES(MV_MICHELSON_NAME_OFFSET)
+#undef MV_MICHELSON_NAME_OFFSET
+            sizeof(mv_michelson_names_t)};
 
 const char *
 mv_michelson_op_name(uint8_t op_code)
@@ -194,22 +57,135 @@ mv_michelson_op_name(uint8_t op_code)
     if (op_code > MV_LAST_MICHELSON_OPCODE) {
         return NULL;
     }
-    return PIC(mv_michelson_op_names_ordered[op_code]);
+    return (const char *)&mv_michelson_names
+           + mv_michelson_name_offsets[op_code];
 }
 
-/*
- * The following `format_base58` and `format_decimal` are adaptaed
- * from `https://github.com/luke-jr/libbase58/blob/master/base58.c`,
- * mostly for working with less stack and a preallocated output
- * buffer. Copyright 2012-2014 Luke Dashjr
- *
- * This program is free software; you can redistribute it and/or modify it
- * under the terms of the standard MIT license.
- */
+size_t
+mv_michelson_op_name_length(uint8_t op_code)
+{
+    return (size_t)(mv_michelson_name_offsets[op_code + 1]
+                    - mv_michelson_name_offsets[op_code] - 1);
+}
 
 static const char mv_b58digits_ordered[]
     = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 
+#define MV_LIMBS_SIZE      20          /// 100 base58 digits, 72 bytes
+#define MV_B58_LIMB_BASE   656356768   /// 58^5
+#define MV_B58_LIMB_DIGITS 5
+
+/**
+ * @brief Converts a number into limbs of base `base`
+ *
+ *        The number is consumed by words of 32 bits, so that it only
+ *        takes one pass over the limbs every 4 bytes. `base` must be
+ *        lower than 2^32.
+ *
+ * @param n: input number
+ * @param l: length of the input number
+ * @param little_endian: whether `n` is stored in little-endian order
+ * @param base: base of the limbs
+ * @param limbs: output limbs, least significant first
+ * @param size: size of `limbs`
+ * @return int: number of limbs used, -1 if `size` is too small
+ */
+static int
+mv_to_limbs(const uint8_t *n, size_t l, bool little_endian, uint32_t base,
+            uint32_t *limbs, size_t size)
+{
+    size_t   used = 0;
+    size_t   i    = 0;
+    size_t   j;
+    size_t   k;
+    uint64_t carry;
+
+    while (i < l) {
+        // The first word takes the leading bytes that do not fill 32 bits
+        k     = ((i == 0) && (l % 4)) ? (l % 4) : 4;
+        carry = 0;
+        for (j = 0; j < k; j++, i++) {
+            carry = (carry << 8) | (little_endian ? n[l - i - 1] : n[i]);
+        }
+        for (j = 0; j < used; j++) {
+            carry += (uint64_t)limbs[j] << (8 * k);
+            limbs[j] = (uint32_t)(carry % base);
+            carry /= base;
+        }
+        while (carry) {
+            if (used == size) {
+                return -1;
+            }
+            limbs[used++] = (uint32_t)(carry % base);
+            carry /= base;
+        }
+    }
+    return (int)used;
+}
+
+/**
+ * @brief Writes limbs, most significant first, without leading zeros
+ *
+ * @param limbs: input limbs, least significant first, the most
+ *               significant one must not be 0
+ * @param used: number of limbs
+ * @param radix: radix of the digits
+ * @param digits: number of digits of a limb
+ * @param alphabet: characters of the digits
+ * @param obuf: output buffer, `used * digits` long at least
+ * @return size_t: number of characters written
+ */
+static size_t
+mv_write_limbs(const uint32_t *limbs, size_t used, uint32_t radix,
+               size_t digits, const char *alphabet, char *obuf)
+{
+    size_t   len = 0;
+    size_t   i;
+    size_t   d;
+    uint32_t limb;
+    char     tmp[9];
+
+    for (i = used; i > 0; i--) {
+        limb = limbs[i - 1];
+        for (d = digits; d > 0; d--) {
+            tmp[d - 1] = alphabet[limb % radix];
+            limb /= radix;
+        }
+        d = 0;
+        if (i == used) {
+            while (tmp[d] == alphabet[0]) {
+                d++;
+            }
+        }
+        memcpy(obuf + len, tmp + d, digits - d);
+        len += digits - d;
+    }
+    return len;
+}
+
+/**
+ * @brief Get the number of digits of limbs, without leading zeros
+ *
+ * @param limbs: input limbs, least significant first
+ * @param used: number of limbs, not 0
+ * @param radix: radix of the digits
+ * @param digits: number of digits of a limb
+ * @return size_t: number of digits
+ */
+static size_t
+mv_limbs_length(const uint32_t *limbs, size_t used, uint32_t radix,
+                size_t digits)
+{
+    size_t   len = (used - 1) * digits;
+    uint32_t top = limbs[used - 1];
+
+    while (top) {
+        len++;
+        top /= radix;
+    }
+    return len;
+}
+
 /**
  * @brief Get the base58 format of a number
  *
@@ -222,8 +198,9 @@ static const char mv_b58digits_ordered[]
 int
 mv_format_base58(const uint8_t *n, size_t l, char *obuf, size_t olen)
 {
-    int    carry;
-    size_t i, j, high, zcount = 0, obuf_len = MV_BASE58_BUFFER_SIZE(l);
+    uint32_t limbs[MV_LIMBS_SIZE];
+    size_t   zcount = 0, len = 0, obuf_len = MV_BASE58_BUFFER_SIZE(l);
+    int      used;
 
     if (olen < obuf_len) {
         PRINTF("[DEBUG] mv_format_base58() called with %u obuf need %u\n",
@@ -231,77 +208,200 @@ mv_format_base58(const uint8_t *n, size_t l, char *obuf, size_t olen)
         return 1;
     }
 
-    memset(obuf, 0, obuf_len);
-
     while ((zcount < l) && !n[zcount]) {
         ++zcount;
     }
 
-    for (i = zcount, high = obuf_len - 1; i < l; ++i, high = j) {
-        carry = n[i];
-        for (j = obuf_len - 1; ((int)j >= 0) && ((j > high) || carry); --j) {
-            carry += 256 * obuf[j];
-            obuf[j] = carry % 58;
-            carry /= 58;
-        }
+    used = mv_to_limbs(n + zcount, l - zcount, false, MV_B58_LIMB_BASE,
+                       limbs, MV_LIMBS_SIZE);
+    if (used < 0) {
+        PRINTF("[WARNING] mv_format_base58() failed: input too large %u\n",
+               l);
+        return 1;
     }
-
-    if (zcount) {
-        memset(obuf, '1', zcount);
+    if (used > 0) {
+        len = mv_limbs_length(limbs, (size_t)used, 58, MV_B58_LIMB_DIGITS);
     }
-
-    for (j = 0; !obuf[j]; ++j) {
-        // Find the last index of obuf
-    }
-    for (i = 0; j < obuf_len; ++i, ++j) {
-        obuf[i] = mv_b58digits_ordered[(unsigned)obuf[j]];
+    if ((zcount + len) >= olen) {
+        PRINTF("[DEBUG] mv_format_base58() called with %u obuf need %u\n",
+               olen, zcount + len + 1);
+        return 1;
     }
-    obuf[i] = '\0';
+
+    memset(obuf, '1', zcount);
+    mv_write_limbs(limbs, (size_t)used, 58, MV_B58_LIMB_DIGITS,
+                   mv_b58digits_ordered, obuf + zcount);
+    obuf[zcount + len] = '\0';
     return 0;
 }
 
+/**
+ * @brief Get the decimal format of a number
+ *
+ * @param n: input number, in little-endian order
+ * @param l: length of the input buffer
+ * @param obuf: output buffer
+ * @param olen: length of the output buffer
+ * @return int: 0 on success
+ */
 int
 mv_format_decimal(const uint8_t *n, size_t l, char *obuf, size_t olen)
 {
-    int    carry;
-    size_t i, j, high, zcount = 0, obuf_len = MV_DECIMAL_BUFFER_SIZE(l);
+    uint32_t limbs[MV_LIMBS_SIZE];
+    size_t   len = 0, obuf_len = MV_DECIMAL_BUFFER_SIZE(l);
+    int      used;
 
     if (olen < obuf_len) {
-        PRINTF("[DEBUG] mv_format_base58() called with %u obuf need %u\n",
+        PRINTF("[DEBUG] mv_format_decimal() called with %u obuf need %u\n",
                olen, obuf_len);
         return 1;
     }
 
-    memset(obuf, 0, obuf_len);
-
-    while ((zcount < l) && !n[l - zcount - 1]) {
-        ++zcount;
+    while ((l > 0) && !n[l - 1]) {
+        --l;
     }
 
-    if (zcount == l) {
+    if (l == 0) {
         obuf[0] = '0';
+        obuf[1] = '\0';
         return 0;
     }
 
-    for (i = zcount, high = obuf_len - 1; i < l; ++i, high = j) {
-        carry = n[l - i - 1];
-        for (j = obuf_len - 1; ((int)j >= 0) && ((j > high) || carry); --j) {
-            carry += 256 * obuf[j];
-            obuf[j] = carry % 10;
-            carry /= 10;
+    used = mv_to_limbs(n, l, true, MV_DEC_LIMB_BASE, limbs, MV_LIMBS_SIZE);
+    if (used < 0) {
+        PRINTF("[WARNING] mv_format_decimal() failed: input too large %u\n",
+               l);
+        return 1;
+    }
+    len = mv_write_limbs(limbs, (size_t)used, 10, MV_DEC_LIMB_DIGITS,
+                         "0123456789", obuf);
+    obuf[len] = '\0';
+    return 0;
+}
+
+int
+mv_format_decimal_limbs(const uint32_t *limbs, size_t used, char *obuf,
+                        size_t olen)
+{
+    size_t len;
+
+    while ((used > 0) && !limbs[used - 1]) {
+        --used;
+    }
+
+    if (used == 0) {
+        if (olen < 2) {
+            return 1;
         }
+        obuf[0] = '0';
+        obuf[1] = '\0';
+        return 0;
     }
 
-    for (j = 0; !obuf[j]; ++j) {
-        // Find the last index of obuf
+    len = mv_limbs_length(limbs, used, 10, MV_DEC_LIMB_DIGITS);
+    if (len >= olen) {
+        PRINTF("[DEBUG] mv_format_decimal_limbs() called with %u obuf "
+               "need %u\n",
+               olen, len + 1);
+        return 1;
+    }
+    len = mv_write_limbs(limbs, used, 10, MV_DEC_LIMB_DIGITS, "0123456789",
+                         obuf);
+    obuf[len] = '\0';
+    return 0;
+}
+
+/**
+ * @brief Writes the digits of a number, backwards
+ *
+ * @param n: number
+ * @param end: end of the output buffer, the last digit is written
+ *             just before it
+ * @param min_digits: number of digits to write at least, padding
+ *                    with 0
+ * @return char *: first digit written
+ */
+static char *
+mv_write_digits_backwards(uint32_t n, char *end, size_t min_digits)
+{
+    do {
+        *--end = (char)('0' + (n % 10));
+        n /= 10;
+        if (min_digits > 0) {
+            min_digits--;
+        }
+    } while ((n != 0) || (min_digits > 0));
+    return end;
+}
+
+int
+mv_format_mumav(uint64_t amount, char *obuf, size_t olen)
+{
+    char     tmp[MV_MUMAV_BUFFER_SIZE];
+    char    *start = tmp + sizeof(tmp) - 1;
+    uint64_t units = amount / 1000000;
+    uint32_t frac  = (uint32_t)(amount % 1000000);
+    size_t   digits;
+    size_t   len;
+
+    *start = '\0';
+    if (frac != 0) {
+        for (digits = 6; (frac % 10) == 0; digits--) {
+            frac /= 10;
+        }
+        start    = mv_write_digits_backwards(frac, start, digits);
+        *--start = '.';
     }
-    for (i = 0; j < obuf_len; ++i, ++j) {
-        obuf[i] = '0' + obuf[j];
+    // At most 14 digits: split them in 32-bit words
+    if (units >= MV_DEC_LIMB_BASE) {
+        start = mv_write_digits_backwards(
+            (uint32_t)(units % MV_DEC_LIMB_BASE), start, MV_DEC_LIMB_DIGITS);
+        units /= MV_DEC_LIMB_BASE;
     }
-    obuf[i] = '\0';
+    start = mv_write_digits_backwards((uint32_t)units, start, 0);
+
+    len = (size_t)(tmp + sizeof(tmp) - 1 - start);
+    if (len >= olen) {
+        return 1;
+    }
+    memcpy(obuf, start, len + 1);
     return 0;
 }
 
+// clang-format off
+#define MV_HEX_ROW(_h)                                             \
+    {_h, '0'}, {_h, '1'}, {_h, '2'}, {_h, '3'}, {_h, '4'}, {_h, '5'}, \
+    {_h, '6'}, {_h, '7'}, {_h, '8'}, {_h, '9'}, {_h, 'A'}, {_h, 'B'}, \
+    {_h, 'C'}, {_h, 'D'}, {_h, 'E'}, {_h, 'F'}
+// clang-format on
+
+/// Uppercase hexadecimal digits of every byte
+static const char mv_hex_pairs[256][2] = {
+    MV_HEX_ROW('0'), MV_HEX_ROW('1'), MV_HEX_ROW('2'), MV_HEX_ROW('3'),
+    MV_HEX_ROW('4'), MV_HEX_ROW('5'), MV_HEX_ROW('6'), MV_HEX_ROW('7'),
+    MV_HEX_ROW('8'), MV_HEX_ROW('9'), MV_HEX_ROW('A'), MV_HEX_ROW('B'),
+    MV_HEX_ROW('C'), MV_HEX_ROW('D'), MV_HEX_ROW('E'), MV_HEX_ROW('F'),
+};
+
+#undef MV_HEX_ROW
+
+size_t
+mv_format_hex(const uint8_t *ibuf, size_t ilen, char *obuf, size_t olen,
+              bool lower)
+{
+    // Setting the bit 0x20 lowers the letters and keeps the digits
+    char   lower_bit = lower ? 0x20 : 0x00;
+    size_t len       = MIN(ilen, olen / 2);
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        const char *pair = mv_hex_pairs[ibuf[i]];
+        obuf[2 * i]       = (char)(pair[0] | lower_bit);
+        obuf[(2 * i) + 1] = (char)(pair[1] | lower_bit);
+    }
+    return len;
+}
+
 #ifndef ACTUALLY_ON_LEDGER
 // Mavryk links with digestif's C hashing functions, but the OPAM
 // package does not publish their C header file for others to use, so
@@ -342,204 +442,375 @@ extern void digestif_sha256_update(struct sha256_ctx *ctx, uint8_t *data,
  */
 extern void digestif_sha256_finalize(struct sha256_ctx *ctx, uint8_t *out);
 
+typedef struct sha256_ctx mv_sha256_ctx;
+
 /**
- * @brief Get the hash sha256 of a data
+ * @brief Hash a data with sha256
+ *
+ *        `out` may alias `data`: the data is consumed before the
+ *        digest is written.
  *
+ * @param ctx: sha256 context to use
  * @param data: data
  * @param size: length of the data
- * @param out: output buffer
- * @param size_out: length of the output buffer
+ * @param out: output buffer of 32 bytes
+ * @return int: 0 on success
  */
-static void
-cx_hash_sha256(uint8_t *data, size_t size, uint8_t *out, size_t size_out)
+static int
+mv_sha256(mv_sha256_ctx *ctx, const uint8_t *data, size_t size,
+          uint8_t *out)
 {
-    struct sha256_ctx ctx;
-    uint8_t           res[32];
-    digestif_sha256_init(&ctx);
-    digestif_sha256_update(&ctx, data, size);
-    digestif_sha256_finalize(&ctx, res);
-    memcpy(out, res, size_out);
+    digestif_sha256_init(ctx);
+    digestif_sha256_update(ctx, (uint8_t *)data, size);
+    digestif_sha256_finalize(ctx, out);
+    return 0;
 }
-#endif
+#else
+typedef cx_sha256_t mv_sha256_ctx;
 
-// clang-format off
-#define B58_PREFIX(_s, _p, _pl, _dl) do {       \
-            if (!strcmp((_s), s)) {             \
-                if ((_dl) != dl) {              \
-                      return 1;                 \
-                }                               \
-                (*p)  = (const uint8_t *)(_p);  \
-                (*pl) = (_pl);                  \
-                return 0;                       \
-            }                                   \
-        } while (0)
+static int
+mv_sha256(mv_sha256_ctx *ctx, const uint8_t *data, size_t size,
+          uint8_t *out)
+{
+    if (cx_sha256_init_no_throw(ctx) != CX_OK) {
+        return 1;
+    }
+    if (cx_hash_no_throw((cx_hash_t *)ctx, CX_LAST, data, size, out,
+                         32)
+        != CX_OK) {
+        return 1;
+    }
+    return 0;
+}
+#endif
 
 /**
- * @brief Get base58 prefix information
+ * @brief Hash a data twice with sha256
  *
- *        To save lines and make things easier to read and modify, we
- *        implement find_prefix() as a series of invocations of the
- *        macro B58_PREFIX().  This macro takes 4 arguments: which
- *        correspond the the arguments of our function directly.  It
- *        matches the textual prefixes and if they do match, it sets
- *        the output parameters and validates that the length is
- *        correct.
+ *        Both passes share a single context and hash in place into
+ *        `out`, on the device hash engine or on digestif.
  *
- *        find_prefix() returns successfully if it finds a definition
- *        and the length is correct.
- *
- * @param s: prefix we are looking for
- * @param p: an out parameter which is the binary prefix we matched
- * @param pl: another out parameter: the length of the returned binary prefix
- * @param dl: data length which we got
+ * @param data: data
+ * @param size: length of the data
+ * @param out: output buffer of 32 bytes
  * @return int: 0 on success
  */
 static int
-find_prefix(const char *s, const uint8_t **p, size_t *pl, size_t dl)
+mv_double_sha256(const uint8_t *data, size_t size, uint8_t *out)
 {
+    mv_sha256_ctx ctx;
 
-    /* For mv_format_hash */
+    if (mv_sha256(&ctx, data, size, out)) {
+        return 1;
+    }
+    return mv_sha256(&ctx, out, 32, out);
+}
 
-    B58_PREFIX("B",     "\x01\x34",         2, 32);
-    B58_PREFIX("o",     "\x05\x74",         2, 32);
-    B58_PREFIX("expr",  "\x0d\x2c\x40\x1b", 4, 32);
-    B58_PREFIX("proto", "\x02\xaa",         2, 32);
+/**
+ * @brief This struct represents a base58check prefix
+ */
+typedef struct {
+    char    name[6];    /// textual prefix
+    uint8_t bytes[4];   /// binary prefix
+    uint8_t len;        /// length of the binary prefix
+    uint8_t data_len;   /// length of the data required
+} mv_base58check_prefix_info;
+
+#ifdef ACTUALLY_ON_LEDGER
+int
+mv_digest_init(mv_digest_ctx *ctx)
+{
+    return cx_blake2b_init_no_throw(ctx, MV_DIGEST_SIZE * 8) != CX_OK;
+}
 
-    /* Public key hashes */
+int
+mv_digest_update(mv_digest_ctx *ctx, const uint8_t *data, size_t len)
+{
+    return cx_hash_no_throw((cx_hash_t *)ctx, 0, data, len, NULL, 0)
+           != CX_OK;
+}
 
-    B58_PREFIX("mv1",  "\x05\xBA\xC4",     3, 20);
-    B58_PREFIX("mv2",  "\x05\xBA\xC7",     3, 20);
-    B58_PREFIX("mv3",  "\x05\xBA\xC9",     3, 20);
-    B58_PREFIX("mv4",  "\x05\xBA\xCC",     3, 20);
+int
+mv_digest_final(mv_digest_ctx *ctx, uint8_t *out)
+{
+    return cx_hash_no_throw((cx_hash_t *)ctx, CX_LAST, NULL, 0, out,
+                            MV_DIGEST_SIZE)
+           != CX_OK;
+}
+#else
+int
+mv_digest_init(mv_digest_ctx *ctx)
+{
+    mv_blake2b_init(ctx, MV_DIGEST_SIZE);
+    return 0;
+}
 
-    /* Public keys */
+int
+mv_digest_update(mv_digest_ctx *ctx, const uint8_t *data, size_t len)
+{
+    mv_blake2b_update(ctx, data, len);
+    return 0;
+}
+
+int
+mv_digest_final(mv_digest_ctx *ctx, uint8_t *out)
+{
+    mv_blake2b_final(ctx, out);
+    return 0;
+}
+#endif
 
-    B58_PREFIX("edpk", "\x0d\x0f\x25\xd9", 4, 32);
-    B58_PREFIX("sppk", "\x03\xfe\xe2\x56", 4, 33);
-    B58_PREFIX("p2pk", "\x03\xb2\x8b\x7f", 4, 33);
-    B58_PREFIX("BLpk", "\x06\x95\x87\xcc", 4, 48);
+/**
+ * @brief Table of the base58check prefixes, indexed by
+ *        `mv_base58check_prefix`
+ *
+ *        The names and the bytes are stored inline, so that no
+ *        pointer of the table needs to be relocated.
+ */
+// clang-format off
+static const mv_base58check_prefix_info
+    b58_prefixes[MV_B58_PREFIX_COUNT] = {
+    [MV_B58_PREFIX_B]     = {"B",     {0x01, 0x34},             2, 32},
+    [MV_B58_PREFIX_O]     = {"o",     {0x05, 0x74},             2, 32},
+    [MV_B58_PREFIX_EXPR]  = {"expr",  {0x0d, 0x2c, 0x40, 0x1b}, 4, 32},
+    [MV_B58_PREFIX_PROTO] = {"proto", {0x02, 0xaa},             2, 32},
+    [MV_B58_PREFIX_MV1]   = {"mv1",   {0x05, 0xBA, 0xC4},       3, 20},
+    [MV_B58_PREFIX_MV2]   = {"mv2",   {0x05, 0xBA, 0xC7},       3, 20},
+    [MV_B58_PREFIX_MV3]   = {"mv3",   {0x05, 0xBA, 0xC9},       3, 20},
+    [MV_B58_PREFIX_MV4]   = {"mv4",   {0x05, 0xBA, 0xCC},       3, 20},
+    [MV_B58_PREFIX_EDPK]  = {"edpk",  {0x0d, 0x0f, 0x25, 0xd9}, 4, 32},
+    [MV_B58_PREFIX_SPPK]  = {"sppk",  {0x03, 0xfe, 0xe2, 0x56}, 4, 33},
+    [MV_B58_PREFIX_P2PK]  = {"p2pk",  {0x03, 0xb2, 0x8b, 0x7f}, 4, 33},
+    [MV_B58_PREFIX_BLPK]  = {"BLpk",  {0x06, 0x95, 0x87, 0xcc}, 4, 48},
+    [MV_B58_PREFIX_KT1]   = {"KT1",   {0x02, 0x5a, 0x79},       3, 20},
+    [MV_B58_PREFIX_TXR1]  = {"txr1",  {0x01, 0x80, 0x78, 0x1f}, 4, 20},
+    [MV_B58_PREFIX_ZKR1]  = {"zkr1",  {0x01, 0xab, 0x54, 0xfb}, 4, 20},
+    [MV_B58_PREFIX_SR1]   = {"sr1",   {0x06, 0x7c, 0x75},       3, 20},
+    [MV_B58_PREFIX_SRC1]  = {"src1",  {0x11, 0xa5, 0x86, 0x8a}, 4, 32},
+};
+// clang-format on
 
-    /* For mv_format_address */
+#ifndef MV_B58_MEMO_SIZE
+#ifdef TARGET_NANOS
+#define MV_B58_MEMO_SIZE 2
+#else
+#define MV_B58_MEMO_SIZE 4
+#endif
+#endif
 
-    B58_PREFIX("KT1",  "\x02\x5a\x79",     3, 20);
-    B58_PREFIX("txr1", "\x01\x80\x78\x1f", 4, 20);
-    B58_PREFIX("zkr1", "\x01\xab\x54\xfb", 4, 20);
+#define MV_B58_MEMO_DATA_LEN 20  /// hashes of the addresses
+#define MV_B58_MEMO_STR_SIZE \
+    MV_BASE58CHECK_BUFFER_SIZE(MV_B58_MEMO_DATA_LEN, 4)
 
-    /* Smart rollup hashes */
+/**
+ * @brief This struct represents a recently formatted address hash
+ */
+typedef struct {
+    uint8_t prefix;                      /// `mv_base58check_prefix`
+    uint8_t data[MV_B58_MEMO_DATA_LEN];  /// hash
+    char    str[MV_B58_MEMO_STR_SIZE];   /// formatted hash, empty if
+                                         /// the entry is unused
+} mv_base58check_memo_entry;
 
-    B58_PREFIX("sr1",  "\x06\x7c\x75",     3, 20);
+/**
+ * @brief Memo of the last formatted address hashes
+ *
+ *        A batch repeats its source and often its destinations: their
+ *        base58check formats are found here instead of being hashed
+ *        and encoded again. The entries are replaced in turn.
+ */
+static struct {
+    mv_base58check_memo_entry entries[MV_B58_MEMO_SIZE];  /// entries
+    uint8_t                   next;  /// next entry to replace
+} b58_memo;
 
-    /* Smart rollup commitment hashes */
+void
+mv_format_base58check_reset_memo(void)
+{
+    memset(&b58_memo, 0, sizeof(b58_memo));
+}
 
-    B58_PREFIX("src1", "\x11\xa5\x86\x8a", 4, 32);
+/**
+ * @brief Find the format of a hash in the memo
+ *
+ * @param prefix: base58 prefix
+ * @param data: hash of `MV_B58_MEMO_DATA_LEN` bytes
+ * @return mv_base58check_memo_entry *: entry, NULL if not found
+ */
+static mv_base58check_memo_entry *
+mv_base58check_memo_find(mv_base58check_prefix prefix, const uint8_t *data)
+{
+    size_t i;
 
-    return 1;
+    for (i = 0; i < MV_B58_MEMO_SIZE; i++) {
+        mv_base58check_memo_entry *entry = &b58_memo.entries[i];
+
+        if ((entry->str[0] != '\0') && (entry->prefix == prefix)
+            && (memcmp(entry->data, data, MV_B58_MEMO_DATA_LEN) == 0)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Record the format of a hash in the memo
+ *
+ * @param prefix: base58 prefix
+ * @param data: hash of `MV_B58_MEMO_DATA_LEN` bytes
+ * @param str: base58check format of the hash
+ */
+static void
+mv_base58check_memo_add(mv_base58check_prefix prefix, const uint8_t *data,
+                        const char *str)
+{
+    mv_base58check_memo_entry *entry = &b58_memo.entries[b58_memo.next];
+    size_t                     len   = strlen(str);
+
+    if (len >= sizeof(entry->str)) {
+        return;
+    }
+    entry->prefix = (uint8_t)prefix;
+    memcpy(entry->data, data, MV_B58_MEMO_DATA_LEN);
+    memcpy(entry->str, str, len + 1);
+    b58_memo.next = (uint8_t)((b58_memo.next + 1) % MV_B58_MEMO_SIZE);
 }
-// clang-format on
 
 int
-mv_format_base58check(const char *sprefix, const uint8_t *data, size_t size,
-                      char *obuf, size_t olen)
+mv_format_base58check_prefix(mv_base58check_prefix prefix,
+                             const uint8_t *data, size_t size, char *obuf,
+                             size_t olen)
 {
-    const uint8_t *prefix = NULL;
-    size_t         prefix_len;
+    const mv_base58check_prefix_info *info;
 
-    if (find_prefix(sprefix, &prefix, &prefix_len, size)) {
+    if ((unsigned)prefix >= MV_B58_PREFIX_COUNT) {
+        return 1;
+    }
+    info = &b58_prefixes[prefix];
+    if (info->data_len != size) {
+        return 1;
+    }
+    if (obuf == NULL) {
+        return 0;
+    }
+    if (olen < MV_BASE58CHECK_BUFFER_SIZE(size, info->len)) {
+        PRINTF("[DEBUG] mv_format_base58check() called with %u obuf\n",
+               olen);
         return 1;
     }
+    if (size == MV_B58_MEMO_DATA_LEN) {
+        const mv_base58check_memo_entry *entry
+            = mv_base58check_memo_find(prefix, data);
 
-    /* In order to avoid vla, we have a maximum buffer size of 64 */
+        if (entry != NULL) {
+            memcpy(obuf, entry->str, strlen(entry->str) + 1);
+            return 0;
+        }
+    }
+
+    /* The prefix and the largest data, with the checksum, take 56
+     * bytes: a single SHA-256 block, whose compression cannot be
+     * shared between prefixes. */
     uint8_t prepared[64];
-    if ((prefix_len + size + 4) > sizeof(prepared)) {
+    if ((info->len + size + 4) > sizeof(prepared)) {
         PRINTF(
             "[WARNING] mv_format_base58check() failed: fixed size "
             "array is too small need: %u\n",
-            prefix_len + size + 4);
+            info->len + size + 4);
+        return 1;
+    }
+
+    memcpy(prepared, info->bytes, info->len);
+    memcpy(prepared + info->len, data, size);
+    uint8_t checksum[32];
+    if (mv_double_sha256(prepared, size + info->len, checksum)) {
+        PRINTF("[WARNING] mv_format_base58check() failed: sha256\n");
+        return 1;
+    }
+    memcpy(prepared + size + info->len, checksum, 4);
+    if (mv_format_base58(prepared, info->len + size + 4, obuf, olen)) {
         return 1;
     }
+    if (size == MV_B58_MEMO_DATA_LEN) {
+        // `data` may be `obuf` itself, as for the fields formatted from
+        // the capture buffer: the key is the copy of the hash
+        mv_base58check_memo_add(prefix, prepared + info->len, obuf);
+    }
+    return 0;
+}
+
+int
+mv_format_base58check(const char *sprefix, const uint8_t *data, size_t size,
+                      char *obuf, size_t olen)
+{
+    size_t i;
 
-    memcpy(prepared, prefix, prefix_len);
-    memcpy(prepared + prefix_len, data, size);
-    uint8_t tmp[32];
-    cx_hash_sha256(prepared, size + prefix_len, tmp, 32);
-    cx_hash_sha256(tmp, 32, tmp, 32);
-    memcpy(prepared + size + prefix_len, tmp, 4);
-    return mv_format_base58(prepared, prefix_len + size + 4, obuf, olen);
+    for (i = 0; i < MV_B58_PREFIX_COUNT; i++) {
+        if (strcmp(sprefix, b58_prefixes[i].name) == 0) {
+            return mv_format_base58check_prefix((mv_base58check_prefix)i,
+                                                data, size, obuf, olen);
+        }
+    }
+    return 1;
 }
 
 int
 mv_format_pkh(const uint8_t *data, size_t size, char *obuf, size_t olen)
 {
-    const char *prefix;
-
-    if (size < 1) {
+    if ((size < 1) || (data[0] > 3)) {
         return 1;
     }
-    // clang-format off
-    switch (data[0]) {
-    case 0:  prefix = "mv1"; break;
-    case 1:  prefix = "mv2"; break;
-    case 2:  prefix = "mv3"; break;
-    case 3:  prefix = "mv4"; break;
-    default: return 1;
-    }
-    // clang-format on
-
-    return mv_format_base58check(prefix, data + 1, size - 1, obuf, olen);
+    return mv_format_base58check_prefix(
+        (mv_base58check_prefix)(MV_B58_PREFIX_MV1 + data[0]), data + 1,
+        size - 1, obuf, olen);
 }
 
 int
 mv_format_pk(const uint8_t *data, size_t size, char *obuf, size_t olen)
 {
-    const char *prefix;
-
-    if (size < 1) {
+    if ((size < 1) || (data[0] > 3)) {
         return 1;
     }
-    // clang-format off
-    switch (data[0]) {
-    case 0:  prefix = "edpk"; break;
-    case 1:  prefix = "sppk"; break;
-    case 2:  prefix = "p2pk"; break;
-    case 3:  prefix = "BLpk"; break;
-    default: return 1;
-    }
-    // clang-format on
-
-    return mv_format_base58check(prefix, data + 1, size - 1, obuf, olen);
+    return mv_format_base58check_prefix(
+        (mv_base58check_prefix)(MV_B58_PREFIX_EDPK + data[0]), data + 1,
+        size - 1, obuf, olen);
 }
 
 int
 mv_format_oph(const uint8_t *data, size_t size, char *obuf, size_t olen)
 {
-    return mv_format_base58check("o", data, size, obuf, olen);
+    return mv_format_base58check_prefix(MV_B58_PREFIX_O, data, size, obuf,
+                                        olen);
 }
 
 int
 mv_format_bh(const uint8_t *data, size_t size, char *obuf, size_t olen)
 {
-    return mv_format_base58check("B", data, size, obuf, olen);
+    return mv_format_base58check_prefix(MV_B58_PREFIX_B, data, size, obuf,
+                                        olen);
 }
 
 int
 mv_format_address(const uint8_t *data, size_t size, char *obuf, size_t olen)
 {
-    const char *prefix;
+    mv_base58check_prefix prefix;
 
     if (size < 1) {
         return 1;
     }
     // clang-format off
     switch (data[0]) {
-    case 1:  prefix = "KT1";  break;
-    case 2:  prefix = "txr1"; break;
-    case 3:  prefix = "scr1"; break;
-    case 4:  prefix = "zkr1"; break;
+    case 1:  prefix = MV_B58_PREFIX_KT1;  break;
+    case 2:  prefix = MV_B58_PREFIX_TXR1; break;
+    case 4:  prefix = MV_B58_PREFIX_ZKR1; break;
 
     case 0:  return mv_format_pkh(data+1, size-1, obuf, olen);
+    /* scr1 has no prefix in the table */
+    case 3:
     default: return 1;
     }
     // clang-format on
 
-    return mv_format_base58check(prefix, data + 1, size - 2, obuf, olen);
+    return mv_format_base58check_prefix(prefix, data + 1, size - 2, obuf,
+                                        olen);
 }
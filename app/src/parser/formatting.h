@@ -17,6 +17,9 @@
 #pragma once
 
 #include "compat.h"
+#ifndef ACTUALLY_ON_LEDGER
+#include "blake2b.h"
+#endif
 
 /**
  * @brief Last Michelson operation code
@@ -40,181 +43,209 @@
 const char *mv_michelson_op_name(uint8_t op_code);
 
 /**
- * @brief Enumeration of all Michelson operation code
+ * @brief Get the length of the name of a valid Michelson op_code
+ *        (`op_code <= MV_LAST_MICHELSON_OPCODE`)
+ *
+ * @param op_code: code of the michelson primitive
+ * @return size_t: length of the name of the michelson primitive
+ */
+size_t mv_michelson_op_name_length(uint8_t op_code);
+
+/**
+ * @brief List of all Michelson primitives, in the order of their
+ *        operation code
  *
  *        Should be kept in sync with the last protocol update, including
  *        order, currently defined in the `michelson_v1_primitives.ml` file
  *        in the Mavryk protocol code.
+ *
+ *        NEVER REORDER elements of this list as the index is used as a
+ *        selector by `mv_michelson_op_name`.
+ *
+ * @param X: macro applied to the name of each primitive
+ */
+// clang-format off
+#define MV_MICHELSON_PRIMITIVES(X) \
+    X(parameter)                      /* 0 */                \
+    X(storage)                        /* 1 */                \
+    X(code)                           /* 2 */                \
+    X(False)                          /* 3 */                \
+    X(Elt)                            /* 4 */                \
+    X(Left)                           /* 5 */                \
+    X(None)                           /* 6 */                \
+    X(Pair)                           /* 7 */                \
+    X(Right)                          /* 8 */                \
+    X(Some)                           /* 9 */                \
+    X(True)                           /* 10 */               \
+    X(Unit)                           /* 11 */               \
+    X(PACK)                           /* 12 */               \
+    X(UNPACK)                         /* 13 */               \
+    X(BLAKE2B)                        /* 14 */               \
+    X(SHA256)                         /* 15 */               \
+    X(SHA512)                         /* 16 */               \
+    X(ABS)                            /* 17 */               \
+    X(ADD)                            /* 18 */               \
+    X(AMOUNT)                         /* 19 */               \
+    X(AND)                            /* 20 */               \
+    X(BALANCE)                        /* 21 */               \
+    X(CAR)                            /* 22 */               \
+    X(CDR)                            /* 23 */               \
+    X(CHECK_SIGNATURE)                /* 24 */               \
+    X(COMPARE)                        /* 25 */               \
+    X(CONCAT)                         /* 26 */               \
+    X(CONS)                           /* 27 */               \
+    X(CREATE_ACCOUNT)                 /* 28 */               \
+    X(CREATE_CONTRACT)                /* 29 */               \
+    X(IMPLICIT_ACCOUNT)               /* 30 */               \
+    X(DIP)                            /* 31 */               \
+    X(DROP)                           /* 32 */               \
+    X(DUP)                            /* 33 */               \
+    X(EDIV)                           /* 34 */               \
+    X(EMPTY_MAP)                      /* 35 */               \
+    X(EMPTY_SET)                      /* 36 */               \
+    X(EQ)                             /* 37 */               \
+    X(EXEC)                           /* 38 */               \
+    X(FAILWITH)                       /* 39 */               \
+    X(GE)                             /* 40 */               \
+    X(GET)                            /* 41 */               \
+    X(GT)                             /* 42 */               \
+    X(HASH_KEY)                       /* 43 */               \
+    X(IF)                             /* 44 */               \
+    X(IF_CONS)                        /* 45 */               \
+    X(IF_LEFT)                        /* 46 */               \
+    X(IF_NONE)                        /* 47 */               \
+    X(INT)                            /* 48 */               \
+    X(LAMBDA)                         /* 49 */               \
+    X(LE)                             /* 50 */               \
+    X(LEFT)                           /* 51 */               \
+    X(LOOP)                           /* 52 */               \
+    X(LSL)                            /* 53 */               \
+    X(LSR)                            /* 54 */               \
+    X(LT)                             /* 55 */               \
+    X(MAP)                            /* 56 */               \
+    X(MEM)                            /* 57 */               \
+    X(MUL)                            /* 58 */               \
+    X(NEG)                            /* 59 */               \
+    X(NEQ)                            /* 60 */               \
+    X(NIL)                            /* 61 */               \
+    X(NONE)                           /* 62 */               \
+    X(NOT)                            /* 63 */               \
+    X(NOW)                            /* 64 */               \
+    X(OR)                             /* 65 */               \
+    X(PAIR)                           /* 66 */               \
+    X(PUSH)                           /* 67 */               \
+    X(RIGHT)                          /* 68 */               \
+    X(SIZE)                           /* 69 */               \
+    X(SOME)                           /* 70 */               \
+    X(SOURCE)                         /* 71 */               \
+    X(SENDER)                         /* 72 */               \
+    X(SELF)                           /* 73 */               \
+    X(STEPS_TO_QUOTA)                 /* 74 [DEPRECATED] */  \
+    X(SUB)                            /* 75 */               \
+    X(SWAP)                           /* 76 */               \
+    X(TRANSFER_TOKENS)                /* 77 */               \
+    X(SET_DELEGATE)                   /* 78 */               \
+    X(UNIT)                           /* 79 */               \
+    X(UPDATE)                         /* 80 */               \
+    X(XOR)                            /* 81 */               \
+    X(ITER)                           /* 82 */               \
+    X(LOOP_LEFT)                      /* 83 */               \
+    X(ADDRESS)                        /* 84 */               \
+    X(CONTRACT)                       /* 85 */               \
+    X(ISNAT)                          /* 86 */               \
+    X(CAST)                           /* 87 */               \
+    X(RENAME)                         /* 88 */               \
+    X(bool)                           /* 89 */               \
+    X(contract)                       /* 90 */               \
+    X(int)                            /* 91 */               \
+    X(key)                            /* 92 */               \
+    X(key_hash)                       /* 93 */               \
+    X(lambda)                         /* 94 */               \
+    X(list)                           /* 95 */               \
+    X(map)                            /* 96 */               \
+    X(big_map)                        /* 97 */               \
+    X(nat)                            /* 98 */               \
+    X(option)                         /* 99 */               \
+    X(or)                             /* 100 */              \
+    X(pair)                           /* 101 */              \
+    X(set)                            /* 102 */              \
+    X(signature)                      /* 103 */              \
+    X(string)                         /* 104 */              \
+    X(bytes)                          /* 105 */              \
+    X(mumav)                          /* 106 */              \
+    X(timestamp)                      /* 107 */              \
+    X(unit)                           /* 108 */              \
+    X(operation)                      /* 109 */              \
+    X(address)                        /* 110 */              \
+    X(SLICE)                          /* 111 */              \
+    X(DIG)                            /* 112 */              \
+    X(DUG)                            /* 113 */              \
+    X(EMPTY_BIG_MAP)                  /* 114 */              \
+    X(APPLY)                          /* 115 */              \
+    X(chain_id)                       /* 116 */              \
+    X(CHAIN_ID)                       /* 117 */              \
+    X(LEVEL)                          /* 118 */              \
+    X(SELF_ADDRESS)                   /* 119 */              \
+    X(never)                          /* 120 */              \
+    X(NEVER)                          /* 121 */              \
+    X(UNPAIR)                         /* 122 */              \
+    X(VOTING_POWER)                   /* 123 */              \
+    X(TOTAL_VOTING_POWER)             /* 124 */              \
+    X(KECCAK)                         /* 125 */              \
+    X(SHA3)                           /* 126 */              \
+    X(PAIRING_CHECK)                  /* 127 */              \
+    X(bls12_381_g1)                   /* 128 */              \
+    X(bls12_381_g2)                   /* 129 */              \
+    X(bls12_381_fr)                   /* 130 */              \
+    X(sapling_state)                  /* 131 */              \
+    X(sapling_transaction_deprecated) /* 132 [DEPRECATED] */ \
+    X(SAPLING_EMPTY_STATE)            /* 133 */              \
+    X(SAPLING_VERIFY_UPDATE)          /* 134 */              \
+    X(ticket)                         /* 135 */              \
+    X(TICKET_DEPRECATED)              /* 136 */              \
+    X(READ_TICKET)                    /* 137 */              \
+    X(SPLIT_TICKET)                   /* 138 */              \
+    X(JOIN_TICKETS)                   /* 139 */              \
+    X(GET_AND_UPDATE)                 /* 140 */              \
+    X(chest)                          /* 141 */              \
+    X(chest_key)                      /* 142 */              \
+    X(OPEN_CHEST)                     /* 143 */              \
+    X(VIEW)                           /* 144 */              \
+    X(view)                           /* 145 */              \
+    X(constant)                       /* 146 */              \
+    X(SUB_MUMAV)                      /* 147 */              \
+    X(tx_rollup_l2_address)           /* 148 */              \
+    X(MIN_BLOCK_TIME)                 /* 149 */              \
+    X(sapling_transaction)            /* 150 */              \
+    X(EMIT)                           /* 151 */              \
+    X(Lambda_rec)                     /* 152 */              \
+    X(LAMBDA_REC)                     /* 153 */              \
+    X(TICKET)                         /* 154 */              \
+    X(BYTES)                          /* 155 */              \
+    X(NAT)                            /* 156 */              \
+    X(Ticket)                         /* 157 */             
+
+// clang-format on
+
+/**
+ * @brief Enumeration of all Michelson operation code
  */
 typedef enum {
-    MV_MICHELSON_OP_parameter                      = 0,
-    MV_MICHELSON_OP_storage                        = 1,
-    MV_MICHELSON_OP_code                           = 2,
-    MV_MICHELSON_OP_False                          = 3,
-    MV_MICHELSON_OP_Elt                            = 4,
-    MV_MICHELSON_OP_Left                           = 5,
-    MV_MICHELSON_OP_None                           = 6,
-    MV_MICHELSON_OP_Pair                           = 7,
-    MV_MICHELSON_OP_Right                          = 8,
-    MV_MICHELSON_OP_Some                           = 9,
-    MV_MICHELSON_OP_True                           = 10,
-    MV_MICHELSON_OP_Unit                           = 11,
-    MV_MICHELSON_OP_PACK                           = 12,
-    MV_MICHELSON_OP_UNPACK                         = 13,
-    MV_MICHELSON_OP_BLAKE2B                        = 14,
-    MV_MICHELSON_OP_SHA256                         = 15,
-    MV_MICHELSON_OP_SHA512                         = 16,
-    MV_MICHELSON_OP_ABS                            = 17,
-    MV_MICHELSON_OP_ADD                            = 18,
-    MV_MICHELSON_OP_AMOUNT                         = 19,
-    MV_MICHELSON_OP_AND                            = 20,
-    MV_MICHELSON_OP_BALANCE                        = 21,
-    MV_MICHELSON_OP_CAR                            = 22,
-    MV_MICHELSON_OP_CDR                            = 23,
-    MV_MICHELSON_OP_CHECK_SIGNATURE                = 24,
-    MV_MICHELSON_OP_COMPARE                        = 25,
-    MV_MICHELSON_OP_CONCAT                         = 26,
-    MV_MICHELSON_OP_CONS                           = 27,
-    MV_MICHELSON_OP_CREATE_ACCOUNT                 = 28,
-    MV_MICHELSON_OP_CREATE_CONTRACT                = 29,
-    MV_MICHELSON_OP_IMPLICIT_ACCOUNT               = 30,
-    MV_MICHELSON_OP_DIP                            = 31,
-    MV_MICHELSON_OP_DROP                           = 32,
-    MV_MICHELSON_OP_DUP                            = 33,
-    MV_MICHELSON_OP_EDIV                           = 34,
-    MV_MICHELSON_OP_EMPTY_MAP                      = 35,
-    MV_MICHELSON_OP_EMPTY_SET                      = 36,
-    MV_MICHELSON_OP_EQ                             = 37,
-    MV_MICHELSON_OP_EXEC                           = 38,
-    MV_MICHELSON_OP_FAILWITH                       = 39,
-    MV_MICHELSON_OP_GE                             = 40,
-    MV_MICHELSON_OP_GET                            = 41,
-    MV_MICHELSON_OP_GT                             = 42,
-    MV_MICHELSON_OP_HASH_KEY                       = 43,
-    MV_MICHELSON_OP_IF                             = 44,
-    MV_MICHELSON_OP_IF_CONS                        = 45,
-    MV_MICHELSON_OP_IF_LEFT                        = 46,
-    MV_MICHELSON_OP_IF_NONE                        = 47,
-    MV_MICHELSON_OP_INT                            = 48,
-    MV_MICHELSON_OP_LAMBDA                         = 49,
-    MV_MICHELSON_OP_LE                             = 50,
-    MV_MICHELSON_OP_LEFT                           = 51,
-    MV_MICHELSON_OP_LOOP                           = 52,
-    MV_MICHELSON_OP_LSL                            = 53,
-    MV_MICHELSON_OP_LSR                            = 54,
-    MV_MICHELSON_OP_LT                             = 55,
-    MV_MICHELSON_OP_MAP                            = 56,
-    MV_MICHELSON_OP_MEM                            = 57,
-    MV_MICHELSON_OP_MUL                            = 58,
-    MV_MICHELSON_OP_NEG                            = 59,
-    MV_MICHELSON_OP_NEQ                            = 60,
-    MV_MICHELSON_OP_NIL                            = 61,
-    MV_MICHELSON_OP_NONE                           = 62,
-    MV_MICHELSON_OP_NOT                            = 63,
-    MV_MICHELSON_OP_NOW                            = 64,
-    MV_MICHELSON_OP_OR                             = 65,
-    MV_MICHELSON_OP_PAIR                           = 66,
-    MV_MICHELSON_OP_PUSH                           = 67,
-    MV_MICHELSON_OP_RIGHT                          = 68,
-    MV_MICHELSON_OP_SIZE                           = 69,
-    MV_MICHELSON_OP_SOME                           = 70,
-    MV_MICHELSON_OP_SOURCE                         = 71,
-    MV_MICHELSON_OP_SENDER                         = 72,
-    MV_MICHELSON_OP_SELF                           = 73,
-    MV_MICHELSON_OP_STEPS_TO_QUOTA                 = 74,
-    MV_MICHELSON_OP_SUB                            = 75,
-    MV_MICHELSON_OP_SWAP                           = 76,
-    MV_MICHELSON_OP_TRANSFER_TOKENS                = 77,
-    MV_MICHELSON_OP_SET_DELEGATE                   = 78,
-    MV_MICHELSON_OP_UNIT                           = 79,
-    MV_MICHELSON_OP_UPDATE                         = 80,
-    MV_MICHELSON_OP_XOR                            = 81,
-    MV_MICHELSON_OP_ITER                           = 82,
-    MV_MICHELSON_OP_LOOP_LEFT                      = 83,
-    MV_MICHELSON_OP_ADDRESS                        = 84,
-    MV_MICHELSON_OP_CONTRACT                       = 85,
-    MV_MICHELSON_OP_ISNAT                          = 86,
-    MV_MICHELSON_OP_CAST                           = 87,
-    MV_MICHELSON_OP_RENAME                         = 88,
-    MV_MICHELSON_OP_bool                           = 89,
-    MV_MICHELSON_OP_contract                       = 90,
-    MV_MICHELSON_OP_int                            = 91,
-    MV_MICHELSON_OP_key                            = 92,
-    MV_MICHELSON_OP_key_hash                       = 93,
-    MV_MICHELSON_OP_lambda                         = 94,
-    MV_MICHELSON_OP_list                           = 95,
-    MV_MICHELSON_OP_map                            = 96,
-    MV_MICHELSON_OP_big_map                        = 97,
-    MV_MICHELSON_OP_nat                            = 98,
-    MV_MICHELSON_OP_option                         = 99,
-    MV_MICHELSON_OP_or                             = 100,
-    MV_MICHELSON_OP_pair                           = 101,
-    MV_MICHELSON_OP_set                            = 102,
-    MV_MICHELSON_OP_signature                      = 103,
-    MV_MICHELSON_OP_string                         = 104,
-    MV_MICHELSON_OP_bytes                          = 105,
-    MV_MICHELSON_OP_mumav                          = 106,
-    MV_MICHELSON_OP_timestamp                      = 107,
-    MV_MICHELSON_OP_unit                           = 108,
-    MV_MICHELSON_OP_operation                      = 109,
-    MV_MICHELSON_OP_address                        = 110,
-    MV_MICHELSON_OP_SLICE                          = 111,
-    MV_MICHELSON_OP_DIG                            = 112,
-    MV_MICHELSON_OP_DUG                            = 113,
-    MV_MICHELSON_OP_EMPTY_BIG_MAP                  = 114,
-    MV_MICHELSON_OP_APPLY                          = 115,
-    MV_MICHELSON_OP_chain_id                       = 116,
-    MV_MICHELSON_OP_CHAIN_ID                       = 117,
-    MV_MICHELSON_OP_LEVEL                          = 118,
-    MV_MICHELSON_OP_SELF_ADDRESS                   = 119,
-    MV_MICHELSON_OP_never                          = 120,
-    MV_MICHELSON_OP_NEVER                          = 121,
-    MV_MICHELSON_OP_UNPAIR                         = 122,
-    MV_MICHELSON_OP_VOTING_POWER                   = 123,
-    MV_MICHELSON_OP_TOTAL_VOTING_POWER             = 124,
-    MV_MICHELSON_OP_KECCAK                         = 125,
-    MV_MICHELSON_OP_SHA3                           = 126,
-    MV_MICHELSON_OP_PAIRING_CHECK                  = 127,
-    MV_MICHELSON_OP_bls12_381_g1                   = 128,
-    MV_MICHELSON_OP_bls12_381_g2                   = 129,
-    MV_MICHELSON_OP_bls12_381_fr                   = 130,
-    MV_MICHELSON_OP_sapling_state                  = 131,
-    MV_MICHELSON_OP_sapling_transaction_deprecated = 132,
-    MV_MICHELSON_OP_SAPLING_EMPTY_STATE            = 133,
-    MV_MICHELSON_OP_SAPLING_VERIFY_UPDATE          = 134,
-    MV_MICHELSON_OP_ticket                         = 135,
-    MV_MICHELSON_OP_TICKET_DEPRECATED              = 136,
-    MV_MICHELSON_OP_READ_TICKET                    = 137,
-    MV_MICHELSON_OP_SPLIT_TICKET                   = 138,
-    MV_MICHELSON_OP_JOIN_TICKETS                   = 139,
-    MV_MICHELSON_OP_GET_AND_UPDATE                 = 140,
-    MV_MICHELSON_OP_chest                          = 141,
-    MV_MICHELSON_OP_chest_key                      = 142,
-    MV_MICHELSON_OP_OPEN_CHEST                     = 143,
-    MV_MICHELSON_OP_VIEW                           = 144,
-    MV_MICHELSON_OP_view                           = 145,
-    MV_MICHELSON_OP_constant                       = 146,
-    MV_MICHELSON_OP_SUB_MUMAV                      = 147,
-    MV_MICHELSON_OP_tx_rollup_l2_address           = 148,
-    MV_MICHELSON_OP_MIN_BLOCK_TIME                 = 149,
-    MV_MICHELSON_OP_sapling_transaction            = 150,
-    MV_MICHELSON_OP_EMIT                           = 151,
-    MV_MICHELSON_OP_Lambda_rec                     = 152,
-    MV_MICHELSON_OP_LAMBDA_REC                     = 153,
-    MV_MICHELSON_OP_TICKET                         = 154,
-    MV_MICHELSON_OP_BYTES                          = 155,
-    MV_MICHELSON_OP_NAT                            = 156,
-    MV_MICHELSON_OP_Ticket                         = 157
+#define MV_MICHELSON_OPCODE(name) MV_MICHELSON_OP_##name,
+    MV_MICHELSON_PRIMITIVES(MV_MICHELSON_OPCODE)
+#undef MV_MICHELSON_OPCODE
 } mv_michelson_opcode;
 
-#define MV_DECIMAL_BUFFER_SIZE(_l) ((((_l)*241) / 100) + 1)
+/// Digits and null terminator
+#define MV_DECIMAL_BUFFER_SIZE(_l) ((((_l)*241) / 100) + 2)
 
 /**
  * @brief Formats a positive number of arbitrary to decimal.
  *
  *        The number is stored in little-endian order in the first `l`
  *        bytes of `n`. The output buffer `obuf` must be at least
- *        `MV_DECIMAL_BUFFER_SIZE(l)` (caller responsibility).
+ *        `MV_DECIMAL_BUFFER_SIZE(l)` (caller responsibility). Inputs
+ *        longer than 74 bytes are rejected.
  *
  * @param n: input number
  * @param l: length of the input number
@@ -224,6 +255,90 @@ typedef enum {
  */
 int mv_format_decimal(const uint8_t *n, size_t l, char *obuf, size_t olen);
 
+#define MV_DEC_LIMB_BASE   1000000000  /// 10^9
+#define MV_DEC_LIMB_DIGITS 9
+
+/**
+ * @brief Formats a positive number given in limbs of base
+ *        `MV_DEC_LIMB_BASE` to decimal.
+ *
+ * @param limbs: input limbs, least significant first
+ * @param used: number of limbs
+ * @param obuf: output buffer
+ * @param olen: length of the output buffer
+ * @return int: 0 on success
+ */
+int mv_format_decimal_limbs(const uint32_t *limbs, size_t used, char *obuf,
+                            size_t olen);
+
+/// Digits of the largest amount, decimal point and null terminator
+#define MV_MUMAV_BUFFER_SIZE 22
+
+/**
+ * @brief Formats an amount of mumav in MVRK, without currency
+ *
+ *        The decimal part is written only if not 0, without its
+ *        trailing zeros, e.g. "0.5" for 500000 mumav.
+ *
+ * @param amount: amount in mumav
+ * @param obuf: output buffer
+ * @param olen: length of the output buffer
+ * @return int: 0 on success
+ */
+int mv_format_mumav(uint64_t amount, char *obuf, size_t olen);
+
+/**
+ * @brief Formats bytes in hexadecimal, two digits per byte, without
+ *        null terminator
+ *
+ *        Only the first bytes whose two digits fit in the output are
+ *        formatted, to split a byte across outputs only at their end.
+ *
+ * @param ibuf: input bytes
+ * @param ilen: number of input bytes
+ * @param obuf: output buffer
+ * @param olen: length of the output buffer
+ * @param lower: whether the letters are lowercase or uppercase
+ * @return size_t: number of bytes formatted
+ */
+size_t mv_format_hex(const uint8_t *ibuf, size_t ilen, char *obuf,
+                     size_t olen, bool lower);
+
+#define MV_DIGEST_SIZE 32  /// Size of the BLAKE2b digests of the values
+
+#ifdef ACTUALLY_ON_LEDGER
+typedef cx_blake2b_t mv_digest_ctx;
+#else
+typedef mv_blake2b_state mv_digest_ctx;
+#endif
+
+/**
+ * @brief Start the BLAKE2b digest of a value, of `MV_DIGEST_SIZE` bytes
+ *
+ * @param ctx: digest context
+ * @return int: 0 on success
+ */
+int mv_digest_init(mv_digest_ctx *ctx);
+
+/**
+ * @brief Add a part of the value to its digest
+ *
+ * @param ctx: digest context
+ * @param data: part of the value
+ * @param len: length of the part
+ * @return int: 0 on success
+ */
+int mv_digest_update(mv_digest_ctx *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Write the digest of the value
+ *
+ * @param ctx: digest context
+ * @param out: output buffer of `MV_DIGEST_SIZE` bytes
+ * @return int: 0 on success
+ */
+int mv_digest_final(mv_digest_ctx *ctx, uint8_t *out);
+
 #define MV_BASE58_BUFFER_SIZE(_l) ((((_l)*138) / 100) + 1)
 
 /**
@@ -231,7 +346,8 @@ int mv_format_decimal(const uint8_t *n, size_t l, char *obuf, size_t olen);
  *        alphabet order (same as Bitcoin).
  *
  *        The output buffer `obuf` must be at least
- *        `BASE58_BUFFER_SIZE(l)` (caller responsibility).
+ *        `BASE58_BUFFER_SIZE(l)` (caller responsibility). Inputs
+ *        longer than 72 bytes are rejected.
  *
  * @param n: input data
  * @param l: length of the input data
@@ -244,6 +360,65 @@ int mv_format_base58(const uint8_t *n, size_t l, char *obuf, size_t olen);
 #define MV_BASE58CHECK_BUFFER_SIZE(_l, _p) \
     MV_BASE58_BUFFER_SIZE(((_p) + (_l)) + 4)
 
+/**
+ * @brief Enumeration of the base58check prefixes
+ *
+ *        NEVER REORDER the public key hashes and the public keys as
+ *        their Mavryk binary tag is used as an offset.
+ */
+typedef enum {
+    /* Hashes */
+    MV_B58_PREFIX_B = 0,
+    MV_B58_PREFIX_O,
+    MV_B58_PREFIX_EXPR,
+    MV_B58_PREFIX_PROTO,
+    /* Public key hashes, in the order of their tag */
+    MV_B58_PREFIX_MV1,
+    MV_B58_PREFIX_MV2,
+    MV_B58_PREFIX_MV3,
+    MV_B58_PREFIX_MV4,
+    /* Public keys, in the order of their tag */
+    MV_B58_PREFIX_EDPK,
+    MV_B58_PREFIX_SPPK,
+    MV_B58_PREFIX_P2PK,
+    MV_B58_PREFIX_BLPK,
+    /* Addresses */
+    MV_B58_PREFIX_KT1,
+    MV_B58_PREFIX_TXR1,
+    MV_B58_PREFIX_ZKR1,
+    /* Smart rollup hashes */
+    MV_B58_PREFIX_SR1,
+    /* Smart rollup commitment hashes */
+    MV_B58_PREFIX_SRC1,
+    MV_B58_PREFIX_COUNT  /// number of prefixes, not a prefix
+} mv_base58check_prefix;
+
+/**
+ * @brief Formats a data in base58check using a prefix of the table
+ *
+ *        Same as `mv_format_base58check`, without looking the prefix
+ *        up by name.
+ *
+ * @param prefix: base58 prefix
+ * @param ibuf: input buffer
+ * @param ilen: length of the input buffer
+ * @param obuf: output buffer, or NULL to only check the input
+ * @param olen: length of the output buffer
+ * @return int: 0 on success
+ */
+int mv_format_base58check_prefix(mv_base58check_prefix prefix,
+                                 const uint8_t *ibuf, size_t ilen,
+                                 char *obuf, size_t olen);
+
+/**
+ * @brief Forget the address hashes formatted so far
+ *
+ *        The base58check formats of the last 20-bytes hashes are
+ *        memoized, so that the addresses repeated in a batch are
+ *        hashed and encoded once.
+ */
+void mv_format_base58check_reset_memo(void);
+
 /**
  * @brief Looks up the prefix from the provided string (arg1),
  *        e.g. "B", "o", "expr", "mv2", etc.
@@ -255,12 +430,13 @@ int mv_format_base58(const uint8_t *n, size_t l, char *obuf, size_t olen);
  *        double-sha256 of this concatenation, and call
  *        `format_base58`. The output buffer `obuf` must be at least
  *        `MV_BASE58CHECK_BUFFER_SIZE(l, prefix_len)` (caller
- *        responsibility).
+ *        responsibility). If `obuf` is NULL, the prefix and the
+ *        length are only checked: nothing is hashed nor formatted.
  *
  * @param prefix: base58 prefix
  * @param ibuf: input buffer
  * @param ilen: length of the input buffer
- * @param obuf: output buffer
+ * @param obuf: output buffer, or NULL to only check the input
  * @param olen: length of the output buffer
  * @return int: 0 on success
  */
@@ -273,6 +449,8 @@ int mv_format_base58check(const char *prefix, const uint8_t *ibuf,
  * the type (e.g. the curve for keys), check the length, and feed the
  * appropriate prefix to `format_base58check`. These function need to
  * be updated when new formats are added via a Mavryk protocol upgrade.
+ * As `format_base58check`, they only check the input if `obuf` is
+ * NULL.
  */
 
 /**
@@ -303,7 +481,8 @@ int mv_format_pkh(const uint8_t *ibuf, size_t ilen, char *obuf, size_t olen);
  * @param olen: length of the output buffer
  * @return int: 0 on success
  *
- * @deprecated Use mv_format_base58check("o", ...) instead
+ * @deprecated Use mv_format_base58check_prefix(MV_B58_PREFIX_O, ...)
+ *             instead
  */
 int mv_format_oph(const uint8_t *ibuf, size_t ilen, char *obuf, size_t olen);
 
@@ -318,7 +497,8 @@ int mv_format_oph(const uint8_t *ibuf, size_t ilen, char *obuf, size_t olen);
  * @param olen: length of the output buffer
  * @return int: 0 on success
  *
- * @deprecated Use mv_format_base58check("B", ...) instead
+ * @deprecated Use mv_format_base58check_prefix(MV_B58_PREFIX_B, ...)
+ *             instead
  */
 int mv_format_bh(const uint8_t *ibuf, size_t ilen, char *obuf, size_t olen);
 
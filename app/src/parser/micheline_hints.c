@@ -0,0 +1,503 @@
+/* Mavryk Embedded C parser for Ledger - Micheline hints
+
+   Copyright 2023 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <string.h>
+
+#include "micheline_hints.h"
+
+/**
+ * @brief Enumeration of the instructions of the hints
+ *
+ *        A hint is the pattern of a value, in prefix order: each
+ *        instruction reads the head of a node, its arguments are read
+ *        by the next ones.
+ */
+typedef enum {
+    MV_HINT_END,      /// the whole value has been read
+    MV_HINT_PAIR,     /// `Pair`, without annotations
+    MV_HINT_OR,       /// `Left` or `Right`, without annotations, is a
+                      /// leaf named `name`, of value `name + 1` or
+                      /// `name + 2`
+    MV_HINT_SEQ,      /// non-empty sequence, of elements read by the
+                      /// instructions up to the next MV_HINT_END_SEQ
+    MV_HINT_END_SEQ,  /// end of the element of a sequence
+    MV_HINT_ADDRESS,  /// address, in bytes or as a string
+    MV_HINT_NAT,      /// natural number
+    MV_HINT_ELT,      /// `Elt`, without annotations
+    MV_HINT_DATA      /// string or bytes
+} mv_hint_insn_kind;
+
+/**
+ * @brief This struct represents an instruction of a hint
+ */
+typedef struct {
+    uint8_t kind;  /// kind, see `mv_hint_insn_kind`
+    uint8_t name;  /// index in `hint_names` of the name of the leaf
+} mv_hint_insn;
+
+/**
+ * @brief This struct represents the hint of an entrypoint
+ */
+typedef struct {
+    const char         *entrypoint;  /// name of the entrypoint, NULL for
+                                     /// packed data
+    const mv_hint_insn *insns;       /// pattern of the parameter
+} mv_hint;
+
+// clang-format off
+
+/**
+ * @brief Names of the leaves, see `mv_hint_insn`
+ */
+enum {
+    NAME_SENDER,
+    NAME_RECIPIENT,
+    NAME_AMOUNT,
+    NAME_TOKEN_ID,
+    NAME_OWNER,
+    NAME_OPERATOR,
+    NAME_UPDATE,
+    NAME_ADD,
+    NAME_REMOVE,
+    NAME_VALUE,
+    NAME_FIRST,
+    NAME_SECOND,
+    NAME_KEY
+};
+
+static const char *const hint_names[] = {
+    [NAME_SENDER]    = "Sender",
+    [NAME_RECIPIENT] = "Recipient",
+    [NAME_AMOUNT]    = "Token amount",
+    [NAME_TOKEN_ID]  = "Token ID",
+    [NAME_OWNER]     = "Owner",
+    [NAME_OPERATOR]  = "Operator",
+    [NAME_UPDATE]    = "Operator update",
+    [NAME_ADD]       = "Add",
+    [NAME_REMOVE]    = "Remove",
+    [NAME_VALUE]     = "Value",
+    [NAME_FIRST]     = "First",
+    [NAME_SECOND]    = "Second",
+    [NAME_KEY]       = "Key"
+};
+
+/// FA1.2: pair (address :from) (pair (address :to) (nat :value))
+static const mv_hint_insn fa12_transfer[] = {
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_ADDRESS, NAME_SENDER},
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_ADDRESS, NAME_RECIPIENT},
+    {MV_HINT_NAT,     NAME_AMOUNT},
+    {MV_HINT_END,     0}
+};
+
+/// FA2: list (pair (address :from_)
+///                 (list :txs (pair (address :to_)
+///                                  (pair (nat :token_id) (nat :amount)))))
+static const mv_hint_insn fa2_transfer[] = {
+    {MV_HINT_SEQ,     0},
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_ADDRESS, NAME_SENDER},
+    {MV_HINT_SEQ,     0},
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_ADDRESS, NAME_RECIPIENT},
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_NAT,     NAME_TOKEN_ID},
+    {MV_HINT_NAT,     NAME_AMOUNT},
+    {MV_HINT_END_SEQ, 0},
+    {MV_HINT_END_SEQ, 0},
+    {MV_HINT_END,     0}
+};
+
+/// FA2: list (or (pair %add_operator (address :owner)
+///                   (pair (address :operator) (nat :token_id)))
+///               (pair %remove_operator ...))
+static const mv_hint_insn fa2_update_operators[] = {
+    {MV_HINT_SEQ,     0},
+    {MV_HINT_OR,      NAME_UPDATE},
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_ADDRESS, NAME_OWNER},
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_ADDRESS, NAME_OPERATOR},
+    {MV_HINT_NAT,     NAME_TOKEN_ID},
+    {MV_HINT_END_SEQ, 0},
+    {MV_HINT_END,     0}
+};
+
+/// Packed data: Pair value value
+static const mv_hint_insn packed_pair[] = {
+    {MV_HINT_PAIR,    0},
+    {MV_HINT_DATA,    NAME_FIRST},
+    {MV_HINT_DATA,    NAME_SECOND},
+    {MV_HINT_END,     0}
+};
+
+/// Packed data: { Elt value value ; ... }
+static const mv_hint_insn packed_map[] = {
+    {MV_HINT_SEQ,     0},
+    {MV_HINT_ELT,     0},
+    {MV_HINT_DATA,    NAME_KEY},
+    {MV_HINT_DATA,    NAME_VALUE},
+    {MV_HINT_END_SEQ, 0},
+    {MV_HINT_END,     0}
+};
+
+/// Hints, those of a same entrypoint are contiguous
+static const mv_hint hints[] = {
+    {"transfer",         fa12_transfer       },
+    {"transfer",         fa2_transfer        },
+    {"update_operators", fa2_update_operators},
+    {NULL,               packed_pair         },
+    {NULL,               packed_map          }
+};
+
+// clang-format on
+
+#define NB_HINTS (sizeof(hints) / sizeof(hints[0]))
+
+/// Address strings are base58check encoded, without entrypoint
+#define MAX_ADDRESS_STRING_LEN 36
+
+/// Longest zarith number that fits in the number parser
+#define MAX_NAT_LEN (MV_NUM_BUFFER_SIZE / 7)
+
+/// Longest string that fits in the capture buffer, between quotes
+#define MAX_TEXT_LEN (MV_CAPTURE_BUFFER_SIZE - 3)
+
+/// Longest bytes that fit in the capture buffer, in hexadecimal
+#define MAX_BYTES_LEN ((MV_CAPTURE_BUFFER_SIZE - 3) / 2)
+
+/**
+ * @brief Read the 4-bytes size of a node
+ *
+ * @param bytes: size, big endian
+ * @return size_t: size
+ */
+static size_t
+read_size(const uint8_t *bytes)
+{
+    return ((size_t)bytes[0] << 24) | ((size_t)bytes[1] << 16)
+           | ((size_t)bytes[2] << 8) | (size_t)bytes[3];
+}
+
+/**
+ * @brief Check if a character is in the base58 alphabet
+ *
+ * @param c: character
+ * @return bool: result
+ */
+static bool
+is_base58(uint8_t c)
+{
+    return ((c >= '1') && (c <= '9')) || ((c >= 'A') && (c <= 'Z')
+                                          && (c != 'I') && (c != 'O'))
+           || ((c >= 'a') && (c <= 'z') && (c != 'l'));
+}
+
+/**
+ * @brief Check if a hint matches an entrypoint
+ *
+ * @param i: index of the hint
+ * @param entrypoint: name of the entrypoint, NULL for packed data
+ * @return bool: result
+ */
+static bool
+is_hint_of(uint8_t i, const char *entrypoint)
+{
+    const char *name = (const char *)PIC(hints[i].entrypoint);
+
+    if ((entrypoint == NULL) || (name == NULL)) {
+        return entrypoint == name;
+    }
+    return strcmp(entrypoint, name) == 0;
+}
+
+/**
+ * @brief Check if the characters of a string node can be displayed as
+ *        is between quotes, without quotes nor backslashes
+ *
+ * @param chars: characters
+ * @param len: number of characters
+ * @return bool: result
+ */
+static bool
+is_plain_text(const uint8_t *chars, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if ((chars[i] < 0x20) || (chars[i] >= 0x7F) || (chars[i] == '\"')
+            || (chars[i] == '\\')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Read an address node
+ *
+ * @param value: node
+ * @param rem: number of bytes up to the end of the value
+ * @param leaf: output leaf, with offsets relative to `value`
+ * @return size_t: size of the node, 0 if it is not an address
+ */
+static size_t
+read_address(const uint8_t *value, size_t rem, mv_micheline_hint_leaf *leaf)
+{
+    size_t size;
+    size_t i;
+
+    if (rem < 5) {
+        return 0;
+    }
+    size = read_size(value + 1);
+    if (size > rem - 5) {
+        return 0;
+    }
+    switch (value[0]) {
+    case MV_MICHELINE_TAG_BYTES:
+        if ((size != 22) || mv_format_address(value + 5, 22, NULL, 0)) {
+            return 0;
+        }
+        leaf->kind = MV_MICHELINE_HINT_LEAF_ADDRESS;
+        break;
+    case MV_MICHELINE_TAG_STRING:
+        if ((size == 0) || (size > MAX_ADDRESS_STRING_LEN)) {
+            return 0;
+        }
+        for (i = 0; i < size; i++) {
+            if (!is_base58(value[5 + i])) {
+                return 0;
+            }
+        }
+        leaf->kind = MV_MICHELINE_HINT_LEAF_STRING;
+        break;
+    default:
+        return 0;
+    }
+    leaf->ofs = 5;
+    leaf->len = (uint16_t)size;
+    return 5 + size;
+}
+
+/**
+ * @brief Read a natural number node
+ *
+ * @param value: node
+ * @param rem: number of bytes up to the end of the value
+ * @param leaf: output leaf, with offsets relative to `value`
+ * @return size_t: size of the node, 0 if it is not a natural number
+ */
+static size_t
+read_nat(const uint8_t *value, size_t rem, mv_micheline_hint_leaf *leaf)
+{
+    size_t len = 1;
+
+    if ((rem < 2) || (value[0] != MV_MICHELINE_TAG_INT)
+        || (value[1] & 0x40)) {
+        return 0;
+    }
+    while (value[len] & 0x80) {
+        len++;
+        if ((len >= rem) || (len > MAX_NAT_LEN)) {
+            return 0;
+        }
+    }
+    leaf->kind = MV_MICHELINE_HINT_LEAF_NAT;
+    leaf->ofs  = 1;
+    leaf->len  = (uint16_t)len;
+    return 1 + len;
+}
+
+/**
+ * @brief Read a string or bytes node
+ *
+ * @param value: node
+ * @param rem: number of bytes up to the end of the value
+ * @param leaf: output leaf, with offsets relative to `value`
+ * @return size_t: size of the node, 0 if it is not a string nor bytes
+ *         that can be displayed
+ */
+static size_t
+read_data(const uint8_t *value, size_t rem, mv_micheline_hint_leaf *leaf)
+{
+    size_t size;
+
+    if (rem < 5) {
+        return 0;
+    }
+    size = read_size(value + 1);
+    if (size > rem - 5) {
+        return 0;
+    }
+    switch (value[0]) {
+    case MV_MICHELINE_TAG_STRING:
+        if ((size > MAX_TEXT_LEN) || !is_plain_text(value + 5, size)) {
+            return 0;
+        }
+        leaf->kind = MV_MICHELINE_HINT_LEAF_TEXT;
+        break;
+    case MV_MICHELINE_TAG_BYTES:
+        if (size > MAX_BYTES_LEN) {
+            return 0;
+        }
+        leaf->kind = MV_MICHELINE_HINT_LEAF_BYTES;
+        break;
+    default:
+        return 0;
+    }
+    leaf->ofs = 5;
+    leaf->len = (uint16_t)size;
+    return 5 + size;
+}
+
+bool
+mv_micheline_hint_lookup(const char               *entrypoint,
+                         mv_micheline_hint_cursor *cursor)
+{
+    uint8_t i;
+
+    for (i = 0; i < NB_HINTS; i++) {
+        if (is_hint_of(i, entrypoint)) {
+            memset(cursor, 0, sizeof(*cursor));
+            cursor->hint = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+mv_micheline_hint_match(mv_micheline_hint_cursor *cursor,
+                        const uint8_t *value, size_t len)
+{
+    const char            *entrypoint = PIC(hints[cursor->hint].entrypoint);
+    mv_micheline_hint_leaf leaf;
+    mv_parser_result       res;
+    uint8_t                i;
+
+    for (i = cursor->hint; (i < NB_HINTS) && is_hint_of(i, entrypoint);
+         i++) {
+        memset(cursor, 0, sizeof(*cursor));
+        cursor->hint = i;
+        do {
+            res = mv_micheline_hint_next(cursor, value, len, &leaf);
+        } while (res == MV_CONTINUE);
+        if (res == MV_BLO_DONE) {
+            memset(cursor, 0, sizeof(*cursor));
+            cursor->hint = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+mv_parser_result
+mv_micheline_hint_next(mv_micheline_hint_cursor *cursor,
+                       const uint8_t *value, size_t len,
+                       mv_micheline_hint_leaf *leaf)
+{
+    const mv_hint_insn *insns = PIC(hints[cursor->hint].insns);
+
+    while (true) {
+        const mv_hint_insn *insn = &insns[cursor->pc++];
+        const uint8_t      *node = value + cursor->ofs;
+        size_t              rem  = len - cursor->ofs;
+        size_t              size;
+        uint8_t             prim;
+
+        leaf->name = PIC(hint_names[insn->name]);
+        switch (insn->kind) {
+        case MV_HINT_END:
+            if ((rem != 0) || (cursor->depth != 0)) {
+                return MV_ERR_INVALID_DATA;
+            }
+            cursor->pc--;
+            return MV_BLO_DONE;
+        case MV_HINT_PAIR:
+        case MV_HINT_ELT:
+            prim = (insn->kind == MV_HINT_PAIR) ? MV_MICHELSON_OP_Pair
+                                                : MV_MICHELSON_OP_Elt;
+            if ((rem < 2) || (node[0] != MV_MICHELINE_TAG_PRIM_2_NOANNOTS)
+                || (node[1] != prim)) {
+                return MV_ERR_INVALID_DATA;
+            }
+            cursor->ofs += 2;
+            break;
+        case MV_HINT_OR:
+            if ((rem < 2) || (node[0] != MV_MICHELINE_TAG_PRIM_1_NOANNOTS)
+                || ((node[1] != MV_MICHELSON_OP_Left)
+                    && (node[1] != MV_MICHELSON_OP_Right))) {
+                return MV_ERR_INVALID_DATA;
+            }
+            leaf->kind  = MV_MICHELINE_HINT_LEAF_CONSTANT;
+            leaf->value = PIC(hint_names[insn->name
+                                         + ((node[1] == MV_MICHELSON_OP_Left)
+                                                ? 1
+                                                : 2)]);
+            leaf->ofs   = cursor->ofs;
+            leaf->len   = 2;
+            cursor->ofs += 2;
+            return MV_CONTINUE;
+        case MV_HINT_SEQ:
+            if ((rem < 5) || (node[0] != MV_MICHELINE_TAG_SEQ)
+                || (cursor->depth >= MV_MICHELINE_HINT_DEPTH)) {
+                return MV_ERR_INVALID_DATA;
+            }
+            size = read_size(node + 1);
+            if ((size == 0) || (size > rem - 5)) {
+                return MV_ERR_INVALID_DATA;
+            }
+            cursor->seq[cursor->depth].pc = cursor->pc;
+            cursor->seq[cursor->depth].stop
+                = (uint16_t)(cursor->ofs + 5 + size);
+            cursor->depth++;
+            cursor->ofs += 5;
+            break;
+        case MV_HINT_END_SEQ: {
+            uint16_t stop = cursor->seq[cursor->depth - 1].stop;
+
+            if (cursor->ofs > stop) {
+                return MV_ERR_INVALID_DATA;
+            }
+            if (cursor->ofs < stop) {
+                cursor->pc = cursor->seq[cursor->depth - 1].pc;
+            } else {
+                cursor->depth--;
+            }
+            break;
+        }
+        case MV_HINT_ADDRESS:
+            size = read_address(node, rem, leaf);
+            goto common_leaf;
+        case MV_HINT_DATA:
+            size = read_data(node, rem, leaf);
+            goto common_leaf;
+        case MV_HINT_NAT:
+            size = read_nat(node, rem, leaf);
+        common_leaf:
+            if (size == 0) {
+                return MV_ERR_INVALID_DATA;
+            }
+            leaf->ofs += cursor->ofs;
+            cursor->ofs += (uint16_t)size;
+            return MV_CONTINUE;
+        default:
+            return MV_ERR_INVALID_STATE;
+        }
+    }
+}
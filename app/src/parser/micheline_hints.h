@@ -0,0 +1,95 @@
+/* Mavryk Embedded C parser for Ledger - Micheline hints
+
+   Copyright 2023 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* A Micheline hint is the shape of the parameter of a well-known
+ * entrypoint, such as the FA1.2 `transfer` or the FA2 `transfer` and
+ * `update_operators`. A parameter matching the shape of a hint of its
+ * entrypoint is displayed as the sequence of its leaves (addresses,
+ * numbers, ...), each one as a field, instead of as a Micheline
+ * expression.
+ *
+ * The common shapes of packed data (0x05), such as the pairs and maps
+ * of strings or bytes of permits and logins, have hints too, as if
+ * they were the parameter of the entrypoint NULL. */
+
+#pragma once
+
+#include "parser_state.h"
+
+/**
+ * @brief Enumeration of the kinds of leaves of a Micheline hint
+ */
+typedef enum {
+    MV_MICHELINE_HINT_LEAF_ADDRESS,   /// 22-bytes address
+    MV_MICHELINE_HINT_LEAF_STRING,    /// address written as a string
+    MV_MICHELINE_HINT_LEAF_NAT,       /// natural number, zarith encoded
+    MV_MICHELINE_HINT_LEAF_CONSTANT,  /// constructor, displayed as `value`
+    MV_MICHELINE_HINT_LEAF_TEXT,      /// string, displayed between quotes
+    MV_MICHELINE_HINT_LEAF_BYTES      /// bytes, displayed in hexadecimal
+} mv_micheline_hint_leaf_kind;
+
+/**
+ * @brief This struct represents a leaf of a value decoded with a
+ *        Micheline hint
+ */
+typedef struct {
+    mv_micheline_hint_leaf_kind kind;   /// kind
+    const char                 *name;   /// name of the field
+    const char                 *value;  /// MV_MICHELINE_HINT_LEAF_CONSTANT
+    uint16_t                    ofs;    /// offset of the bytes of the
+                                        /// leaf in the value
+    uint16_t                    len;    /// number of bytes of the leaf
+} mv_micheline_hint_leaf;
+
+/**
+ * @brief Find the first hint of an entrypoint
+ *
+ * @param entrypoint: name of the entrypoint, NULL for packed data
+ * @param cursor: output cursor, at the start of the hint
+ * @return bool: false if the entrypoint has no hint
+ */
+bool mv_micheline_hint_lookup(const char               *entrypoint,
+                              mv_micheline_hint_cursor *cursor);
+
+/**
+ * @brief Find the hint of the entrypoint of a cursor matching a value
+ *
+ *        The hints of the entrypoint are tried in turn, from the one
+ *        of `cursor`.
+ *
+ * @param cursor: cursor from `mv_micheline_hint_lookup`, updated to the
+ *                start of the matching hint
+ * @param value: binary Micheline value
+ * @param len: length of the value
+ * @return bool: false if no hint matches the whole value
+ */
+bool mv_micheline_hint_match(mv_micheline_hint_cursor *cursor,
+                             const uint8_t *value, size_t len);
+
+/**
+ * @brief Decode the next leaf of a value
+ *
+ * @param cursor: cursor, updated
+ * @param value: binary Micheline value
+ * @param len: length of the value
+ * @param leaf: output leaf
+ * @return mv_parser_result: MV_CONTINUE with a leaf, MV_BLO_DONE at
+ *         the end of the value, MV_ERR_INVALID_DATA if the value does
+ *         not match the hint
+ */
+mv_parser_result mv_micheline_hint_next(mv_micheline_hint_cursor *cursor,
+                                        const uint8_t *value, size_t len,
+                                        mv_micheline_hint_leaf *leaf);
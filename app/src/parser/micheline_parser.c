@@ -31,6 +31,7 @@ static mv_parser_result begin_sized(mv_parser_state *state);
 static mv_parser_result print_escaped(mv_parser_state *state, uint8_t b);
 static mv_parser_result parser_put(mv_parser_state *state, char c);
 static mv_parser_result tag_selection(mv_parser_state *state, uint8_t t);
+static mv_parser_result step(mv_parser_state *state);
 
 #ifdef MAVRYK_DEBUG
 const char *const mv_micheline_parser_step_name[]
@@ -40,6 +41,10 @@ const char *const mv_micheline_parser_step_name[]
 
 const char hex_c[] = "0123456789ABCDEF";
 
+/// Whether a string character can be printed without escaping
+#define IS_PRINTABLE(b) \
+    (((b) >= 0x20) && ((b) < 0x80) && ((b) != '\"') && ((b) != '\\'))
+
 void
 mv_micheline_parser_init(mv_parser_state *state)
 {
@@ -48,6 +53,7 @@ mv_micheline_parser_init(mv_parser_state *state)
     m->frame         = m->stack;
     m->stack[0].step = MV_MICHELINE_STEP_TAG;
     m->is_unit       = false;
+    MV_RECORD_DEPTH(state, micheline);
 }
 
 /**
@@ -67,6 +73,7 @@ push_frame(mv_parser_state *state, mv_micheline_parser_step_kind step)
     }
     m->frame++;
     m->frame->step = step;
+    MV_RECORD_DEPTH(state, micheline);
     mv_continue;
 }
 
@@ -103,13 +110,16 @@ begin_sized(mv_parser_state *state)
     if (push_frame(state, MV_MICHELINE_STEP_SIZE)) {
         mv_reraise;
     }
-    m->frame->step_size.size = 0;
-    m->frame->stop           = state->ofs + 4;
+    m->regs.size   = 0;
+    m->frame->stop = state->ofs + 4;
     mv_continue;
 }
 
 /**
- * @brief Ask to print an escape character
+ * @brief Print an escape character
+ *
+ *        The escape sequence is written at once if the output has room
+ *        for it, and only resumed from the capture buffer otherwise.
  *
  * @param state: parser state
  * @param b: escape character
@@ -118,9 +128,8 @@ begin_sized(mv_parser_state *state)
 static mv_parser_result
 print_escaped(mv_parser_state *state, uint8_t b)
 {
-    char *buf = (char *)state->buffers.capture;
-    mv_must(push_frame(state, MV_MICHELINE_STEP_PRINT_CAPTURE));
-    state->micheline.frame->step_capture.ofs = 0;
+    char  *buf = (char *)state->buffers.capture;
+    size_t written;
     // clang-format off
     switch (b) {
     case '\\': strncpy(buf,"\\\\",MV_CAPTURE_BUFFER_SIZE); break;
@@ -136,6 +145,11 @@ print_escaped(mv_parser_state *state, uint8_t b)
         break;
     }
     // clang-format on
+    if (strlen(buf) <= state->regs.olen) {
+        return mv_parser_put_str(state, buf, &written);
+    }
+    mv_must(push_frame(state, MV_MICHELINE_STEP_PRINT_CAPTURE));
+    state->micheline.regs.capture_ofs = 0;
     mv_continue;
 }
 
@@ -153,6 +167,34 @@ parser_put(mv_parser_state *state, char c)
     return mv_parser_put(state, c);
 }
 
+/**
+ * @brief Transition of a micheline tag: the step reading its value
+ *        and, for a prim, the shape of its application
+ */
+typedef struct {
+    uint8_t step : 4;   /// mv_micheline_parser_step_kind
+    uint8_t nargs : 2;  /// number of arguments, 3 for a sized list
+    uint8_t annot : 1;  /// if need to read an annotation
+} mv_micheline_tag_transition;
+
+// clang-format off
+static const mv_micheline_tag_transition tag_transitions[] = {
+    [MV_MICHELINE_TAG_INT]             = {MV_MICHELINE_STEP_INT,     0, 0},
+    [MV_MICHELINE_TAG_STRING]          = {MV_MICHELINE_STEP_STRING,  0, 0},
+    [MV_MICHELINE_TAG_SEQ]             = {MV_MICHELINE_STEP_SEQ,     0, 0},
+    [MV_MICHELINE_TAG_PRIM_0_NOANNOTS] = {MV_MICHELINE_STEP_PRIM_OP, 0, 0},
+    [MV_MICHELINE_TAG_PRIM_0_ANNOTS]   = {MV_MICHELINE_STEP_PRIM_OP, 0, 1},
+    [MV_MICHELINE_TAG_PRIM_1_NOANNOTS] = {MV_MICHELINE_STEP_PRIM_OP, 1, 0},
+    [MV_MICHELINE_TAG_PRIM_1_ANNOTS]   = {MV_MICHELINE_STEP_PRIM_OP, 1, 1},
+    [MV_MICHELINE_TAG_PRIM_2_NOANNOTS] = {MV_MICHELINE_STEP_PRIM_OP, 2, 0},
+    [MV_MICHELINE_TAG_PRIM_2_ANNOTS]   = {MV_MICHELINE_STEP_PRIM_OP, 2, 1},
+    [MV_MICHELINE_TAG_PRIM_N]          = {MV_MICHELINE_STEP_PRIM_OP, 3, 1},
+    [MV_MICHELINE_TAG_BYTES]           = {MV_MICHELINE_STEP_BYTES,   0, 0},
+};
+// clang-format on
+
+#define NB_TAGS (sizeof(tag_transitions) / sizeof(tag_transitions[0]))
+
 /**
  * @brief Plan the steps required to read the micheline value
  *        associated to the micheline tag
@@ -164,63 +206,45 @@ parser_put(mv_parser_state *state, char c)
 static mv_parser_result
 tag_selection(mv_parser_state *state, uint8_t t)
 {
-    mv_micheline_state *m = &state->micheline;
-    uint8_t             nargs;
-    uint8_t             annot;
-    uint8_t             wrap;
-
-    switch (t) {
-    case MV_MICHELINE_TAG_INT:
-        m->frame->step = MV_MICHELINE_STEP_INT;
-        mv_parse_num_state_init(&state->buffers.num, &m->frame->step_int);
+    mv_micheline_state                *m = &state->micheline;
+    const mv_micheline_tag_transition *tr;
+
+    if (t >= NB_TAGS) {
+        mv_raise(INVALID_TAG);
+    }
+    tr             = &tag_transitions[t];
+    m->frame->step = tr->step;
+
+    switch (tr->step) {
+    case MV_MICHELINE_STEP_INT:
+        mv_parse_num_state_init(&state->buffers.num, &m->regs.num);
         for (int i = 0; i < (MV_NUM_BUFFER_SIZE / 8); i++) {
             state->buffers.num.bytes[i] = 0;
         }
         break;
-    case MV_MICHELINE_TAG_SEQ:
-        m->frame->step           = MV_MICHELINE_STEP_SEQ;
+    case MV_MICHELINE_STEP_SEQ:
         m->frame->step_seq.first = true;
         mv_must(begin_sized(state));
         break;
-    case MV_MICHELINE_TAG_BYTES:
-        m->frame->step                    = MV_MICHELINE_STEP_BYTES;
+    case MV_MICHELINE_STEP_BYTES:
         m->frame->step_bytes.first        = true;
         m->frame->step_bytes.has_rem_half = false;
         mv_must(begin_sized(state));
         break;
-    case MV_MICHELINE_TAG_STRING:
-        m->frame->step              = MV_MICHELINE_STEP_STRING;
+    case MV_MICHELINE_STEP_STRING:
         m->frame->step_string.first = true;
         mv_must(begin_sized(state));
         break;
-    case MV_MICHELINE_TAG_PRIM_0_ANNOTS:
-    case MV_MICHELINE_TAG_PRIM_0_NOANNOTS:
-    case MV_MICHELINE_TAG_PRIM_1_ANNOTS:
-    case MV_MICHELINE_TAG_PRIM_1_NOANNOTS:
-    case MV_MICHELINE_TAG_PRIM_2_ANNOTS:
-    case MV_MICHELINE_TAG_PRIM_2_NOANNOTS:
-        nargs = (t - 3) >> 1;
-        annot = (~t & 1);
-        wrap  = (m->frame > m->stack)
-               && (m->frame[-1].step == MV_MICHELINE_STEP_PRIM)
-               && ((nargs > 0) || annot);
-        goto common_prim;
-    case MV_MICHELINE_TAG_PRIM_N:
-        wrap = (m->frame > m->stack)
-               && (m->frame[-1].step == MV_MICHELINE_STEP_PRIM);
-        nargs = 3;
-        annot = true;
-    common_prim:
-        m->frame->step            = MV_MICHELINE_STEP_PRIM_OP;
-        m->frame->step_prim.ofs   = 0;
-        m->frame->step_prim.nargs = nargs;
-        m->frame->step_prim.wrap  = wrap;
+    default:  // MV_MICHELINE_STEP_PRIM_OP
+        m->frame->step_prim.nargs = tr->nargs;
+        m->frame->step_prim.wrap  = (m->frame > m->stack)
+                                   && (m->frame[-1].step
+                                       == MV_MICHELINE_STEP_PRIM)
+                                   && ((tr->nargs > 0) || tr->annot);
         m->frame->step_prim.spc   = false;
         m->frame->step_prim.first = true;
-        m->frame->step_prim.annot = annot;
+        m->frame->step_prim.annot = tr->annot;
         break;
-    default:
-        mv_raise(INVALID_TAG);
     }
     mv_continue;
 }
@@ -228,10 +252,7 @@ tag_selection(mv_parser_state *state, uint8_t t)
 mv_parser_result
 mv_micheline_parser_step(mv_parser_state *state)
 {
-    mv_micheline_state *m = &state->micheline;
-    uint8_t             b;
-    uint8_t             op;
-    uint8_t             t;
+    mv_parser_result res;
 
     // cannot restart after error
     if (MV_IS_ERR(state->errno)) {
@@ -242,42 +263,64 @@ mv_micheline_parser_step(mv_parser_state *state)
         mv_stop(DONE);
     }
 
+    // the frames go on without returning until the parser blocks
+    do {
+        res = step(state);
+    } while (res == MV_CONTINUE);
+    return res;
+}
+
+/**
+ * @brief Apply one step to the frame on top of the micheline stack
+ *
+ * @param state: parser state
+ * @return mv_parser_result: parser result
+ */
+static mv_parser_result
+step(mv_parser_state *state)
+{
+    mv_micheline_state *m = &state->micheline;
+    uint8_t             b;
+    uint8_t             op;
+    uint8_t             t;
+
     PRINTF(
         "[DEBUG] micheline(frame: %d, offset:%d/%d, step: %s, errno: %s)\n",
         (int)(m->frame - m->stack), (int)state->ofs, (int)m->frame->stop,
         (const char *)PIC(mv_micheline_parser_step_name[m->frame->step]),
         mv_parser_result_name(state->errno));
 
-    switch (state->micheline.frame->step) {
+    switch (m->frame->step) {
     case MV_MICHELINE_STEP_INT:
         mv_must(mv_parser_read(state, &b));
-        mv_must(
-            mv_parse_int_step(&state->buffers.num, &m->frame->step_int, b));
-        if (m->frame->step_int.stop) {
-            m->frame->step          = MV_MICHELINE_STEP_PRINT_INT;
-            m->frame->step_int.size = 0;
+        mv_must(mv_parse_int_step(&state->buffers.num, &m->regs.num, b));
+        if (m->regs.num.stop) {
+            m->frame->step   = MV_MICHELINE_STEP_PRINT_INT;
+            m->regs.num.size = 0;
         }
         break;
     case MV_MICHELINE_STEP_PRINT_INT:
-        if (m->frame->step_int.sign) {
+        if (m->regs.num.sign) {
             mv_must(parser_put(state, '-'));
-            m->frame->step_int.sign = 0;
-        } else if (state->buffers.num.decimal[m->frame->step_int.size]) {
-            mv_must(parser_put(
-                state, state->buffers.num.decimal[m->frame->step_int.size]));
-            m->frame->step_int.size++;
+            m->regs.num.sign = 0;
         } else {
+            size_t           written;
+            mv_parser_result res = mv_parser_put_str(
+                state, &state->buffers.num.decimal[m->regs.num.size],
+                &written);
+            m->regs.num.size += (uint16_t)written;
+            mv_must(res);
             mv_must(pop_frame(state));
         }
         break;
     case MV_MICHELINE_STEP_SIZE:
         mv_must(mv_parser_read(state, &b));
-        if (m->frame->step_size.size > 255) {
+        if (m->regs.size > 255) {
             mv_raise(TOO_LARGE);  // enforce 16-bit restriction
         }
-        m->frame->step_size.size = (m->frame->step_size.size << 8) | b;
+        m->regs.size = (m->regs.size << 8) | b;
         if (m->frame->stop == state->ofs) {
-            m->frame[-1].stop = state->ofs + m->frame->step_size.size;
+            m->frame[-1].stop = state->ofs + m->regs.size;
             mv_must(pop_frame(state));
         }
         break;
@@ -300,35 +343,45 @@ mv_micheline_parser_step(mv_parser_state *state)
             mv_must(push_frame(state, MV_MICHELINE_STEP_TAG));
         }
         break;
-    case MV_MICHELINE_STEP_PRINT_CAPTURE:
-        if (state->buffers
-                .capture[state->micheline.frame->step_capture.ofs]) {
-            mv_must(parser_put(
-                state, state->buffers.capture[m->frame->step_capture.ofs]));
-            m->frame->step_capture.ofs++;
-        } else {
-            mv_must(pop_frame(state));
-        }
+    case MV_MICHELINE_STEP_PRINT_CAPTURE: {
+        size_t           written;
+        mv_parser_result res = mv_parser_put_str(
+            state,
+            (const char *)&state->buffers.capture[m->regs.capture_ofs],
+            &written);
+        m->regs.capture_ofs += (uint16_t)written;
+        mv_must(res);
+        mv_must(pop_frame(state));
         break;
+    }
     case MV_MICHELINE_STEP_BYTES:
         if (m->frame->step_bytes.has_rem_half) {
-            mv_must(parser_put(state, m->frame->step_bytes.rem_half));
+            mv_must(parser_put(state, m->regs.rem_half));
             m->frame->step_bytes.has_rem_half = 0;
         } else if (state->micheline.frame->step_bytes.first) {
             mv_must(parser_put(state, '0'));
             m->frame->step_bytes.has_rem_half = true;
-            m->frame->step_bytes.rem_half     = 'x';
+            m->regs.rem_half                  = 'x';
             m->frame->step_bytes.first        = false;
         } else if (m->frame->stop == state->ofs) {
             mv_must(pop_frame(state));
         } else {
-            char half;
-            mv_must(mv_parser_peek(state, &b));
-            half = hex_c[(b & 0xF0) >> 4];
-            mv_must(parser_put(state, half));
-            m->frame->step_bytes.has_rem_half = true;
-            m->frame->step_bytes.rem_half     = hex_c[b & 0x0F];
-            mv_parser_skip(state);
+            const uint8_t *run;
+            size_t         len;
+            size_t         i;
+            mv_must(mv_parser_peek_n(state, &run, &len));
+            len = MIN(len, (size_t)(m->frame->stop - state->ofs));
+            // print the whole bytes that fit in the output at once, a
+            // byte is only split at the end of the output
+            i = mv_parser_put_hex(state, run, len);
+            if (i > 0) {
+                mv_parser_skip_n(state, i);
+            } else {
+                mv_must(parser_put(state, hex_c[(run[0] & 0xF0) >> 4]));
+                m->frame->step_bytes.has_rem_half = true;
+                m->regs.rem_half                  = hex_c[run[0] & 0x0F];
+                mv_parser_skip(state);
+            }
         }
         break;
     case MV_MICHELINE_STEP_STRING:
@@ -339,11 +392,23 @@ mv_micheline_parser_step(mv_parser_state *state)
             mv_must(parser_put(state, '\"'));
             mv_must(pop_frame(state));
         } else {
-            mv_must(mv_parser_peek(state, &b));
-            if ((b >= 0x20) && (b < 0x80) && (b != '\"') && (b != '\\')) {
-                mv_must(parser_put(state, b));
-                mv_parser_skip(state);
+            const uint8_t *run;
+            size_t         len;
+            size_t         i;
+            mv_must(mv_parser_peek_n(state, &run, &len));
+            len = MIN(len, (size_t)(m->frame->stop - state->ofs));
+            // print the run of characters that need no escaping at once
+            for (i = 0; (i < len) && IS_PRINTABLE(run[i]); i++) {
+                // find the end of the run
+            }
+            if (i > 0) {
+                size_t           written;
+                mv_parser_result res
+                    = mv_parser_put_n(state, (const char *)run, i, &written);
+                mv_parser_skip_n(state, written);
+                mv_must(res);
             } else {
+                b = run[0];
                 mv_parser_skip(state);
                 mv_must(print_escaped(state, b));
             }
@@ -358,13 +423,20 @@ mv_micheline_parser_step(mv_parser_state *state)
         if (m->frame->stop == state->ofs) {
             mv_must(pop_frame(state));
         } else {
+            const uint8_t   *run;
+            size_t           len;
+            size_t           written;
+            mv_parser_result res;
             if (m->frame->step_annot.first) {
                 mv_must(parser_put(state, ' '));
                 m->frame->step_annot.first = false;
             }
-            mv_must(mv_parser_peek(state, &b));
-            mv_must(parser_put(state, b));
-            mv_parser_skip(state);
+            // annotations are printed as they are, by runs
+            mv_must(mv_parser_peek_n(state, &run, &len));
+            len = MIN(len, (size_t)(m->frame->stop - state->ofs));
+            res = mv_parser_put_n(state, (const char *)run, len, &written);
+            mv_parser_skip_n(state, written);
+            mv_must(res);
         }
         break;
     case MV_MICHELINE_STEP_PRIM_OP:
@@ -372,8 +444,9 @@ mv_micheline_parser_step(mv_parser_state *state)
         if (mv_michelson_op_name(op) == NULL) {
             mv_raise(INVALID_OP);
         }
-        m->frame->step         = MV_MICHELINE_STEP_PRIM_NAME;
-        m->frame->step_prim.op = op;
+        m->frame->step   = MV_MICHELINE_STEP_PRIM_NAME;
+        m->regs.prim.op  = op;
+        m->regs.prim.ofs = 0;
         // clang-format off
         m->is_unit = ((m->frame == m->stack)
                       && (op == MV_MICHELSON_OP_Unit)
@@ -386,17 +459,21 @@ mv_micheline_parser_step(mv_parser_state *state)
             mv_must(parser_put(state, '('));
             m->frame->step_prim.first = false;
         }
-        if (mv_michelson_op_name(
-                m->frame->step_prim.op)[m->frame->step_prim.ofs]) {
-            mv_must(parser_put(
-                state, mv_michelson_op_name(
-                           m->frame->step_prim.op)[m->frame->step_prim.ofs]));
-            m->frame->step_prim.ofs++;
-        } else {
-            m->frame->step = MV_MICHELINE_STEP_PRIM;
-            if (m->frame->step_prim.nargs == 3) {
-                mv_must(begin_sized(state));
-            }
+        {
+            size_t           ofs = m->regs.prim.ofs;
+            size_t           written;
+            mv_parser_result res;
+
+            op  = m->regs.prim.op;
+            res = mv_parser_put_n(
+                state, mv_michelson_op_name(op) + ofs,
+                mv_michelson_op_name_length(op) - ofs, &written);
+            m->regs.prim.ofs += (uint8_t)written;
+            mv_must(res);
+        }
+        m->frame->step = MV_MICHELINE_STEP_PRIM;
+        if (m->frame->step_prim.nargs == 3) {
+            mv_must(begin_sized(state));
         }
         break;
     case MV_MICHELINE_STEP_PRIM:
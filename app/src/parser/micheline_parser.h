@@ -18,6 +18,8 @@
 
 #include "parser_state.h"
 
+extern const char hex_c[];  /// Uppercase hexadecimal digits
+
 /**
  * @brief Initialize a micheline parser state
  *
@@ -26,7 +28,7 @@
 void mv_micheline_parser_init(mv_parser_state *state);
 
 /**
- * @brief Apply one step to the micheline parser
+ * @brief Apply steps to the micheline parser, until it blocks
  *
  * @param state: parser state
  * @return mv_parser_result: parser result
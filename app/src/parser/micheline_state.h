@@ -18,8 +18,6 @@
 
 #include "num_state.h"
 
-#define MV_MICHELINE_STACK_DEPTH 45  /// Maximum micheline depth handled
-
 /**
  * @brief Enumeration of all micheline tags
  */
@@ -71,36 +69,29 @@ typedef enum {
 /**
  * @brief This struct represents the frame of the parser of micheline
  *
- *        A frame contains the next step to be performed and its
- *        corresponding context
+ *        A frame contains the next step to be performed and the
+ *        flags of its context. The registers which are only used
+ *        while the frame is on top of the stack are in the shared
+ *        `mv_micheline_parser_regs` slot.
  */
 typedef struct {
-    mv_micheline_parser_step_kind step : 4;  /// step
     uint16_t                      stop;      /// stop offset
+    mv_micheline_parser_step_kind step : 4;  /// step
     union {
-        struct {
-            uint16_t size;  /// size read
-        } step_size;        /// MV_MICHELINE_STEP_SIZE
         struct {
             uint8_t first : 1;  /// if read first byte
         } step_seq;             /// MV_MICHELINE_STEP_SEQ
         struct {
             uint8_t first : 1;         /// if read first byte
             uint8_t has_rem_half : 1;  /// if half the byte remains to print
-            uint8_t rem_half;          /// remaining half of the byte
         } step_bytes;                  /// MV_MICHELINE_STEP_BYTES
         struct {
             uint8_t first : 1;  /// if read first byte
         } step_string;          /// MV_MICHELINE_STEP_STRING
         struct {
-            uint8_t first : 1;        /// if read first byte
-        } step_annot;                 /// MV_MICHELINE_STEP_ANNOT
-        mv_num_parser_regs step_int;  /// number parser register
-                                      /// MV_MICHELINE_STEP_INT,
-                                      /// MV_MICHELINE_STEP_PRINT_INT
+            uint8_t first : 1;  /// if read first byte
+        } step_annot;           /// MV_MICHELINE_STEP_ANNOT
         struct {
-            uint8_t op;         /// prim op
-            uint8_t ofs;        /// offset
             uint8_t nargs : 2;  /// number of arguments
             uint8_t wrap : 1;   /// if wrap in a prim
             uint8_t spc : 1;    /// if has space
@@ -109,13 +100,45 @@ typedef struct {
         } step_prim;            /// MV_MICHELINE_STEP_PRIM_OP,
                                 /// MV_MICHELINE_STEP_PRIM_NAME,
                                 /// MV_MICHELINE_STEP_PRIM
-        struct {
-            int ofs;     /// offset of the capture buffer
-        } step_capture;  /// MV_MICHELINE_STEP_CAPTURE_BYTES,
-                         /// MV_MICHELINE_STEP_PRINT_CAPTURE
     };
 } mv_micheline_parser_frame;
 
+/**
+ * @brief This union represents the registers of the top frame of the
+ *        parser of micheline
+ *
+ *        The steps using them never push a frame before they are
+ *        done, so a single slot is shared by the whole stack.
+ */
+typedef union {
+    uint16_t size;  /// size read, MV_MICHELINE_STEP_SIZE
+    mv_num_parser_regs
+        num;  /// number parser register
+              /// MV_MICHELINE_STEP_INT, MV_MICHELINE_STEP_PRINT_INT
+    struct {
+        uint8_t op;   /// prim op
+        uint8_t ofs;  /// offset of the prim name printed
+    } prim;           /// MV_MICHELINE_STEP_PRIM_OP,
+                      /// MV_MICHELINE_STEP_PRIM_NAME
+    uint8_t rem_half;      /// remaining half of the byte,
+                           /// MV_MICHELINE_STEP_BYTES
+    uint16_t capture_ofs;  /// offset of the capture buffer
+                           /// MV_MICHELINE_STEP_PRINT_CAPTURE
+} mv_micheline_parser_regs;
+
+/// RAM budget of the micheline stack, in bytes
+#ifndef MV_MICHELINE_STACK_BUDGET
+#ifdef TARGET_NANOS
+#define MV_MICHELINE_STACK_BUDGET 384
+#else
+#define MV_MICHELINE_STACK_BUDGET 512
+#endif
+#endif
+
+/// Maximum micheline depth handled, within `MV_MICHELINE_STACK_BUDGET`
+#define MV_MICHELINE_STACK_DEPTH \
+    (MV_MICHELINE_STACK_BUDGET / sizeof(mv_micheline_parser_frame))
+
 /**
  * @brief This struct represents the parser of micheline
  *
@@ -129,5 +152,26 @@ typedef struct {
         stack[MV_MICHELINE_STACK_DEPTH];  /// stack of frames
     mv_micheline_parser_frame *frame;     /// current frame
                                           /// init == stack, NULL when done
+    mv_micheline_parser_regs regs;  /// registers of the current frame
     bool is_unit;  /// indicates whether the micheline read is a unit
 } mv_micheline_state;
+
+/// Maximum number of nested sequences in a Micheline hint
+#define MV_MICHELINE_HINT_DEPTH 2
+
+/**
+ * @brief This struct represents the cursor of the decoder of a value
+ *        with a Micheline hint
+ *
+ *        See `micheline_hints.h`.
+ */
+typedef struct {
+    uint8_t  hint;   /// index of the hint
+    uint8_t  pc;     /// index of the next instruction of the hint
+    uint16_t ofs;    /// offset of the next node in the value
+    uint8_t  depth;  /// number of sequences being read
+    struct {
+        uint8_t  pc;    /// index of the first instruction of an element
+        uint16_t stop;  /// offset of the end of the sequence
+    } seq[MV_MICHELINE_HINT_DEPTH];  /// sequences being read
+} mv_micheline_hint_cursor;
@@ -22,11 +22,65 @@ mv_parse_num_state_init(mv_num_parser_buffer *buffers,
                         mv_num_parser_regs   *regs)
 {
     buffers->bytes[0] = 0;
+    memset(buffers->limbs, 0, sizeof(buffers->limbs));
+    memset(buffers->power, 0, sizeof(buffers->power));
+    buffers->power[0] = 1;
     regs->size        = 0;
     regs->sign        = 0;
     regs->stop        = 0;
 }
 
+/**
+ * @brief Split a carry into a decimal limb and the next carry
+ *
+ *        As `MV_DEC_LIMB_BASE` is 2^9 * 5^9 and the carry is lower than
+ *        2^41, this only takes a 32-bit division.
+ *
+ * @param carry: carry, replaced by the next one
+ * @return uint32_t: limb, `carry` modulo `MV_DEC_LIMB_BASE`
+ */
+static uint32_t
+mv_parse_num_divmod_limb(uint64_t *carry)
+{
+    uint32_t q = (uint32_t)(*carry >> 9) / (MV_DEC_LIMB_BASE >> 9);
+    uint32_t r = (uint32_t)(*carry - ((uint64_t)q * MV_DEC_LIMB_BASE));
+
+    *carry = q;
+    return r;
+}
+
+/**
+ * @brief Add a group of bits to the decimal limbs of a number
+ *
+ *        Then, if more groups follow, shift the weight of the next
+ *        group.
+ *
+ * @param buffers: number buffers
+ * @param v: value of the group of bits
+ * @param s: number of bits of the group
+ * @param cont: if more groups follow
+ */
+static void
+mv_parse_num_add_limbs(mv_num_parser_buffer *buffers, uint8_t v, uint8_t s,
+                       bool cont)
+{
+    uint64_t carry = 0;
+    size_t   i;
+
+    for (i = 0; i < MV_NUM_LIMBS; i++) {
+        carry += buffers->limbs[i] + ((uint64_t)buffers->power[i] * v);
+        buffers->limbs[i] = mv_parse_num_divmod_limb(&carry);
+    }
+    if (!cont) {
+        return;
+    }
+    carry = 0;
+    for (i = 0; i < MV_NUM_LIMBS; i++) {
+        carry += (uint64_t)buffers->power[i] << s;
+        buffers->power[i] = mv_parse_num_divmod_limb(&carry);
+    }
+}
+
 mv_parser_result
 mv_parse_num_step(mv_num_parser_buffer *buffers, mv_num_parser_regs *regs,
                   uint8_t b, bool natural)
@@ -56,10 +110,13 @@ mv_parse_num_step(mv_num_parser_buffer *buffers, mv_num_parser_regs *regs,
         buffers->bytes[hi_idx] = hi;
         regs->size += s;
     }
+    mv_parse_num_add_limbs(buffers, v, s, cont);
     if (!cont) {
         regs->stop = true;
-        mv_format_decimal(buffers->bytes, (regs->size + 7) / 8,
-                          buffers->decimal, sizeof(buffers->decimal));
+        MV_PROFILE_CALL(MV_PROFILE_FORMAT);
+        MV_PROFILE_UNITS(MV_PROFILE_FORMAT, (regs->size + 7) / 8);
+        mv_format_decimal_limbs(buffers->limbs, MV_NUM_LIMBS,
+                                buffers->decimal, sizeof(buffers->decimal));
     }
     return MV_CONTINUE;
 }
@@ -78,6 +135,23 @@ mv_parse_nat_step(mv_num_parser_buffer *buffers, mv_num_parser_regs *regs,
     return mv_parse_num_step(buffers, regs, b, 1);
 }
 
+bool
+mv_parse_num_to_uint64(const mv_num_parser_buffer *buffers,
+                       const mv_num_parser_regs *regs, uint64_t *value)
+{
+    size_t len = (regs->size + 7) / 8;
+    size_t i;
+
+    *value = 0;
+    for (i = len; i > 0; i--) {
+        if ((i > sizeof(*value)) && (buffers->bytes[i - 1] != 0)) {
+            return false;
+        }
+        *value = (*value << 8) | buffers->bytes[i - 1];
+    }
+    return true;
+}
+
 bool
 mv_string_to_mumav(const char *str, uint64_t *res)
 {
@@ -87,12 +161,22 @@ mv_string_to_mumav(const char *str, uint64_t *res)
     }
 
     *res = 0;
+    if (str[0] == '\0') {
+        PRINTF("[ERROR] Empty string\n");
+        return false;
+    }
     for (int i = 0; str[i] != '\0'; i++) {
-        if ((str[i] < '0') || (str[i] > '9')) {
+        uint8_t digit = (uint8_t)(str[i] - '0');
+
+        if (digit > 9) {
             PRINTF("[ERROR] Non-digit character: %c\n", str[i]);
             return false;
         }
-        *res = (*res * 10) + (str[i] - '0');
+        if (*res > ((UINT64_MAX - digit) / 10)) {
+            PRINTF("[ERROR] Amount too large\n");
+            return false;
+        }
+        *res = (*res * 10) + digit;
     }
 
     return true;
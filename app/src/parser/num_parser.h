@@ -63,9 +63,26 @@ mv_parser_result mv_parse_int_step(mv_num_parser_buffer *buffers,
 mv_parser_result mv_parse_nat_step(mv_num_parser_buffer *buffers,
                                    mv_num_parser_regs *regs, uint8_t b);
 
+/**
+ * @brief Get the absolute value of a fully parsed number
+ *
+ *        The value is read from the bytes of the number, not from its
+ *        decimal string.
+ *
+ * @param buffers: number parser buffers
+ * @param regs: number parser register
+ * @param value: output value
+ * @return bool: false if the number does not fit in 64 bits
+ */
+bool mv_parse_num_to_uint64(const mv_num_parser_buffer *buffers,
+                            const mv_num_parser_regs *regs, uint64_t *value);
+
 /**
  * @brief format a buffer to mumav number
  *
+ *        The buffer must be the decimal digits of an amount of mumav
+ *        that fits in 64 bits.
+ *
  * @param in: intput buffer
  * @param out: output number
  * @return bool: success
@@ -31,10 +31,23 @@ typedef struct {
 
 #define MV_NUM_BUFFER_SIZE 256  /// Size of the number buffer
 
+/// Number of decimal limbs of the largest number
+#define MV_NUM_LIMBS                                                     \
+    (((MV_DECIMAL_BUFFER_SIZE(MV_NUM_BUFFER_SIZE / 8) - 1)               \
+      + (MV_DEC_LIMB_DIGITS - 1))                                        \
+     / MV_DEC_LIMB_DIGITS)
+
 /**
  * @brief This struct represents the output buffers for the parser of a number
+ *
+ *        The decimal limbs are updated as each group of bits is read,
+ *        so that each byte takes the same time and the number is
+ *        written in decimal in linear time once read.
  */
 typedef struct {
     uint8_t bytes[MV_NUM_BUFFER_SIZE / 8];                         /// bytes
     char decimal[MV_DECIMAL_BUFFER_SIZE(MV_NUM_BUFFER_SIZE / 8)];  /// decimal
+    uint32_t limbs[MV_NUM_LIMBS];  /// number, in base `MV_DEC_LIMB_BASE`
+    uint32_t power[MV_NUM_LIMBS];  /// weight of the next group of bits,
+                                   /// in base `MV_DEC_LIMB_BASE`
 } mv_num_parser_buffer;
@@ -19,6 +19,7 @@
 #include <string.h>
 
 #include "operation_parser.h"
+#include "micheline_hints.h"
 #include "micheline_parser.h"
 #include "num_parser.h"
 
@@ -27,6 +28,7 @@
 static mv_parser_result push_frame(mv_parser_state              *state,
                                    mv_operation_parser_step_kind step);
 static mv_parser_result pop_frame(mv_parser_state *state);
+static mv_parser_result step(mv_parser_state *state);
 
 #ifdef MAVRYK_DEBUG
 const char *const mv_operation_parser_step_name[] = {"OPTION",
@@ -47,6 +49,7 @@ const char *const mv_operation_parser_step_name[] = {"OPTION",
                                                      "READ_STRING",
                                                      "READ_SMART_ENTRYPOINT",
                                                      "READ_MICHELINE",
+                                                     "READ_PARAMETER",
                                                      "READ_SORU_MESSAGES",
                                                      "READ_SORU_KIND",
                                                      "READ_BALLOT",
@@ -121,11 +124,13 @@ const char *const mv_operation_parser_step_name[] = {"OPTION",
 #define MV_OPERATION_FIELDS(name, ...) \
   const mv_operation_field_descriptor name[] = { __VA_ARGS__, MV_OPERATION_LAST_FIELD}
 
+#ifndef MAVRYK_NO_PROPOSALS
 MV_OPERATION_FIELDS(proposals_fields,
     MV_OPERATION_FIELD("Source",   MV_OPERATION_FIELD_PKH),
     MV_OPERATION_FIELD("Period",   MV_OPERATION_FIELD_INT32),
     MV_OPERATION_FIELD("Proposal", MV_OPERATION_FIELD_PROTOS)
 );
+#endif
 
 MV_OPERATION_FIELDS(ballot_fields,
     MV_OPERATION_FIELD("Source",   MV_OPERATION_FIELD_PKH),
@@ -155,7 +160,7 @@ MV_OPERATION_FIELDS(transaction_fields,
     MV_OPERATION_OPTION_FIELD("_Parameters",
         MV_OPERATION_TUPLE_FIELD("_Parameters",
             MV_OPERATION_FIELD("Entrypoint", MV_OPERATION_FIELD_SMART_ENTRYPOINT),
-            MV_OPERATION_FIELD("Parameter",  MV_OPERATION_FIELD_EXPR, .complex=true)),
+            MV_OPERATION_FIELD("Parameter",  MV_OPERATION_FIELD_PARAMETER, .complex=true)),
         .display_none=false)
 );
 
@@ -214,6 +219,7 @@ MV_OPERATION_FIELDS(transfer_tck_fields,
     MV_OPERATION_FIELD("Entrypoint",  MV_OPERATION_FIELD_STRING)
 );
 
+#ifndef MAVRYK_NO_SORU
 MV_OPERATION_FIELDS(soru_add_msg_fields,
     MV_OPERATION_MANAGER_OPERATION_FIELDS,
     MV_OPERATION_FIELD("Message", MV_OPERATION_FIELD_SORU_MESSAGES)
@@ -235,30 +241,79 @@ MV_OPERATION_FIELDS(soru_origin_fields,
         MV_OPERATION_FIELD("Whitelist",  MV_OPERATION_FIELD_PKH_LIST),
         .display_none=false)
 );
+#endif
 
 /**
  * @brief Array of all handled operations
  */
 const mv_operation_descriptor mv_operation_descriptors[] = {
-    {MV_OPERATION_TAG_PROPOSALS,    "Proposals",                  proposals_fields   },
-    {MV_OPERATION_TAG_BALLOT,       "Ballot",                     ballot_fields      },
-    {MV_OPERATION_TAG_FAILING_NOOP, "Failing noop",               failing_noop_fields},
-    {MV_OPERATION_TAG_REVEAL,       "Reveal",                     reveal_fields      },
-    {MV_OPERATION_TAG_TRANSACTION,  "Transaction",                transaction_fields },
-    {MV_OPERATION_TAG_ORIGINATION,  "Origination",                origination_fields },
-    {MV_OPERATION_TAG_DELEGATION,   "Delegation",                 delegation_fields  },
-    {MV_OPERATION_TAG_REG_GLB_CST,  "Register global constant",   reg_glb_cst_fields },
-    {MV_OPERATION_TAG_SET_DEPOSIT,  "Set deposit limit",          set_deposit_fields },
-    {MV_OPERATION_TAG_INC_PAID_STG, "Increase paid storage",      inc_paid_stg_fields},
-    {MV_OPERATION_TAG_UPDATE_CK,    "Set consensus key",          update_ck_fields   },
-    {MV_OPERATION_TAG_TRANSFER_TCK, "Transfer ticket",            transfer_tck_fields},
-    {MV_OPERATION_TAG_SORU_ADD_MSG, "SR: send messages",          soru_add_msg_fields},
-    {MV_OPERATION_TAG_SORU_EXE_MSG, "SR: execute outbox message", soru_exe_msg_fields},
-    {MV_OPERATION_TAG_SORU_ORIGIN,  "SR: originate",              soru_origin_fields },
-    {0,                             NULL,                         0                  }
+#ifndef MAVRYK_NO_PROPOSALS
+    [MV_OPERATION_KIND_PROPOSALS]    = {MV_OPERATION_TAG_PROPOSALS,    "Proposals",                  proposals_fields   },
+#endif
+    [MV_OPERATION_KIND_BALLOT]       = {MV_OPERATION_TAG_BALLOT,       "Ballot",                     ballot_fields      },
+    [MV_OPERATION_KIND_FAILING_NOOP] = {MV_OPERATION_TAG_FAILING_NOOP, "Failing noop",               failing_noop_fields},
+    [MV_OPERATION_KIND_REVEAL]       = {MV_OPERATION_TAG_REVEAL,       "Reveal",                     reveal_fields      },
+    [MV_OPERATION_KIND_TRANSACTION]  = {MV_OPERATION_TAG_TRANSACTION,  "Transaction",                transaction_fields },
+    [MV_OPERATION_KIND_ORIGINATION]  = {MV_OPERATION_TAG_ORIGINATION,  "Origination",                origination_fields },
+    [MV_OPERATION_KIND_DELEGATION]   = {MV_OPERATION_TAG_DELEGATION,   "Delegation",                 delegation_fields  },
+    [MV_OPERATION_KIND_REG_GLB_CST]  = {MV_OPERATION_TAG_REG_GLB_CST,  "Register global constant",   reg_glb_cst_fields },
+    [MV_OPERATION_KIND_SET_DEPOSIT]  = {MV_OPERATION_TAG_SET_DEPOSIT,  "Set deposit limit",          set_deposit_fields },
+    [MV_OPERATION_KIND_INC_PAID_STG] = {MV_OPERATION_TAG_INC_PAID_STG, "Increase paid storage",      inc_paid_stg_fields},
+    [MV_OPERATION_KIND_UPDATE_CK]    = {MV_OPERATION_TAG_UPDATE_CK,    "Set consensus key",          update_ck_fields   },
+    [MV_OPERATION_KIND_TRANSFER_TCK] = {MV_OPERATION_TAG_TRANSFER_TCK, "Transfer ticket",            transfer_tck_fields},
+#ifndef MAVRYK_NO_SORU
+    [MV_OPERATION_KIND_SORU_ADD_MSG] = {MV_OPERATION_TAG_SORU_ADD_MSG, "SR: send messages",          soru_add_msg_fields},
+    [MV_OPERATION_KIND_SORU_EXE_MSG] = {MV_OPERATION_TAG_SORU_EXE_MSG, "SR: execute outbox message", soru_exe_msg_fields},
+    [MV_OPERATION_KIND_SORU_ORIGIN]  = {MV_OPERATION_TAG_SORU_ORIGIN,  "SR: originate",              soru_origin_fields },
+#endif
+    [MV_OPERATION_NB_KINDS]          = {0,                             NULL,                         0                  }
+};
+
+/**
+ * @brief Index + 1 in `mv_operation_descriptors` of the descriptor of
+ *        each operation tag, 0 when the tag is not handled
+ */
+static const uint8_t mv_operation_kinds[256] = {
+#ifndef MAVRYK_NO_PROPOSALS
+    [MV_OPERATION_TAG_PROPOSALS]    = MV_OPERATION_KIND_PROPOSALS + 1,
+#endif
+    [MV_OPERATION_TAG_BALLOT]       = MV_OPERATION_KIND_BALLOT + 1,
+    [MV_OPERATION_TAG_FAILING_NOOP] = MV_OPERATION_KIND_FAILING_NOOP + 1,
+    [MV_OPERATION_TAG_REVEAL]       = MV_OPERATION_KIND_REVEAL + 1,
+    [MV_OPERATION_TAG_TRANSACTION]  = MV_OPERATION_KIND_TRANSACTION + 1,
+    [MV_OPERATION_TAG_ORIGINATION]  = MV_OPERATION_KIND_ORIGINATION + 1,
+    [MV_OPERATION_TAG_DELEGATION]   = MV_OPERATION_KIND_DELEGATION + 1,
+    [MV_OPERATION_TAG_REG_GLB_CST]  = MV_OPERATION_KIND_REG_GLB_CST + 1,
+    [MV_OPERATION_TAG_SET_DEPOSIT]  = MV_OPERATION_KIND_SET_DEPOSIT + 1,
+    [MV_OPERATION_TAG_INC_PAID_STG] = MV_OPERATION_KIND_INC_PAID_STG + 1,
+    [MV_OPERATION_TAG_UPDATE_CK]    = MV_OPERATION_KIND_UPDATE_CK + 1,
+    [MV_OPERATION_TAG_TRANSFER_TCK] = MV_OPERATION_KIND_TRANSFER_TCK + 1,
+#ifndef MAVRYK_NO_SORU
+    [MV_OPERATION_TAG_SORU_ADD_MSG] = MV_OPERATION_KIND_SORU_ADD_MSG + 1,
+    [MV_OPERATION_TAG_SORU_EXE_MSG] = MV_OPERATION_KIND_SORU_EXE_MSG + 1,
+    [MV_OPERATION_TAG_SORU_ORIGIN]  = MV_OPERATION_KIND_SORU_ORIGIN + 1,
+#endif
 };
 // clang-format on
 
+/**
+ * @brief Find the descriptor of an operation tag
+ *
+ * @param tag: operation tag
+ * @return const mv_operation_descriptor *: descriptor of the operation,
+ *         NULL if the tag is not handled
+ */
+static const mv_operation_descriptor *
+mv_operation_descriptor_of(uint8_t tag)
+{
+    uint8_t kind = mv_operation_kinds[tag];
+
+    if (kind == 0) {
+        return NULL;
+    }
+    return &mv_operation_descriptors[kind - 1];
+}
+
 static const char *expression_name = "Expression";   /// title for micheline
 static const char *unset_message   = "Field unset";  /// title for unset field
 
@@ -279,6 +334,7 @@ push_frame(mv_parser_state *state, mv_operation_parser_step_kind step)
     }
     op->frame++;
     op->frame->step = step;
+    MV_RECORD_DEPTH(state, operation);
     mv_continue;
 }
 
@@ -295,6 +351,10 @@ pop_frame(mv_parser_state *state)
 
     if (op->frame == op->stack) {
         op->frame = NULL;
+        PRINTF("[DEBUG] max depth(operation: %d/%d, micheline: %d/%d)\n",
+               (int)state->max_depth.operation, MV_OPERATION_STACK_DEPTH,
+               (int)state->max_depth.micheline,
+               (int)MV_MICHELINE_STACK_DEPTH);
         mv_stop(DONE);
     }
     op->frame--;
@@ -307,6 +367,94 @@ mv_operation_parser_set_size(mv_parser_state *state, uint16_t size)
     state->operation.stack[0].stop = size;
 }
 
+void
+mv_operation_parser_set_lookahead(mv_parser_state *state, bool lookahead)
+{
+    state->operation.lookahead = lookahead;
+}
+
+void
+mv_operation_parser_set_validate_only(mv_parser_state *state,
+                                      bool             validate_only)
+{
+    state->operation.validate_only = validate_only;
+}
+
+void
+mv_operation_parser_set_collapse(mv_parser_state *state, bool collapse)
+{
+    state->operation.collapse = collapse;
+}
+
+bool
+mv_operation_parser_expand(mv_parser_state *state)
+{
+    mv_operation_parser_frame *frame = state->operation.frame;
+
+    if (!state->field_info.is_field_folded || (frame == NULL)
+        || (frame->step != MV_OPERATION_STEP_READ_MICHELINE)
+        || !frame->step_read_micheline.folded) {
+        return false;
+    }
+    frame->step_read_micheline.folded = 0;
+    return true;
+}
+
+void
+mv_operation_parser_set_expected(mv_parser_state             *state,
+                                 const mv_operation_expected *expected)
+{
+    state->operation.expected = expected;
+}
+
+uint16_t
+mv_operation_summary_nb_kind(const mv_operation_summary *summary,
+                             mv_operation_tag            tag)
+{
+    uint8_t kind = mv_operation_kinds[(uint8_t)tag];
+
+    if (kind == 0) {
+        return 0;
+    }
+    return summary->nb_kind[kind - 1];
+}
+
+bool
+mv_operation_summary_merge(mv_operation_summary       *summary,
+                           const mv_operation_summary *other)
+{
+    size_t i;
+
+    if (((summary->total_fee + other->total_fee) < summary->total_fee)
+        || ((summary->total_amount + other->total_amount)
+            < summary->total_amount)
+        || ((summary->nb_operations + other->nb_operations) > UINT16_MAX)
+        || ((summary->nb_destination + other->nb_destination)
+            > UINT16_MAX)) {
+        return false;
+    }
+
+    summary->total_fee += other->total_fee;
+    summary->total_amount += other->total_amount;
+    summary->nb_operations += other->nb_operations;
+    for (i = 0; i < MV_OPERATION_NB_KINDS; i++) {
+        summary->nb_kind[i] += other->nb_kind[i];
+    }
+    if (other->nb_destination != 0) {
+        if (summary->nb_destination == 0) {
+            memcpy(summary->destination, other->destination, 22);
+            summary->nb_destination = other->nb_destination;
+        } else if (memcmp(summary->destination, other->destination, 22)
+                   == 0) {
+            summary->nb_destination += other->nb_destination;
+        } else {
+            summary->several_destinations = true;
+        }
+    }
+    summary->several_destinations |= other->several_destinations;
+    return true;
+}
+
 void
 mv_operation_parser_init(mv_parser_state *state, uint16_t size,
                          bool skip_magic)
@@ -314,18 +462,24 @@ mv_operation_parser_init(mv_parser_state *state, uint16_t size,
     mv_operation_state *op = &state->operation;
 
     mv_parser_init(state);
-    state->operation.seen_reveal = 0;
+    mv_format_base58check_reset_memo();
+    state->operation.seen_reveal   = 0;
+    state->operation.lookahead     = 0;
+    state->operation.validate_only = 0;
+    state->operation.collapse      = 0;
     memset(&state->operation.source, 0, 22);
     memset(&state->operation.destination, 0, 22);
     op->batch_index = 0;
+    op->run_tag     = MV_OPERATION_TAG_END;
+    op->run_length  = 0;
 #ifdef HAVE_SWAP
-    op->last_tag  = MV_OPERATION_TAG_END;
-    op->nb_reveal = 0;
+    op->last_tag = MV_OPERATION_TAG_END;
 #endif  // HAVE_SWAP
-    op->total_fee     = 0;
-    op->total_amount  = 0;
+    memset(&op->summary, 0, sizeof(op->summary));
+    op->expected      = NULL;
     op->frame         = op->stack;
     op->stack[0].stop = size;
+    MV_RECORD_DEPTH(state, operation);
     if (!skip_magic) {
         op->stack[0].step = MV_OPERATION_STEP_MAGIC;
     } else {
@@ -429,8 +583,8 @@ mv_step_tuple(mv_parser_state *state)
     ASSERT_STEP(state, TUPLE);
     mv_operation_state                  *op    = &state->operation;
     mv_parser_regs                      *regs  = &state->regs;
-    const mv_operation_field_descriptor *field = PIC(
-        &op->frame->step_tuple.fields[op->frame->step_tuple.field_index]);
+    const mv_operation_field_descriptor *field
+        = &op->frame->step_tuple.fields[op->frame->step_tuple.field_index];
 
     // Remaining content from previous section - display this first.
     if (regs->oofs > 0) {
@@ -480,11 +634,23 @@ mv_step_magic(mv_parser_state *state)
         op->frame->step_read_bytes.len  = 32;
         break;
     case 5:  // micheline expression
-        op->frame->step = MV_OPERATION_STEP_READ_MICHELINE;
+        // Packed data of a known size may match a hint
+        op->hint.has_hints
+            = (op->frame->stop != MV_UNKNOWN_SIZE)
+              && mv_micheline_hint_lookup(NULL, &op->hint.cursor);
+        op->frame->step = op->hint.has_hints
+                              ? MV_OPERATION_STEP_READ_PARAMETER
+                              : MV_OPERATION_STEP_READ_MICHELINE;
         op->frame->step_read_micheline.inited = 0;
         op->frame->step_read_micheline.skip   = false;
+        op->frame->step_read_micheline.replay = 0;
+        op->frame->step_read_micheline.hinted = 0;
+        op->frame->step_read_micheline.folded = 0;
+        op->frame->step_read_micheline.asking = 0;
         op->frame->step_read_micheline.name   = (char *)PIC(expression_name);
-        op->frame->stop                       = 0;
+        if (!op->hint.has_hints) {
+            op->frame->stop = 0;
+        }
         break;
     default:
         mv_raise(INVALID_TAG);
@@ -517,6 +683,64 @@ mv_step_size(mv_parser_state *state)
     mv_continue;
 }
 
+/**
+ * @brief Check an operation tag against the operation expected
+ *
+ *        Only one transaction is expected, after at most one reveal.
+ *
+ * @param op: operations parser state
+ * @param tag: tag of the operation read, recorded in the summary
+ * @return bool: true if the operation is expected
+ */
+static bool
+mv_expected_tag(const mv_operation_state *op, uint8_t tag)
+{
+    uint16_t nb_reveal;
+    uint16_t nb_transaction;
+
+    nb_reveal      = mv_operation_summary_nb_kind(&op->summary,
+                                                  MV_OPERATION_TAG_REVEAL);
+    nb_transaction = mv_operation_summary_nb_kind(
+        &op->summary, MV_OPERATION_TAG_TRANSACTION);
+    switch (tag) {
+    case MV_OPERATION_TAG_REVEAL:
+        return (nb_reveal == 0) && (nb_transaction == 0);
+    case MV_OPERATION_TAG_TRANSACTION:
+        return nb_transaction == 0;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Check a total against the operation expected, once a field
+ *        adding to it has been read
+ *
+ *        The transaction is the last operation expected: its fee and
+ *        amount complete the totals, which must then be the expected
+ *        ones. Before, they must not exceed them.
+ *
+ * @param op: operations parser state
+ * @param kind: kind of the field read
+ * @return bool: true if the total can still be the expected one
+ */
+static bool
+mv_expected_total(const mv_operation_state *op, mv_operation_field_kind kind)
+{
+    bool last = op->run_tag == MV_OPERATION_TAG_TRANSACTION;
+
+    switch (kind) {
+    case MV_OPERATION_FIELD_AMOUNT:
+        return last ? (op->summary.total_amount == op->expected->amount)
+                    : (op->summary.total_amount <= op->expected->amount);
+    case MV_OPERATION_FIELD_FEE:
+        return last ? (op->summary.total_fee == op->expected->fee)
+                    : (op->summary.total_fee <= op->expected->fee);
+    default:
+        return true;
+    }
+}
+
 /**
  * @brief Find the operation associated to the operation tag and ask
  *        to read its fields
@@ -534,23 +758,110 @@ mv_step_tag(mv_parser_state *state)
     mv_must(mv_parser_read(state, &t));
 #ifdef HAVE_SWAP
     op->last_tag = t;
-    if (t == MV_OPERATION_TAG_REVEAL) {
-        op->nb_reveal++;
-    }
 #endif  // HAVE_SWAP
-    for (d = mv_operation_descriptors; d->tag != MV_OPERATION_TAG_END; d++) {
-        if (d->tag == t) {
-            op->frame->step                   = MV_OPERATION_STEP_TUPLE;
-            op->frame->step_tuple.fields      = d->fields;
-            op->frame->step_tuple.field_index = 0;
-            mv_must(push_frame(state, MV_OPERATION_STEP_PRINT));
-            snprintf(state->field_info.field_name, 30, "Operation (%d)",
-                     op->batch_index);
-            op->frame->step_print.str = d->name;
-            mv_continue;
-        }
+    d = mv_operation_descriptor_of(t);
+    if (d == NULL) {
+        mv_raise(INVALID_TAG);
+    }
+    if ((op->expected != NULL) && !mv_expected_tag(op, t)) {
+        mv_raise(UNEXPECTED);
     }
-    mv_raise(INVALID_TAG);
+    if (t != op->run_tag) {
+        op->run_tag    = t;
+        op->run_length = 0;
+    }
+    op->summary.nb_operations++;
+    op->summary.nb_kind[d - mv_operation_descriptors]++;
+    op->frame->step                   = MV_OPERATION_STEP_TUPLE;
+    op->frame->step_tuple.fields      = PIC(d->fields);
+    op->frame->step_tuple.field_index = 0;
+    mv_must(push_frame(state, MV_OPERATION_STEP_PRINT));
+    snprintf(state->field_info.field_name, 30, "Operation (%d)",
+             op->batch_index);
+    op->frame->step_print.str = d->name;
+    mv_continue;
+}
+
+/**
+ * @brief Drop what has been printed
+ *
+ * @param state: parser state
+ */
+static void
+mv_drop_output(mv_parser_state *state)
+{
+    mv_parser_regs *regs = &state->regs;
+
+    memset(regs->obuf, 0x0, regs->oofs);
+    regs->olen += regs->oofs;
+    regs->oofs = 0;
+}
+
+/**
+ * @brief Apply one step to the micheline parser on the parameter
+ *        captured for a hint
+ *
+ *        The input registers and offset of the parser are those of the
+ *        parameter for the time of the step only.
+ *
+ * @param state: parser state
+ */
+static void
+mv_replay_micheline_step(mv_parser_state *state)
+{
+    mv_operation_hint *hint = &state->operation.hint;
+    mv_parser_regs    *regs = &state->regs;
+    const uint8_t     *ibuf = regs->ibuf;
+    size_t             iofs = regs->iofs;
+    size_t             ilen = regs->ilen;
+    int                ofs  = state->ofs;
+
+    regs->ibuf = hint->value;
+    regs->iofs = hint->ofs;
+    regs->ilen = hint->len - hint->ofs;
+    state->ofs = hint->start + hint->ofs;
+    if (mv_micheline_parser_step(state) == MV_BLO_FEED_ME) {
+        // The expression goes beyond the parameter
+        mv_parser_set_errno(state, MV_ERR_TOO_LARGE);
+    }
+    hint->ofs  = (uint16_t)regs->iofs;
+    regs->ibuf = ibuf;
+    regs->iofs = iofs;
+    regs->ilen = ilen;
+    state->ofs = ofs;
+}
+
+/**
+ * @brief Fold the expression of a complex field to its size
+ *
+ *        In collapse mode, a large enough expression is first printed
+ *        as its size in `CAPTURE`, and then only read unless the user
+ *        expands it meanwhile, see `mv_operation_parser_expand`.
+ *
+ * @param state: parser state
+ * @return bool: whether the expression is folded
+ */
+static bool
+mv_fold_micheline(mv_parser_state *state)
+{
+    mv_operation_state *op = &state->operation;
+    size_t              size;
+
+    if (!op->collapse || op->validate_only
+        || !state->field_info.is_field_complex || (op->frame->stop == 0)) {
+        return false;
+    }
+    size = op->frame->step_read_micheline.replay
+               ? op->hint.len
+               : (size_t)(op->frame->stop - state->ofs);
+    if (size < MV_OPERATION_COLLAPSE_SIZE) {
+        return false;
+    }
+    op->frame->step_read_micheline.folded = 1;
+    op->frame->step_read_micheline.asking = 1;
+    state->field_info.is_field_folded     = true;
+    snprintf((char *)CAPTURE, sizeof(CAPTURE), "%d bytes", (int)size);
+    return true;
 }
 
 /**
@@ -565,13 +876,37 @@ mv_step_read_micheline(mv_parser_state *state)
     ASSERT_STEP(state, READ_MICHELINE);
     mv_operation_state *op   = &state->operation;
     mv_parser_regs     *regs = &state->regs;
+    bool                drop;
     if (!op->frame->step_read_micheline.inited) {
         op->frame->step_read_micheline.inited = 1;
         STRLCPY(state->field_info.field_name,
                 op->frame->step_read_micheline.name);
         mv_micheline_parser_init(state);
+        if (mv_fold_micheline(state)) {
+            mv_must(push_frame(state, MV_OPERATION_STEP_PRINT));
+            op->frame->step_print.str = (char *)CAPTURE;
+            mv_continue;
+        }
+    }
+    if (op->frame->step_read_micheline.asking) {
+        // The size has been displayed, the expression may be expanded
+        op->frame->step_read_micheline.asking = 0;
+        state->field_info.is_field_folded     = false;
+        if (regs->oofs > 0) {
+            mv_stop(IM_FULL);
+        }
+    }
+    if (op->frame->step_read_micheline.replay) {
+        mv_replay_micheline_step(state);
+    } else {
+        mv_micheline_parser_step(state);
+    }
+    drop = op->validate_only || op->frame->step_read_micheline.folded;
+    if (drop && (state->errno == MV_BLO_IM_FULL)) {
+        // The expression is still parsed to be validated
+        mv_drop_output(state);
+        mv_continue;
     }
-    mv_micheline_parser_step(state);
     if (state->errno == MV_BLO_DONE) {
         if (state->micheline.is_unit) {
             state->field_info.is_field_complex = false;
@@ -579,7 +914,14 @@ mv_step_read_micheline(mv_parser_state *state)
         if ((op->frame->stop != 0) && (state->ofs != op->frame->stop)) {
             mv_raise(TOO_LARGE);
         }
+        if (op->frame->step_read_micheline.replay
+            && (op->hint.ofs != op->hint.len)) {
+            mv_raise(TOO_LARGE);
+        }
         mv_must(pop_frame(state));
+        if (drop) {
+            mv_drop_output(state);
+        }
         if (regs->oofs > 0) {
             mv_stop(IM_FULL);
         } else {
@@ -590,63 +932,160 @@ mv_step_read_micheline(mv_parser_state *state)
 }
 
 /**
- * @brief Format a string as an amount
+ * @brief Print a leaf of a parameter decoded with a hint
  *
- * @param str: string to format
+ * @param state: parser state
+ * @param leaf: leaf
+ * @return mv_parser_result: parser result
  */
-static void
-mv_format_amount(char *str)
+static mv_parser_result
+mv_print_hint_leaf(mv_parser_state *state, const mv_micheline_hint_leaf *leaf)
 {
-    int len = 0;
-    while (str[len]) {
-        len++;
-    }
-    if ((len == 1) && (str[0] == 0)) {
-        // just 0
-        goto add_currency;
-    }
-    if (len < 7) {
-        // less than one tez, pad left up to the '0.'
-        int j;
-        int pad = 7 - len;
-        for (j = len; j >= 0; j--) {
-            str[j + pad] = str[j];
+    mv_operation_state *op    = &state->operation;
+    const uint8_t      *bytes = &op->hint.value[leaf->ofs];
+    char               *str   = (char *)CAPTURE;
+    mv_num_parser_regs  num;
+    size_t              i;
+
+    switch (leaf->kind) {
+    case MV_MICHELINE_HINT_LEAF_ADDRESS:
+        if (op->lookahead) {
+            // Always fits in one screen, no need to format it
+            CAPTURE[0] = '\0';
+        } else if (mv_format_address(bytes, 22, str, sizeof(CAPTURE))) {
+            mv_raise(INVALID_TAG);
         }
-        for (j = 0; j < pad; j++) {
-            str[j] = '0';
+        break;
+    case MV_MICHELINE_HINT_LEAF_STRING:
+        memcpy(CAPTURE, bytes, leaf->len);
+        CAPTURE[leaf->len] = '\0';
+        break;
+    case MV_MICHELINE_HINT_LEAF_NAT:
+        mv_parse_num_state_init(&state->buffers.num, &num);
+        for (i = 0; i < leaf->len; i++) {
+            mv_must(mv_parse_int_step(&state->buffers.num, &num, bytes[i]));
         }
-        len = 7;
+        str = state->buffers.num.decimal;
+        break;
+    case MV_MICHELINE_HINT_LEAF_CONSTANT:
+        str = (char *)leaf->value;
+        break;
+    case MV_MICHELINE_HINT_LEAF_TEXT:
+        CAPTURE[0] = '"';
+        memcpy(&CAPTURE[1], bytes, leaf->len);
+        CAPTURE[leaf->len + 1] = '"';
+        CAPTURE[leaf->len + 2] = '\0';
+        break;
+    case MV_MICHELINE_HINT_LEAF_BYTES:
+        CAPTURE[0] = '0';
+        CAPTURE[1] = 'x';
+        mv_format_hex(bytes, leaf->len, (char *)&CAPTURE[2],
+                      2 * leaf->len, false);
+        CAPTURE[2 + (2 * leaf->len)] = '\0';
+        break;
+    default:
+        mv_raise(INVALID_STATE);
     }
-    int no_decimals = 1;
-    for (int i = 0; i < 6; i++) {
-        no_decimals &= (str[len - 1 - i] == '0');
+    mv_must(push_frame(state, MV_OPERATION_STEP_PRINT));
+    op->frame->step_print.str = str;
+    mv_continue;
+}
+
+/**
+ * @brief Read the parameter of a transaction, or packed data
+ *
+ *        The parameter of an entrypoint with hints is captured whole,
+ *        up to `MV_OPERATION_HINT_SIZE` bytes. When it matches one of
+ *        the hints, its leaves are printed as fields, otherwise it is
+ *        read again from the capture as a micheline expression. Other
+ *        parameters are directly read as micheline expressions. Packed
+ *        data is read the same way, with the hints of packed data.
+ *
+ * @param state: parser state
+ * @return mv_parser_result: parser result
+ */
+static mv_parser_result
+mv_step_read_parameter(mv_parser_state *state)
+{
+    ASSERT_STEP(state, READ_PARAMETER);
+    mv_operation_state    *op   = &state->operation;
+    mv_operation_hint     *hint = &op->hint;
+    mv_parser_regs        *regs = &state->regs;
+    mv_micheline_hint_leaf leaf;
+    mv_parser_result       res;
+
+    if (!op->frame->step_read_micheline.inited) {
+        if (!hint->has_hints
+            || ((size_t)(op->frame->stop - state->ofs)
+                > sizeof(hint->value))) {
+            op->frame->step = MV_OPERATION_STEP_READ_MICHELINE;
+            mv_continue;
+        }
+        op->frame->step_read_micheline.inited = 1;
+        hint->len                             = 0;
+        hint->start                           = (uint16_t)state->ofs;
+        hint->ofs                             = 0;
     }
-    if (no_decimals) {
-        // integral value, don't include the decimal part (no '.'_
-        str[len - 6] = 0;
-        len -= 6;
-    } else {
-        // more than one tez, add the '.'
-        for (int i = 0; i < 6; i++) {
-            str[len - i] = str[len - i - 1];
+    if (!op->frame->step_read_micheline.hinted) {
+        if (state->ofs != op->frame->stop) {
+            size_t read;
+            mv_must(mv_parser_read_n(state, &hint->value[hint->len],
+                                     (size_t)(op->frame->stop - state->ofs),
+                                     &read));
+            hint->len += (uint16_t)read;
+            mv_continue;
         }
-        str[len - 6] = '.';
-        len++;
-        str[len] = 0;
-        // drop trailing non significant zeroes
-        while (str[len - 1] == '0') {
-            len--;
-            str[len] = 0;
+        if (!mv_micheline_hint_match(&hint->cursor, hint->value,
+                                     hint->len)) {
+            op->frame->step = MV_OPERATION_STEP_READ_MICHELINE;
+            op->frame->step_read_micheline.inited = 0;
+            op->frame->step_read_micheline.replay = 1;
+            mv_continue;
         }
+        if (op->frame->step_read_micheline.skip || op->validate_only) {
+            // The parameter has been validated by the hint
+            mv_must(pop_frame(state));
+            mv_continue;
+        }
+        op->frame->step_read_micheline.hinted = 1;
+        op->frame->step_read_micheline.first  = 1;
+    }
+
+    // Remaining content from previous field - display this first.
+    if (regs->oofs > 0) {
+        mv_stop(IM_FULL);
+    }
+    res = mv_micheline_hint_next(&hint->cursor, hint->value, hint->len,
+                                 &leaf);
+    if (res == MV_BLO_DONE) {
+        mv_must(pop_frame(state));
+        mv_continue;
     }
-add_currency:
-    str[len]     = ' ';
-    str[len + 1] = 'M';
-    str[len + 2] = 'V';
-    str[len + 3] = 'R';
-    str[len + 4] = 'K';
-    len += 5;
-    str[len] = 0;
+    mv_must(res);
+    STRLCPY(state->field_info.field_name, leaf.name);
+    if (!op->frame->step_read_micheline.first) {
+        state->field_info.field_index++;
+    }
+    op->frame->step_read_micheline.first = 0;
+    mv_must(mv_print_hint_leaf(state, &leaf));
+    mv_continue;
+}
+
+/**
+ * @brief Format an amount of mumav in MVRK
+ *
+ * @param amount: amount in mumav
+ * @param str: output string, `MV_DECIMAL_BUFFER_SIZE` of the number
+ *             buffer long
+ */
+static void
+mv_format_amount(uint64_t amount, char *str)
+{
+    size_t len;
+
+    mv_format_mumav(amount, str, MV_MUMAV_BUFFER_SIZE);
+    len = strlen(str);
+    memcpy(str + len, " MVRK", sizeof(" MVRK"));
 }
 
 /**
@@ -666,21 +1105,32 @@ mv_step_read_num(mv_parser_state *state)
                               &op->frame->step_read_num.state, b,
                               op->frame->step_read_num.natural));
     if (op->frame->step_read_num.state.stop) {
-        uint64_t value;
-        if (!mv_string_to_mumav(state->buffers.num.decimal, &value)) {
-            mv_raise(INVALID_DATA);
-        }
+        uint64_t *total = NULL;
+        uint64_t  value = 0;
         switch (op->frame->step_read_num.kind) {
         case MV_OPERATION_FIELD_AMOUNT:
-            op->total_amount += value;
+            total = &op->summary.total_amount;
             break;
         case MV_OPERATION_FIELD_FEE:
-            op->total_fee += value;
+            total = &op->summary.total_fee;
             break;
         default:
             break;
         }
-        if (op->frame->step_read_num.skip) {
+        if (total != NULL) {
+            if (!mv_parse_num_to_uint64(&state->buffers.num,
+                                        &op->frame->step_read_num.state,
+                                        &value)) {
+                mv_raise(INVALID_DATA);
+            }
+            *total += value;
+            if ((op->expected != NULL)
+                && !mv_expected_total(op,
+                                      op->frame->step_read_num.kind)) {
+                mv_raise(UNEXPECTED);
+            }
+        }
+        if (op->frame->step_read_num.skip || op->validate_only) {
             mv_must(pop_frame(state));
             mv_continue;
         }
@@ -692,7 +1142,7 @@ mv_step_read_num(mv_parser_state *state)
             break;
         case MV_OPERATION_FIELD_FEE:
         case MV_OPERATION_FIELD_AMOUNT: {
-            mv_format_amount(str);
+            mv_format_amount(value, str);
             break;
         }
         default:
@@ -729,83 +1179,204 @@ mv_step_read_int32(mv_parser_state *state)
 }
 
 /**
- * @brief Read bytes
+ * @brief Record a destination read
+ *
+ * @param op: operations parser state
+ * @param destination: destination read, 22 bytes
+ */
+static void
+mv_record_destination(mv_operation_state *op, const uint8_t *destination)
+{
+    mv_operation_summary *summary = &op->summary;
+
+    memcpy(op->destination, destination, 22);
+    if (summary->nb_destination == 0) {
+        memcpy(summary->destination, destination, 22);
+        summary->nb_destination = 1;
+    } else if (memcmp(summary->destination, destination, 22) == 0) {
+        summary->nb_destination++;
+    } else {
+        summary->several_destinations = true;
+    }
+}
+
+/**
+ * @brief Record the source of an operation in the current run of
+ *        operations
+ *
+ * @param op: operation state
+ * @param source: source read
+ * @return bool: true if the source was displayed in full for the
+ *         first `MV_OPERATION_BATCH_RUN` operations of the run
+ */
+static bool
+mv_record_source(mv_operation_state *op, const uint8_t *source)
+{
+    if ((op->run_length > 0) && (memcmp(op->source, source, 21) != 0)) {
+        op->run_length = 0;
+    }
+    memcpy(op->source, source, 21);
+    if (op->run_length < UINT16_MAX) {
+        op->run_length++;
+    }
+    return op->run_length > MV_OPERATION_BATCH_RUN;
+}
+
+/**
+ * @brief Format read bytes into the capture buffer and ask to print them
  *
  * @param state: parser state
+ * @param bytes: bytes read, either in the capture buffer or in the
+ *               input buffer
  * @return mv_parser_result: parser result
  */
 static mv_parser_result
-mv_step_read_bytes(mv_parser_state *state)
+mv_format_bytes(mv_parser_state *state, const uint8_t *bytes)
 {
-    ASSERT_STEP(state, READ_BYTES);
-    mv_operation_state *op = &state->operation;
-    if (op->frame->step_read_bytes.ofs < op->frame->step_read_bytes.len) {
-        uint8_t *c;
-        c = &CAPTURE[op->frame->step_read_bytes.ofs];
-        mv_must(mv_parser_read(state, c));
-        op->frame->step_read_bytes.ofs++;
-    } else {
-        if (op->frame->step_read_num.skip) {
+    mv_operation_state *op   = &state->operation;
+    char               *obuf = (char *)CAPTURE;
+    size_t              olen = sizeof(CAPTURE);
+
+    if (op->frame->step_read_num.skip) {
+        mv_must(pop_frame(state));
+        mv_continue;
+    }
+    if ((op->frame->step_read_bytes.kind == MV_OPERATION_FIELD_SOURCE)
+        && mv_record_source(op, bytes)) {
+        // Same source as the previous operation of the run, already
+        // checked and displayed: only a marker is displayed
+        if (op->validate_only) {
             mv_must(pop_frame(state));
             mv_continue;
         }
-        switch (op->frame->step_read_bytes.kind) {
-        case MV_OPERATION_FIELD_SOURCE:
-            memcpy(op->source, CAPTURE, 22);
-            __attribute__((fallthrough));
-        case MV_OPERATION_FIELD_PKH:
-            if (mv_format_pkh(CAPTURE, 21, (char *)CAPTURE,
-                              sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
-            }
-            break;
-        case MV_OPERATION_FIELD_PK:
-            if (mv_format_pk(CAPTURE, op->frame->step_read_bytes.len,
-                             (char *)CAPTURE, sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
-            }
-            break;
-        case MV_OPERATION_FIELD_SR:
-            if (mv_format_base58check("sr1", CAPTURE, 20, (char *)CAPTURE,
-                                      sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
-            }
-            break;
-        case MV_OPERATION_FIELD_SRC:
-            if (mv_format_base58check("src1", CAPTURE, 32, (char *)CAPTURE,
-                                      sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
-            }
-            break;
-        case MV_OPERATION_FIELD_PROTO:
-            if (mv_format_base58check("proto", CAPTURE, 32, (char *)CAPTURE,
-                                      sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
-            }
-            break;
-        case MV_OPERATION_FIELD_DESTINATION:
-            memcpy(op->destination, CAPTURE, 22);
-            if (mv_format_address(CAPTURE, 22, (char *)CAPTURE,
-                                  sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
-            }
-            break;
-        case MV_OPERATION_FIELD_OPH:
-            if (mv_format_oph(CAPTURE, 32, (char *)CAPTURE,
-                              sizeof(CAPTURE))) {
+        snprintf((char *)CAPTURE, sizeof(CAPTURE), "Same as previous");
+        op->frame->step           = MV_OPERATION_STEP_PRINT;
+        op->frame->step_print.str = (char *)CAPTURE;
+        mv_continue;
+    }
+    if (op->lookahead) {
+        if (op->frame->step_read_bytes.kind
+            == MV_OPERATION_FIELD_DESTINATION) {
+            mv_record_destination(op, bytes);
+        }
+        // Always fits in one screen, no need to format it
+        CAPTURE[0]                = '\0';
+        op->frame->step           = MV_OPERATION_STEP_PRINT;
+        op->frame->step_print.str = (char *)CAPTURE;
+        mv_continue;
+    }
+    if (op->validate_only) {
+        // Only check the tags and lengths
+        obuf = NULL;
+        olen = 0;
+    } else {
+        MV_PROFILE_CALL(MV_PROFILE_FORMAT);
+        MV_PROFILE_UNITS(MV_PROFILE_FORMAT, op->frame->step_read_bytes.len);
+    }
+    switch (op->frame->step_read_bytes.kind) {
+    case MV_OPERATION_FIELD_SOURCE:
+    case MV_OPERATION_FIELD_PKH:
+        if (mv_format_pkh(bytes, 21, obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+    case MV_OPERATION_FIELD_PK:
+        if (mv_format_pk(bytes, op->frame->step_read_bytes.len, obuf,
+                         olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+#ifndef MAVRYK_NO_SORU
+    case MV_OPERATION_FIELD_SR:
+        if (mv_format_base58check_prefix(MV_B58_PREFIX_SR1, bytes, 20,
+                                         obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+    case MV_OPERATION_FIELD_SRC:
+        if (mv_format_base58check_prefix(MV_B58_PREFIX_SRC1, bytes, 32,
+                                         obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+#endif
+    case MV_OPERATION_FIELD_PROTO:
+        if (mv_format_base58check_prefix(MV_B58_PREFIX_PROTO, bytes, 32,
+                                         obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+    case MV_OPERATION_FIELD_DESTINATION: {
+        // Matched in its own buffer, the bytes may be in the capture one
+        char destination[MV_OPERATION_EXPECTED_DESTINATION_SIZE];
+
+        mv_record_destination(op, bytes);
+        if (op->expected != NULL) {
+            if (mv_format_address(bytes, 22, destination,
+                                  sizeof(destination))) {
                 mv_raise(INVALID_TAG);
             }
-            break;
-        case MV_OPERATION_FIELD_BH:
-            if (mv_format_bh(CAPTURE, 32, (char *)CAPTURE, sizeof(CAPTURE))) {
-                mv_raise(INVALID_TAG);
+            if (strcmp(destination, op->expected->destination) != 0) {
+                mv_raise(UNEXPECTED);
             }
-            break;
-        default:
-            mv_raise(INVALID_STATE);
         }
-        op->frame->step           = MV_OPERATION_STEP_PRINT;
-        op->frame->step_print.str = (char *)CAPTURE;
+        if (mv_format_address(bytes, 22, obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+    }
+    break;
+    case MV_OPERATION_FIELD_OPH:
+        if (mv_format_oph(bytes, 32, obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+    case MV_OPERATION_FIELD_BH:
+        if (mv_format_bh(bytes, 32, obuf, olen)) {
+            mv_raise(INVALID_TAG);
+        }
+        break;
+    default:
+        mv_raise(INVALID_STATE);
+    }
+    if (op->validate_only) {
+        mv_must(pop_frame(state));
+        mv_continue;
+    }
+    op->frame->step           = MV_OPERATION_STEP_PRINT;
+    op->frame->step_print.str = (char *)CAPTURE;
+    mv_continue;
+}
+
+/**
+ * @brief Read bytes
+ *
+ *        When the bytes are all in the current input buffer, they are
+ *        formatted from it, otherwise they are first captured.
+ *
+ * @param state: parser state
+ * @return mv_parser_result: parser result
+ */
+static mv_parser_result
+mv_step_read_bytes(mv_parser_state *state)
+{
+    ASSERT_STEP(state, READ_BYTES);
+    mv_operation_state *op    = &state->operation;
+    const uint8_t      *bytes = NULL;
+    if ((op->frame->step_read_bytes.ofs == 0)
+        && mv_parser_read_in_place(state, &bytes,
+                                   op->frame->step_read_bytes.len)) {
+        op->frame->step_read_bytes.ofs = op->frame->step_read_bytes.len;
+        mv_must(mv_format_bytes(state, bytes));
+    } else if (op->frame->step_read_bytes.ofs
+               < op->frame->step_read_bytes.len) {
+        size_t read;
+        mv_must(mv_parser_read_n(
+            state, &CAPTURE[op->frame->step_read_bytes.ofs],
+            op->frame->step_read_bytes.len - op->frame->step_read_bytes.ofs,
+            &read));
+        op->frame->step_read_bytes.ofs += (uint16_t)read;
+    } else {
+        mv_must(mv_format_bytes(state, CAPTURE));
     }
     mv_continue;
 }
@@ -861,12 +1432,67 @@ mv_step_read_string(mv_parser_state *state)
     mv_operation_state *op = &state->operation;
     if (state->ofs == op->frame->stop) {
         CAPTURE[op->frame->step_read_string.ofs] = 0;
+        if (op->frame->step_read_string.hint) {
+            op->hint.has_hints = mv_micheline_hint_lookup(
+                (const char *)CAPTURE, &op->hint.cursor);
+        }
         mv_must(mv_print_string(state));
+    } else if ((op->frame->step_read_string.ofs + 1)
+               >= MV_CAPTURE_BUFFER_SIZE) {
+        mv_raise(TOO_LARGE);
     } else {
-        uint8_t b;
-        mv_must(mv_parser_read(state, &b));
-        CAPTURE[op->frame->step_read_string.ofs] = b;
-        op->frame->step_read_string.ofs++;
+        size_t read;
+        mv_must(mv_parser_read_n(
+            state, &CAPTURE[op->frame->step_read_string.ofs],
+            MIN((size_t)(op->frame->stop - state->ofs),
+                (size_t)(MV_CAPTURE_BUFFER_SIZE - 1
+                         - op->frame->step_read_string.ofs)),
+            &read));
+        op->frame->step_read_string.ofs += (uint16_t)read;
+    }
+    mv_continue;
+}
+
+/**
+ * @brief Read a binary value displayed by its length and digest
+ *
+ *        The value is hashed as it passes through the input, and its
+ *        digest is only skipped when the screens are counted or the
+ *        operation only validated, as it does not change their number.
+ *
+ * @param state: parser state
+ * @return mv_parser_result: parser result
+ */
+static mv_parser_result
+mv_read_binary_digest(mv_parser_state *state)
+{
+    mv_operation_state *op   = &state->operation;
+    bool                hash = !op->lookahead && !op->validate_only;
+
+    if (state->ofs == op->frame->stop) {
+        uint8_t digest[MV_DIGEST_SIZE];
+        int     len;
+
+        memset(digest, 0, sizeof(digest));
+        if (hash && mv_digest_final(&state->buffers.digest, digest)) {
+            mv_raise(INVALID_STATE);
+        }
+        len = snprintf((char *)CAPTURE, sizeof(CAPTURE), "%d bytes, blake2b ",
+                       op->frame->step_read_string.ofs);
+        mv_format_hex(digest, MV_DIGEST_SIZE, (char *)CAPTURE + len,
+                      2 * MV_DIGEST_SIZE, true);
+        CAPTURE[len + (2 * MV_DIGEST_SIZE)] = '\0';
+        mv_must(mv_print_string(state));
+    } else {
+        const uint8_t *bytes;
+        size_t         len;
+
+        mv_must(mv_parser_peek_n(state, &bytes, &len));
+        len = MIN(len, (size_t)(op->frame->stop - state->ofs));
+        if (hash && mv_digest_update(&state->buffers.digest, bytes, len)) {
+            mv_raise(INVALID_STATE);
+        }
+        mv_parser_skip_n(state, len);
     }
     mv_continue;
 }
@@ -882,7 +1508,22 @@ mv_step_read_binary(mv_parser_state *state)
 {
     ASSERT_STEP(state, READ_BINARY);
     mv_operation_state *op = &state->operation;
-    if (state->ofs == op->frame->stop) {
+    if (!op->frame->step_read_string.started) {
+        op->frame->step_read_string.started = true;
+        if (!op->frame->step_read_string.skip
+            && ((op->frame->stop - state->ofs)
+                > MV_OPERATION_BINARY_DIGEST_SIZE)) {
+            op->frame->step_read_string.digest = true;
+            op->frame->step_read_string.ofs
+                = (uint16_t)(op->frame->stop - state->ofs);
+            if (!op->lookahead && !op->validate_only
+                && mv_digest_init(&state->buffers.digest)) {
+                mv_raise(INVALID_STATE);
+            }
+        }
+    } else if (op->frame->step_read_string.digest) {
+        mv_must(mv_read_binary_digest(state));
+    } else if (state->ofs == op->frame->stop) {
         CAPTURE[op->frame->step_read_string.ofs] = 0;
         mv_must(mv_print_string(state));
     } else if ((op->frame->step_read_string.ofs + 2)
@@ -894,11 +1535,21 @@ mv_step_read_binary(mv_parser_state *state)
             op->frame->step_print.str = (char *)CAPTURE;
         }
     } else {
-        uint8_t b;
-        mv_must(mv_parser_read(state, &b));
-        char *buf = (char *)CAPTURE + op->frame->step_read_string.ofs;
-        snprintf(buf, 4, "%02x", b);
-        op->frame->step_read_string.ofs += 2;
+        uint8_t bytes[32];
+        size_t  read;
+        // Fill the capture buffer, keeping room for the null terminator
+        size_t room = (size_t)(MV_CAPTURE_BUFFER_SIZE - 1
+                               - op->frame->step_read_string.ofs)
+                      / 2;
+        mv_must(mv_parser_read_n(
+            state, bytes,
+            MIN(MIN(sizeof(bytes), room),
+                (size_t)(op->frame->stop - state->ofs)),
+            &read));
+        mv_format_hex(bytes, read,
+                      (char *)CAPTURE + op->frame->step_read_string.ofs,
+                      2 * read, true);
+        op->frame->step_read_string.ofs += (uint16_t)(2 * read);
     }
     mv_continue;
 }
@@ -916,6 +1567,7 @@ mv_step_read_smart_entrypoint(mv_parser_state *state)
     mv_operation_state *op = &state->operation;
     uint8_t             b;
     mv_must(mv_parser_read(state, &b));
+    op->hint.has_hints = false;
     switch (b) {
     case 0:
         strlcpy((char *)CAPTURE, "default", sizeof(CAPTURE));
@@ -958,8 +1610,9 @@ mv_step_read_smart_entrypoint(mv_parser_state *state)
         mv_must(mv_print_string(state));
         break;
     case 0xFF:
-        op->frame->step                 = MV_OPERATION_STEP_READ_STRING;
-        op->frame->step_read_string.ofs = 0;
+        op->frame->step                  = MV_OPERATION_STEP_READ_STRING;
+        op->frame->step_read_string.ofs  = 0;
+        op->frame->step_read_string.hint = true;
         mv_must(push_frame(state, MV_OPERATION_STEP_SIZE));
         op->frame->step_size.size     = 0;
         op->frame->step_size.size_len = 1;
@@ -1004,14 +1657,16 @@ mv_step_field(mv_parser_state *state)
     }
     case MV_OPERATION_FIELD_TUPLE: {
         op->frame->step                   = MV_OPERATION_STEP_TUPLE;
-        op->frame->step_tuple.fields      = field->field_tuple.fields;
+        op->frame->step_tuple.fields      = PIC(field->field_tuple.fields);
         op->frame->step_tuple.field_index = 0;
         break;
     }
     case MV_OPERATION_FIELD_BINARY: {
-        op->frame->step                  = MV_OPERATION_STEP_READ_BINARY;
-        op->frame->step_read_string.ofs  = 0;
-        op->frame->step_read_string.skip = field->skip;
+        op->frame->step                     = MV_OPERATION_STEP_READ_BINARY;
+        op->frame->step_read_string.ofs     = 0;
+        op->frame->step_read_string.skip    = field->skip;
+        op->frame->step_read_string.started = false;
+        op->frame->step_read_string.digest  = false;
         mv_must(push_frame(state, MV_OPERATION_STEP_SIZE));
         op->frame->step_size.size     = 0;
         op->frame->step_size.size_len = 4;
@@ -1031,6 +1686,7 @@ mv_step_field(mv_parser_state *state)
         op->frame->step_read_bytes.skip = field->skip;
         break;
     }
+#ifndef MAVRYK_NO_SORU
     case MV_OPERATION_FIELD_SR: {
         op->frame->step                 = MV_OPERATION_STEP_READ_BYTES;
         op->frame->step_read_bytes.kind = field->kind;
@@ -1047,6 +1703,7 @@ mv_step_field(mv_parser_state *state)
         op->frame->step_read_bytes.len  = 32;
         break;
     }
+#endif
     case MV_OPERATION_FIELD_PROTO: {
         op->frame->step                 = MV_OPERATION_STEP_READ_BYTES;
         op->frame->step_read_bytes.kind = field->kind;
@@ -1055,6 +1712,7 @@ mv_step_field(mv_parser_state *state)
         op->frame->step_read_bytes.len  = 32;
         break;
     }
+#ifndef MAVRYK_NO_PROPOSALS
     case MV_OPERATION_FIELD_PROTOS: {
         op->frame->step                 = MV_OPERATION_STEP_READ_PROTOS;
         op->frame->step_read_list.name  = name;
@@ -1065,6 +1723,7 @@ mv_step_field(mv_parser_state *state)
         op->frame->step_size.size_len = 4;
         break;
     }
+#endif
     case MV_OPERATION_FIELD_DESTINATION: {
         op->frame->step                 = MV_OPERATION_STEP_READ_BYTES;
         op->frame->step_read_bytes.kind = field->kind;
@@ -1106,10 +1765,17 @@ mv_step_field(mv_parser_state *state)
         op->frame->step_read_string.skip = field->skip;
         break;
     }
-    case MV_OPERATION_FIELD_EXPR: {
-        op->frame->step = MV_OPERATION_STEP_READ_MICHELINE;
+    case MV_OPERATION_FIELD_EXPR:
+    case MV_OPERATION_FIELD_PARAMETER: {
+        op->frame->step = (field->kind == MV_OPERATION_FIELD_PARAMETER)
+                              ? MV_OPERATION_STEP_READ_PARAMETER
+                              : MV_OPERATION_STEP_READ_MICHELINE;
         op->frame->step_read_micheline.inited = 0;
         op->frame->step_read_micheline.skip   = field->skip;
+        op->frame->step_read_micheline.replay = 0;
+        op->frame->step_read_micheline.hinted = 0;
+        op->frame->step_read_micheline.folded = 0;
+        op->frame->step_read_micheline.asking = 0;
         op->frame->step_read_micheline.name   = name;
         mv_must(push_frame(state, MV_OPERATION_STEP_SIZE));
         op->frame->step_size.size     = 0;
@@ -1120,11 +1786,13 @@ mv_step_field(mv_parser_state *state)
         op->frame->step                  = MV_OPERATION_STEP_READ_STRING;
         op->frame->step_read_string.ofs  = 0;
         op->frame->step_read_string.skip = field->skip;
+        op->frame->step_read_string.hint = false;
         mv_must(push_frame(state, MV_OPERATION_STEP_SIZE));
         op->frame->step_size.size     = 0;
         op->frame->step_size.size_len = 4;
         break;
     }
+#ifndef MAVRYK_NO_SORU
     case MV_OPERATION_FIELD_SORU_MESSAGES: {
         op->frame->step                = MV_OPERATION_STEP_READ_SORU_MESSAGES;
         op->frame->step_read_list.name = name;
@@ -1150,6 +1818,7 @@ mv_step_field(mv_parser_state *state)
         op->frame->step_size.size_len = 4;
         break;
     }
+#endif
     case MV_OPERATION_FIELD_BALLOT: {
         op->frame->step                  = MV_OPERATION_STEP_READ_BALLOT;
         op->frame->step_read_string.skip = field->skip;
@@ -1196,6 +1865,7 @@ mv_step_read_pk(mv_parser_state *state)
     mv_continue;
 }
 
+#ifndef MAVRYK_NO_SORU
 /**
  * @brief Read a list of public key hash
  *
@@ -1260,8 +1930,10 @@ mv_step_read_soru_messages(mv_parser_state *state)
         mv_must(push_frame(state, MV_OPERATION_STEP_READ_BINARY));
         snprintf(state->field_info.field_name, MV_FIELD_NAME_SIZE, "%s (%d)",
                  name, index);
-        op->frame->step_read_string.ofs  = 0;
-        op->frame->step_read_string.skip = skip;
+        op->frame->step_read_string.ofs     = 0;
+        op->frame->step_read_string.skip    = skip;
+        op->frame->step_read_string.started = false;
+        op->frame->step_read_string.digest  = false;
         mv_must(push_frame(state, MV_OPERATION_STEP_SIZE));
         op->frame->step_size.size     = 0;
         op->frame->step_size.size_len = 4;
@@ -1297,6 +1969,7 @@ mv_step_read_soru_kind(mv_parser_state *state)
     mv_must(mv_print_string(state));
     mv_continue;
 }
+#endif  // MAVRYK_NO_SORU
 
 /**
  * @brief Read a ballot
@@ -1327,6 +2000,7 @@ mv_step_read_ballot(mv_parser_state *state)
     mv_continue;
 }
 
+#ifndef MAVRYK_NO_PROPOSALS
 /**
  * @brief Read a protocol list
  *
@@ -1361,6 +2035,7 @@ mv_step_read_protos(mv_parser_state *state)
     }
     mv_continue;
 }
+#endif  // MAVRYK_NO_PROPOSALS
 
 /**
  * @brief Print a string
@@ -1382,16 +2057,19 @@ mv_step_print(mv_parser_state *state, bool partial)
                STRING_STEP(state->operation.frame->step));
         mv_raise(INVALID_STATE);
     }
-    mv_operation_state *op  = &state->operation;
-    const char         *str = PIC(op->frame->step_print.str);
-    if (*str) {
-        mv_must(mv_parser_put(state, *str));
-        op->frame->step_print.str++;
-    } else {
+    mv_operation_state *op = &state->operation;
+    if (op->validate_only) {
         mv_must(pop_frame(state));
-        if (!partial) {
-            mv_stop(IM_FULL);
-        }
+        mv_continue;
+    }
+    const char      *str = PIC(op->frame->step_print.str);
+    size_t           written;
+    mv_parser_result res = mv_parser_put_str(state, str, &written);
+    op->frame->step_print.str += written;
+    mv_must(res);
+    mv_must(pop_frame(state));
+    if (!partial) {
+        mv_stop(IM_FULL);
     }
     mv_continue;
 }
@@ -1399,13 +2077,53 @@ mv_step_print(mv_parser_state *state, bool partial)
 mv_parser_result
 mv_operation_parser_step(mv_parser_state *state)
 {
-    mv_operation_state *op = &state->operation;
+    // cannot restart after error
+    if (MV_IS_ERR(state->errno)) {
+        mv_reraise;
+    }
+    return step(state);
+}
 
+mv_parser_result
+mv_operation_parser_run(mv_parser_state *state, mv_operation_run_policy policy,
+                        size_t *nb_outputs, size_t max_outputs)
+{
     // cannot restart after error
     if (MV_IS_ERR(state->errno)) {
         mv_reraise;
     }
 
+    for (;;) {
+        while (!MV_IS_BLOCKED(step(state))) {
+            // Loop while the result is successful and not blocking
+            MV_PROFILE_UNITS(MV_PROFILE_PARSE, 1);
+        }
+        if ((state->errno != MV_BLO_IM_FULL)
+            || (policy == MV_OPERATION_RUN_DISPLAY)) {
+            break;
+        }
+        if (policy == MV_OPERATION_RUN_AGGREGATE) {
+            (*nb_outputs)++;
+            if (*nb_outputs >= max_outputs) {
+                break;
+            }
+        }
+        mv_drop_output(state);
+    }
+    mv_reraise;
+}
+
+/**
+ * @brief Apply one step to the operations parser, which has not failed
+ *
+ * @param state: parser state
+ * @return mv_parser_result: parser result
+ */
+static mv_parser_result
+step(mv_parser_state *state)
+{
+    mv_operation_state *op = &state->operation;
+
     // nothing else to do
     if (op->frame == NULL) {
         mv_stop(DONE);
@@ -1437,6 +2155,9 @@ mv_operation_parser_step(mv_parser_state *state)
     case MV_OPERATION_STEP_READ_MICHELINE:
         mv_must(mv_step_read_micheline(state));
         break;
+    case MV_OPERATION_STEP_READ_PARAMETER:
+        mv_must(mv_step_read_parameter(state));
+        break;
     case MV_OPERATION_STEP_READ_NUM:
         mv_must(mv_step_read_num(state));
         break;
@@ -1467,21 +2188,25 @@ mv_operation_parser_step(mv_parser_state *state)
     case MV_OPERATION_STEP_READ_PK:
         mv_must(mv_step_read_pk(state));
         break;
+#ifndef MAVRYK_NO_SORU
     case MV_OPERATION_STEP_READ_SORU_MESSAGES:
         mv_must(mv_step_read_soru_messages(state));
         break;
     case MV_OPERATION_STEP_READ_SORU_KIND:
         mv_must(mv_step_read_soru_kind(state));
         break;
+    case MV_OPERATION_STEP_READ_PKH_LIST:
+        mv_must(mv_step_read_pkh_list(state));
+        break;
+#endif
     case MV_OPERATION_STEP_READ_BALLOT:
         mv_must(mv_step_read_ballot(state));
         break;
+#ifndef MAVRYK_NO_PROPOSALS
     case MV_OPERATION_STEP_READ_PROTOS:
         mv_must(mv_step_read_protos(state));
         break;
-    case MV_OPERATION_STEP_READ_PKH_LIST:
-        mv_must(mv_step_read_pkh_list(state));
-        break;
+#endif
     case MV_OPERATION_STEP_PRINT:
     case MV_OPERATION_STEP_PARTIAL_PRINT:
         mv_must(mv_step_print(
@@ -47,6 +47,79 @@ void mv_operation_parser_init(mv_parser_state *state, uint16_t size,
  */
 void mv_operation_parser_set_size(mv_parser_state *state, uint16_t size);
 
+/**
+ * @brief Set the lookahead mode
+ *
+ *        In lookahead mode, the fields are delimited as usual but the
+ *        fixed-size ones (hashes, keys, addresses) are not formatted
+ *        and print nothing, as they always fit in one screen. It is
+ *        meant to cheaply count the screens needed to display some
+ *        operations.
+ *
+ * @param state: parser state
+ * @param lookahead: whether the lookahead mode is set
+ */
+void mv_operation_parser_set_lookahead(mv_parser_state *state,
+                                       bool             lookahead);
+
+/**
+ * @brief Set the validate-only mode
+ *
+ *        In validate-only mode, the operations are read and checked
+ *        as usual, and the source, destination, totals and number of
+ *        operations are still recorded, but no field is formatted
+ *        nor printed: the parser never blocks on a full output. It
+ *        is meant for the flows that do not display the fields.
+ *
+ * @param state: parser state
+ * @param validate_only: whether the validate-only mode is set
+ */
+void mv_operation_parser_set_validate_only(mv_parser_state *state,
+                                           bool             validate_only);
+
+/**
+ * @brief Set the collapse mode
+ *
+ *        In collapse mode, the expressions of the complex fields of
+ *        at least `MV_OPERATION_COLLAPSE_SIZE` bytes are first only
+ *        displayed by their size, with `field_info.is_field_folded`
+ *        set. The expression is then still read and validated, but
+ *        printed only if `mv_operation_parser_expand` is called
+ *        before the next step.
+ *
+ * @param state: parser state
+ * @param collapse: whether the collapse mode is set
+ */
+void mv_operation_parser_set_collapse(mv_parser_state *state, bool collapse);
+
+/**
+ * @brief Print the expression of the field displayed by its size
+ *
+ *        Does nothing if the last field parsed is not folded, or
+ *        already expanded.
+ *
+ * @param state: parser state
+ * @return bool: whether the expression is expanded by this call
+ */
+bool mv_operation_parser_expand(mv_parser_state *state);
+
+/**
+ * @brief Set the operation expected
+ *
+ *        Only a transaction, possibly preceded by a reveal, is then
+ *        accepted. Its destination, amount and total fee must be the
+ *        expected ones: the parser fails with MV_ERR_UNEXPECTED as
+ *        soon as a field does not match, the fee of the reveal as soon
+ *        as it exceeds the expected one. The operation must still be
+ *        checked complete once the parser is done.
+ *
+ * @param state: parser state
+ * @param expected: operation expected, NULL to accept any operation,
+ *                  must outlive the parser
+ */
+void mv_operation_parser_set_expected(mv_parser_state             *state,
+                                      const mv_operation_expected *expected);
+
 /**
  * @brief Apply one step to the operations parser
  *
@@ -54,3 +127,57 @@ void mv_operation_parser_set_size(mv_parser_state *state, uint16_t size);
  * @return mv_parser_result: parser result
  */
 mv_parser_result mv_operation_parser_step(mv_parser_state *state);
+
+/**
+ * @brief What the parser driver does with a full output
+ */
+typedef enum {
+    MV_OPERATION_RUN_DISPLAY,   /// stop, for the output to be displayed
+    MV_OPERATION_RUN_DISCARD,   /// drop it and go on
+    MV_OPERATION_RUN_AGGREGATE  /// count it, drop it and go on
+} mv_operation_run_policy;
+
+/**
+ * @brief Run the operations parser until it blocks
+ *
+ *        The steps are applied in one call, which only returns on a
+ *        blocking result: `MV_BLO_IM_FULL` with the field of the
+ *        output in `field_info` for the display, `MV_BLO_FEED_ME`,
+ *        `MV_BLO_DONE` or an error. With `MV_OPERATION_RUN_DISCARD`,
+ *        the full outputs are dropped and never returned. With
+ *        `MV_OPERATION_RUN_AGGREGATE`, they are counted too, and the
+ *        parser stops on the `max_outputs`-th one, before dropping it.
+ *
+ * @param state: parser state
+ * @param policy: what to do with a full output
+ * @param nb_outputs: number of full outputs, incremented for
+ *                    `MV_OPERATION_RUN_AGGREGATE`, may be NULL otherwise
+ * @param max_outputs: number of full outputs to stop at, for
+ *                     `MV_OPERATION_RUN_AGGREGATE`
+ * @return mv_parser_result: blocking result or error
+ */
+mv_parser_result mv_operation_parser_run(mv_parser_state        *state,
+                                         mv_operation_run_policy policy,
+                                         size_t                 *nb_outputs,
+                                         size_t                  max_outputs);
+
+/**
+ * @brief Get the number of operations of a kind in some aggregates
+ *
+ * @param summary: aggregates of the operations
+ * @param tag: tag of the kind of operations
+ * @return uint16_t: number of operations of this kind
+ */
+uint16_t mv_operation_summary_nb_kind(const mv_operation_summary *summary,
+                                      mv_operation_tag            tag);
+
+/**
+ * @brief Add the aggregates of some operations to others
+ *
+ * @param summary: aggregates to update
+ * @param other: aggregates to add
+ * @return bool: false if a count or a total overflows, then `summary`
+ *               is left unchanged
+ */
+bool mv_operation_summary_merge(mv_operation_summary       *summary,
+                                const mv_operation_summary *other);
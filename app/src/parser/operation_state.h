@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include "formatting.h"
 #include "num_state.h"
+#include "micheline_state.h"
 
 /**
  * @brief Enumeration of all operations tags
@@ -41,6 +43,38 @@ typedef enum {
     MV_OPERATION_TAG_SORU_EXE_MSG = 206
 } mv_operation_tag;
 
+/**
+ * @brief Enumeration of the operations handled, in the order of
+ *        `mv_operation_descriptors`
+ *
+ *        The build profiles of the constrained targets can leave out
+ *        the operations rarely signed from a wallet: the smart rollup
+ *        ones with `MAVRYK_NO_SORU` and the proposals with
+ *        `MAVRYK_NO_PROPOSALS`. Their tags are then not handled.
+ */
+typedef enum {
+#ifndef MAVRYK_NO_PROPOSALS
+    MV_OPERATION_KIND_PROPOSALS,
+#endif
+    MV_OPERATION_KIND_BALLOT,
+    MV_OPERATION_KIND_FAILING_NOOP,
+    MV_OPERATION_KIND_REVEAL,
+    MV_OPERATION_KIND_TRANSACTION,
+    MV_OPERATION_KIND_ORIGINATION,
+    MV_OPERATION_KIND_DELEGATION,
+    MV_OPERATION_KIND_REG_GLB_CST,
+    MV_OPERATION_KIND_SET_DEPOSIT,
+    MV_OPERATION_KIND_INC_PAID_STG,
+    MV_OPERATION_KIND_UPDATE_CK,
+    MV_OPERATION_KIND_TRANSFER_TCK,
+#ifndef MAVRYK_NO_SORU
+    MV_OPERATION_KIND_SORU_ADD_MSG,
+    MV_OPERATION_KIND_SORU_EXE_MSG,
+    MV_OPERATION_KIND_SORU_ORIGIN,
+#endif
+    MV_OPERATION_NB_KINDS  /// Number of operations handled
+} mv_operation_kind;
+
 /**
  * @brief Enumeration of all operations parser step
  */
@@ -63,6 +97,7 @@ typedef enum {
     MV_OPERATION_STEP_READ_STRING,
     MV_OPERATION_STEP_READ_SMART_ENTRYPOINT,
     MV_OPERATION_STEP_READ_MICHELINE,
+    MV_OPERATION_STEP_READ_PARAMETER,
     MV_OPERATION_STEP_READ_SORU_MESSAGES,
     MV_OPERATION_STEP_READ_SORU_KIND,
     MV_OPERATION_STEP_READ_BALLOT,
@@ -94,6 +129,7 @@ typedef enum {
     MV_OPERATION_FIELD_DESTINATION,
     MV_OPERATION_FIELD_SMART_ENTRYPOINT,
     MV_OPERATION_FIELD_EXPR,
+    MV_OPERATION_FIELD_PARAMETER,
     MV_OPERATION_FIELD_OPH,
     MV_OPERATION_FIELD_BH,
     MV_OPERATION_FIELD_SORU_MESSAGES,
@@ -165,7 +201,7 @@ typedef struct {
         } step_field;    /// MV_OPERATION_STEP_FIELD
         struct {
             const mv_operation_field_descriptor
-                   *fields;       /// fields of the tuple
+                   *fields;       /// fields of the tuple, already relocated
             uint8_t field_index;  /// index of the current field to read
         } step_tuple;             /// MV_OPERATION_STEP_TUPLE
         struct {
@@ -204,16 +240,31 @@ typedef struct {
             uint8_t ofs : 3;   /// number offset
         } step_read_int32;     /// MV_OPERATION_STEP_READ_INT32
         struct {
-            uint16_t ofs;       /// current buffer string offset
-            uint8_t  skip : 1;  /// if the field is skipped
-        } step_read_string;     /// MV_OPERATION_STEP_READ_STRING
-                                /// MV_OPERATION_STEP_READ_BINARY
+            uint16_t ofs;          /// current buffer string offset, or
+                                   /// length of a digested value
+            uint8_t  skip : 1;     /// if the field is skipped
+            uint8_t  hint : 1;     /// if the string is an entrypoint, to
+                                   /// look up its hints
+            uint8_t  started : 1;  /// if the binary value has started to
+                                   /// be read
+            uint8_t  digest : 1;   /// if the binary value is displayed
+                                   /// by its digest
+        } step_read_string;        /// MV_OPERATION_STEP_READ_STRING
+                                   /// MV_OPERATION_STEP_READ_BINARY
         struct {
-            const char *name;  /// field name
-            uint8_t
-                inited : 1;    /// if the parser micheline has been initialize
-            uint8_t skip : 1;  /// if the field is skipped
-        } step_read_micheline;  /// MV_OPERATION_STEP_READ_MICHELINE
+            const char *name;        /// field name
+            uint8_t     inited : 1;  /// if the parser is initialized
+            uint8_t     skip : 1;    /// if the field is skipped
+            uint8_t     replay : 1;  /// if the expression is read again
+                                     /// from `mv_operation_hint`
+            uint8_t     hinted : 1;  /// if the leaves of a hint are printed
+            uint8_t     first : 1;   /// if no leaf is printed yet
+            uint8_t     folded : 1;  /// if the expression is displayed
+                                     /// by its size only
+            uint8_t     asking : 1;  /// if its size is displayed, until
+                                     /// the user may expand it
+        } step_read_micheline;       /// MV_OPERATION_STEP_READ_MICHELINE
+                                     /// MV_OPERATION_STEP_READ_PARAMETER
         struct {
             const char *name;      /// field name
             uint16_t    index;     /// current index in the list
@@ -225,6 +276,89 @@ typedef struct {
 
 #define MV_OPERATION_STACK_DEPTH 6  /// Maximum operations depth handled
 
+/// Number of operations of a run of operations of the same kind and
+/// source whose source is displayed, like payouts in a batch: for the
+/// following ones of the run, the source is displayed as the same as
+/// the previous one
+#define MV_OPERATION_BATCH_RUN 3
+
+/**
+ * @brief This struct represents the aggregates of the operations read
+ *
+ *        They are accumulated as the fields are decoded, and are
+ *        complete as soon as the parser is done.
+ */
+typedef struct {
+    uint64_t total_fee;      /// sum of the fees
+    uint64_t total_amount;   /// sum of the amounts
+    uint16_t nb_operations;  /// number of operations
+    uint16_t nb_kind[MV_OPERATION_NB_KINDS];  /// number of operations of
+                                              /// each kind, in the order
+                                              /// of the descriptors
+    uint8_t  destination[22];       /// first destination
+    uint16_t nb_destination;        /// number of operations to
+                                    /// `destination`
+    bool     several_destinations;  /// if other destinations were seen
+} mv_operation_summary;
+
+/// Size of the largest binary value displayed in hexadecimal: longer
+/// ones, such as kernels and rollup messages, are displayed by their
+/// length and their BLAKE2b digest
+#ifndef MV_OPERATION_BINARY_DIGEST_SIZE
+#define MV_OPERATION_BINARY_DIGEST_SIZE 128
+#endif
+
+/// Size of the smallest expression of a complex field displayed by its
+/// size in collapse mode, see `mv_operation_parser_set_collapse`
+#ifndef MV_OPERATION_COLLAPSE_SIZE
+#define MV_OPERATION_COLLAPSE_SIZE 64
+#endif
+
+/// Size of the largest transaction parameter decoded with a hint
+#ifndef MV_OPERATION_HINT_SIZE
+#ifdef TARGET_NANOS
+#define MV_OPERATION_HINT_SIZE 80
+#else
+#define MV_OPERATION_HINT_SIZE 160
+#endif
+#endif
+
+/**
+ * @brief This struct represents a transaction parameter being decoded
+ *        with a Micheline hint
+ *
+ *        The parameter is captured whole, as it cannot be displayed
+ *        before it is known to match the hint. If it does not match,
+ *        it is read again from `value` as a Micheline expression.
+ */
+typedef struct {
+    uint8_t  value[MV_OPERATION_HINT_SIZE];  /// parameter
+    uint16_t len;                            /// number of bytes captured
+    uint16_t start;                          /// offset of the parameter
+    uint16_t ofs;  /// offset in `value` of the expression read again
+    bool     has_hints;               /// if the entrypoint read has hints
+    mv_micheline_hint_cursor cursor;  /// decoder of the parameter
+} mv_operation_hint;
+
+/// Size of the expected destination, a base58check address formatted
+/// with `mv_format_address`
+#define MV_OPERATION_EXPECTED_DESTINATION_SIZE \
+    MV_BASE58CHECK_BUFFER_SIZE(20, 3)
+
+/**
+ * @brief This struct represents the operation a flow expects to sign,
+ *        like the transaction of an exchange
+ *
+ *        The operations read are matched against it as each field is
+ *        decoded, so that the parser stops at the first mismatch.
+ */
+typedef struct {
+    uint64_t amount;  /// amount of the transaction
+    uint64_t fee;     /// total fee, the one of the reveal included
+    char     destination
+        [MV_OPERATION_EXPECTED_DESTINATION_SIZE];  /// destination
+} mv_operation_expected;
+
 /**
  * @brief This struct represents the parser of operations
  *
@@ -239,13 +373,25 @@ typedef struct {
     mv_operation_parser_frame *frame;     /// current frame
                                           /// init == stack, NULL when done
     uint8_t  seen_reveal : 1;             /// check at most one reveal
+    uint8_t  lookahead : 1;               /// only count the screens, the
+                                          /// fixed-size fields are not
+                                          /// formatted
+    uint8_t  validate_only : 1;           /// only validate, nothing is
+                                          /// formatted nor printed
+    uint8_t  collapse : 1;                /// display the large complex
+                                          /// expressions by their size
     uint8_t  source[22];                  /// check consistent source in batch
     uint8_t  destination[22];             /// saved for entrypoint dispatch
     uint16_t batch_index;                 /// to print a sequence number
+    uint8_t  run_tag;                     /// tag of the current run of
+                                          /// operations
+    uint16_t run_length;                  /// number of operations of the
+                                          /// run, with the same source
 #ifdef HAVE_SWAP
-    mv_operation_tag last_tag;   /// last operations tag encountered
-    uint16_t         nb_reveal;  /// number of reveal encountered
-#endif                           // HAVE_SWAP
-    uint64_t total_fee;          /// last fee encountered
-    uint64_t total_amount;       /// last amount encountered
+    mv_operation_tag last_tag;  /// last operations tag encountered
+#endif                          // HAVE_SWAP
+    mv_operation_summary summary;  /// aggregates of the operations read
+    mv_operation_hint    hint;     /// parameter decoded with a hint
+    const mv_operation_expected
+        *expected;  /// operation to match, NULL if none
 } mv_operation_state;
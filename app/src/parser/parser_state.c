@@ -16,8 +16,12 @@
    See the License for the specific language governing permissions and
    limitations under the License. */
 
+#include <stddef.h>
+
 #include "parser_state.h"
 
+#include "formatting.h"
+
 /**
  * @brief Helper to handle parser result case
  */
@@ -49,6 +53,7 @@ mv_parser_result_name(mv_parser_result code)
     MV_LABEL(ERR_TOO_LARGE);
     MV_LABEL(ERR_TOO_DEEP);
     MV_LABEL(ERR_INVALID_STATE);
+    MV_LABEL(ERR_UNEXPECTED);
     default:
         return "Unknown";
     }
@@ -62,7 +67,12 @@ mv_parser_init(mv_parser_state *state)
     state->ofs                         = 0;
     state->field_info.field_name[0]    = 0;
     state->field_info.is_field_complex = false;
+    state->field_info.is_field_folded  = false;
     state->field_info.field_index      = 0;
+#ifdef MAVRYK_DEBUG
+    state->max_depth.micheline = 0;
+    state->max_depth.operation = 0;
+#endif
 }
 
 void
@@ -120,6 +130,54 @@ mv_parser_put(mv_parser_state *state, char c)
     mv_continue;
 }
 
+mv_parser_result
+mv_parser_put_str(mv_parser_state *state, const char *str, size_t *written)
+{
+    mv_parser_regs *regs = &state->regs;
+    size_t          len  = 0;
+
+    while ((len < regs->olen) && str[len]) {
+        regs->obuf[regs->oofs + len] = str[len];
+        len++;
+    }
+    regs->oofs += len;
+    regs->olen -= len;
+    *written = len;
+    if (str[len]) {
+        mv_stop(IM_FULL);
+    }
+    mv_continue;
+}
+
+mv_parser_result
+mv_parser_put_n(mv_parser_state *state, const char *str, size_t len,
+                size_t *written)
+{
+    mv_parser_regs *regs = &state->regs;
+
+    *written = MIN(len, regs->olen);
+    memcpy(regs->obuf + regs->oofs, str, *written);
+    regs->oofs += *written;
+    regs->olen -= *written;
+    if (*written < len) {
+        mv_stop(IM_FULL);
+    }
+    mv_continue;
+}
+
+size_t
+mv_parser_put_hex(mv_parser_state *state, const uint8_t *bytes, size_t len)
+{
+    mv_parser_regs *regs = &state->regs;
+    size_t          put
+        = mv_format_hex(bytes, len, regs->obuf + regs->oofs, regs->olen,
+                        false);
+
+    regs->oofs += 2 * put;
+    regs->olen -= 2 * put;
+    return put;
+}
+
 mv_parser_result
 mv_parser_read(mv_parser_state *state, uint8_t *r)
 {
@@ -134,6 +192,43 @@ mv_parser_read(mv_parser_state *state, uint8_t *r)
     mv_continue;
 }
 
+mv_parser_result
+mv_parser_read_n(mv_parser_state *state, uint8_t *out, size_t len,
+                 size_t *read)
+{
+    mv_parser_regs *regs = &state->regs;
+
+    *read = 0;
+    if (len == 0) {
+        mv_continue;
+    }
+    if (regs->ilen < 1) {
+        mv_stop(FEED_ME);
+    }
+    *read = MIN(len, regs->ilen);
+    memcpy(out, regs->ibuf + regs->iofs, *read);
+    regs->iofs += *read;
+    regs->ilen -= *read;
+    state->ofs += (int)*read;
+    mv_continue;
+}
+
+bool
+mv_parser_read_in_place(mv_parser_state *state, const uint8_t **out,
+                        size_t len)
+{
+    mv_parser_regs *regs = &state->regs;
+
+    if (regs->ilen < len) {
+        return false;
+    }
+    *out = regs->ibuf + regs->iofs;
+    regs->iofs += len;
+    regs->ilen -= len;
+    state->ofs += (int)len;
+    return true;
+}
+
 mv_parser_result
 mv_parser_peek(mv_parser_state *state, uint8_t *r)
 {
@@ -146,6 +241,29 @@ mv_parser_peek(mv_parser_state *state, uint8_t *r)
     mv_continue;
 }
 
+mv_parser_result
+mv_parser_peek_n(mv_parser_state *state, const uint8_t **out, size_t *len)
+{
+    mv_parser_regs *regs = &state->regs;
+
+    if (regs->ilen < 1) {
+        mv_stop(FEED_ME);
+    }
+    *out = regs->ibuf + regs->iofs;
+    *len = regs->ilen;
+    mv_continue;
+}
+
+void
+mv_parser_skip_n(mv_parser_state *state, size_t len)
+{
+    mv_parser_regs *regs = &state->regs;
+
+    regs->iofs += len;
+    regs->ilen -= len;
+    state->ofs += (int)len;
+}
+
 void
 mv_parser_skip(mv_parser_state *state)
 {
@@ -155,3 +273,277 @@ mv_parser_skip(mv_parser_state *state)
     regs->ilen--;
     state->ofs++;
 }
+
+// snapshots
+
+/**
+ * @brief Header of a snapshot
+ *
+ *        It is followed by the common fields, the tails of the
+ *        micheline and operation states, the live frames, then the
+ *        live bytes of the buffers.
+ */
+typedef struct {
+    const mv_parser_state *origin;  /// state the snapshot was taken from
+    uint16_t capture_len;           /// number of live bytes of the capture
+    uint16_t oofs;                  /// number of output bytes pending
+    uint16_t ilen;                  /// number of input bytes pending
+    uint8_t  micheline_depth;       /// number of live micheline frames
+    uint8_t  operation_depth;       /// number of live operation frames
+    bool     has_num;               /// if the number buffer is live
+} mv_parser_snapshot_header;
+
+/// Offset and size of the fields of a `type` following `member`
+#define TAIL_OFS(type, member) \
+    (offsetof(type, member) + sizeof(((type *)0)->member))
+#define TAIL_SIZE(type, member) (sizeof(type) - TAIL_OFS(type, member))
+
+#define MICHELINE_TAIL_OFS  TAIL_OFS(mv_micheline_state, frame)
+#define MICHELINE_TAIL_SIZE TAIL_SIZE(mv_micheline_state, frame)
+#define OPERATION_TAIL_OFS  TAIL_OFS(mv_operation_state, frame)
+#define OPERATION_TAIL_SIZE TAIL_SIZE(mv_operation_state, frame)
+
+#define FIXED_SIZE                                                    \
+    (sizeof(mv_parser_snapshot_header)                                \
+     + sizeof(((mv_parser_state *)0)->field_info) + sizeof(int)       \
+     + sizeof(mv_parser_result) + MICHELINE_TAIL_SIZE                 \
+     + OPERATION_TAIL_SIZE)
+
+/**
+ * @brief Get the number of live bytes of a string of the capture buffer
+ *
+ * @param state: parser state
+ * @param str: string, may be outside of the capture buffer
+ * @return size_t: number of bytes up to the end of `str`, 0 if `str` is
+ *                 outside of the capture buffer
+ */
+static size_t
+live_capture_str(const mv_parser_state *state, const char *str)
+{
+    const char *capture = (const char *)state->buffers.capture;
+
+    if ((str < capture) || (str >= capture + MV_CAPTURE_BUFFER_SIZE)) {
+        return 0;
+    }
+    return (size_t)(str - capture)
+           + strnlen(str, (size_t)(capture + MV_CAPTURE_BUFFER_SIZE - str))
+           + 1;
+}
+
+/**
+ * @brief Get the layout of the snapshot of a parser state
+ *
+ *        The capture and number buffers are only live while the
+ *        current step reads or prints them.
+ *
+ * @param state: parser state
+ * @param header: output header of the snapshot
+ * @return size_t: size of the snapshot
+ */
+static size_t
+snapshot_layout(const mv_parser_state *state,
+                mv_parser_snapshot_header *header)
+{
+    const mv_operation_parser_frame *op = state->operation.frame;
+    const mv_micheline_parser_frame *m  = state->micheline.frame;
+    const char *decimal = state->buffers.num.decimal;
+    size_t      capture_len = 0;
+
+    memset(header, 0, sizeof(*header));
+    header->origin = state;
+    header->oofs   = (uint16_t)state->regs.oofs;
+    header->ilen   = (uint16_t)state->regs.ilen;
+
+    if (op != NULL) {
+        header->operation_depth
+            = (uint8_t)(op - state->operation.stack + 1);
+
+        switch (op->step) {
+        case MV_OPERATION_STEP_READ_BYTES:
+            capture_len = op->step_read_bytes.ofs;
+            break;
+        case MV_OPERATION_STEP_READ_STRING:
+            capture_len = op->step_read_string.ofs;
+            break;
+        case MV_OPERATION_STEP_READ_BINARY:
+            capture_len = op->step_read_string.digest
+                              ? sizeof(state->buffers.digest)
+                              : op->step_read_string.ofs;
+            break;
+        case MV_OPERATION_STEP_READ_NUM:
+            header->has_num = true;
+            break;
+        case MV_OPERATION_STEP_PRINT:
+        case MV_OPERATION_STEP_PARTIAL_PRINT:
+            capture_len     = live_capture_str(state, op->step_print.str);
+            header->has_num = ((op->step_print.str >= decimal)
+                               && (op->step_print.str
+                                   < decimal + sizeof(state->buffers.num
+                                                          .decimal)));
+            break;
+        case MV_OPERATION_STEP_READ_MICHELINE:
+            if (!op->step_read_micheline.inited || (m == NULL)) {
+                break;
+            }
+            header->micheline_depth
+                = (uint8_t)(m - state->micheline.stack + 1);
+            if (m->step == MV_MICHELINE_STEP_PRINT_CAPTURE) {
+                capture_len = live_capture_str(
+                    state, (const char *)&state->buffers
+                               .capture[state->micheline.regs.capture_ofs]);
+            } else if ((m->step == MV_MICHELINE_STEP_INT)
+                       || (m->step == MV_MICHELINE_STEP_PRINT_INT)) {
+                header->has_num = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    header->capture_len = (uint16_t)capture_len;
+
+    return FIXED_SIZE
+           + (header->micheline_depth * sizeof(mv_micheline_parser_frame))
+           + (header->operation_depth * sizeof(mv_operation_parser_frame))
+           + (header->has_num ? sizeof(mv_num_parser_buffer) : 0)
+           + capture_len + state->regs.oofs + state->regs.ilen;
+}
+
+size_t
+mv_parser_snapshot_size(const mv_parser_state *state)
+{
+    mv_parser_snapshot_header header;
+
+    return snapshot_layout(state, &header);
+}
+
+/**
+ * @brief Append bytes to a snapshot
+ */
+#define PUT(_cursor, _src, _len)           \
+    do {                                   \
+        memcpy((_cursor), (_src), (_len)); \
+        (_cursor) += (_len);               \
+    } while (0)
+
+/**
+ * @brief Read bytes from a snapshot
+ */
+#define GET(_dst, _cursor, _len)           \
+    do {                                   \
+        memcpy((_dst), (_cursor), (_len)); \
+        (_cursor) += (_len);               \
+    } while (0)
+
+mv_parser_result
+mv_parser_snapshot(const mv_parser_state *state, uint8_t *buf, size_t len)
+{
+    mv_parser_snapshot_header header;
+    uint8_t                  *cursor = buf;
+
+    if ((state->regs.oofs > UINT16_MAX) || (state->regs.ilen > UINT16_MAX)
+        || (len < snapshot_layout(state, &header))) {
+        return MV_ERR_TOO_LARGE;
+    }
+
+    PUT(cursor, &header, sizeof(header));
+    PUT(cursor, &state->field_info, sizeof(state->field_info));
+    PUT(cursor, &state->ofs, sizeof(state->ofs));
+    PUT(cursor, &state->errno, sizeof(state->errno));
+    PUT(cursor, (const uint8_t *)&state->micheline + MICHELINE_TAIL_OFS,
+        MICHELINE_TAIL_SIZE);
+    PUT(cursor, (const uint8_t *)&state->operation + OPERATION_TAIL_OFS,
+        OPERATION_TAIL_SIZE);
+    PUT(cursor, state->micheline.stack,
+        header.micheline_depth * sizeof(mv_micheline_parser_frame));
+    PUT(cursor, state->operation.stack,
+        header.operation_depth * sizeof(mv_operation_parser_frame));
+    if (header.has_num) {
+        PUT(cursor, &state->buffers.num, sizeof(state->buffers.num));
+    }
+    PUT(cursor, state->buffers.capture, header.capture_len);
+    if (header.oofs > 0) {
+        PUT(cursor, state->regs.obuf, header.oofs);
+    }
+    if (header.ilen > 0) {
+        PUT(cursor, state->regs.ibuf + state->regs.iofs, header.ilen);
+    }
+    return MV_CONTINUE;
+}
+
+mv_parser_result
+mv_parser_restore(mv_parser_state *state, const uint8_t *buf, size_t len,
+                  char *obuf, size_t olen)
+{
+    mv_parser_snapshot_header   header;
+    const uint8_t              *cursor = buf;
+    mv_operation_parser_frame  *frame;
+    const uint8_t              *origin;
+    size_t                      size;
+
+    if (len < sizeof(header)) {
+        return MV_ERR_INVALID_STATE;
+    }
+    GET(&header, cursor, sizeof(header));
+    size = FIXED_SIZE
+           + (header.micheline_depth * sizeof(mv_micheline_parser_frame))
+           + (header.operation_depth * sizeof(mv_operation_parser_frame))
+           + (header.has_num ? sizeof(mv_num_parser_buffer) : 0)
+           + header.capture_len + header.oofs + header.ilen;
+    if ((len != size) || (header.micheline_depth > MV_MICHELINE_STACK_DEPTH)
+        || (header.operation_depth > MV_OPERATION_STACK_DEPTH)
+        || ((header.capture_len > MV_CAPTURE_BUFFER_SIZE)
+            && (header.capture_len > sizeof(state->buffers.digest)))
+        || (header.oofs > olen)) {
+        return MV_ERR_INVALID_STATE;
+    }
+
+    GET(&state->field_info, cursor, sizeof(state->field_info));
+    GET(&state->ofs, cursor, sizeof(state->ofs));
+    GET(&state->errno, cursor, sizeof(state->errno));
+    GET((uint8_t *)&state->micheline + MICHELINE_TAIL_OFS, cursor,
+        MICHELINE_TAIL_SIZE);
+    GET((uint8_t *)&state->operation + OPERATION_TAIL_OFS, cursor,
+        OPERATION_TAIL_SIZE);
+    GET(state->micheline.stack, cursor,
+        header.micheline_depth * sizeof(mv_micheline_parser_frame));
+    GET(state->operation.stack, cursor,
+        header.operation_depth * sizeof(mv_operation_parser_frame));
+    if (header.has_num) {
+        GET(&state->buffers.num, cursor, sizeof(state->buffers.num));
+    }
+    GET(state->buffers.capture, cursor, header.capture_len);
+
+    state->micheline.frame
+        = header.micheline_depth
+              ? &state->micheline.stack[header.micheline_depth - 1]
+              : NULL;
+    state->operation.frame
+        = header.operation_depth
+              ? &state->operation.stack[header.operation_depth - 1]
+              : NULL;
+
+    // Strings printed from the buffers of the original state
+    origin = (const uint8_t *)header.origin;
+    for (frame = state->operation.stack; frame < state->operation.stack
+                                                     + header.operation_depth;
+         frame++) {
+        const uint8_t *str = (const uint8_t *)frame->step_print.str;
+
+        if (((frame->step == MV_OPERATION_STEP_PRINT)
+             || (frame->step == MV_OPERATION_STEP_PARTIAL_PRINT))
+            && (str >= origin) && (str < origin + sizeof(mv_parser_state))) {
+            frame->step_print.str
+                = (const char *)((uint8_t *)state + (str - origin));
+        }
+    }
+
+    memset(obuf, 0x0, olen);
+    GET(obuf, cursor, header.oofs);
+    state->regs.obuf = obuf;
+    state->regs.oofs = header.oofs;
+    state->regs.olen = olen - header.oofs;
+
+    mv_parser_refill(state, cursor, header.ilen);
+    return MV_CONTINUE;
+}
@@ -21,6 +21,7 @@
 #include "num_state.h"
 #include "micheline_state.h"
 #include "operation_state.h"
+#include "formatting.h"
 
 // Parser buffers and buffer handling registers
 
@@ -69,6 +70,7 @@ typedef enum {
     MV_ERR_TOO_LARGE     = 204,  /// too large data has been found
     MV_ERR_TOO_DEEP      = 205,  /// too deep data has been found
     MV_ERR_INVALID_STATE = 206,  /// parser is in an invalid state
+    MV_ERR_UNEXPECTED    = 207,  /// data does not match the expected one
 } mv_parser_result;
 
 #define MV_IS_BLOCKED(code) \
@@ -95,6 +97,9 @@ typedef struct {
                                               /// parsed
         bool is_field_complex;  /// if the last field parsed is considered
                                 /// too complex for a common user
+        bool is_field_folded;   /// if the last field parsed is only
+                                /// displayed by its size, see
+                                /// `mv_operation_parser_expand`
         int field_index;        /// index of the last field parsed
     } field_info;               /// information of the last field parsed
                                 // common singleton buffers
@@ -103,11 +108,23 @@ typedef struct {
     mv_micheline_state micheline;  /// micheline parser state
     mv_operation_state operation;  /// operation parser state
     struct {
-        mv_num_parser_buffer num;                 /// number parser buffer
-        uint8_t capture[MV_CAPTURE_BUFFER_SIZE];  /// capture buffer is used
-                                                  /// to store string values
+        mv_num_parser_buffer num;  /// number parser buffer
+        union {
+            uint8_t capture[MV_CAPTURE_BUFFER_SIZE];  /// capture buffer is
+                                                      /// used to store
+                                                      /// string values
+            mv_digest_ctx digest;  /// digest of the value read, while it
+                                   /// is not captured
+        };
     } buffers;
     mv_parser_result errno;  /// current parser result
+#ifdef MAVRYK_DEBUG
+    struct {
+        uint8_t micheline;  /// most micheline frames used at once
+        uint8_t operation;  /// most operation frames used at once
+    } max_depth;            /// high-water marks of the stacks, reset by
+                            /// `mv_parser_init`
+#endif
 } mv_parser_state;
 
 /**
@@ -163,6 +180,50 @@ void mv_parser_skip(mv_parser_state *state);
  */
 mv_parser_result mv_parser_put(mv_parser_state *state, char c);
 
+/**
+ * @brief Put as many characters of a string as fit at the end of what
+ *        has been parsed
+ *
+ *        Blocks with `MV_BLO_IM_FULL` if the string does not fit
+ *        entirely, the caller resumes after the `written` first
+ *        characters once the output has been flushed.
+ *
+ * @param state: parser state
+ * @param str: null terminated string
+ * @param written: output number of characters written
+ * @return mv_parser_result: parser result
+ */
+mv_parser_result mv_parser_put_str(mv_parser_state *state, const char *str,
+                                   size_t *written);
+
+/**
+ * @brief Same as `mv_parser_put_str` for the first `len` characters of
+ *        `str`
+ *
+ * @param state: parser state
+ * @param str: characters to put
+ * @param len: number of characters to put
+ * @param written: output number of characters written
+ * @return mv_parser_result: parser result
+ */
+mv_parser_result mv_parser_put_n(mv_parser_state *state, const char *str,
+                                 size_t len, size_t *written);
+
+/**
+ * @brief Put the hexadecimal of as many whole bytes as fit at the end
+ *        of what has been parsed, in uppercase
+ *
+ *        Never blocks: the caller resumes after the bytes put, and only
+ *        splits a byte when the output has room for a single digit.
+ *
+ * @param state: parser state
+ * @param bytes: bytes to put
+ * @param len: number of bytes to put
+ * @return size_t: number of bytes put
+ */
+size_t mv_parser_put_hex(mv_parser_state *state, const uint8_t *bytes,
+                         size_t len);
+
 /**
  * @brief Read a bytes
  *
@@ -172,6 +233,36 @@ mv_parser_result mv_parser_put(mv_parser_state *state, char c);
  */
 mv_parser_result mv_parser_read(mv_parser_state *state, uint8_t *out);
 
+/**
+ * @brief Read up to `len` bytes at once
+ *
+ *        Reads as many bytes as available in the current input
+ *        buffer, blocks only if none is.
+ *
+ * @param state: parser state
+ * @param out: output buffer, at least `len` long
+ * @param len: maximum number of bytes to read
+ * @param read: output number of bytes read
+ * @return mv_parser_result: parser result
+ */
+mv_parser_result mv_parser_read_n(mv_parser_state *state, uint8_t *out,
+                                  size_t len, size_t *read);
+
+/**
+ * @brief Read `len` bytes in place, without copying them
+ *
+ *        Nothing is read if less than `len` bytes remain in the
+ *        current input buffer. `out` is only valid until the next
+ *        refill.
+ *
+ * @param state: parser state
+ * @param out: output pointer to the bytes in the input buffer
+ * @param len: number of bytes to read
+ * @return bool: whether the bytes have been read
+ */
+bool mv_parser_read_in_place(mv_parser_state *state, const uint8_t **out,
+                             size_t len);
+
 /**
  * @brief Peek a bytes
  *
@@ -181,6 +272,72 @@ mv_parser_result mv_parser_read(mv_parser_state *state, uint8_t *out);
  */
 mv_parser_result mv_parser_peek(mv_parser_state *state, uint8_t *out);
 
+/**
+ * @brief Peek all the bytes available in the current input buffer
+ *
+ * @param state: parser state
+ * @param out: output pointer to the bytes in the input buffer
+ * @param len: output number of bytes available, at least 1
+ * @return mv_parser_result: parser result
+ */
+mv_parser_result mv_parser_peek_n(mv_parser_state *state,
+                                  const uint8_t **out, size_t *len);
+
+/**
+ * @brief Skip `len` bytes, which must have been peeked
+ *
+ * @param state: parser state
+ * @param len: number of bytes to skip
+ */
+void mv_parser_skip_n(mv_parser_state *state, size_t len);
+
+// snapshots
+
+/**
+ * @brief Get the size of a snapshot of a parser state
+ *
+ * @param state: parser state
+ * @return size_t: size of the snapshot
+ */
+size_t mv_parser_snapshot_size(const mv_parser_state *state);
+
+/**
+ * @brief Take a snapshot of a parser state
+ *
+ *        Only the live frames of the stacks, the live bytes of the
+ *        capture and number buffers, and the output and input bytes
+ *        pending in the registers are saved. The micheline stack is
+ *        only saved while it is used by the operation parser. The
+ *        snapshot is only meaningful to the same build of the
+ *        parser.
+ *
+ * @param state: parser state
+ * @param buf: output snapshot
+ * @param len: size of `buf`, at least `mv_parser_snapshot_size`
+ * @return mv_parser_result: MV_CONTINUE or MV_ERR_TOO_LARGE
+ */
+mv_parser_result mv_parser_snapshot(const mv_parser_state *state,
+                                    uint8_t *buf, size_t len);
+
+/**
+ * @brief Restore a parser state from a snapshot
+ *
+ *        The pending output is copied to `obuf`, as if flushed. The
+ *        pending input is read from the snapshot itself, which must
+ *        stay valid until the next refill.
+ *
+ * @param state: parser state, may differ from the one of the snapshot
+ * @param buf: snapshot
+ * @param len: size of the snapshot
+ * @param obuf: output buffer
+ * @param olen: length of the output buffer
+ * @return mv_parser_result: MV_CONTINUE or MV_ERR_INVALID_STATE if the
+ *                           snapshot is malformed
+ */
+mv_parser_result mv_parser_restore(mv_parser_state *state,
+                                   const uint8_t *buf, size_t len,
+                                   char *obuf, size_t olen);
+
 // error handling utils
 
 /**
@@ -231,3 +388,20 @@ mv_parser_result mv_parser_set_errno(mv_parser_state *state,
 
 #define mv_continue mv_return(MV_CONTINUE)  /// continue parsing
 #define mv_break    mv_return(MV_BREAK)     /// break parsing
+
+/**
+ * @brief Record the depth reached by the current frame of the stack
+ *        of `parser` (`micheline` or `operation`) in `max_depth`
+ */
+#ifdef MAVRYK_DEBUG
+#define MV_RECORD_DEPTH(state, parser)                                      \
+    do {                                                                    \
+        uint8_t _depth                                                      \
+            = (uint8_t)((state)->parser.frame - (state)->parser.stack + 1); \
+        if ((state)->max_depth.parser < _depth) {                           \
+            (state)->max_depth.parser = _depth;                             \
+        }                                                                   \
+    } while (0)
+#else
+#define MV_RECORD_DEPTH(state, parser)
+#endif
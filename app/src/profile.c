@@ -0,0 +1,112 @@
+/* Tezos Ledger application - Profiling counters
+
+   Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include "profile.h"
+
+#ifdef MAVRYK_PROFILE
+
+#include <stddef.h>
+
+#include "globals.h"
+
+mv_profile_counter_t mv_profile[MV_PROFILE_NB_SECTIONS];
+uint32_t             mv_profile_stack[MV_PROFILE_NB_FLOWS];
+
+/// Byte painted on the free stack
+#define MV_STACK_PAINT 0xA5u
+/// Bytes left unpainted below the frame of the painter, for its callees
+#define MV_STACK_PAINT_MARGIN 64u
+
+static uint8_t          *mv_stack_top  = NULL;  /// Frame of `app_main`
+static mv_profile_flow_t mv_stack_flow = MV_PROFILE_FLOW_OTHER;
+
+/// Lowest address of the stack, just above the canary
+#define MV_STACK_BOTTOM ((uint8_t *)(&app_stack_canary + 1))
+
+/**
+ * @brief Paint the stack from the canary up to below a frame
+ *
+ * @param frame: address in the frame of the caller of the painter
+ */
+static void
+paint(uint8_t *frame)
+{
+    volatile uint8_t *p;
+
+    for (p = MV_STACK_BOTTOM; p < frame - MV_STACK_PAINT_MARGIN; p++) {
+        *p = MV_STACK_PAINT;
+    }
+}
+
+void
+mv_profile_stack_paint(void)
+{
+    uint8_t here;
+
+    mv_stack_top = &here;
+    paint(&here);
+}
+
+void
+mv_profile_stack_record(void)
+{
+    uint8_t  here;
+    uint8_t *p = MV_STACK_BOTTOM;
+    uint32_t depth;
+
+    while ((p < mv_stack_top) && (*p == MV_STACK_PAINT)) {
+        p++;
+    }
+    depth = (uint32_t)(mv_stack_top - p);
+    if (depth > mv_profile_stack[mv_stack_flow]) {
+        mv_profile_stack[mv_stack_flow] = depth;
+    }
+
+    mv_stack_flow = MV_PROFILE_FLOW_OTHER;
+    paint(&here);
+}
+
+void
+mv_profile_stack_flow(void)
+{
+    switch (global.step) {
+    case ST_PROMPT:
+        mv_stack_flow = MV_PROFILE_FLOW_PUBKEY;
+        break;
+    case ST_CLEAR_SIGN:
+        mv_stack_flow = MV_PROFILE_FLOW_CLEAR_SIGN;
+        break;
+    case ST_SUMMARY_SIGN:
+        mv_stack_flow = MV_PROFILE_FLOW_SUMMARY_SIGN;
+        break;
+    case ST_BLIND_SIGN:
+        mv_stack_flow = MV_PROFILE_FLOW_BLIND_SIGN;
+        break;
+    case ST_SWAP_SIGN:
+        mv_stack_flow = MV_PROFILE_FLOW_SWAP_SIGN;
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t
+mv_profile_stack_size(void)
+{
+    return (uint32_t)(mv_stack_top - MV_STACK_BOTTOM);
+}
+
+#endif
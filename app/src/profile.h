@@ -0,0 +1,120 @@
+/* Tezos Ledger application - Profiling counters
+
+   Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Sections of the app profiled when built with `MAVRYK_PROFILE`
+ *
+ *        Apps cannot read a cycle counter, so each section counts its
+ *        calls and the units of work it processed.
+ */
+typedef enum {
+    MV_PROFILE_HASH,     /// Hash of the data to sign, units: bytes
+    MV_PROFILE_PARSE,    /// Operation parser, units: non-blocking steps
+    MV_PROFILE_FORMAT,   /// Formatting of the parsed values, units: bytes
+    MV_PROFILE_UI_PUSH,  /// `mv_ui_stream_push`, units: characters pushed
+    MV_PROFILE_SIGN,     /// Signature of a hash, units: bytes
+    MV_PROFILE_NB_SECTIONS
+} mv_profile_section_t;
+
+/**
+ * @brief Counters of a profiled section
+ *
+ */
+typedef struct {
+    uint32_t calls;  /// Number of times the section has been entered.
+    uint32_t units;  /// Units of work processed by the section.
+} mv_profile_counter_t;
+
+/**
+ * @brief Flows of the app whose stack usage is profiled when built with
+ *        `MAVRYK_PROFILE`
+ *
+ *        The usage of an APDU, from its dispatch to the next command,
+ *        the UI events in between included, is charged to the flow of
+ *        the app at that time.
+ */
+typedef enum {
+    MV_PROFILE_FLOW_OTHER,         /// No review: version, keys fetched...
+    MV_PROFILE_FLOW_PUBKEY,        /// Review of a public key
+    MV_PROFILE_FLOW_CLEAR_SIGN,    /// Clear signing of an operation
+    MV_PROFILE_FLOW_SUMMARY_SIGN,  /// Summary signing of an operation
+    MV_PROFILE_FLOW_BLIND_SIGN,    /// Blind signing of an operation
+    MV_PROFILE_FLOW_SWAP_SIGN,     /// Signing of a swap
+    MV_PROFILE_NB_FLOWS
+} mv_profile_flow_t;
+
+#ifdef MAVRYK_PROFILE
+
+/// Counters of the sections, only reset by `INS_GET_PROFILE`
+extern mv_profile_counter_t mv_profile[MV_PROFILE_NB_SECTIONS];
+
+/// Count a call of `section`
+#define MV_PROFILE_CALL(section) (mv_profile[section].calls++)
+
+/// Count `nb_units` units of work in `section`
+#define MV_PROFILE_UNITS(section, nb_units) \
+    (mv_profile[section].units += (uint32_t)(nb_units))
+
+/// Deepest stack usage of each flow, in bytes below `app_main`
+extern uint32_t mv_profile_stack[MV_PROFILE_NB_FLOWS];
+
+/**
+ * @brief Paint the stack, from the canary to the frame of the caller,
+ *        to later find the deepest address written
+ *
+ *        Only to be called from `app_main`, which the depths are
+ *        relative to.
+ */
+void mv_profile_stack_paint(void);
+
+/**
+ * @brief Charge the deepest stack usage since the last paint to the
+ *        current flow, then paint the stack again
+ *
+ *        Only to be called from `app_main`.
+ */
+void mv_profile_stack_record(void);
+
+/**
+ * @brief Switch the flow charged to the one of the step of the app, if
+ *        it reviews something
+ */
+void mv_profile_stack_flow(void);
+
+/**
+ * @brief Get the stack available below `app_main`
+ *
+ * @return uint32_t: number of bytes between the canary and `app_main`
+ */
+uint32_t mv_profile_stack_size(void);
+
+#define MV_PROFILE_STACK_PAINT()  mv_profile_stack_paint()
+#define MV_PROFILE_STACK_RECORD() mv_profile_stack_record()
+#define MV_PROFILE_STACK_FLOW()   mv_profile_stack_flow()
+
+#else
+
+#define MV_PROFILE_CALL(section)
+#define MV_PROFILE_UNITS(section, nb_units)
+#define MV_PROFILE_STACK_PAINT()
+#define MV_PROFILE_STACK_RECORD()
+#define MV_PROFILE_STACK_FLOW()
+
+#endif
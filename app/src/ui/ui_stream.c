@@ -35,9 +35,45 @@ static void         succ(void);
 static void         change_screen_left(void);
 static void         change_screen_right(void);
 static void         redisplay(void);
+#ifdef MV_UI_STREAM_PREFETCH
+static void         prefetch_screens(void);
+#endif
 
 const bagl_icon_details_t C_icon_rien = {0, 0, 1, NULL, NULL};
 
+#ifndef TARGET_NANOS
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST  '~'
+
+/// Widths in pixels of the printable ASCII glyphs of the regular 11px
+/// font, filled once by `init_glyph_widths`.
+static uint8_t glyph_widths[GLYPH_LAST - GLYPH_FIRST + 1];
+
+static void
+init_glyph_widths(void)
+{
+    char c;
+
+    if (glyph_widths[0] != 0) {
+        return;
+    }
+    for (c = GLYPH_FIRST; c <= GLYPH_LAST; c++) {
+        glyph_widths[c - GLYPH_FIRST] = (uint8_t)bagl_compute_line_width(
+            BAGL_FONT_OPEN_SANS_REGULAR_11px, 0, &c, 1, BAGL_ENCODING_LATIN1);
+    }
+}
+
+static uint8_t
+glyph_width(char c)
+{
+    if ((c >= GLYPH_FIRST) && (c <= GLYPH_LAST)) {
+        return glyph_widths[c - GLYPH_FIRST];
+    }
+    return (uint8_t)bagl_compute_line_width(
+        BAGL_FONT_OPEN_SANS_REGULAR_11px, 0, &c, 1, BAGL_ENCODING_LATIN1);
+}
+#endif
+
 void
 mv_ui_stream_init(void (*cb)(mv_ui_cb_type_t cb_type))
 {
@@ -53,10 +89,57 @@ mv_ui_stream_init(void (*cb)(mv_ui_cb_type_t cb_type))
     s->last          = 0;
 
     ui_strings_init();
+#ifndef TARGET_NANOS
+    init_glyph_widths();
+#endif
 
     FUNC_LEAVE();
 }
 
+#ifdef MV_UI_STREAM_PREFETCH
+void
+mv_ui_stream_set_prefetch(void (*prefetch)(void))
+{
+    G_stream.prefetch = prefetch;
+}
+
+/**
+ * @brief Push the next screens while the current one is displayed.
+ *
+ * The screens ahead must not overwrite the current one, nor the one
+ * before: older screens of the history are dropped until the ring
+ * buffer can hold a full screen.
+ */
+static void
+prefetch_screens(void)
+{
+    mv_ui_stream_t *s = &G_stream;
+    bool            can_fit;
+    int16_t         total;
+
+    MV_PREAMBLE(("current=%d total=%d", s->current, s->total));
+
+    while ((s->prefetch != NULL) && !s->full
+           && ((s->total - s->current) < MV_UI_STREAM_PREFETCH_SCREENS)) {
+        MV_CHECK(ui_strings_can_fit(MV_UI_STREAM_SCREEN_SIZE, &can_fit));
+        while (!can_fit && ((s->last + 1) < s->current)) {
+            MV_CHECK(drop_last_screen());
+            MV_CHECK(ui_strings_can_fit(MV_UI_STREAM_SCREEN_SIZE, &can_fit));
+        }
+        if (!can_fit) {
+            break;
+        }
+        total = s->total;
+        s->prefetch();
+        if ((s->total == total) || (global.step == ST_ERROR)) {
+            break;
+        }
+    }
+
+    MV_POSTAMBLE;
+}
+#endif
+
 static void
 pred(void)
 {
@@ -327,6 +410,13 @@ change_screen_right(void)
     succ();
 
     redisplay();
+#ifdef MV_UI_STREAM_PREFETCH
+    prefetch_screens();
+    if (global.step == ST_ERROR) {
+        global.step = ST_IDLE;
+        ui_home_init();
+    }
+#endif
     MV_POSTAMBLE;
 }
 
@@ -336,6 +426,9 @@ mv_ui_stream_start(void)
     FUNC_ENTER(("void"));
 
     redisplay();
+#ifdef MV_UI_STREAM_PREFETCH
+    prefetch_screens();
+#endif
 
     FUNC_LEAVE();
 }
@@ -351,6 +444,9 @@ mv_ui_stream(void)
     }
 
     redisplay();
+#ifdef MV_UI_STREAM_PREFETCH
+    prefetch_screens();
+#endif
     FUNC_LEAVE();
 }
 
@@ -371,13 +467,18 @@ mv_ui_max_line_chars(const char *value, int length)
     will_fit = se_get_cropped_length(value, will_fit, BAGL_WIDTH,
                                      BAGL_ENCODING_LATIN1);
 #elif defined(HAVE_BAGL)
-    uint8_t width;
-    will_fit++;
-    do {
-        width = bagl_compute_line_width(BAGL_FONT_OPEN_SANS_REGULAR_11px, 0,
-                                        value, --will_fit,
-                                        BAGL_ENCODING_LATIN1);
-    } while (width >= BAGL_WIDTH);
+    uint16_t width = 0;
+    uint8_t  i;
+
+    /* The line width is the sum of the glyph widths: keep the
+     * characters whose cumulated width fits the screen. */
+    for (i = 0; i < will_fit; i++) {
+        if ((width + glyph_width(value[i])) >= BAGL_WIDTH) {
+            break;
+        }
+        width += glyph_width(value[i]);
+    }
+    will_fit = i;
 
     PRINTF("[DEBUG] max_line_width(value: \"%s\", width: %d, will_fit: %d)\n",
            value, width, will_fit);
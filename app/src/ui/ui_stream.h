@@ -45,6 +45,10 @@
 
 #include "ui_strings.h"
 
+/* The history screens are kept rendered in the strings ring buffer.
+ * They cannot be regenerated from parser checkpoints instead: the
+ * operation bytes are hashed and dropped as soon as they are parsed,
+ * and the host only ever sends the next packet. */
 #ifdef TARGET_NANOS
 #define MV_UI_STREAM_HISTORY_SCREENS \
     5  /// Max number of screens in history for nanos
@@ -59,13 +63,35 @@
 #define MV_UI_STREAM_CONTENTS_WIDTH MV_SCREEN_WITDH_FULL_REGULAR_11PX
 #define MV_UI_STREAM_CONTENTS_LINES (MV_SCREEN_LINES_11PX - 1)
 #elif HAVE_NBGL
+#ifdef NB_MAX_LINES_IN_REVIEW
+#define MV_UI_STREAM_REVIEW_LINES NB_MAX_LINES_IN_REVIEW
+#else
+#define MV_UI_STREAM_REVIEW_LINES 9
+#endif
+/* A chunk of value fills the lines of a review page left by its item,
+ * each line holding at least MV_UI_STREAM_CONTENTS_WIDTH characters.
+ * A chunk that does not fit is cut one line at a time by
+ * `mv_ui_stream_pushl`, so that the pages are the same as with chunks
+ * of one line. */
 #define MV_UI_STREAM_CONTENTS_WIDTH 20
-#define MV_UI_STREAM_CONTENTS_LINES 1
+#define MV_UI_STREAM_CONTENTS_LINES (MV_UI_STREAM_REVIEW_LINES - 1)
 #endif
 
 #define MV_UI_STREAM_CONTENTS_SIZE \
     (MV_UI_STREAM_CONTENTS_WIDTH * MV_UI_STREAM_CONTENTS_LINES)
 
+#if defined(HAVE_BAGL) && !defined(TARGET_NANOS)
+/* While the user reads a screen, the next one is pushed ahead, when the
+ * strings ring buffer can hold it while keeping the screen before the
+ * current one. No prefetching on Nano S, whose ring buffer hardly holds
+ * more than the screen displayed. */
+#define MV_UI_STREAM_PREFETCH
+#define MV_UI_STREAM_PREFETCH_SCREENS \
+    1  /// Max number of screens pushed ahead of the current one
+#define MV_UI_STREAM_SCREEN_SIZE \
+    (MV_UI_STREAM_TITLE_WIDTH + MV_UI_STREAM_CONTENTS_SIZE)
+#endif
+
 /**
  * @brief Following #define's specify different "cb_types" which are passed to
  * our callback and it can be used to determine which screen was displayed
@@ -81,7 +107,9 @@
 
 typedef uint8_t mv_ui_cb_type_t;
 #define MV_UI_STREAM_CB_NOCB 0x00u
-#ifdef HAVE_NBGL
+#ifdef HAVE_BAGL
+#define MV_UI_STREAM_CB_EXPAND 0x0Cu
+#else  // HAVE_NBGL
 #define MV_UI_STREAM_CB_SUMMARY 0x0Du
 #endif
 #define MV_UI_STREAM_CB_BLINDSIGN          0x0Eu
@@ -190,6 +218,9 @@ typedef struct {
     bool    full;             // true if history is full.
     bool    pressed_right;    // true if right button was pressed.
     mv_ui_stream_display_t current_screen;  // current screen's values.
+#ifdef MV_UI_STREAM_PREFETCH
+    void (*prefetch)(void);  // callback to push the next screens ahead.
+#endif
 #ifdef HAVE_NBGL
     nbgl_callback_t
         stream_cb;  // callback to be called when new screen is needed.
@@ -198,6 +229,20 @@ typedef struct {
 
 void mv_ui_stream_init(void (*cb)(mv_ui_cb_type_t cb_type));
 
+#ifdef MV_UI_STREAM_PREFETCH
+/**
+ * @brief Set the callback pushing the next screens while the user reads
+ * the current one. It is reset by `mv_ui_stream_init`.
+ *
+ * The callback is called after each display, until
+ * MV_UI_STREAM_PREFETCH_SCREENS screens are ahead, the stream is closed
+ * or the callback pushes nothing.
+ *
+ * @param prefetch: callback, may push screens with `mv_ui_stream_push`
+ */
+void mv_ui_stream_set_prefetch(void (*prefetch)(void));
+#endif
+
 /**
  * @brief  Push title & content to a single screen
  * content may not always fit on screen entirely - returns total
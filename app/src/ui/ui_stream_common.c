@@ -17,6 +17,7 @@
    limitations under the License. */
 #include "exception.h"
 #include "globals.h"
+#include "profile.h"
 #include "ui_strings.h"
 #include "ui_stream.h"
 
@@ -47,7 +48,12 @@ mv_ui_stream_push(mv_ui_cb_type_t cb_type, const char *title,
                   const char *value, mv_ui_layout_type_t layout_type,
                   mv_ui_icon_t icon)
 {
-    return mv_ui_stream_pushl(cb_type, title, value, -1, layout_type, icon);
+    size_t pushed
+        = mv_ui_stream_pushl(cb_type, title, value, -1, layout_type, icon);
+
+    MV_PROFILE_CALL(MV_PROFILE_UI_PUSH);
+    MV_PROFILE_UNITS(MV_PROFILE_UI_PUSH, pushed);
+    return pushed;
 }
 
 mv_ui_cb_type_t
@@ -478,50 +478,67 @@ mv_ui_stream_pushl(mv_ui_cb_type_t cb_type, const char *title,
             s->screens[bucket].cb_type = cb_type;
         }
 
-        char *out = NULL;
-
-        if (append) {
-            bool can_fit = false;
-            ui_strings_can_fit(length, &can_fit);
-            if (!can_fit) {
-                // The lasts item belong to the current screen: We can not
-                // drop, we need to push to the next screen
-                if (s->last == s->total + 1) {
-                    s->total++;
-                    return 0;
+        char  *out  = NULL;
+        size_t pair = append ? (idx - 1) : idx;
+
+        while (true) {
+            if (append) {
+                bool can_fit = false;
+                ui_strings_can_fit(length, &can_fit);
+                if (!can_fit) {
+                    // The lasts item belong to the current screen: We can
+                    // not drop, we need to push to the next screen
+                    if (s->last == s->total + 1) {
+                        s->total++;
+                        return 0;
+                    }
+                    drop_last_screen();
                 }
-                drop_last_screen();
+
+                offset = ui_strings_append_last(value, length, &out);
+            } else {
+                push_str(value, length,
+                         (char **)&s->screens[bucket].pairs[idx].value);
+                offset = length;
             }
 
-            offset = ui_strings_append_last(&value[offset], length, &out);
-            idx--;
-        } else {
-            push_str(&value[offset], length,
-                     (char **)&s->screens[bucket].pairs[idx].value);
-            offset = length;
+            /* Check that the whole screen fits on the page
+             * if it doesn't, we need to pop this pair, and move
+             * to the next screen.
+             */
+            nbgl_layoutTagValueList_t l
+                = {.nbPairs           = pair,
+                   .pairs             = s->screens[bucket].pairs,
+                   .smallCaseForValue = false,
+                   .wrapping          = true};
+
+            uint8_t fit = nbgl_useCaseGetNbTagValuesInPage(
+                (uint8_t)(pair + 1), &l, 0, &push_to_next);
+            PRINTF("[DEBUG] idx=%d fit=%d push_to_next=%d length=%d\n",
+                   pair, fit, push_to_next, length);
+            /*
+             * Dont push to next screen if the number of pairs is one.
+             */
+            push_to_next = (fit <= (uint8_t)pair);
+
+            /* A chunk is up to a page of value: retry with one line of
+             * MV_UI_STREAM_CONTENTS_WIDTH characters less, so that the
+             * page ends where chunks of one line would have ended it,
+             * the rest will start the next page. */
+            if (!push_to_next || (offset == 0)
+                || (length <= MV_UI_STREAM_CONTENTS_WIDTH)) {
+                break;
+            }
+            if (append) {
+                ui_strings_drop_last(&out);
+            } else {
+                ui_strings_drop_last(
+                    (char **)&s->screens[bucket].pairs[idx].value);
+            }
+            length = ((length - 1) / MV_UI_STREAM_CONTENTS_WIDTH)
+                     * MV_UI_STREAM_CONTENTS_WIDTH;
         }
 
-        /* Check that the whole screen fits on the page
-         * if it doesn't, we need to pop this pair, and move
-         * to the next screen.
-         */
-        nbgl_layoutTagValueList_t l = {.nbPairs = idx,
-                                       .pairs   = s->screens[bucket].pairs,
-                                       .smallCaseForValue = false,
-                                       .wrapping          = true};
-
-        /* This returns the number that can fit. Potentially we could
-         * optimistically push all 4 rows, and then try?
-         */
-        uint8_t fit = nbgl_useCaseGetNbTagValuesInPage((uint8_t)(idx + 1), &l,
-                                                       0, &push_to_next);
-        PRINTF("[DEBUG] idx=%d fit=%d push_to_next=%d\n", idx, fit,
-               push_to_next);
-        /*
-         * Dont push to next screen if the number of pairs is one.
-         */
-        push_to_next = (fit <= (uint8_t)idx);
-
         if (push_to_next) {
             /* We need to move to the next screen, retry */
             if (append && (offset > 0)) {
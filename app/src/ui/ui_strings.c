@@ -29,6 +29,10 @@
 #define BUFF_START ((char *)(s->buffer))
 #define BUFF_END   ((char *)(s->buffer) + BUFF_LEN)
 
+/* Index entry of the n-th oldest string */
+#define ENTRY(n) ((s->first + (n)) % UI_STRINGS_MAX_COUNT)
+#define LAST     ENTRY(s->count - 1)
+
 /* Prototypes */
 void   ui_strings_init(void);
 void   ui_strings_push(const char *str, size_t len, char **out);
@@ -57,6 +61,7 @@ ui_strings_init(void)
     s->end          = BUFF_START;
     s->internal_end = BUFF_START;
     s->count        = 0;
+    s->first        = 0;
 }
 
 /* @param len: we want to a string s of strlen(s) == len
@@ -89,6 +94,11 @@ ui_strings_fit_up_to(size_t len, char **write_start)
 
     /* Buffer not empty */
 
+    if (s->count == UI_STRINGS_MAX_COUNT) {
+        /* No index entry left */
+        MV_SUCCEED();
+    }
+
     if (s->start > s->end) {
         *write_start = s->end;
         out_len      = MIN((size_t)(s->start - s->end), len + 1);
@@ -151,6 +161,8 @@ ui_strings_push(const char *in, size_t len, char **out)
 
     strlcpy(ws, in, len + 1);
     s->count++;
+    s->ofs[LAST] = (ui_strings_ofs_t)(ws - BUFF_START);
+    s->len[LAST] = (ui_strings_ofs_t)len;
 
     s->end = ws + len + 1;
 
@@ -179,15 +191,15 @@ ui_strings_drop(char **in)
     MV_ASSERT(EXC_MEMORY_ERROR, (s->start < s->internal_end));
     MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
 
-    size_t len = strlen(*in);
+    size_t len = s->len[s->first];
 
     char *new = *in + len + 1;
     MV_ASSERT(EXC_MEMORY_ERROR, (new <= s->internal_end));
 
-    PRINTF("[DEBUG] zeroing %p (%d) (%s)\n", s->start, len, s->start);
-    memset(s->start, '\0', len);
+    PRINTF("[DEBUG] dropping %p (%d) (%s)\n", s->start, len, s->start);
     *in = NULL;
     s->count--;
+    s->first = (uint8_t)ENTRY(1);
 
     if (new < s->internal_end) {
         s->start = new;
@@ -219,22 +231,26 @@ ui_strings_drop_last(char **in)
 
     /* argument checks */
     MV_ASSERT_NOTNULL(*in);
-
-    size_t len = strlen(*in);
     MV_ASSERT(EXC_MEMORY_ERROR, (!ui_strings_is_empty()));
-    MV_ASSERT(EXC_MEMORY_ERROR, ((*in + len) == (s->end - 1)));
+
+    char  *last = BUFF_START + s->ofs[LAST];
+    size_t len  = (size_t)(s->end - 1 - *in);
+    MV_ASSERT(EXC_MEMORY_ERROR,
+              ((last <= *in) && (*in + len == last + s->len[LAST])));
     /* Internal checks */
     MV_ASSERT(EXC_MEMORY_ERROR, (s->start < s->internal_end));
     MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
 
-    PRINTF("[DEBUG] zeroing %p (%d) (%s)\n", *in, len, *in);
-    memset(*in, '\0', len);
+    PRINTF("[DEBUG] dropping %p (%d) (%s)\n", *in, len, *in);
 
-    if (*in == BUFF_START || *(*in - 1) == '\0') {
+    if (*in == last) {
         s->count--;
         s->end = *in;
     } else {
-        s->end = *in + 1;
+        /* Only drop the chars appended to the last string */
+        **in         = '\0';
+        s->len[LAST] = (ui_strings_ofs_t)(*in - last);
+        s->end       = *in + 1;
     }
 
     *in = NULL;
@@ -284,6 +300,7 @@ ui_strings_append_last(const char *str, size_t max, char **out)
     appended = max - 1;
 
     s->end += appended;
+    s->len[LAST] = (ui_strings_ofs_t)(s->len[LAST] + appended);
 
     if (s->end > s->start) {
         s->internal_end = s->end;
@@ -305,104 +322,20 @@ ui_strings_is_empty(void)
 }
 
 #ifdef MAVRYK_DEBUG
-void
-ui_strings_next(char **p)
-{
-    mv_ui_strings_t *s = UI_STRINGS;
-
-    if (*p >= s->start) {
-        size_t len  = strlen(*p);
-        char  *next = *p + len + 1;
-
-        if (next < s->internal_end) {
-            *p = next;
-        } else if (s->start >= s->end) {
-            *p = BUFF_START;
-        } else {
-            *p = NULL;
-        }
-    } else if (*p < s->end) {
-        size_t len  = strlen(*p);
-        char  *next = *p + len + 1;
-
-        if (next < s->end) {
-            *p = next;
-        } else {
-            *p = NULL;
-        }
-    } else {
-        *p = NULL;
-    }
-}
-
 void
 ui_strings_print(void)
 {
     mv_ui_strings_t *s = UI_STRINGS;
+    size_t           i;
 
-    if (ui_strings_is_empty()) {
-        PRINTF("[DEBUG] START\t\t%p\n[DEBUG] END\t\t%p\n", BUFF_START,
-               BUFF_END);
-        return;
-    }
-
-    if (s->start == BUFF_START) {
-        char *p = s->start;
-        PRINTF("[DEBUG] START\tstart->\t%p %s\n", s->start, s->start);
-        while (true) {
-            ui_strings_next(&p);
-            if (!p) {
-                break;
-            }
-            PRINTF("[DEBUG] \t\t%p %s\n", p, p);
-        }
-        if (s->end < BUFF_END) {
-            PRINTF("[DEBUG] \tend  ->\t%p\n[DEBUG] END\t\t%p\n", s->end,
-                   BUFF_END);
-        } else {
-            PRINTF("[DEBUG] END\tend ->\t%p\n", s->end);
-        }
-    } else if (s->start >= s->end) {
-        char *p = BUFF_START;
-        PRINTF("[DEBUG] START\t\t%p %s\n", p, p);
-        while (true) {
-            ui_strings_next(&p);
-
-            if (!p) {
-                PRINTF("[DEBUG] \tend  ->\t%p\n", s->end);
-                break;
-            }
-            PRINTF("[DEBUG] \t\t%p %s\n", p, p);
-        }
+    PRINTF("[DEBUG] START\t\t%p\n", BUFF_START);
+    for (i = 0; i < s->count; i++) {
+        char *p = BUFF_START + s->ofs[ENTRY(i)];
 
-        p = s->start;
-        PRINTF("[DEBUG] \tstart->\t%p %s\n", p, p);
-        while (true) {
-            ui_strings_next(&p);
-            if (p >= s->start) {
-                PRINTF("[DEBUG] \t\t%p %s\n", p, p);
-            } else {
-                break;
-            }
-        }
-        PRINTF("[DEBUG] END\t\t%p\n", BUFF_END);
-    } else {
-        char *p = s->start;
-        PRINTF("[DEBUG] START\t\t%p\n", BUFF_START);
-        PRINTF("[DEBUG] \tstart->\t%p %s\n", p, p);
-        while (true) {
-            ui_strings_next(&p);
-            if (!p) {
-                break;
-            }
-            PRINTF("[DEBUG] \t\t%p %s\n", p, p);
-        }
-        if (s->end < BUFF_END) {
-            PRINTF("[DEBUG] \tend  ->\t%p\n[DEBUG] END\t\t%p\n", s->end,
-                   BUFF_END);
-        } else {
-            PRINTF("[DEBUG] END\tend ->\t%p\n", s->end);
-        }
+        PRINTF("[DEBUG] \t%s\t%p %s\n", (i == 0) ? "start->" : "", p, p);
     }
+    PRINTF("[DEBUG] \tend  ->\t%p\n[DEBUG] \tint_end->\t%p\n", s->end,
+           s->internal_end);
+    PRINTF("[DEBUG] END\t\t%p\n", BUFF_END);
 }
 #endif
@@ -16,6 +16,10 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * @brief This file implements ring buffer to store the strings to be
  * displayed on the ledger screen. The ring buffer is fixed in size and
@@ -34,6 +38,27 @@
 #define BUFF_LEN 512  /// Ring buffer length for stax
 #endif
 
+/**
+ * @brief Max number of strings in the ring buffer.
+ *
+ * The strings belong to the history screens: a title and the lines of
+ * the body on BAGL, the item-value pairs on NBGL, for each of the
+ * MV_UI_STREAM_HISTORY_SCREENS screens.
+ */
+#ifdef TARGET_NANOS
+#define UI_STRINGS_MAX_COUNT (5 * 2)
+#elif defined(HAVE_BAGL)
+#define UI_STRINGS_MAX_COUNT (8 * 5)
+#else
+#define UI_STRINGS_MAX_COUNT (8 * 8)
+#endif
+
+#if BUFF_LEN <= 256
+typedef uint8_t ui_strings_ofs_t;
+#else
+typedef uint16_t ui_strings_ofs_t;
+#endif
+
 /**
  * @brief This struct represents the ring buffer to store title-value pairs to
  * be displayed on the ledger device screens.
@@ -50,6 +75,11 @@ typedef struct {
     char *internal_end;  /// Actual end of the buffer after which no data is
                          /// present. 0 <= internal_end < BUFF_LEN
     size_t count;        /// Number of strings stored in the buffer
+    uint8_t first;       /// Index entry of the oldest string
+    ui_strings_ofs_t
+        ofs[UI_STRINGS_MAX_COUNT];  /// Offsets of the strings in the buffer,
+                                    /// from the oldest, in a ring.
+    ui_strings_ofs_t len[UI_STRINGS_MAX_COUNT];  /// Lengths of the strings
 } mv_ui_strings_t;
 
 /**
@@ -84,7 +114,8 @@ void ui_strings_drop(char **str);
 void ui_strings_drop_last(char **str);
 /**
  * @brief Checks if the ring buffer can fit the string of length len, without
- * deleting any existing strings.
+ * deleting any existing strings. A string never fits once the buffer holds
+ * UI_STRINGS_MAX_COUNT strings.
  *
  * @param len Length of string.
  * @param can_fit result of the check, true if string can fit, false
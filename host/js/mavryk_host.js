@@ -0,0 +1,79 @@
+// Copyright 2024 Functori <contact@functori.com>
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+// http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// JS binding of the host library of the parser, see mavryk_host.h, over
+// its WebAssembly build (`make wasm`).
+
+'use strict';
+
+const MavrykHostModule = require('./mavryk_host_wasm.js');
+
+const API_VERSION = 1;
+
+const Device = Object.freeze({
+  NANOS: 0,
+  NANOSP: 1,
+  NANOX: 2,
+  STAX: 3,
+  FLEX: 4,
+});
+
+const Review = Object.freeze({
+  CLEAR: 0,
+  SUMMARY: 1,
+  BLIND: 2,
+  REJECT: 3,
+});
+
+// Layout of mv_host_preflight
+const PREFLIGHT_SIZE = 32;
+
+async function load() {
+  const m = await MavrykHostModule();
+  const version = m.cwrap('mv_host_api_version', 'number', [])();
+  if (version !== API_VERSION) {
+    throw new Error(`Unsupported mavryk_host API version ${version}`);
+  }
+  const preflightMessage = m.cwrap(
+    'mv_host_preflight_message', 'number',
+    ['number', 'number', 'number', 'number']);
+  const resultName = m.cwrap('mv_host_result_name', 'string', ['number']);
+
+  // Predict the review of a message (Uint8Array) by the app on a device
+  function preflight(message, device) {
+    const msg = m._malloc(message.length);
+    const out = m._malloc(PREFLIGHT_SIZE);
+    try {
+      m.HEAPU8.set(message, msg);
+      if (preflightMessage(msg, message.length, device, out) !== 0) {
+        throw new Error('Unknown device or message too large');
+      }
+      return {
+        review: m.getValue(out, 'i32'),
+        result: resultName(m.getValue(out + 4, 'i32')),
+        nbScreens: m.getValue(out + 8, 'i32') >>> 0,
+        nbOperations: m.getValue(out + 12, 'i16') & 0xFFFF,
+        totalFee: BigInt.asUintN(64, m.getValue(out + 16, 'i64')),
+        totalAmount: BigInt.asUintN(64, m.getValue(out + 24, 'i64')),
+      };
+    } finally {
+      m._free(msg);
+      m._free(out);
+    }
+  }
+
+  return { preflight };
+}
+
+module.exports = { load, Device, Review, API_VERSION };
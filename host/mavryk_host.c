@@ -0,0 +1,194 @@
+/* Mavryk Embedded C parser for Ledger - Host library
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <stdlib.h>
+
+#include "mavryk_host.h"
+#include "operation_parser.h"
+
+/**
+ * @brief This struct represents the screens of a device
+ */
+typedef struct {
+    size_t   screen_size;  /// MV_UI_STREAM_CONTENTS_SIZE
+    uint32_t max_screens;  /// NB_MAX_SCREEN_ALLOWED, 0 if none
+} mv_host_screens;
+
+/// Screens of each device, indexed by mv_host_device
+static const mv_host_screens mv_host_devices[] = {
+    [MV_HOST_DEVICE_NANOS]  = {19,      20},
+    [MV_HOST_DEVICE_NANOSP] = {19 * 4,  12},
+    [MV_HOST_DEVICE_NANOX]  = {19 * 4,  12},
+    [MV_HOST_DEVICE_STAX]   = {20 * 8,  0 },
+    [MV_HOST_DEVICE_FLEX]   = {20 * 8,  0 },
+};
+
+#define MV_HOST_NB_DEVICES \
+    (sizeof(mv_host_devices) / sizeof(mv_host_devices[0]))
+
+int
+mv_host_api_version(void)
+{
+    return MV_HOST_API_VERSION;
+}
+
+/**
+ * @brief Count the screens of the first packet of a message, in
+ *        lookahead mode, as `lookahead_screens` does on the device
+ *
+ * @param st: parser state
+ * @param msg: message
+ * @param len: length of the message
+ * @param obuf: output buffer, of `screens->screen_size` + 1 bytes
+ * @param screens: screens of the device
+ * @return uint32_t: number of screens, at most `screens->max_screens`
+ */
+static uint32_t
+lookahead_screens(mv_parser_state *st, const uint8_t *msg, size_t len,
+                  char *obuf, const mv_host_screens *screens)
+{
+    size_t packet     = MIN(len, MV_HOST_PACKET_SIZE);
+    size_t nb_screens = 0;
+
+    mv_operation_parser_init(st, MV_UNKNOWN_SIZE, false);
+    mv_operation_parser_set_lookahead(st, true);
+    mv_parser_refill(st, msg, packet);
+    if (packet == len) {
+        mv_operation_parser_set_size(st, (uint16_t)len);
+    }
+    mv_parser_flush(st, obuf, screens->screen_size);
+
+    if (screens->max_screens > 0) {
+        mv_operation_parser_run(st, MV_OPERATION_RUN_AGGREGATE, &nb_screens,
+                                screens->max_screens);
+    }
+    return (uint32_t)nb_screens;
+}
+
+/**
+ * @brief Parse a whole message, in packets and screens, as the device
+ *        reviews it
+ *
+ * @param st: parser state
+ * @param msg: message
+ * @param len: length of the message
+ * @param obuf: output buffer, of `screens->screen_size` + 1 bytes
+ * @param screens: screens of the device
+ * @param preflight: prediction, `nb_screens` and `result` updated
+ */
+static void
+parse_message(mv_parser_state *st, const uint8_t *msg, size_t len,
+              char *obuf, const mv_host_screens *screens,
+              mv_host_preflight *preflight)
+{
+    size_t ofs = 0;
+
+    mv_operation_parser_init(st, MV_UNKNOWN_SIZE, false);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, obuf, screens->screen_size);
+
+    while (true) {
+        switch (
+            mv_operation_parser_run(st, MV_OPERATION_RUN_DISPLAY, NULL, 0)) {
+        case MV_BLO_FEED_ME: {
+            size_t packet = MIN(len - ofs, MV_HOST_PACKET_SIZE);
+
+            if (packet == 0) {
+                // Out of input before the end of the operations
+                preflight->result = MV_ERR_INVALID_STATE;
+                return;
+            }
+            mv_parser_refill(st, msg + ofs, packet);
+            ofs += packet;
+            if (ofs == len) {
+                mv_operation_parser_set_size(st, (uint16_t)len);
+            }
+            break;
+        }
+        case MV_BLO_IM_FULL:
+            preflight->nb_screens++;
+            mv_parser_flush(st, obuf, screens->screen_size);
+            break;
+        case MV_BLO_DONE:
+            if (st->regs.oofs > 0) {
+                preflight->nb_screens++;
+            }
+            preflight->result = MV_BLO_DONE;
+            return;
+        default:
+            preflight->result = st->errno;
+            return;
+        }
+    }
+}
+
+int
+mv_host_preflight_message(const uint8_t *msg, size_t len, int32_t device,
+                          mv_host_preflight *preflight)
+{
+    const mv_host_screens *screens;
+    mv_parser_state       *st;
+    char                  *obuf;
+
+    if ((device < 0) || ((size_t)device >= MV_HOST_NB_DEVICES)
+        || (len >= MV_UNKNOWN_SIZE) || (preflight == NULL)) {
+        return -1;
+    }
+    screens = &mv_host_devices[device];
+
+    st   = malloc(sizeof(mv_parser_state));
+    // zeroed, as `mv_parser_flush` keeps the pending end of the output
+    obuf = calloc(screens->screen_size + 1, 1);
+    if ((st == NULL) || (obuf == NULL)) {
+        free(st);
+        free(obuf);
+        return -1;
+    }
+
+    memset(preflight, 0, sizeof(mv_host_preflight));
+    parse_message(st, msg, len, obuf, screens, preflight);
+    preflight->nb_operations = st->operation.summary.nb_operations;
+    preflight->total_fee     = st->operation.summary.total_fee;
+    preflight->total_amount  = st->operation.summary.total_amount;
+
+    switch (preflight->result) {
+    case MV_BLO_DONE:
+        preflight->review = MV_HOST_REVIEW_CLEAR;
+        if ((screens->max_screens != 0)
+            && (lookahead_screens(st, msg, len, obuf, screens)
+                >= screens->max_screens)) {
+            preflight->review = MV_HOST_REVIEW_SUMMARY;
+        }
+        break;
+    case MV_ERR_TOO_LARGE:
+    case MV_ERR_TOO_DEEP:
+        preflight->review = MV_HOST_REVIEW_BLIND;
+        break;
+    default:
+        preflight->review = MV_HOST_REVIEW_REJECT;
+        break;
+    }
+
+    free(st);
+    free(obuf);
+    return 0;
+}
+
+const char *
+mv_host_result_name(int32_t result)
+{
+    return mv_parser_result_name((mv_parser_result)result);
+}
@@ -0,0 +1,112 @@
+/* Mavryk Embedded C parser for Ledger - Host library
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* The host library is the parser of the app built for the wallet side.
+ * It runs the parser of the device over a whole message to sign, to
+ * predict before talking to the device how the app will review it:
+ * the number of screens, the totals of the summary, and whether the
+ * fields are reviewed in clear, summarized or blind signed.
+ *
+ * The API only uses plain integer types and structs, so that it can be
+ * called from C, from Python with ctypes, and from JS once built to
+ * WebAssembly. Incompatible changes bump MV_HOST_API_VERSION. */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Version of the API, bumped on incompatible changes of the functions
+/// or of `mv_host_preflight`
+#define MV_HOST_API_VERSION 1
+
+/// Size of the packets of the message sent to the device
+#define MV_HOST_PACKET_SIZE 235
+
+/**
+ * @brief Enumeration of the devices whose reviews are predicted
+ */
+typedef enum {
+    MV_HOST_DEVICE_NANOS  = 0,
+    MV_HOST_DEVICE_NANOSP = 1,
+    MV_HOST_DEVICE_NANOX  = 2,
+    MV_HOST_DEVICE_STAX   = 3,
+    MV_HOST_DEVICE_FLEX   = 4
+} mv_host_device;
+
+/**
+ * @brief Enumeration of the reviews of a message by the app
+ */
+typedef enum {
+    MV_HOST_REVIEW_CLEAR   = 0,  /// fields reviewed one by one
+    MV_HOST_REVIEW_SUMMARY = 1,  /// too many screens, only the totals
+                                 /// are reviewed, if blind signing is
+                                 /// enabled
+    MV_HOST_REVIEW_BLIND   = 2,  /// too large or too deep to be parsed,
+                                 /// blind signed if blind signing is
+                                 /// enabled
+    MV_HOST_REVIEW_REJECT  = 3   /// rejected
+} mv_host_review;
+
+/**
+ * @brief This struct represents the prediction of the review of a
+ *        message
+ */
+typedef struct {
+    int32_t  review;         /// mv_host_review
+    int32_t  result;         /// final result of the parser,
+                             /// a mv_parser_result
+    uint32_t nb_screens;     /// screens of the fields displayed in
+                             /// clear
+    uint16_t nb_operations;  /// number of operations
+    uint64_t total_fee;      /// sum of the fees
+    uint64_t total_amount;   /// sum of the amounts
+} mv_host_preflight;
+
+/**
+ * @brief Get the version of the API of the library
+ *
+ * @return int: MV_HOST_API_VERSION of the library
+ */
+int mv_host_api_version(void);
+
+/**
+ * @brief Predict the review of a message by the app
+ *
+ *        The message is parsed as the device parses it, in packets of
+ *        MV_HOST_PACKET_SIZE bytes and in screens of the size of the
+ *        device. As on the device, the summary is chosen when the first
+ *        packet alone needs the maximum number of screens of the
+ *        device, while `nb_screens` counts the screens of the whole
+ *        message.
+ *
+ * @param msg: message to sign, watermark included
+ * @param len: length of the message
+ * @param device: device reviewing the message, a mv_host_device
+ * @param preflight: output prediction
+ * @return int: 0 on success, -1 if the device is unknown or the message
+ *              is too large for the app
+ */
+int mv_host_preflight_message(const uint8_t *msg, size_t len,
+                              int32_t device, mv_host_preflight *preflight);
+
+/**
+ * @brief Get the name of a parser result
+ *
+ * @param result: parser result, as `mv_host_preflight.result`
+ * @return const char*: name of the result
+ */
+const char *mv_host_result_name(int32_t result);
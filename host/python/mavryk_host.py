@@ -0,0 +1,99 @@
+# Copyright 2024 Functori <contact@functori.com>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+# http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Python binding of the host library of the parser, see mavryk_host.h."""
+
+import ctypes
+import os
+from dataclasses import dataclass
+from enum import IntEnum
+from typing import Optional
+
+API_VERSION = 1
+
+
+class Device(IntEnum):
+    """Devices whose reviews are predicted."""
+    NANOS  = 0
+    NANOSP = 1
+    NANOX  = 2
+    STAX   = 3
+    FLEX   = 4
+
+
+class Review(IntEnum):
+    """Reviews of a message by the app."""
+    CLEAR   = 0
+    SUMMARY = 1
+    BLIND   = 2
+    REJECT  = 3
+
+
+class _Preflight(ctypes.Structure):
+    _fields_ = [
+        ("review", ctypes.c_int32),
+        ("result", ctypes.c_int32),
+        ("nb_screens", ctypes.c_uint32),
+        ("nb_operations", ctypes.c_uint16),
+        ("total_fee", ctypes.c_uint64),
+        ("total_amount", ctypes.c_uint64),
+    ]
+
+
+@dataclass
+class Preflight:
+    """Prediction of the review of a message."""
+    review: Review
+    result: str
+    nb_screens: int
+    nb_operations: int
+    total_fee: int
+    total_amount: int
+
+
+class MavrykHost:
+    """Host library of the parser."""
+
+    def __init__(self, path: Optional[str] = None):
+        if path is None:
+            path = os.path.join(os.path.dirname(__file__), "..",
+                                "libmavryk_host.so")
+        self._lib = ctypes.CDLL(path)
+        self._lib.mv_host_api_version.restype = ctypes.c_int
+        self._lib.mv_host_preflight_message.argtypes = [
+            ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int32,
+            ctypes.POINTER(_Preflight)
+        ]
+        self._lib.mv_host_preflight_message.restype = ctypes.c_int
+        self._lib.mv_host_result_name.argtypes = [ctypes.c_int32]
+        self._lib.mv_host_result_name.restype = ctypes.c_char_p
+        version = self._lib.mv_host_api_version()
+        if version != API_VERSION:
+            raise RuntimeError(
+                f"Unsupported mavryk_host API version {version}")
+
+    def preflight(self, message: bytes, device: Device) -> Preflight:
+        """Predict the review of a message by the app on a device."""
+        raw = _Preflight()
+        if self._lib.mv_host_preflight_message(
+                message, len(message), device, ctypes.byref(raw)) != 0:
+            raise ValueError("Unknown device or message too large")
+        return Preflight(
+            review=Review(raw.review),
+            result=self._lib.mv_host_result_name(raw.result).decode(),
+            nb_screens=raw.nb_screens,
+            nb_operations=raw.nb_operations,
+            total_fee=raw.total_fee,
+            total_amount=raw.total_amount,
+        )
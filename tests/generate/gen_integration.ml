@@ -192,7 +192,13 @@ let is_unit_expr lazy_expr =
   let str = Format.asprintf "%a" (pp_node ~wrap:false) (Micheline.root expr) in
   str = "Unit"
 
-let pp_string_binary ppf s = Format.fprintf ppf "%a" Hex.pp (Hex.of_string s)
+(* Binaries longer than [MV_OPERATION_BINARY_DIGEST_SIZE] are displayed
+   by their length and digest *)
+let pp_string_binary ppf s =
+  if String.length s > 128 then
+    Format.fprintf ppf "%d bytes, blake2b %a" (String.length s) Hex.pp
+      (Hex.of_string Mavryk_crypto.Blake2B.(to_string (hash_string [ s ])))
+  else Format.fprintf ppf "%a" Hex.pp (Hex.of_string s)
 
 let pp_serialized_proof ppf proof =
   let proof =
@@ -25,6 +25,7 @@ from ragger.navigator import Navigator, NanoNavigator, TouchNavigator
 
 from utils.account import Account, DEFAULT_ACCOUNT, DEFAULT_SEED
 from utils.backend import MavrykBackend, SpeculosMavrykBackend
+from utils.latency import LatencyBaseline, LatencyRecorder
 from utils.navigator import MavrykNavigator
 
 FIRMWARES: List[Firmware] = [
@@ -68,6 +69,23 @@ def pytest_addoption(parser):
                      type=str,
                      help="App",
                      required=True)
+    parser.addoption("--latency-baseline",
+                     type=Path,
+                     default=Path(__file__).parent / "latency_baseline.json",
+                     help="File of the p95 latencies to compare with")
+    parser.addoption("--latency-threshold",
+                     type=float,
+                     default=1.5,
+                     help="Ratio of the baseline p95 latency that fails a test")
+    parser.addoption("--latency-slack",
+                     type=float,
+                     default=50.0,
+                     help="Milliseconds over the baseline p95 latency always tolerated")
+    parser.addoption("--golden-latency",
+                     action="store_const",
+                     const=True,
+                     default=False,
+                     help="Set the baseline p95 latencies")
 
 @pytest.fixture(scope="session")
 def firmware(pytestconfig) -> Firmware :
@@ -118,13 +136,55 @@ def account(request) -> Account:
     param = getattr(request, "param", None)
     return param.get("account", DEFAULT_ACCOUNT) if param else DEFAULT_ACCOUNT
 
+@pytest.fixture(scope="session")
+def latency_baseline(pytestconfig, firmware: Firmware) -> LatencyBaseline:
+    """Get `latency_baseline` for pytest."""
+    return LatencyBaseline(pytestconfig.getoption("latency_baseline"),
+                           firmware.device)
+
+def latency_key(nodeid: str) -> str:
+    """Key of a test from the root of the python tests."""
+    path, _, name = nodeid.partition("::")
+    parts = Path(path).parts
+    # Remove `tests/integration/python/`
+    test_root = 'python'
+    if test_root in parts:
+        parts = parts[parts.index(test_root) + 1:]
+    return f"{Path(*parts)}::{name}"
+
+def check_latency(request,
+                  recorder: LatencyRecorder,
+                  baseline: LatencyBaseline) -> None:
+    """Report the latencies of the test and compare them to the baseline."""
+    if not recorder.samples:
+        return
+    print(f"Latencies (ms):\n{recorder.report()}")
+    key = latency_key(request.node.nodeid)
+    p95 = recorder.p95()
+    if request.config.getoption("golden_latency"):
+        baseline.update(key, p95)
+        return
+    expected = baseline.get(key)
+    if expected is None:
+        return
+    regressions = LatencyBaseline.regressions(
+        p95,
+        expected,
+        request.config.getoption("latency_threshold"),
+        request.config.getoption("latency_slack")
+    )
+    if regressions:
+        pytest.fail("Latency regression:\n" + "\n".join(regressions))
+
 @pytest.fixture(scope="function")
-def backend(app_path: Path,
+def backend(request,
+            app_path: Path,
             firmware: Firmware,
             port: int,
             display: bool,
             seed: str,
-            speculos_args: List[str]) -> Generator[MavrykBackend, None, None]:
+            speculos_args: List[str],
+            latency_baseline: LatencyBaseline) -> Generator[MavrykBackend, None, None]:
     """Get `backend` for pytest."""
 
     if display:
@@ -140,9 +200,15 @@ def backend(app_path: Path,
                                    firmware,
                                    args=speculos_args)
 
+    backend.latency = LatencyRecorder()
+
     with backend as b:
         yield b
 
+    # Only check the latencies of the tests that passed
+    if not getattr(request.node, "rep_call_failed", False):
+        check_latency(request, backend.latency, latency_baseline)
+
 @pytest.fixture(scope="function")
 def mavryk_navigator(
         backend: MavrykBackend,
@@ -227,6 +293,14 @@ def pytest_runtest_logreport(report):
     """Called at the end of running the runtest protocol for a single test."""
     logs[report.head_line].append(report)
 
+@pytest.hookimpl(hookwrapper=True)
+def pytest_runtest_makereport(item):
+    """Mark the failed tests to skip their latency check."""
+    outcome = yield
+    report = outcome.get_result()
+    if report.when == "call" and report.failed:
+        item.rep_call_failed = True
+
 @pytest.hookimpl(tryfirst=True)
 def pytest_runtest_logfinish(nodeid, location):
     """Called at the end of running the runtest protocol for a single item."""
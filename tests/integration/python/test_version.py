@@ -17,6 +17,7 @@
 """Gathering of tests related to app version."""
 
 import git
+from ragger.firmware import Firmware
 
 from utils.backend import MavrykBackend, Version
 
@@ -54,3 +55,29 @@ def test_git(backend: MavrykBackend):
 
     assert current_commit == app_commit, \
         f"Expected {current_commit} but got {app_commit}"
+
+
+def test_capabilities(backend: MavrykBackend, firmware: Firmware):
+    """Test the packet sizes and the fast signing modes of the app."""
+
+    data = backend.capabilities()
+
+    assert len(data) == 12, \
+        f"Expected 12 bytes but got {data.hex()}"
+
+    version, current, usb, _ble, u2f, modes, batch, nb_staged = data[:8]
+    staged_size = int.from_bytes(data[8:10], 'big')
+    hashed_size = int.from_bytes(data[10:12], 'big')
+
+    assert version == 1, f"Expected version 1 but got {version}"
+    assert current == usb == 255, \
+        f"Expected packets of 255 bytes but got {current} and {usb}"
+    assert u2f == 250, f"Expected U2F packets of 250 bytes but got {u2f}"
+    # blind signing is disabled by default: no pre-hashed mode
+    assert modes == 0x0b, f"Expected modes 0x0b but got {modes:#x}"
+    if firmware == Firmware.NANOS:
+        assert (batch, nb_staged, staged_size, hashed_size) == (4, 0, 0, 0)
+    else:
+        assert batch == 8, f"Expected 8 operations but got {batch}"
+        assert staged_size == nb_staged * 255
+        assert hashed_size == 4 * 255
@@ -183,6 +183,73 @@ def test_wrong_derivation_path(
     with StatusCode.WRONG_LENGTH_FOR_INS.expected():
         sender(backend, account)
 
+@pytest.mark.parametrize("nb_operations", [0, 9], ids=lambda nb: f"nb_operations={nb}")
+def test_wrong_batch_size(backend: MavrykBackend, account: Account, nb_operations: int):
+    """Check wrong number of operations of a batch behaviour"""
+
+    with StatusCode.WRONG_VALUES.expected():
+        backend._exchange(
+            Ins.SIGN_BATCH,
+            index=Index.FIRST,
+            sig_type=account.sig_type,
+            payload=nb_operations.to_bytes(1, 'big') + account.path
+        )
+
+def test_batch_signature_without_batch(backend: MavrykBackend):
+    """Check batch signature request outside of a batch behaviour"""
+
+    with StatusCode.UNEXPECTED_STATE.expected():
+        backend._exchange(Ins.SIGN_BATCH, index=Index.SIGNATURE, sig_type=0)
+
+def test_wrong_capabilities_modes(backend: MavrykBackend):
+    """Check capabilities request of a mode not entered on request behaviour"""
+
+    with StatusCode.WRONG_PARAM.expected():
+        backend.capabilities(modes=0x01)
+
+def test_wrong_public_keys_count(backend: MavrykBackend, account: Account):
+    """Check public keys request of no key behaviour"""
+
+    with StatusCode.WRONG_VALUES.expected():
+        backend._exchange(
+            Ins.GET_PUBLIC_KEYS,
+            index=Index.FIRST,
+            sig_type=account.sig_type,
+            payload=(0).to_bytes(4, 'big') + (0).to_bytes(1, 'big') + account.path
+        )
+
+def test_hash_only_without_blindsign(backend: MavrykBackend, account: Account):
+    """Check hash-only signing without blind signing behaviour"""
+
+    with StatusCode.SECURITY.expected():
+        backend._exchange(
+            Ins.SIGN,
+            index=Index.HASH_ONLY,
+            sig_type=account.sig_type,
+            payload=account.path
+        )
+
+def test_signing_key_without_signing(backend: MavrykBackend, account: Account):
+    """Check additional signing key outside of a signing behaviour"""
+
+    with StatusCode.UNEXPECTED_STATE.expected():
+        backend._exchange(
+            Ins.SIGN,
+            index=Index.KEY,
+            sig_type=account.sig_type,
+            payload=account.path
+        )
+
+def test_sign_hash_without_blindsign(backend: MavrykBackend, account: Account):
+    """Check pre-hashed signing without blind signing behaviour"""
+
+    with StatusCode.SECURITY.expected():
+        backend._exchange(
+            Ins.SIGN_HASH,
+            sig_type=account.sig_type,
+            payload=bytes(32) + account.path
+        )
+
 @pytest.mark.parametrize("class_", [0x00, 0x81])
 def test_wrong_class(backend: MavrykBackend, class_: int):
     """Check wrong apdu class behaviour"""
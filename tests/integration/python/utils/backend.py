@@ -19,7 +19,7 @@ from enum import IntEnum
 from multiprocessing.pool import ThreadPool
 from struct import unpack
 import time
-from typing import Callable, Generator, TypeVar, Union
+from typing import Callable, Generator, Optional, TypeVar, Union
 
 from types import SimpleNamespace
 
@@ -28,6 +28,7 @@ from ragger.backend.interface import BackendInterface, RAPDU
 from ragger.error import ExceptionRAPDU
 
 from .account import Account, SigType
+from .latency import LatencyRecorder
 from .message import Message
 
 
@@ -104,6 +105,10 @@ class Ins(IntEnum):
     QUERY_AUTH_KEY_WITH_CURVE = 0x0d
     HMAC                      = 0x0e
     SIGN_WITH_HASH            = 0x0f
+    SIGN_BATCH                = 0x10
+    GET_PUBLIC_KEYS           = 0x11
+    SIGN_HASH                 = 0x13
+    GET_CAPABILITIES          = 0x14
 
     def __str__(self) -> str:
         return self.name
@@ -115,6 +120,9 @@ class Index(IntEnum):
     OTHER      = 0x01
     LAST       = 0x80
     OTHER_LAST = 0x81
+    SIGNATURE  = 0x02
+    HASH_ONLY  = 0x03
+    KEY        = 0x04
 
     def __str__(self) -> str:
         return self.name
@@ -187,6 +195,17 @@ MAX_APDU_SIZE: int = 235
 class MavrykBackend(BackendInterface):
     """Class representing the backen of the mavryk app."""
 
+    latency: Optional[LatencyRecorder] = None
+
+    @contextmanager
+    def _record_latency(self, kind: str) -> Generator[None, None, None]:
+        """Record the latency of the wrapped block if tracing is enabled."""
+        if self.latency is None:
+            yield
+        else:
+            with self.latency.record(kind):
+                yield
+
     def _exchange(self,
                   ins: Union[Ins, int],
                   index: Union[Index, int] = Index.FIRST,
@@ -199,11 +218,13 @@ class MavrykBackend(BackendInterface):
         # Set to a non-existent value to ensure that p2 is unused
         p2: int = sig_type if sig_type is not None else 0xff
 
-        rapdu: RAPDU = self.exchange(Cla.DEFAULT,
-                                     ins,
-                                     p1=index,
-                                     p2=p2,
-                                     data=payload)
+        ins_name = Ins(ins).name if ins in Ins._value2member_map_ else f"{ins:#04x}"
+        with self._record_latency(f"apdu {ins_name}"):
+            rapdu: RAPDU = self.exchange(Cla.DEFAULT,
+                                         ins,
+                                         p1=index,
+                                         p2=p2,
+                                         data=payload)
 
         if rapdu.status != StatusCode.OK:
             raise ExceptionRAPDU(rapdu.status, rapdu.data)
@@ -218,6 +239,11 @@ class MavrykBackend(BackendInterface):
         """Requests the app version."""
         return self._exchange(Ins.VERSION)
 
+    def capabilities(self, modes: int = 0) -> bytes:
+        """Requests the packet sizes and the fast signing modes.
+        Use `modes` to enter the windowed mode"""
+        return self._exchange(Ins.GET_CAPABILITIES, index=modes, sig_type=0)
+
     def _provide_public_key(self,
                             account: Account,
                             with_prompt: bool = False) -> bytes:
@@ -0,0 +1,128 @@
+# Copyright 2025 Functori <contact@functori.com>
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+
+# http://www.apache.org/licenses/LICENSE-2.0
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Latency tracing of the APDU exchanges and the screen navigations."""
+
+from contextlib import contextmanager
+import fcntl
+import json
+import math
+from pathlib import Path
+import time
+from typing import Dict, Generator, List, Optional
+
+
+def percentile(samples: List[float], rank: float) -> float:
+    """Nearest-rank percentile of non-empty `samples`."""
+    ordered = sorted(samples)
+    index = max(math.ceil(rank / 100 * len(ordered)) - 1, 0)
+    return ordered[index]
+
+
+class LatencyRecorder:
+    """Class recording the latencies of a test.
+
+    Samples are grouped by kind: `apdu <INS>` for the exchanges and
+    `navigation` for the navigation instructions. Latencies are in
+    milliseconds.
+    """
+
+    samples: Dict[str, List[float]]
+
+    def __init__(self):
+        self.samples = {}
+
+    @contextmanager
+    def record(self, kind: str) -> Generator[None, None, None]:
+        """Record the latency of the wrapped block as a `kind` sample."""
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            elapsed = (time.perf_counter() - start) * 1000
+            self.samples.setdefault(kind, []).append(elapsed)
+
+    def p95(self) -> Dict[str, float]:
+        """The p95 latency of each kind."""
+        return {kind: round(percentile(samples, 95), 3)
+                for kind, samples in sorted(self.samples.items())}
+
+    def report(self) -> str:
+        """Report of the latencies of each kind."""
+        lines = [f"{'kind':<32} {'count':>6} {'p50':>10} {'p95':>10} {'max':>10}"]
+        for kind, samples in sorted(self.samples.items()):
+            lines.append(
+                f"{kind:<32} {len(samples):>6} "
+                f"{percentile(samples, 50):>10.1f} "
+                f"{percentile(samples, 95):>10.1f} "
+                f"{max(samples):>10.1f}"
+            )
+        return "\n".join(lines)
+
+
+class LatencyBaseline:
+    """Class representing the checked-in p95 latencies.
+
+    The baseline file maps a device and a test to the p95 latency of
+    each of its kinds.
+    """
+
+    path: Path
+    device: str
+
+    def __init__(self, path: Path, device: str):
+        self.path = path
+        self.device = device
+
+    def _load(self) -> Dict[str, Dict[str, Dict[str, float]]]:
+        if not self.path.exists() or self.path.stat().st_size == 0:
+            return {}
+        with open(self.path, 'r', encoding="utf-8") as reader:
+            return json.load(reader)
+
+    def get(self, test: str) -> Optional[Dict[str, float]]:
+        """The p95 latencies of `test`, if any."""
+        return self._load().get(self.device, {}).get(test)
+
+    def update(self, test: str, p95: Dict[str, float]) -> None:
+        """Set the p95 latencies of `test`.
+
+        The file is locked as tests may run in parallel."""
+        with open(self.path, 'a+', encoding="utf-8") as file:
+            fcntl.flock(file, fcntl.LOCK_EX)
+            file.seek(0)
+            content = file.read()
+            baseline = json.loads(content) if content else {}
+            baseline.setdefault(self.device, {})[test] = p95
+            file.seek(0)
+            file.truncate()
+            json.dump(baseline, file, indent=2, sort_keys=True)
+            file.write("\n")
+
+    @staticmethod
+    def regressions(p95: Dict[str, float],
+                    expected: Dict[str, float],
+                    threshold: float,
+                    slack: float) -> List[str]:
+        """Kinds whose p95 exceeds `threshold` times the expected one.
+
+        `slack` milliseconds are tolerated over the expected p95 to
+        avoid failing on the noise of the fastest kinds."""
+        return [
+            f"{kind}: p95 {latency:.1f}ms > {expected[kind]:.1f}ms"
+            for kind, latency in p95.items()
+            if kind in expected
+            and latency > max(expected[kind] * threshold,
+                              expected[kind] + slack)
+        ]
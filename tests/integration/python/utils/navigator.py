@@ -206,8 +206,16 @@ class MavrykNavigator(metaclass=MetaScreen):
                 MavrykNavInsID.WARNING_CHOICE_BLINDSIGN: self.review_tx.back_to_safety.reject,
             }
             self._navigator._callbacks.update(mavryk_callbacks)
+        self._navigator._run_instruction = self._trace_latency(self._navigator._run_instruction)
         self._root_dir = Path(__file__).resolve().parent.parent
 
+    def _trace_latency(self, run_instruction: Callable):
+        """Wrapper to record the latency of each navigation instruction"""
+        def wrapper(*args, **kwargs):
+            with self._backend._record_latency("navigation"):
+                return run_instruction(*args, **kwargs)
+        return wrapper
+
     def _ignore_processing(self, callback: Callable):
         """Wrapper to ignore the `Proccessing` screen"""
         def wrapper(*args, **kwargs):
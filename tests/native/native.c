@@ -0,0 +1,549 @@
+/* Mavryk Ledger application - Native runner of APDU sequences
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Runs the main loop of the app, `app_main`, on scripts of APDUs,
+   without emulator: the SDK is stubbed by sdk.c and the user is
+   simulated by pressing the buttons whenever a command waits for its
+   response, see `press`.
+
+   A script has one exchange per line, all other lines are ignored:
+     => <command in hex>
+     <= <expected response in hex, status word included>
+   An expected response is optional, the responses are printed instead.
+*/
+
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <io.h>
+#include <ux.h>
+
+#include "app_main.h"
+#include "globals.h"
+
+/// Responses to a command waiting for them before the runner gives up
+#define MAX_PRESSES 10000
+
+/// Maximum length of a response, status word included
+#define MAX_RESPONSE_SIZE IO_APDU_BUFFER_SIZE
+
+/**
+ * @brief This struct represents an exchange of a script
+ */
+typedef struct {
+    uint8_t command[IO_APDU_BUFFER_SIZE];  /// Command
+    size_t  command_len;                   /// Length of the command
+    uint8_t expected[MAX_RESPONSE_SIZE];   /// Expected response
+    int     expected_len;                  /// -1 if none
+    uint8_t response[MAX_RESPONSE_SIZE];   /// Response received
+    size_t  response_len;                  /// Length of the response
+} exchange_t;
+
+/**
+ * @brief This struct represents a script
+ */
+typedef struct {
+    const char *name;          /// File of the script
+    exchange_t *exchanges;     /// Exchanges
+    size_t      nb_exchanges;  /// Number of exchanges
+} script_t;
+
+/**
+ * @brief This struct represents the user simulated
+ */
+typedef struct {
+    bool accept;   /// Accept the reviews, or reject them
+    bool verbose;  /// Print the screens reviewed
+} user_t;
+
+/**
+ * @brief This struct represents a run of the app on a script
+ */
+typedef struct {
+    script_t *script;        /// Script
+    user_t    user;          /// User
+    size_t    nb_commands;   /// Commands sent
+    size_t    nb_responses;  /// Responses received
+    bool      failed;        /// Whether the run failed
+} run_t;
+
+static run_t run;
+
+// IO
+
+void
+io_init(void)
+{
+}
+
+/**
+ * @brief Receive a response, as the SDK writes it in the APDU buffer
+ *
+ * @param data: response, status word included
+ * @param len: length of the response
+ */
+static void
+reply(const uint8_t *data, size_t len)
+{
+    exchange_t *exchange;
+
+    if (run.nb_responses == run.nb_commands) {
+        fprintf(stderr, "[native] %s: response without command\n",
+                run.script->name);
+        run.failed = true;
+        return;
+    }
+    exchange               = &run.script->exchanges[run.nb_responses];
+    exchange->response_len = MIN(len, sizeof(exchange->response));
+    memcpy(exchange->response, data, exchange->response_len);
+    memmove(G_io_apdu_buffer, exchange->response, exchange->response_len);
+    run.nb_responses++;
+}
+
+int
+io_send_response_buffers(const buffer_t *rdatalist, size_t count,
+                         uint16_t sw)
+{
+    uint8_t response[MAX_RESPONSE_SIZE];
+    size_t  len = 0;
+    size_t  i;
+
+    for (i = 0; i < count; i++) {
+        size_t size = rdatalist[i].size - rdatalist[i].offset;
+
+        if ((len + size + 2) > sizeof(response)) {
+            return -1;
+        }
+        memcpy(response + len, rdatalist[i].ptr + rdatalist[i].offset,
+               size);
+        len += size;
+    }
+    U2BE_ENCODE(response, len, sw);
+    reply(response, len + 2);
+    return 0;
+}
+
+int
+io_send_response_pointer(const uint8_t *ptr, size_t size, uint16_t sw)
+{
+    buffer_t buffer = {.ptr = ptr, .size = size, .offset = 0};
+
+    return io_send_response_buffers(&buffer, 1, sw);
+}
+
+int
+io_send_sw(uint16_t sw)
+{
+    return io_send_response_buffers(NULL, 0, sw);
+}
+
+unsigned short
+io_exchange(unsigned char channel_and_flags, unsigned short tx_len)
+{
+    if (!(channel_and_flags & IO_RETURN_AFTER_TX)) {
+        fprintf(stderr, "[native] io_exchange: only transmissions\n");
+        exit(2);
+    }
+    reply(G_io_apdu_buffer, tx_len);
+    return 0;
+}
+
+// User
+
+static void
+print_stream_screen(void)
+{
+    mv_ui_stream_t        *s = &global.ui.stream;
+    mv_ui_stream_screen_t *screen
+        = &s->screens[s->current % MV_UI_STREAM_HISTORY_SCREENS];
+    size_t line;
+
+    fprintf(stderr, "[screen] %s", screen->title ? screen->title : "");
+    for (line = 0; line < screen->body_len; line++) {
+        fprintf(stderr, " | %s", screen->body[line]);
+    }
+    fprintf(stderr, "\n");
+}
+
+/**
+ * @brief Whether the user presses both buttons on a screen of a stream
+ *
+ * @param cb_type: callback of the screen
+ * @return bool: whether the screen is the choice of the user
+ */
+static bool
+is_choice(mv_ui_cb_type_t cb_type)
+{
+    if (run.user.accept) {
+        return (cb_type == MV_UI_STREAM_CB_ACCEPT)
+               || (cb_type == MV_UI_STREAM_CB_VALIDATE)
+               || (cb_type == MV_UI_STREAM_CB_BLINDSIGN);
+    }
+    return (cb_type == MV_UI_STREAM_CB_REJECT)
+           || (cb_type == MV_UI_STREAM_CB_CANCEL)
+           || (cb_type == MV_UI_STREAM_CB_BLINDSIGN_REJECT);
+}
+
+/**
+ * @brief Press a button on a stream: right until the choice of the
+ *        user, or the last screen if the stream only ends with another
+ *        choice, then both
+ *
+ * @return bool: whether a button was pressed
+ */
+static bool
+press_stream(void)
+{
+    mv_ui_stream_t        *s  = &global.ui.stream;
+    button_push_callback_t cb = G_ux.stack[0].button_push_callback;
+    mv_ui_cb_type_t        cb_type;
+    bool                   at_end;
+
+    if (cb == NULL) {
+        return false;
+    }
+    cb_type = s->screens[s->current % MV_UI_STREAM_HISTORY_SCREENS].cb_type;
+    at_end  = s->full && (s->current == s->total);
+    if (run.user.verbose) {
+        print_stream_screen();
+    }
+    if (is_choice(cb_type)
+        || (at_end && (cb_type != MV_UI_STREAM_CB_NOCB))) {
+        cb(BUTTON_EVT_RELEASED | BUTTON_LEFT | BUTTON_RIGHT, 0);
+        return true;
+    }
+    if (at_end) {
+        return false;
+    }
+    cb(BUTTON_EVT_RELEASED | BUTTON_RIGHT, 0);
+    return true;
+}
+
+/**
+ * @brief Press a button on a flow: right until its first action to
+ *        accept, its last one to reject, then both
+ *
+ * @return bool: whether a button was pressed
+ */
+static bool
+press_flow(void)
+{
+    const ux_flow_step_t *const *steps = G_native_flow.steps;
+    const ux_flow_step_t        *step  = steps[G_native_flow.index];
+    bool                         first = true;
+    bool                         last  = true;
+    size_t                       i;
+
+    for (i = 0; i < G_native_flow.index; i++) {
+        first = first && (steps[i]->validate == NULL);
+    }
+    for (i = G_native_flow.index + 1;
+         (steps[i] != FLOW_END_STEP) && (steps[i] != FLOW_LOOP); i++) {
+        last = last && (steps[i]->validate == NULL);
+    }
+    if (run.user.verbose) {
+        fprintf(stderr, "[screen] %s\n", step->name);
+    }
+    if ((step->validate != NULL) && (run.user.accept ? first : last)) {
+        step->validate();
+        return true;
+    }
+    switch ((uintptr_t)steps[G_native_flow.index + 1]) {
+    case (uintptr_t)FLOW_END_STEP:
+        return false;
+    case (uintptr_t)FLOW_LOOP:
+        G_native_flow.index = 0;
+        break;
+    default:
+        G_native_flow.index++;
+        break;
+    }
+    return true;
+}
+
+/**
+ * @brief Press a button of the review, if any
+ *
+ * @return bool: whether a button was pressed
+ */
+static bool
+press(void)
+{
+    if ((global.step == ST_IDLE) || (global.step == ST_ERROR)) {
+        // Nothing to review
+        return false;
+    }
+    if (G_native_flow.steps != NULL) {
+        return press_flow();
+    }
+    return press_stream();
+}
+
+int
+io_recv_command(void)
+{
+    exchange_t *exchange;
+    int         presses = 0;
+
+    while ((run.nb_responses < run.nb_commands) && !run.failed) {
+        if ((presses == MAX_PRESSES) || !press()) {
+            fprintf(stderr, "[native] %s: no response to command %zu\n",
+                    run.script->name, run.nb_commands);
+            run.failed = true;
+        }
+        presses++;
+    }
+    if (run.failed || (run.nb_commands == run.script->nb_exchanges)) {
+        return -1;
+    }
+    exchange = &run.script->exchanges[run.nb_commands];
+    memcpy(G_io_apdu_buffer, exchange->command, exchange->command_len);
+    run.nb_commands++;
+    return (int)exchange->command_len;
+}
+
+// Scripts
+
+/**
+ * @brief Decode an hexadecimal string
+ *
+ * @param hex: string, up to the end of the line
+ * @param out: output
+ * @param size: size of the output
+ * @return int: length decoded, -1 on error
+ */
+static int
+decode_hex(const char *hex, uint8_t *out, size_t size)
+{
+    size_t len = 0;
+
+    while ((*hex != '\0') && (*hex != '\n') && (*hex != '\r')) {
+        unsigned int byte;
+
+        if ((len == size) || (sscanf(hex, "%2x", &byte) != 1)
+            || (hex[1] == '\0')) {
+            return -1;
+        }
+        out[len++] = (uint8_t)byte;
+        hex += 2;
+    }
+    return (int)len;
+}
+
+static void
+print_hex(FILE *f, const char *prefix, const uint8_t *data, size_t len)
+{
+    size_t i;
+
+    fprintf(f, "%s", prefix);
+    for (i = 0; i < len; i++) {
+        fprintf(f, "%02x", data[i]);
+    }
+    fprintf(f, "\n");
+}
+
+/**
+ * @brief Load a script
+ *
+ * @param script: script loaded
+ * @param name: file of the script, "-" for the standard input
+ * @return bool: whether the script is valid
+ */
+static bool
+load_script(script_t *script, const char *name)
+{
+    FILE  *f = (strcmp(name, "-") == 0) ? stdin : fopen(name, "r");
+    char   line[4 * MAX_RESPONSE_SIZE];
+    size_t capacity = 0;
+    int    lineno   = 0;
+
+    if (f == NULL) {
+        perror(name);
+        return false;
+    }
+    memset(script, 0, sizeof(*script));
+    script->name = name;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        exchange_t *exchange;
+        int         len;
+
+        lineno++;
+        if (strncmp(line, "=> ", 3) == 0) {
+            if (script->nb_exchanges == capacity) {
+                capacity          = (capacity == 0) ? 64 : (2 * capacity);
+                script->exchanges = realloc(script->exchanges,
+                                            capacity * sizeof(exchange_t));
+            }
+            exchange = &script->exchanges[script->nb_exchanges++];
+            len      = decode_hex(line + 3, exchange->command,
+                                  sizeof(exchange->command));
+            exchange->command_len  = (size_t)len;
+            exchange->expected_len = -1;
+        } else if ((strncmp(line, "<= ", 3) == 0)
+                   && (script->nb_exchanges > 0)) {
+            exchange = &script->exchanges[script->nb_exchanges - 1];
+            len      = decode_hex(line + 3, exchange->expected,
+                                  sizeof(exchange->expected));
+            exchange->expected_len = len;
+        } else {
+            continue;
+        }
+        if (len < 0) {
+            fprintf(stderr, "%s:%d: invalid hexadecimal\n", name, lineno);
+            return false;
+        }
+    }
+    if (f != stdin) {
+        fclose(f);
+    }
+    return true;
+}
+
+/**
+ * @brief Run the app on a script, from a fresh boot
+ *
+ * @param script: script
+ * @param user: user simulated
+ * @return bool: whether every command received its response
+ */
+static bool
+run_script(script_t *script, user_t user)
+{
+    memset(&run, 0, sizeof(run));
+    run.script = script;
+    run.user   = user;
+    app_main();
+    return !run.failed && (run.nb_responses == script->nb_exchanges);
+}
+
+/**
+ * @brief Check the responses of the last run of a script
+ *
+ * @param script: script
+ * @param print: print the exchanges
+ * @return bool: whether the responses are the expected ones
+ */
+static bool
+check_script(const script_t *script, bool print)
+{
+    bool   ok = true;
+    size_t i;
+
+    for (i = 0; i < run.nb_responses; i++) {
+        const exchange_t *exchange = &script->exchanges[i];
+
+        if (print) {
+            print_hex(stdout, "=> ", exchange->command,
+                      exchange->command_len);
+            print_hex(stdout, "<= ", exchange->response,
+                      exchange->response_len);
+        }
+        if ((exchange->expected_len >= 0)
+            && (((size_t)exchange->expected_len != exchange->response_len)
+                || (memcmp(exchange->expected, exchange->response,
+                           exchange->response_len)
+                    != 0))) {
+            fprintf(stderr, "[native] %s: unexpected response %zu\n",
+                    script->name, i + 1);
+            print_hex(stderr, "  expected ", exchange->expected,
+                      (size_t)exchange->expected_len);
+            print_hex(stderr, "  received ", exchange->response,
+                      exchange->response_len);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static void
+usage(const char *argv0)
+{
+    fprintf(stderr,
+            "Usage: %s [-r] [-e] [-b] [-n RUNS] [-q] [-v] SCRIPT...\n"
+            "  -r       reject the reviews instead of accepting them\n"
+            "  -e       enable the expert mode\n"
+            "  -b       enable the blindsigning\n"
+            "  -n RUNS  run each script RUNS times, and report the "
+            "throughput\n"
+            "  -q       do not print the exchanges\n"
+            "  -v       print the screens reviewed\n"
+            "A SCRIPT \"-\" is read from the standard input.\n",
+            argv0);
+}
+
+int
+main(int argc, char *argv[])
+{
+    user_t          user  = {.accept = true, .verbose = false};
+    long            runs  = 1;
+    bool            quiet = false;
+    bool            ok    = true;
+    size_t          nb_apdus = 0;
+    struct timespec start;
+    struct timespec stop;
+    double          elapsed;
+    int             opt;
+    int             i;
+    long            r;
+
+    while ((opt = getopt(argc, argv, "rebn:qvh")) != -1) {
+        switch (opt) {
+        case 'r': user.accept = false;              break;
+        case 'e': toggle_expert_mode();             break;
+        case 'b': toggle_blindsigning();            break;
+        case 'n': runs = strtol(optarg, NULL, 10);  break;
+        case 'q': quiet = true;                     break;
+        case 'v': user.verbose = true;              break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((optind == argc) || (runs < 1)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = optind; i < argc; i++) {
+        script_t script;
+
+        if (!load_script(&script, argv[i])) {
+            return 2;
+        }
+        for (r = 0; r < runs; r++) {
+            if (!run_script(&script, user)) {
+                ok = false;
+            }
+            if (!check_script(&script, !quiet && (r == 0))) {
+                ok = false;
+            }
+            nb_apdus += run.nb_commands;
+        }
+        free(script.exchanges);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    if (runs > 1) {
+        elapsed = (double)(stop.tv_sec - start.tv_sec)
+                  + ((double)(stop.tv_nsec - start.tv_nsec) / 1e9);
+        fprintf(stderr, "[native] %ld runs, %zu APDUs in %.3fs: %.0f APDU/s\n",
+                runs * (argc - optind), nb_apdus, elapsed,
+                (double)nb_apdus / elapsed);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,601 @@
+/* Mavryk Ledger application - Native SDK stub
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <buffer.h>
+#include <crypto_helpers.h>
+#include <cx.h>
+#include <os.h>
+#include <os_io_seproxyhal.h>
+#include <parser.h>
+#include <ux.h>
+
+// OS
+
+unsigned char   G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+unsigned char   G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
+io_apdu_media_t G_io_apdu_media = IO_APDU_MEDIA_USB_HID;
+unsigned int    app_stack_canary;
+
+void
+native_throw(unsigned int exception)
+{
+    fprintf(stderr, "[native] exception 0x%04X thrown\n", exception);
+    exit(2);
+}
+
+size_t
+strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+
+    if (size > 0) {
+        size_t n = MIN(len, size - 1);
+
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+size_t
+strlcat(char *dst, const char *src, size_t size)
+{
+    size_t len = strnlen(dst, size);
+
+    if (len == size) {
+        return len + strlen(src);
+    }
+    return len + strlcpy(dst + len, src, size - len);
+}
+
+void
+os_sched_exit(int exit_code)
+{
+    exit(exit_code == -1 ? 0 : exit_code);
+}
+
+/**
+ * @brief The settings of the app are constants, in NVM on the device
+ *        and in read-only pages natively: unprotect their pages to
+ *        write them.
+ */
+void
+nvm_write(void *dst, void *src, unsigned int len)
+{
+    uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)dst & ~(page - 1);
+    uintptr_t end   = ((uintptr_t)dst + len + page - 1) & ~(page - 1);
+
+    if (mprotect((void *)start, end - start, PROT_READ | PROT_WRITE) != 0) {
+        perror("[native] nvm_write");
+        exit(2);
+    }
+    memcpy(dst, src, len);
+}
+
+// Buffers
+
+bool
+buffer_can_read(const buffer_t *buffer, size_t n)
+{
+    return (buffer->size - buffer->offset) >= n;
+}
+
+bool
+buffer_seek_cur(buffer_t *buffer, size_t offset)
+{
+    if ((buffer->offset + offset) < buffer->offset
+        || (buffer->offset + offset) > buffer->size) {
+        return false;
+    }
+    buffer->offset += offset;
+    return true;
+}
+
+bool
+buffer_read_u8(buffer_t *buffer, uint8_t *value)
+{
+    if (!buffer_can_read(buffer, 1)) {
+        *value = 0;
+        return false;
+    }
+    *value = buffer->ptr[buffer->offset];
+    buffer->offset++;
+    return true;
+}
+
+bool
+buffer_read_u32(buffer_t *buffer, uint32_t *value, endianness_t endianness)
+{
+    const uint8_t *p;
+
+    if (!buffer_can_read(buffer, 4)) {
+        *value = 0;
+        return false;
+    }
+    p = buffer->ptr + buffer->offset;
+    if (endianness == BE) {
+        *value = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+                 | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+    } else {
+        *value = ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16)
+                 | ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+    }
+    buffer->offset += 4;
+    return true;
+}
+
+/// Maximum length of a BIP32 path read by the SDK
+#define MAX_BIP32_PATH 10
+
+bool
+buffer_read_bip32_path(buffer_t *buffer, uint32_t *out, size_t out_len)
+{
+    size_t i;
+
+    if ((out_len == 0) || (out_len > MAX_BIP32_PATH)
+        || !buffer_can_read(buffer, 4 * out_len)) {
+        return false;
+    }
+    for (i = 0; i < out_len; i++) {
+        buffer_read_u32(buffer, &out[i], BE);
+    }
+    return true;
+}
+
+bool
+apdu_parser(command_t *cmd, uint8_t *buf, size_t buf_len)
+{
+    if ((buf_len < 4) || (buf_len > IO_APDU_BUFFER_SIZE)) {
+        return false;
+    }
+    cmd->cla  = buf[0];
+    cmd->ins  = buf[1];
+    cmd->p1   = buf[2];
+    cmd->p2   = buf[3];
+    cmd->lc   = (buf_len >= 5) ? buf[4] : 0;
+    cmd->data = (buf_len > 5) ? buf + 5 : NULL;
+    return (buf_len <= 5) || ((buf_len - 5) == cmd->lc);
+}
+
+// Hashes
+
+cx_err_t
+cx_blake2b_init_no_throw(cx_blake2b_t *hash, size_t size)
+{
+    if ((size == 0) || (size % 8 != 0) || (size > 8 * MV_BLAKE2B_MAX_SIZE)) {
+        return CX_INVALID_PARAMETER;
+    }
+    hash->header.md = CX_BLAKE2B;
+    mv_blake2b_init(&hash->state, size / 8);
+    return CX_OK;
+}
+
+cx_err_t
+cx_sha256_init_no_throw(cx_sha256_t *hash)
+{
+    hash->header.md = CX_SHA256;
+    digestif_sha256_init(&hash->state);
+    return CX_OK;
+}
+
+cx_err_t
+cx_hash_no_throw(cx_hash_t *hash, uint32_t mode, const uint8_t *in,
+                 size_t len, uint8_t *out, size_t out_len)
+{
+    switch (hash->md) {
+    case CX_BLAKE2B: {
+        cx_blake2b_t *h = (cx_blake2b_t *)hash;
+
+        mv_blake2b_update(&h->state, in, len);
+        if (mode & CX_LAST) {
+            if (out_len < h->state.out_len) {
+                return CX_INVALID_PARAMETER;
+            }
+            mv_blake2b_final(&h->state, out);
+        }
+        return CX_OK;
+    }
+    case CX_SHA256: {
+        cx_sha256_t *h = (cx_sha256_t *)hash;
+
+        digestif_sha256_update(&h->state, (uint8_t *)in, (uint32_t)len);
+        if (mode & CX_LAST) {
+            if (out_len < SHA256_DIGEST_SIZE) {
+                return CX_INVALID_PARAMETER;
+            }
+            digestif_sha256_finalize(&h->state, out);
+        }
+        return CX_OK;
+    }
+    default:
+        return CX_INVALID_PARAMETER;
+    }
+}
+
+/**
+ * @brief Hash the concatenation of two inputs
+ *
+ * @param a: first input
+ * @param a_len: length of the first input
+ * @param b: second input
+ * @param b_len: length of the second input
+ * @param out: digest
+ * @param out_len: length of the digest
+ */
+static void
+hash2(const uint8_t *a, size_t a_len, const uint8_t *b, size_t b_len,
+      uint8_t *out, size_t out_len)
+{
+    mv_blake2b_state state;
+
+    mv_blake2b_init(&state, out_len);
+    mv_blake2b_update(&state, a, a_len);
+    mv_blake2b_update(&state, b, b_len);
+    mv_blake2b_final(&state, out);
+}
+
+cx_err_t
+cx_hmac_sha512_init_no_throw(cx_hmac_sha512_t *hmac, const uint8_t *key,
+                             size_t key_len)
+{
+    if (key_len > sizeof(hmac->key)) {
+        return CX_INVALID_PARAMETER;
+    }
+    hmac->header.md = CX_SHA512;
+    memcpy(hmac->key, key, key_len);
+    hmac->key_len = key_len;
+    return CX_OK;
+}
+
+/**
+ * @brief Only a keyed hash of 64 bytes: the keys are fakes anyway
+ */
+cx_err_t
+cx_hmac_no_throw(cx_hmac_t *hmac, uint32_t mode, const uint8_t *in,
+                 size_t len, uint8_t *mac, size_t mac_len)
+{
+    if (!(mode & CX_LAST) || (mac_len < 64)) {
+        return CX_INVALID_PARAMETER;
+    }
+    hash2(hmac->key, hmac->key_len, in, len, mac, 64);
+    return CX_OK;
+}
+
+// Arithmetic
+
+static const uint8_t secp256k1_order[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFE, 0xBA, 0xAE, 0xDC, 0xE6, 0xAF, 0x48,
+    0xA0, 0x3B, 0xBF, 0xD2, 0x5E, 0x8C, 0xD0, 0x36, 0x41, 0x41,
+};
+
+static const uint8_t secp256r1_order[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xBC, 0xE6, 0xFA, 0xAD, 0xA7, 0x17,
+    0x9E, 0x84, 0xF3, 0xB9, 0xCA, 0xC2, 0xFC, 0x63, 0x25, 0x51,
+};
+
+cx_err_t
+cx_ecdomain_parameter(cx_curve_t cv, cx_curve_dom_param_t id, uint8_t *p,
+                      uint32_t p_len)
+{
+    if ((id != CX_CURVE_PARAM_Order) || (p_len < 32)) {
+        return CX_INVALID_PARAMETER;
+    }
+    switch (cv) {
+    case CX_CURVE_SECP256K1:
+        memcpy(p, secp256k1_order, 32);
+        return CX_OK;
+    case CX_CURVE_SECP256R1:
+        memcpy(p, secp256r1_order, 32);
+        return CX_OK;
+    default:
+        return CX_INVALID_PARAMETER;
+    }
+}
+
+cx_err_t
+cx_math_cmp_no_throw(const uint8_t *a, const uint8_t *b, size_t len,
+                     int *diff)
+{
+    *diff = memcmp(a, b, len);
+    return CX_OK;
+}
+
+cx_err_t
+cx_math_addm_no_throw(uint8_t *r, const uint8_t *a, const uint8_t *b,
+                      const uint8_t *m, size_t len)
+{
+    unsigned int carry = 0;
+    int          borrow;
+    size_t       i;
+
+    for (i = len; i-- > 0;) {
+        carry += (unsigned int)a[i] + b[i];
+        r[i] = (uint8_t)carry;
+        carry >>= 8;
+    }
+    if ((carry == 0) && (memcmp(r, m, len) < 0)) {
+        return CX_OK;
+    }
+    borrow = 0;
+    for (i = len; i-- > 0;) {
+        int d = (int)r[i] - m[i] - borrow;
+
+        borrow = d < 0;
+        r[i]   = (uint8_t)d;
+    }
+    return CX_OK;
+}
+
+bool
+cx_math_is_zero(const uint8_t *a, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (a[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Keys
+
+/// Fake seed of the device
+static const uint8_t native_seed[] = "mavryk native runner seed";
+
+cx_err_t
+os_derive_bip32_with_seed_no_throw(unsigned int   derivation_mode,
+                                   cx_curve_t     curve,
+                                   const uint32_t *path,
+                                   unsigned int   path_len,
+                                   unsigned char  raw_privkey[64],
+                                   unsigned char *chain_code,
+                                   unsigned char *seed, unsigned int seed_len)
+{
+    uint8_t      master[2] = {(uint8_t)derivation_mode, (uint8_t)curve};
+    uint8_t      order[32];
+    uint8_t      data[1 + 32 + 4];
+    uint8_t      digest[64];
+    unsigned int i;
+
+    // Same derivation as the hardened children of keys.c, for all the
+    // indexes: the public keys of a node and of a path agree.
+    hash2(master, sizeof(master), native_seed, sizeof(native_seed), digest,
+          sizeof(digest));
+    for (i = 0; i < path_len; i++) {
+        data[0] = 0x00;
+        memcpy(data + 1, digest, 32);
+        U4BE_ENCODE(data, 1 + 32, path[i]);
+        memcpy(raw_privkey, digest, 32);
+        hash2(digest + 32, 32, data, sizeof(data), digest, sizeof(digest));
+        if (curve != CX_CURVE_Ed25519) {
+            if ((cx_ecdomain_parameter(curve, CX_CURVE_PARAM_Order, order,
+                                       sizeof(order))
+                 != CX_OK)
+                || (memcmp(digest, order, 32) >= 0)) {
+                return CX_INTERNAL_ERROR;
+            }
+            cx_math_addm_no_throw(digest, digest, raw_privkey, order, 32);
+        }
+    }
+    memcpy(raw_privkey, digest, 32);
+    if (chain_code != NULL) {
+        memcpy(chain_code, digest + 32, 32);
+    }
+    return CX_OK;
+}
+
+cx_err_t
+cx_ecfp_init_private_key_no_throw(cx_curve_t curve, const uint8_t *raw_key,
+                                  size_t                     key_len,
+                                  cx_ecfp_256_private_key_t *pvkey)
+{
+    if (key_len != sizeof(pvkey->d)) {
+        return CX_INVALID_PARAMETER;
+    }
+    pvkey->curve = curve;
+    pvkey->d_len = key_len;
+    memcpy(pvkey->d, raw_key, key_len);
+    return CX_OK;
+}
+
+cx_err_t
+cx_ecfp_generate_pair_no_throw(cx_curve_t             curve,
+                               cx_ecfp_public_key_t  *pubkey,
+                               cx_ecfp_private_key_t *privkey,
+                               bool                   keepprivate)
+{
+    uint8_t tag = (uint8_t)curve;
+
+    // Uncompressed point: 0x04 || x || y
+    pubkey->curve = curve;
+    pubkey->W_len = 65;
+    pubkey->W[0]  = 0x04;
+    hash2(&tag, 1, privkey->d, privkey->d_len, pubkey->W + 1, 64);
+    return CX_OK;
+}
+
+cx_err_t
+cx_edwards_compress_point_no_throw(cx_curve_t curve, uint8_t *p,
+                                   size_t p_len)
+{
+    if ((curve != CX_CURVE_Ed25519) || (p_len != 65) || (p[0] != 0x04)) {
+        return CX_INVALID_PARAMETER;
+    }
+    p[0] = 0x02;
+    return CX_OK;
+}
+
+cx_err_t
+bip32_derive_with_seed_init_privkey_256(
+    unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+    size_t path_len, cx_ecfp_256_private_key_t *privkey, uint8_t *chain_code,
+    unsigned char *seed, size_t seed_len)
+{
+    uint8_t  raw_privkey[64];
+    cx_err_t error;
+
+    error = os_derive_bip32_with_seed_no_throw(
+        derivation_mode, curve, path, (unsigned int)path_len, raw_privkey,
+        chain_code, seed, (unsigned int)seed_len);
+    if (error == CX_OK) {
+        error = cx_ecfp_init_private_key_no_throw(curve, raw_privkey, 32,
+                                                  privkey);
+    }
+    explicit_bzero(raw_privkey, sizeof(raw_privkey));
+    return error;
+}
+
+cx_err_t
+bip32_derive_with_seed_get_pubkey_256(
+    unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+    size_t path_len, uint8_t raw_pubkey[65], uint8_t *chain_code,
+    cx_md_t hashID, unsigned char *seed, size_t seed_len)
+{
+    cx_ecfp_256_private_key_t privkey;
+    cx_ecfp_public_key_t      pubkey;
+    cx_err_t                  error;
+
+    error = bip32_derive_with_seed_init_privkey_256(
+        derivation_mode, curve, path, path_len, &privkey, chain_code, seed,
+        seed_len);
+    if (error == CX_OK) {
+        error = cx_ecfp_generate_pair_no_throw(curve, &pubkey, &privkey,
+                                               true);
+        memcpy(raw_pubkey, pubkey.W, pubkey.W_len);
+    }
+    explicit_bzero(&privkey, sizeof(privkey));
+    return error;
+}
+
+// Signatures
+
+cx_err_t
+cx_eddsa_sign_no_throw(const cx_ecfp_private_key_t *pvkey, cx_md_t hashID,
+                       const uint8_t *hash, size_t hash_len, uint8_t *sig,
+                       size_t sig_len)
+{
+    if (sig_len < 64) {
+        return CX_INVALID_PARAMETER;
+    }
+    hash2(pvkey->d, pvkey->d_len, hash, hash_len, sig, 64);
+    return CX_OK;
+}
+
+/// Length of a DER signature with two integers of 32 bytes
+#define DER_SIGNATURE_SIZE (2 + (2 * (2 + 32)))
+
+cx_err_t
+cx_ecdsa_sign_no_throw(const cx_ecfp_private_key_t *pvkey, uint32_t mode,
+                       cx_md_t hashID, const uint8_t *hash, size_t hash_len,
+                       uint8_t *sig, size_t *sig_len, uint32_t *info)
+{
+    uint8_t rs[64];
+
+    if (*sig_len < DER_SIGNATURE_SIZE) {
+        return CX_INVALID_PARAMETER;
+    }
+    hash2(pvkey->d, pvkey->d_len, hash, hash_len, rs, sizeof(rs));
+    // Positive integers of 32 bytes
+    rs[0] &= 0x7F;
+    rs[32] &= 0x7F;
+
+    sig[0] = 0x30;
+    sig[1] = DER_SIGNATURE_SIZE - 2;
+    sig[2] = 0x02;
+    sig[3] = 32;
+    memcpy(sig + 4, rs, 32);
+    sig[4 + 32] = 0x02;
+    sig[5 + 32] = 32;
+    memcpy(sig + 6 + 32, rs + 32, 32);
+    *sig_len = DER_SIGNATURE_SIZE;
+    *info    = (rs[63] & 0x01) ? CX_ECCINFO_PARITY_ODD : 0;
+    return CX_OK;
+}
+
+// BAGL
+
+const bagl_icon_details_t C_icon_back        = {0};
+const bagl_icon_details_t C_icon_back_x      = {0};
+const bagl_icon_details_t C_icon_coggle      = {0};
+const bagl_icon_details_t C_icon_crossmark   = {0};
+const bagl_icon_details_t C_icon_dashboard_x = {0};
+const bagl_icon_details_t C_icon_eye         = {0};
+const bagl_icon_details_t C_icon_go_forbid   = {0};
+const bagl_icon_details_t C_icon_go_left     = {0};
+const bagl_icon_details_t C_icon_go_right    = {0};
+const bagl_icon_details_t C_icon_validate_14 = {0};
+const bagl_icon_details_t C_icon_warning     = {0};
+const bagl_icon_details_t C_mavryk_16px      = {0};
+
+unsigned short
+bagl_compute_line_width(unsigned short font_id, unsigned short width,
+                        const void *text, unsigned char text_length,
+                        unsigned char text_encoding)
+{
+    return (unsigned short)(text_length * NATIVE_GLYPH_WIDTH);
+}
+
+unsigned int
+se_get_cropped_length(const char *text, unsigned int text_length,
+                      unsigned int max_width, unsigned char text_encoding)
+{
+    return MIN(text_length, (max_width - 1) / NATIVE_GLYPH_WIDTH);
+}
+
+// UX
+
+ux_state_t        G_ux;
+bolos_ux_params_t G_ux_params;
+native_ux_flow_t  G_native_flow;
+
+unsigned int
+ux_stack_push(void)
+{
+    G_ux.stack_count = 1;
+    return 0;
+}
+
+void
+native_ux_redisplay(void)
+{
+    G_native_flow.steps = NULL;
+}
+
+void
+ux_flow_init(unsigned int stack_slot, const ux_flow_step_t *const *steps,
+             const ux_flow_step_t *start_step)
+{
+    size_t i;
+
+    G_ux.stack[0].button_push_callback = NULL;
+    G_native_flow.steps                = steps;
+    G_native_flow.index                = 0;
+    for (i = 0; (start_step != NULL) && (steps[i] != FLOW_END_STEP); i++) {
+        if (steps[i] == start_step) {
+            G_native_flow.index = i;
+            break;
+        }
+    }
+}
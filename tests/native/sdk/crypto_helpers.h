@@ -0,0 +1,29 @@
+/* Mavryk Ledger application - Native SDK stub: cryptography helpers
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include "cx.h"
+
+cx_err_t bip32_derive_with_seed_init_privkey_256(
+    unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+    size_t path_len, cx_ecfp_256_private_key_t *privkey, uint8_t *chain_code,
+    unsigned char *seed, size_t seed_len);
+
+cx_err_t bip32_derive_with_seed_get_pubkey_256(
+    unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+    size_t path_len, uint8_t raw_pubkey[65], uint8_t *chain_code,
+    cx_md_t hashID, unsigned char *seed, size_t seed_len);
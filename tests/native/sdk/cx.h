@@ -0,0 +1,152 @@
+/* Mavryk Ledger application - Native SDK stub: cryptography
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include "os.h"
+
+#include "blake2b.h"
+#include "sha256.h"
+
+/* The hashes are the actual ones, so that the hashes displayed and
+   returned are those of the device. The keys and the signatures are
+   only deterministic fakes: they are derived from the path with the
+   hashes above, not from a seed on the curves. */
+
+typedef uint32_t cx_err_t;
+
+#define CX_OK                 0x00000000u
+#define CX_INVALID_PARAMETER  0xFFFFFF97u
+#define CX_INTERNAL_ERROR     0xFFFFFF85u
+
+#define CX_LAST        (1 << 0)
+#define CX_SIGN        (2 << 1)
+#define CX_RND_RFC6979 (3 << 9)
+
+#define CX_ECCINFO_PARITY_ODD 1
+#define CX_ECCINFO_xGTn       2
+
+#define CX_CHECK(call)         \
+    do {                       \
+        error = (call);        \
+        if (error != CX_OK) {  \
+            goto end;          \
+        }                      \
+    } while (0)
+
+typedef enum {
+    CX_NONE,
+    CX_SHA256,
+    CX_SHA512,
+    CX_BLAKE2B,
+} cx_md_t;
+
+typedef enum {
+    CX_CURVE_NONE,
+    CX_CURVE_SECP256K1,
+    CX_CURVE_SECP256R1,
+    CX_CURVE_Ed25519,
+} cx_curve_t;
+
+#define CX_CURVE_256K1 CX_CURVE_SECP256K1
+#define CX_CURVE_256R1 CX_CURVE_SECP256R1
+
+typedef enum {
+    CX_CURVE_PARAM_Order = 6,
+} cx_curve_dom_param_t;
+
+#define HDW_NORMAL         0
+#define HDW_ED25519_SLIP10 1
+
+typedef struct {
+    cx_md_t md;  /// Hash function
+} cx_hash_t;
+
+typedef struct {
+    cx_hash_t        header;  /// Hash function, CX_BLAKE2B
+    mv_blake2b_state state;   /// Native state
+} cx_blake2b_t;
+
+typedef struct {
+    cx_hash_t         header;  /// Hash function, CX_SHA256
+    struct sha256_ctx state;   /// Native state
+} cx_sha256_t;
+
+typedef struct {
+    cx_hash_t header;   /// Hash function, CX_SHA512
+    uint8_t   key[64];  /// Key
+    size_t    key_len;  /// Length of the key
+} cx_hmac_t;
+
+typedef cx_hmac_t cx_hmac_sha512_t;
+
+typedef struct {
+    cx_curve_t curve;  /// Curve of the key
+    size_t     W_len;  /// Length of the key
+    uint8_t    W[65];  /// Public key
+} cx_ecfp_public_key_t;
+
+typedef struct {
+    cx_curve_t curve;  /// Curve of the key
+    size_t     d_len;  /// Length of the key
+    uint8_t    d[32];  /// Private key
+} cx_ecfp_256_private_key_t;
+
+typedef cx_ecfp_256_private_key_t cx_ecfp_private_key_t;
+
+cx_err_t cx_blake2b_init_no_throw(cx_blake2b_t *hash, size_t size);
+cx_err_t cx_sha256_init_no_throw(cx_sha256_t *hash);
+cx_err_t cx_hash_no_throw(cx_hash_t *hash, uint32_t mode, const uint8_t *in,
+                          size_t len, uint8_t *out, size_t out_len);
+
+cx_err_t cx_hmac_sha512_init_no_throw(cx_hmac_sha512_t *hmac,
+                                      const uint8_t *key, size_t key_len);
+cx_err_t cx_hmac_no_throw(cx_hmac_t *hmac, uint32_t mode, const uint8_t *in,
+                          size_t len, uint8_t *mac, size_t mac_len);
+
+cx_err_t cx_ecdomain_parameter(cx_curve_t cv, cx_curve_dom_param_t id,
+                               uint8_t *p, uint32_t p_len);
+cx_err_t cx_math_cmp_no_throw(const uint8_t *a, const uint8_t *b,
+                              size_t len, int *diff);
+cx_err_t cx_math_addm_no_throw(uint8_t *r, const uint8_t *a,
+                               const uint8_t *b, const uint8_t *m,
+                               size_t len);
+bool     cx_math_is_zero(const uint8_t *a, size_t len);
+
+cx_err_t cx_ecfp_init_private_key_no_throw(
+    cx_curve_t curve, const uint8_t *raw_key, size_t key_len,
+    cx_ecfp_256_private_key_t *pvkey);
+cx_err_t cx_ecfp_generate_pair_no_throw(cx_curve_t             curve,
+                                        cx_ecfp_public_key_t  *pubkey,
+                                        cx_ecfp_private_key_t *privkey,
+                                        bool                   keepprivate);
+cx_err_t cx_edwards_compress_point_no_throw(cx_curve_t curve, uint8_t *p,
+                                            size_t p_len);
+
+cx_err_t cx_eddsa_sign_no_throw(const cx_ecfp_private_key_t *pvkey,
+                                cx_md_t hashID, const uint8_t *hash,
+                                size_t hash_len, uint8_t *sig,
+                                size_t sig_len);
+cx_err_t cx_ecdsa_sign_no_throw(const cx_ecfp_private_key_t *pvkey,
+                                uint32_t mode, cx_md_t hashID,
+                                const uint8_t *hash, size_t hash_len,
+                                uint8_t *sig, size_t *sig_len,
+                                uint32_t *info);
+
+cx_err_t os_derive_bip32_with_seed_no_throw(
+    unsigned int derivation_mode, cx_curve_t curve, const uint32_t *path,
+    unsigned int path_len, unsigned char raw_privkey[64],
+    unsigned char *chain_code, unsigned char *seed, unsigned int seed_len);
@@ -0,0 +1,38 @@
+/* Mavryk Ledger application - Native SDK stub: glyphs
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+typedef struct {
+    unsigned int         width;   /// Width in pixels
+    unsigned int         height;  /// Height in pixels
+    unsigned int         bpp;     /// Bits per pixel
+    const unsigned int  *colors;  /// Palette
+    const unsigned char *bitmap;  /// Pixels
+} bagl_icon_details_t;
+
+extern const bagl_icon_details_t C_icon_back;
+extern const bagl_icon_details_t C_icon_back_x;
+extern const bagl_icon_details_t C_icon_coggle;
+extern const bagl_icon_details_t C_icon_crossmark;
+extern const bagl_icon_details_t C_icon_dashboard_x;
+extern const bagl_icon_details_t C_icon_eye;
+extern const bagl_icon_details_t C_icon_go_forbid;
+extern const bagl_icon_details_t C_icon_go_left;
+extern const bagl_icon_details_t C_icon_go_right;
+extern const bagl_icon_details_t C_icon_validate_14;
+extern const bagl_icon_details_t C_icon_warning;
+extern const bagl_icon_details_t C_mavryk_16px;
@@ -0,0 +1,28 @@
+/* Mavryk Ledger application - Native SDK stub: IO
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "buffer.h"
+
+void io_init(void);
+int  io_recv_command(void);
+int  io_send_response_buffers(const buffer_t *rdatalist, size_t count,
+                              uint16_t sw);
+int  io_send_response_pointer(const uint8_t *ptr, size_t size, uint16_t sw);
+int  io_send_sw(uint16_t sw);
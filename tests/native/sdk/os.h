@@ -0,0 +1,80 @@
+/* Mavryk Ledger application - Native SDK stub: OS
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bolos_target.h"
+
+#define PIC(x) ((void *)(x))
+
+#ifdef MAVRYK_DEBUG
+#define PRINTF printf
+#else
+#define PRINTF(...) \
+    do {            \
+    } while (0)
+#endif
+
+/**
+ * @brief Exceptions are not caught natively: report them and stop
+ *
+ * @param exception: exception thrown
+ */
+__attribute__((noreturn)) void native_throw(unsigned int exception);
+
+#define THROW(x) native_throw(x)
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#define ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+#define U2BE_ENCODE(buf, off, value)                \
+    do {                                            \
+        (buf)[(off)]     = (uint8_t)((value) >> 8); \
+        (buf)[(off) + 1] = (uint8_t)(value);        \
+    } while (0)
+
+#define U4BE_ENCODE(buf, off, value)                 \
+    do {                                             \
+        (buf)[(off)]     = (uint8_t)((value) >> 24); \
+        (buf)[(off) + 1] = (uint8_t)((value) >> 16); \
+        (buf)[(off) + 2] = (uint8_t)((value) >> 8);  \
+        (buf)[(off) + 3] = (uint8_t)(value);         \
+    } while (0)
+
+size_t strlcpy(char *dst, const char *src, size_t size);
+size_t strlcat(char *dst, const char *src, size_t size);
+
+void os_sched_exit(int exit_code);
+void nvm_write(void *dst, void *src, unsigned int len);
+
+#define IO_APDU_BUFFER_SIZE         (5 + 255)
+#define IO_SEPROXYHAL_BUFFER_SIZE_B 300
+
+extern unsigned char G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+
+#define CHANNEL_APDU       0x00
+#define IO_RETURN_AFTER_TX 0x20
+
+unsigned short io_exchange(unsigned char channel_and_flags,
+                           unsigned short tx_len);
@@ -0,0 +1,28 @@
+/* Mavryk Ledger application - Native SDK stub: IO over the seproxyhal
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include "os.h"
+
+typedef enum {
+    IO_APDU_MEDIA_NONE,
+    IO_APDU_MEDIA_USB_HID,
+    IO_APDU_MEDIA_BLE,
+    IO_APDU_MEDIA_U2F,
+} io_apdu_media_t;
+
+extern io_apdu_media_t G_io_apdu_media;
@@ -0,0 +1,32 @@
+/* Mavryk Ledger application - Native SDK stub: APDU parser
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint8_t  cla;   /// Instruction class
+    uint8_t  ins;   /// Instruction code
+    uint8_t  p1;    /// Instruction parameter 1
+    uint8_t  p2;    /// Instruction parameter 2
+    uint8_t  lc;    /// Length of command data
+    uint8_t *data;  /// Command data
+} command_t;
+
+bool apdu_parser(command_t *cmd, uint8_t *buf, size_t buf_len);
@@ -0,0 +1,151 @@
+/* Mavryk Ledger application - Native SDK stub: BAGL user experience
+
+   Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#pragma once
+
+#include "os.h"
+
+#include "glyphs.h"
+
+/* Only the state that the app reads and writes is kept: the screens
+   are not drawn, but the native runner presses the buttons through the
+   callbacks registered here, see native.c. */
+
+#define BAGL_WIDTH  128
+#define BAGL_HEIGHT 64
+
+#define BAGL_RECTANGLE 1
+#define BAGL_LABELINE  7
+#define BAGL_ICON      5
+
+#define BAGL_FILL          1
+#define BAGL_GLYPH_NOGLYPH 0
+
+#define BAGL_FONT_OPEN_SANS_EXTRABOLD_11px 8
+#define BAGL_FONT_OPEN_SANS_REGULAR_11px   10
+#define BAGL_FONT_ALIGNMENT_CENTER         0x8000
+
+#define BAGL_ENCODING_LATIN1 0
+
+/// Width in pixels of every glyph: the fonts are not known natively
+#define NATIVE_GLYPH_WIDTH 6
+
+typedef struct {
+    unsigned int   type;
+    unsigned char  userid;
+    short          x;
+    short          y;
+    unsigned short width;
+    unsigned short height;
+    unsigned char  stroke;
+    unsigned char  radius;
+    unsigned char  fill;
+    unsigned int   fgcolor;
+    unsigned int   bgcolor;
+    unsigned short font_id;
+    unsigned char  icon_id;
+} bagl_component_t;
+
+typedef struct {
+    bagl_component_t component;  /// Geometry and style
+    const char      *text;       /// Text, or icon details
+} bagl_element_t;
+
+unsigned short bagl_compute_line_width(unsigned short font_id,
+                                       unsigned short width, const void *text,
+                                       unsigned char text_length,
+                                       unsigned char text_encoding);
+unsigned int   se_get_cropped_length(const char  *text,
+                                     unsigned int text_length,
+                                     unsigned int max_width,
+                                     unsigned char text_encoding);
+
+#define BUTTON_LEFT         1
+#define BUTTON_RIGHT        2
+#define BUTTON_EVT_RELEASED 0x80000000
+
+typedef unsigned int (*button_push_callback_t)(
+    unsigned int button_mask, unsigned int button_mask_counter);
+
+typedef struct {
+    const bagl_element_t *element_array;        /// Elements displayed
+    unsigned int          element_array_count;  /// Number of elements
+} ux_element_array_t;
+
+typedef struct {
+    ux_element_array_t     element_arrays[1];     /// Screen displayed
+    button_push_callback_t button_push_callback;  /// Button handler
+    void                  *screen_before_element_display_callback;
+} ux_stack_slot_t;
+
+typedef struct {
+    unsigned int    stack_count;  /// Number of slots in use
+    ux_stack_slot_t stack[1];     /// Display stack
+} ux_state_t;
+
+typedef struct {
+    unsigned int ux_id;  /// Event
+} bolos_ux_params_t;
+
+extern ux_state_t        G_ux;
+extern bolos_ux_params_t G_ux_params;
+
+unsigned int ux_stack_push(void);
+
+#define UX_WAKE_UP()
+#define UX_REDISPLAY() native_ux_redisplay()
+
+/**
+ * @brief Record that the element array of the stack is displayed,
+ *        instead of a flow
+ */
+void native_ux_redisplay(void);
+
+/* Flows */
+
+typedef struct {
+    void (*validate)(void);  /// Action of both buttons, NULL if none
+    const char *name;        /// Name of the step
+} ux_flow_step_t;
+
+#define FLOW_LOOP     ((const ux_flow_step_t *)(uintptr_t)0xFFFFFFFEu)
+#define FLOW_END_STEP ((const ux_flow_step_t *)(uintptr_t)0xFFFFFFFFu)
+
+#define UX_STEP_NOCB(stepname, layoutkind, ...) \
+    const ux_flow_step_t stepname = {NULL, #stepname}
+
+#define UX_STEP_CB(stepname, layoutkind, validate_cb, ...) \
+    static void stepname##_validate(void)                  \
+    {                                                      \
+        validate_cb;                                       \
+    }                                                      \
+    const ux_flow_step_t stepname = {stepname##_validate, #stepname}
+
+#define UX_FLOW(flowname, ...) \
+    const ux_flow_step_t *const flowname[] = {__VA_ARGS__, FLOW_END_STEP}
+
+void ux_flow_init(unsigned int stack_slot, const ux_flow_step_t *const *steps,
+                  const ux_flow_step_t *start_step);
+
+/**
+ * @brief This struct represents the flow displayed, if any
+ */
+typedef struct {
+    const ux_flow_step_t *const *steps;  /// Steps, NULL if no flow
+    size_t                       index;  /// Step displayed
+} native_ux_flow_t;
+
+extern native_ux_flow_t G_native_flow;
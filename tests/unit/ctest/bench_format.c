@@ -0,0 +1,331 @@
+/* Copyright 2023 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Benchmark of the number formatters against the byte-by-byte carry
+ * loops they replaced, of the base58check formatter against its
+ * previous hashing, and of the amount formatter against the previous
+ * formatting through a decimal string.
+ *
+ * Each formatter is run on random inputs of the sizes met while
+ * parsing operations, and its output is checked against the
+ * reference one.
+ *
+ * Usage: ./bench_format [iterations] */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "formatting.h"
+
+#define DEFAULT_ITERATIONS 100000
+#define NB_INPUTS          64
+#define MAX_INPUT_SIZE     64
+
+struct sha256_ctx {
+    uint64_t sz;
+    uint8_t  buf[128];
+    uint32_t h[8];
+};
+
+extern void digestif_sha256_init(struct sha256_ctx *ctx);
+extern void digestif_sha256_update(struct sha256_ctx *ctx, uint8_t *data,
+                                   uint32_t size);
+extern void digestif_sha256_finalize(struct sha256_ctx *ctx, uint8_t *out);
+
+typedef int (*formatter_t)(const uint8_t *, size_t, char *, size_t);
+
+typedef struct {
+    const char *name;
+    size_t      size;
+    formatter_t format;
+    formatter_t reference;
+} bench_case_t;
+
+static const char b58digits_ordered[]
+    = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+/* Previous `mv_format_base58`, without the leading zeros handling. */
+static int
+reference_base58(const uint8_t *n, size_t l, char *obuf, size_t olen)
+{
+    int    carry;
+    size_t i, j, high, obuf_len = MV_BASE58_BUFFER_SIZE(l);
+
+    if (olen < obuf_len) {
+        return 1;
+    }
+
+    memset(obuf, 0, obuf_len);
+
+    for (i = 0, high = obuf_len - 1; i < l; ++i, high = j) {
+        carry = n[i];
+        for (j = obuf_len - 1; ((int)j >= 0) && ((j > high) || carry); --j) {
+            carry += 256 * obuf[j];
+            obuf[j] = (char)(carry % 58);
+            carry /= 58;
+        }
+    }
+
+    for (j = 0; !obuf[j]; ++j) {
+        // Find the last index of obuf
+    }
+    for (i = 0; j < obuf_len; ++i, ++j) {
+        obuf[i] = b58digits_ordered[(unsigned)obuf[j]];
+    }
+    obuf[i] = '\0';
+    return 0;
+}
+
+/* Previous `mv_format_decimal`. */
+static int
+reference_decimal(const uint8_t *n, size_t l, char *obuf, size_t olen)
+{
+    int    carry;
+    size_t i, j, high, zcount = 0, obuf_len = MV_DECIMAL_BUFFER_SIZE(l);
+
+    if (olen < obuf_len) {
+        return 1;
+    }
+
+    memset(obuf, 0, obuf_len);
+
+    while ((zcount < l) && !n[l - zcount - 1]) {
+        ++zcount;
+    }
+
+    if (zcount == l) {
+        obuf[0] = '0';
+        return 0;
+    }
+
+    for (i = zcount, high = obuf_len - 1; i < l; ++i, high = j) {
+        carry = n[l - i - 1];
+        for (j = obuf_len - 1; ((int)j >= 0) && ((j > high) || carry); --j) {
+            carry += 256 * obuf[j];
+            obuf[j] = (char)(carry % 10);
+            carry /= 10;
+        }
+    }
+
+    for (j = 0; !obuf[j]; ++j) {
+        // Find the last index of obuf
+    }
+    for (i = 0; j < obuf_len; ++i, ++j) {
+        obuf[i] = (char)('0' + obuf[j]);
+    }
+    obuf[i] = '\0';
+    return 0;
+}
+
+/* Previous sha256 of `mv_format_base58check`, through a copy. */
+static void
+reference_sha256(uint8_t *data, size_t size, uint8_t *out)
+{
+    struct sha256_ctx ctx;
+    uint8_t           res[32];
+
+    digestif_sha256_init(&ctx);
+    digestif_sha256_update(&ctx, data, size);
+    digestif_sha256_finalize(&ctx, res);
+    memcpy(out, res, 32);
+}
+
+/* Previous `mv_format_base58check` of the "mv1" prefix. */
+static int
+reference_base58check(const uint8_t *n, size_t l, char *obuf, size_t olen)
+{
+    uint8_t prepared[64] = {0x05, 0xBA, 0xC4};
+    uint8_t tmp[32];
+
+    if (l != 20) {
+        return 1;
+    }
+    memcpy(prepared + 3, n, l);
+    reference_sha256(prepared, l + 3, tmp);
+    reference_sha256(tmp, 32, tmp);
+    memcpy(prepared + l + 3, tmp, 4);
+    return mv_format_base58(prepared, l + 7, obuf, olen);
+}
+
+static int
+format_base58check(const uint8_t *n, size_t l, char *obuf, size_t olen)
+{
+    return mv_format_base58check_prefix(MV_B58_PREFIX_MV1, n, l, obuf, olen);
+}
+
+/* Previous amount formatting: `mv_format_decimal`, then shifting the
+ * digits to insert the decimal point. */
+static int
+reference_mumav(const uint8_t *n, size_t l, char *str, size_t olen)
+{
+    int len = 0;
+    int i;
+
+    if ((olen < MV_DECIMAL_BUFFER_SIZE(l)) || (olen < 8)
+        || mv_format_decimal(n, l, str, olen)) {
+        return 1;
+    }
+    len = (int)strlen(str);
+    if (len < 7) {
+        int pad = 7 - len;
+        for (i = len; i >= 0; i--) {
+            str[i + pad] = str[i];
+        }
+        for (i = 0; i < pad; i++) {
+            str[i] = '0';
+        }
+        len = 7;
+    }
+    int no_decimals = 1;
+    for (i = 0; i < 6; i++) {
+        no_decimals &= (str[len - 1 - i] == '0');
+    }
+    if (no_decimals) {
+        str[len - 6] = 0;
+    } else {
+        for (i = 0; i < 6; i++) {
+            str[len - i] = str[len - i - 1];
+        }
+        str[len - 6] = '.';
+        len++;
+        str[len] = 0;
+        while (str[len - 1] == '0') {
+            len--;
+            str[len] = 0;
+        }
+    }
+    return 0;
+}
+
+static int
+format_mumav(const uint8_t *n, size_t l, char *obuf, size_t olen)
+{
+    uint64_t amount = 0;
+    size_t   i;
+
+    for (i = l; i > 0; i--) {
+        amount = (amount << 8) | n[i - 1];
+    }
+    return mv_format_mumav(amount, obuf, olen);
+}
+
+static const bench_case_t cases[] = {
+    {"base58", 21, mv_format_base58, reference_base58},
+    {"base58", 33, mv_format_base58, reference_base58},
+    {"base58", 36, mv_format_base58, reference_base58},
+    {"decimal", 8, mv_format_decimal, reference_decimal},
+    {"decimal", 16, mv_format_decimal, reference_decimal},
+    {"decimal", 32, mv_format_decimal, reference_decimal},
+    {"base58check", 20, format_base58check, reference_base58check},
+    {"mumav", 4, format_mumav, reference_mumav},
+    {"mumav", 8, format_mumav, reference_mumav},
+};
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/**
+ * @brief Time a formatter on a set of inputs
+ *
+ * @param format: formatter to time
+ * @param inputs: inputs of the formatter
+ * @param size: size of each input
+ * @param iterations: number of runs over the whole set of inputs
+ * @return double: average time of a call in nanoseconds
+ */
+static double
+time_formatter(formatter_t format, uint8_t inputs[][MAX_INPUT_SIZE],
+               size_t size, size_t iterations)
+{
+    char   obuf[MV_BASE58_BUFFER_SIZE(MAX_INPUT_SIZE) * 2];
+    double start = now();
+    size_t i;
+    size_t k;
+
+    for (i = 0; i < iterations; i++) {
+        for (k = 0; k < NB_INPUTS; k++) {
+            format(inputs[k], size, obuf, sizeof(obuf));
+        }
+    }
+    return (now() - start) * 1e9 / (double)(iterations * NB_INPUTS);
+}
+
+int
+main(int argc, const char *argv[])
+{
+    static uint8_t inputs[NB_INPUTS][MAX_INPUT_SIZE];
+    size_t         iterations = DEFAULT_ITERATIONS;
+    size_t         c;
+    size_t         i;
+    size_t         k;
+
+    if (argc > 1) {
+        iterations = strtoul(argv[1], NULL, 10);
+    }
+    if (iterations == 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    srand(42);
+    printf("iterations: %zu, inputs: %d\n", iterations, NB_INPUTS);
+    printf("%-16s %6s %14s %14s %8s\n", "formatter", "bytes", "ns/call",
+           "reference", "speedup");
+
+    for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        const bench_case_t *bench_case = &cases[c];
+        double              t_format;
+        double              t_reference;
+
+        for (k = 0; k < NB_INPUTS; k++) {
+            char obuf[MV_BASE58_BUFFER_SIZE(MAX_INPUT_SIZE) * 2];
+            char expected[MV_BASE58_BUFFER_SIZE(MAX_INPUT_SIZE) * 2];
+
+            for (i = 0; i < bench_case->size; i++) {
+                inputs[k][i] = (uint8_t)rand();
+            }
+            // Like the base58check prefixes, never start with 0
+            inputs[k][0] |= 1;
+
+            if (bench_case->format(inputs[k], bench_case->size, obuf,
+                                   sizeof(obuf))
+                || bench_case->reference(inputs[k], bench_case->size,
+                                         expected, sizeof(expected))
+                || strcmp(obuf, expected)) {
+                fprintf(stderr, "%s: '%s' expected '%s'\n", bench_case->name,
+                        obuf, expected);
+                return EXIT_FAILURE;
+            }
+        }
+
+        t_format    = time_formatter(bench_case->format, inputs,
+                                     bench_case->size, iterations);
+        t_reference = time_formatter(bench_case->reference, inputs,
+                                     bench_case->size, iterations);
+        printf("%-16s %6zu %14.1f %14.1f %7.2fx\n", bench_case->name,
+               bench_case->size, t_format, t_reference,
+               t_reference / t_format);
+    }
+
+    return EXIT_SUCCESS;
+}
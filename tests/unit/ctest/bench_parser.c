@@ -0,0 +1,287 @@
+/* Copyright 2023 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Throughput benchmark of the operation parser.
+ *
+ * Every operation of the corpus is fed to `mv_operation_parser_step`
+ * in chunks of `MAX_APDU_SIZE` bytes, as `handle_data_apdu_clear`
+ * does on the device, and the output is flushed in screens of
+ * `olen` characters.
+ *
+ * Usage: ./bench_parser [iterations] [olen] */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "operation_parser.h"
+
+#define MAX_APDU_SIZE      235
+#define DEFAULT_ITERATIONS 2000
+#define DEFAULT_OLEN       50
+#define BATCH_SIZE         20
+#define BRANCH_HEX_LEN     66  // watermark + 32 bytes branch
+
+typedef struct {
+    const char *name;
+    const char *hex;
+    size_t      repeat;  /// number of times the contents (without the
+                         /// branch) is repeated to build a batch
+} bench_case_t;
+
+typedef struct {
+    size_t   bytes;
+    uint64_t steps;
+    uint64_t fields;
+    uint64_t feed_me;
+    uint64_t im_full;
+    double   seconds;
+} bench_stats_t;
+
+static const bench_case_t corpus[] = {
+    {"proposals",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "0500ffdd6102321bc251e4a5190ad5b12b251069d9b400000020000000400bcd7b"
+     "2cadcd87ecb0d5c50330fb59feed7432bffecede8a09a2b86cfb33847b0bcd7b2c"
+     "adcd87ecb0d5c50330fb59feed7432bffecede8a09a2b86dac301a2d",
+     1},
+    {"reveal",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "6b00ffdd6102321bc251e4a5190ad5b12b251069d9b4904e02030400747884d9ab"
+     "df16b3ab745158925f567e222f71225501826fa83347f6cbe9c393",
+     1},
+    {"transaction",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+     "0000000000000000000000000000000000000000",
+     1},
+    {"transaction_batch",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+     "0000000000000000000000000000000000000000",
+     BATCH_SIZE},
+    {"call",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "6c01f6552df4f5ff51c3d13347cab045cfdb8b9bd803c0b8020031020000012bad"
+     "922d045c068660fabe19576f8506a1fa8fa3ff090000001007070080a4e8030707"
+     "0080b48913030b",
+     1},
+    {"origination",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "6d00ffdd6102321bc251e4a5190ad5b12b251069d9b4904e020304a0c21e000000"
+     "0002037a0000000a07650100000001310002",
+     1},
+    {"delegation",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "6e01774d99da021b92d8c3dfc2e814c7658440319be2c09a0cf40509f906ff0059"
+     "1e842444265757d6a65e3670ca18b5e662f9c0",
+     1},
+    {"transfer_ticket",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "9e00ffdd6102321bc251e4a5190ad5b12b251069d9b4904e02030400000002037a"
+     "0000000a076501000000013100020000ffdd6102321bc251e4a5190ad5b12b2510"
+     "69d9b4010100000000000000000000000000000000000000000000000007646566"
+     "61756c74",
+     1},
+    {"sc_rollup_originate",
+     "030000000000000000000000000000000000000000000000000000000000000000"
+     "c800ffdd6102321bc251e4a5190ad5b12b251069d9b4904e02030400000000c639"
+     "663039663239353264333435323863373333663934363135636663333962633535"
+     "353631396663353530646434613637626132323038636538653836376161336431"
+     "336136656639396466626533326336393734616139613231353064323165636132"
+     "396333333439653539633133623930383166316331316234343061633464333435"
+     "356465646265346565306465313561386166363230643463383632343764396431"
+     "333264653162623664613233643566663964386466666461323262613961383400"
+     "00000a07070100000001310002ff0000003f00ffdd6102321bc251e4a5190ad5b1"
+     "2b251069d9b401f6552df4f5ff51c3d13347cab045cfdb8b9bd8030278eb8b6ab9"
+     "a768579cd5146b480789650c83f28e",
+     1},
+};
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/**
+ * @brief Decode the hex operation of a bench case
+ *
+ *        The contents following the branch are repeated
+ *        `bench_case->repeat` times.
+ *
+ * @param bench_case: bench case to decode
+ * @param len: output length of the decoded operation
+ * @return uint8_t*: decoded operation, to be freed by the caller
+ */
+static uint8_t *
+decode_case(const bench_case_t *bench_case, size_t *len)
+{
+    const char *contents     = bench_case->hex + BRANCH_HEX_LEN;
+    size_t      contents_len = (strlen(contents) / 2);
+    size_t      total
+        = (BRANCH_HEX_LEN / 2) + (contents_len * bench_case->repeat);
+    uint8_t *bytes = malloc(total);
+    size_t   ofs   = 0;
+    size_t   i;
+    size_t   r;
+
+    for (i = 0; i < BRANCH_HEX_LEN / 2; i++) {
+        sscanf(bench_case->hex + (2 * i), "%2hhx", &bytes[ofs++]);
+    }
+    for (r = 0; r < bench_case->repeat; r++) {
+        for (i = 0; i < contents_len; i++) {
+            sscanf(contents + (2 * i), "%2hhx", &bytes[ofs++]);
+        }
+    }
+
+    *len = total;
+    return bytes;
+}
+
+/**
+ * @brief Parse an operation once, feeding it in `MAX_APDU_SIZE` chunks
+ *
+ * @param st: parser state
+ * @param bytes: operation to parse
+ * @param len: length of the operation
+ * @param obuf: output buffer
+ * @param olen: size of the output buffer
+ * @param stats: statistics to update
+ * @return mv_parser_result: final parser result
+ */
+static mv_parser_result
+parse_once(mv_parser_state *st, const uint8_t *bytes, size_t len, char *obuf,
+           size_t olen, bench_stats_t *stats)
+{
+    size_t ofs        = 0;
+    int    last_field = -1;
+
+    mv_operation_parser_init(st, (uint16_t)len, false);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, obuf, olen);
+
+    while (true) {
+        do {
+            stats->steps++;
+        } while (!MV_IS_BLOCKED(mv_operation_parser_step(st)));
+
+        if (st->field_info.field_index != last_field) {
+            last_field = st->field_info.field_index;
+            stats->fields++;
+        }
+
+        switch (st->errno) {
+        case MV_BLO_FEED_ME: {
+            size_t chunk = MIN(MAX_APDU_SIZE, len - ofs);
+
+            stats->feed_me++;
+            mv_parser_refill(st, bytes + ofs, chunk);
+            ofs += chunk;
+            break;
+        }
+        case MV_BLO_IM_FULL:
+            stats->im_full++;
+            mv_parser_flush(st, obuf, olen);
+            break;
+        case MV_BLO_DONE:
+            stats->bytes += len;
+            return st->errno;
+        default:
+            return st->errno;
+        }
+    }
+}
+
+static void
+print_stats(const char *name, const bench_stats_t *stats, size_t iterations)
+{
+    printf("%-20s %8zu %12.0f %10.2f %10.2f %10.2f\n", name,
+           stats->bytes / iterations, (double)stats->bytes / stats->seconds,
+           stats->fields ? (double)stats->steps / (double)stats->fields : 0.0,
+           (double)stats->feed_me / (double)iterations,
+           (double)stats->im_full / (double)iterations);
+}
+
+int
+main(int argc, const char *argv[])
+{
+    size_t           iterations = DEFAULT_ITERATIONS;
+    size_t           olen       = DEFAULT_OLEN;
+    mv_parser_state *st         = malloc(sizeof(mv_parser_state));
+    bench_stats_t    total;
+    char            *obuf;
+    size_t           c;
+    size_t           i;
+
+    if (argc > 1) {
+        iterations = strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        olen = strtoul(argv[2], NULL, 10);
+    }
+    if ((iterations == 0) || (olen == 0)) {
+        fprintf(stderr, "usage: %s [iterations] [olen]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    obuf = malloc(olen + 1);
+    memset(&total, 0, sizeof(total));
+
+    printf("iterations: %zu, chunk: %d bytes, output: %zu chars\n",
+           iterations, MAX_APDU_SIZE, olen);
+    printf("%-20s %8s %12s %10s %10s %10s\n", "operation", "bytes",
+           "bytes/s", "steps/fld", "feed_me", "im_full");
+
+    for (c = 0; c < sizeof(corpus) / sizeof(corpus[0]); c++) {
+        bench_stats_t stats;
+        size_t        len;
+        uint8_t      *bytes = decode_case(&corpus[c], &len);
+        double        start;
+
+        memset(&stats, 0, sizeof(stats));
+        start = now();
+        for (i = 0; i < iterations; i++) {
+            memset(st, 0, sizeof(mv_parser_state));
+            if (parse_once(st, bytes, len, obuf, olen, &stats)
+                != MV_BLO_DONE) {
+                fprintf(stderr, "%s: parsing error: %s\n", corpus[c].name,
+                        mv_parser_result_name(st->errno));
+                return EXIT_FAILURE;
+            }
+        }
+        stats.seconds = now() - start;
+        free(bytes);
+
+        print_stats(corpus[c].name, &stats, iterations);
+
+        total.bytes += stats.bytes;
+        total.steps += stats.steps;
+        total.fields += stats.fields;
+        total.feed_me += stats.feed_me;
+        total.im_full += stats.im_full;
+        total.seconds += stats.seconds;
+    }
+
+    print_stats("total", &total, iterations);
+
+    free(obuf);
+    free(st);
+    return EXIT_SUCCESS;
+}
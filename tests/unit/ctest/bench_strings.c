@@ -0,0 +1,488 @@
+/* Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Benchmark of the ring buffer of the UI strings against the strlen
+ * walks it replaced.
+ *
+ * Both buffers are driven as the stream display does: screens of a
+ * title and body lines are pushed, the oldest screens are dropped to
+ * make room, and trailing strings are appended to or dropped when a
+ * screen has to be retried. The positions of the strings in both
+ * buffers are checked to be the same.
+ *
+ * Usage: ./bench_strings [iterations] */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "globals.h"
+#include "ui_strings.h"
+
+#define DEFAULT_ITERATIONS 200000
+#define HISTORY_SCREENS    8
+#define SCREEN_STRINGS     5
+#define MAX_STRING_LEN     30
+#define RUNS               5
+
+void   ui_strings_init(void);
+size_t ui_strings_fit_up_to(size_t len, char **write_start);
+
+globals_t       global;
+mv_ui_strings_t bench_strings;
+
+void
+io_send_sw(uint16_t sw)
+{
+    fprintf(stderr, "ui_strings failed with 0x%04x\n", sw);
+    exit(EXIT_FAILURE);
+}
+
+/* Previous ring buffer, without the index of the strings. */
+typedef struct {
+    char   buffer[BUFF_LEN];
+    char  *start;
+    char  *end;
+    char  *internal_end;
+    size_t count;
+} reference_strings_t;
+
+static reference_strings_t reference;
+
+#define BUFF_START ((char *)(s->buffer))
+#define BUFF_END   ((char *)(s->buffer) + BUFF_LEN)
+
+static void
+reference_init(void)
+{
+    reference_strings_t *s = &reference;
+
+    memset(s->buffer, '\0', BUFF_LEN);
+    s->start        = BUFF_START;
+    s->end          = BUFF_START;
+    s->internal_end = BUFF_START;
+    s->count        = 0;
+}
+
+static bool
+reference_is_empty(void)
+{
+    reference_strings_t *s = &reference;
+
+    return (s->start == s->end) && (s->count == 0);
+}
+
+/* Previous `ui_strings_fit_up_to`. */
+static size_t
+reference_fit_up_to(size_t len, char **write_start)
+{
+    reference_strings_t *s       = &reference;
+    size_t               out_len = 0;
+    MV_PREAMBLE(
+        ("len=%d, start=%p, end=%p", len, s->start, s->end, s->internal_end));
+
+    /* Preconditions */
+    MV_ASSERT(EXC_MEMORY_ERROR, (*write_start == NULL));
+    /* Internal checks */
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
+
+    if (reference_is_empty()) {
+        MV_ASSERT(EXC_MEMORY_ERROR, (len < BUFF_LEN));
+
+        *write_start = s->start;
+        out_len      = len + 1;
+
+        MV_SUCCEED();
+    }
+
+    /* Buffer not empty */
+
+    if (s->start > s->end) {
+        *write_start = s->end;
+        out_len      = MIN((size_t)(s->start - s->end), len + 1);
+    } else if (s->start < s->end) {
+        /* start < end */
+        size_t chars_at_start = MIN((size_t)(s->start - BUFF_START), len + 1);
+        size_t chars_at_end   = MIN((size_t)(BUFF_END - s->end), len + 1);
+        if ((chars_at_end == len + 1) || (chars_at_end >= chars_at_start)) {
+            *write_start = s->end;
+            out_len      = chars_at_end;
+        } else {
+            *write_start = BUFF_START;
+            out_len      = chars_at_start;
+        }
+    }
+
+    MV_POSTAMBLE;
+    return out_len;
+}
+
+/* Previous `ui_strings_push`. */
+static void
+reference_push(const char *in, size_t len, char **out)
+{
+    reference_strings_t *s = &reference;
+    MV_PREAMBLE(("'%s' | in=%p, len=%d, start=%p, end=%p, internal_end=%p",
+                 in, in, len, s->start, s->end, s->internal_end));
+
+    /* Preconditions */
+    MV_ASSERT(EXC_MEMORY_ERROR, (*out == NULL));
+    MV_ASSERT_NOTNULL(in);
+    /* Internal checks */
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
+
+    char  *ws = NULL;
+    size_t out_len;
+    MV_CHECK(out_len = reference_fit_up_to(len, &ws));
+
+    MV_ASSERT(EXC_MEMORY_ERROR, (out_len - 1 == len));
+    MV_ASSERT(EXC_MEMORY_ERROR, ws != NULL);
+
+    strlcpy(ws, in, len + 1);
+    s->count++;
+
+    s->end = ws + len + 1;
+
+    if (s->end > s->internal_end) {
+        s->internal_end = s->end;
+    }
+
+    *out = ws;
+
+    MV_POSTAMBLE;
+}
+
+/* Previous `ui_strings_drop`. */
+static void
+reference_drop(char **in)
+{
+    reference_strings_t *s = &reference;
+    MV_PREAMBLE(("in=%p, start=%p, end=%p", *in, s->start, s->end));
+
+    /* argument checks */
+    MV_ASSERT(EXC_MEMORY_ERROR, (*in == s->start));
+    MV_ASSERT(EXC_MEMORY_ERROR, (!reference_is_empty()));
+    /* Internal checks */
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->start < s->internal_end));
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
+
+    size_t len = strlen(*in);
+
+    char *new = *in + len + 1;
+    MV_ASSERT(EXC_MEMORY_ERROR, (new <= s->internal_end));
+
+    memset(s->start, '\0', len);
+    *in = NULL;
+    s->count--;
+
+    if (new < s->internal_end) {
+        s->start = new;
+        MV_SUCCEED();
+    }
+
+    /* This was the last string in the region */
+
+    s->start = BUFF_START;
+
+    if (s->end == s->internal_end) {
+        /* This was the last string in the ring buffer */
+        s->end = BUFF_START;
+        MV_ASSERT(EXC_MEMORY_ERROR, (reference_is_empty()));
+    }
+
+    s->internal_end = s->end;
+
+    MV_POSTAMBLE;
+}
+
+/* Previous `ui_strings_drop_last`. */
+static void
+reference_drop_last(char **in)
+{
+    reference_strings_t *s = &reference;
+    MV_PREAMBLE(("in=%p, start=%p, end=%p", *in, s->start, s->end));
+
+    /* argument checks */
+    MV_ASSERT_NOTNULL(*in);
+
+    size_t len = strlen(*in);
+    MV_ASSERT(EXC_MEMORY_ERROR, (!reference_is_empty()));
+    MV_ASSERT(EXC_MEMORY_ERROR, ((*in + len) == (s->end - 1)));
+    /* Internal checks */
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->start < s->internal_end));
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
+
+    memset(*in, '\0', len);
+
+    if (*in == BUFF_START || *(*in - 1) == '\0') {
+        s->count--;
+        s->end = *in;
+    } else {
+        s->end = *in + 1;
+    }
+
+    *in = NULL;
+
+    if (s->end == BUFF_START && !reference_is_empty()) {
+        s->end = s->internal_end;
+    } else if (s->start <= s->end) {
+        s->internal_end = s->end;
+    }
+
+    MV_POSTAMBLE;
+}
+
+/* Previous `ui_strings_append_last`. */
+static size_t
+reference_append_last(const char *str, size_t max, char **out)
+{
+    size_t               appended = 0;
+    reference_strings_t *s        = &reference;
+
+    MV_PREAMBLE(("str=%s, out=%p", str, out));
+
+    /* argument checks */
+    MV_ASSERT_NOTNULL(str);
+    MV_ASSERT(EXC_MEMORY_ERROR, (*out == NULL));
+    MV_ASSERT(EXC_MEMORY_ERROR, (!reference_is_empty()));
+    /* Internal checks */
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->start < s->internal_end));
+    MV_ASSERT(EXC_MEMORY_ERROR, (s->end <= s->internal_end));
+
+    if (s->start == s->end) {
+        // Cannot append any chars
+        MV_SUCCEED();
+    }
+
+    if (s->start < s->end) {
+        max = (size_t)MIN((int)max + 1, BUFF_END - s->end);
+    } else {
+        max = (size_t)MIN((int)max + 1, s->start - s->end);
+    }
+
+    *out = s->end - 1;
+
+    strlcpy(*out, str, max);
+    appended = max - 1;
+
+    s->end += appended;
+
+    if (s->end > s->start) {
+        s->internal_end = s->end;
+    }
+
+
+    MV_POSTAMBLE;
+    return appended;
+}
+
+static bool
+new_can_fit(size_t len)
+{
+    bool can_fit = false;
+
+    ui_strings_can_fit(len, &can_fit);
+    return can_fit;
+}
+
+static bool
+reference_can_fit(size_t len)
+{
+    char *ws = NULL;
+
+    return reference_fit_up_to(len, &ws) == len + 1;
+}
+
+typedef struct {
+    void (*init)(void);
+    bool (*can_fit)(size_t len);
+    void (*push)(const char *in, size_t len, char **out);
+    void (*drop)(char **in);
+    void (*drop_last)(char **in);
+    size_t (*append_last)(const char *str, size_t max, char **out);
+    const char *buffer;
+} strings_impl_t;
+
+static const strings_impl_t impls[] = {
+    {ui_strings_init, new_can_fit, ui_strings_push, ui_strings_drop,
+     ui_strings_drop_last, ui_strings_append_last, bench_strings.buffer},
+    {reference_init, reference_can_fit, reference_push, reference_drop,
+     reference_drop_last, reference_append_last, reference.buffer},
+};
+
+typedef struct {
+    char  *strings[SCREEN_STRINGS];
+    size_t nb_strings;
+} screen_t;
+
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/**
+ * @brief Drive a ring buffer as the stream display does
+ *
+ * @param impl: ring buffer to drive
+ * @param inputs: length and action of each string to push
+ * @param iterations: number of strings to push
+ * @param trace: positions of the strings pushed, for the comparison
+ *               of the implementations
+ * @return double: time taken in seconds
+ */
+static double
+run_stream(const strings_impl_t *impl, const uint8_t *inputs,
+           size_t iterations, uint16_t *trace)
+{
+    static const char text[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+    screen_t          screens[HISTORY_SCREENS];
+    size_t            first = 0;
+    size_t            last  = 0;
+    size_t            i;
+    double            start;
+
+    memset(screens, 0, sizeof(screens));
+    impl->init();
+
+    start = now();
+    for (i = 0; i < iterations; i++) {
+        screen_t *screen = &screens[last % HISTORY_SCREENS];
+        size_t    len    = inputs[i] % MAX_STRING_LEN;
+        int       action = inputs[i] / MAX_STRING_LEN;
+        char     *out    = NULL;
+
+        if ((screen->nb_strings == SCREEN_STRINGS)
+            || ((last - first) == HISTORY_SCREENS)) {
+            /* Screen complete or history full: drop the oldest one */
+            if ((last - first) == HISTORY_SCREENS) {
+                screen_t *oldest = &screens[first % HISTORY_SCREENS];
+                size_t    k;
+
+                for (k = 0; k < oldest->nb_strings; k++) {
+                    impl->drop(&oldest->strings[k]);
+                }
+                oldest->nb_strings = 0;
+                first++;
+            } else {
+                last++;
+            }
+            trace[i] = UINT16_MAX;
+            continue;
+        }
+
+        while (!impl->can_fit(len)) {
+            screen_t *oldest = &screens[first % HISTORY_SCREENS];
+            size_t    k;
+
+            if (oldest == screen) {
+                len = 0;
+                break;
+            }
+            for (k = 0; k < oldest->nb_strings; k++) {
+                impl->drop(&oldest->strings[k]);
+            }
+            oldest->nb_strings = 0;
+            first++;
+        }
+        if (!impl->can_fit(len)) {
+            trace[i] = UINT16_MAX;
+            continue;
+        }
+
+        impl->push(text, len, &screen->strings[screen->nb_strings]);
+        trace[i]
+            = (uint16_t)(screen->strings[screen->nb_strings] - impl->buffer);
+
+        if (action == 0) {
+            /* The string does not fit the screen: retry on the next */
+            impl->drop_last(&screen->strings[screen->nb_strings]);
+            continue;
+        }
+        if ((action == 1) && (len > 0) && impl->can_fit(5)
+            && (trace[i] + len + 1 < BUFF_LEN)) {
+            /* Continue the string then drop the continuation */
+            size_t appended = impl->append_last(text, 5, &out);
+
+            if (appended > 0) {
+                impl->drop_last(&out);
+            }
+        }
+        screen->nb_strings++;
+    }
+    return now() - start;
+}
+
+int
+main(int argc, const char *argv[])
+{
+    size_t    iterations = DEFAULT_ITERATIONS;
+    uint8_t  *inputs;
+    uint16_t *traces[2];
+    size_t    i;
+    size_t    r;
+    double    t_new;
+    double    t_reference;
+
+    if (argc > 1) {
+        iterations = strtoul(argv[1], NULL, 10);
+    }
+    if (iterations == 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    inputs    = malloc(iterations);
+    traces[0] = malloc(iterations * sizeof(uint16_t));
+    traces[1] = malloc(iterations * sizeof(uint16_t));
+
+    srand(42);
+    for (i = 0; i < iterations; i++) {
+        inputs[i] = (uint8_t)(rand() % (MAX_STRING_LEN * 8));
+    }
+
+    t_new       = run_stream(&impls[0], inputs, iterations, traces[0]);
+    t_reference = run_stream(&impls[1], inputs, iterations, traces[1]);
+    for (r = 1; r < RUNS; r++) {
+        /* Keep the best runs to smooth out the noise */
+        t_new       = MIN(t_new, run_stream(&impls[0], inputs, iterations,
+                                            traces[0]));
+        t_reference = MIN(t_reference, run_stream(&impls[1], inputs,
+                                                  iterations, traces[1]));
+    }
+
+    if (memcmp(traces[0], traces[1], iterations * sizeof(uint16_t))) {
+        fprintf(stderr, "ring buffers diverged\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("iterations: %zu, buffer: %d chars, %d strings\n", iterations,
+           BUFF_LEN, UI_STRINGS_MAX_COUNT);
+    printf("%-16s %14s %14s %8s\n", "ring buffer", "ns/op", "reference",
+           "speedup");
+    printf("%-16s %14.1f %14.1f %7.2fx\n", "ui_strings",
+           t_new * 1e9 / (double)iterations,
+           t_reference * 1e9 / (double)iterations, t_reference / t_new);
+
+    free(inputs);
+    free(traces[0]);
+    free(traces[1]);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,316 @@
+/* Copyright 2023 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Fuzzer of `mv_operation_parser_step` and `mv_micheline_parser_step`.
+ *
+ * The first `FUZZ_HEADER_SIZE` bytes of an input are its settings:
+ * - byte 0: parser to run (`FUZZ_MICHELINE`) and whether the
+ *   operation parser only validates (`FUZZ_VALIDATE_ONLY`),
+ * - byte 1: seed of the splitting of the payload in chunks of 1 to
+ *   `MAX_APDU_SIZE` bytes,
+ * - byte 2: size of the output buffer, from 1 to `MAX_OLEN`.
+ * The rest of the input is the payload given to the parser.
+ *
+ * Each chunk and the output buffer (with its null terminator) are
+ * allocated at their exact size, so that the sanitizers catch any out
+ * of bounds access. A parser
+ * that runs more than `MAX_STEPS_PER_BYTE` steps per byte without
+ * blocking is reported as a crash.
+ *
+ * Besides the crashers, the inputs whose number of steps per byte or
+ * stack depth is the highest seen so far are saved in the benchmark
+ * corpus directory (`$FUZZ_BENCH_CORPUS`, `bench_corpus` by default).
+ *
+ * Built with `-DFUZZ_LIBFUZZER -fsanitize=fuzzer`, this is a
+ * libFuzzer target. Otherwise, it runs the files given as arguments,
+ * or the standard input (for AFL), and prints their step counts.
+ *
+ * Usage: ./fuzz_parser [FILE]... */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "micheline_parser.h"
+#include "operation_parser.h"
+
+#define FUZZ_HEADER_SIZE   3
+#define FUZZ_MICHELINE     0x01u
+#define FUZZ_VALIDATE_ONLY 0x02u
+#define MAX_APDU_SIZE      235
+#define MAX_OLEN           128
+#define MAX_STEPS_PER_BYTE 64
+#define MIN_RECORD_SIZE    32  // below, the steps per byte are dominated
+                               // by the fixed costs of the parsers
+#define MAX_INPUT_SIZE     (1 << 16)
+
+typedef struct {
+    size_t           bytes;    /// payload size
+    size_t           steps;    /// steps run
+    size_t           feed_me;  /// number of chunks given
+    size_t           im_full;  /// number of output flushes
+    uint8_t          depth;    /// deepest stack reached
+    mv_parser_result result;   /// final parser result
+} fuzz_stats_t;
+
+static double  best_steps_per_byte = 0.0;
+static uint8_t best_depth          = 0;
+
+/**
+ * @brief Draw the size of the next chunk
+ *
+ * @param seed: state of the xorshift generator, updated
+ * @return size_t: chunk size, between 1 and `MAX_APDU_SIZE`
+ */
+static size_t
+next_chunk_size(uint32_t *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return 1 + (*seed % MAX_APDU_SIZE);
+}
+
+/**
+ * @brief Update the deepest stack reached by the parsers
+ *
+ * @param st: parser state
+ * @param stats: statistics to update
+ */
+static void
+record_depth(const mv_parser_state *st, fuzz_stats_t *stats)
+{
+    uint8_t depth;
+
+    if (st->micheline.frame != NULL) {
+        depth = (uint8_t)(st->micheline.frame - st->micheline.stack + 1);
+        if (stats->depth < depth) {
+            stats->depth = depth;
+        }
+    }
+    if (st->operation.frame != NULL) {
+        depth = (uint8_t)(st->operation.frame - st->operation.stack + 1);
+        if (stats->depth < depth) {
+            stats->depth = depth;
+        }
+    }
+}
+
+/**
+ * @brief Parse the payload of an input with its settings
+ *
+ * @param data: input
+ * @param size: size of the input, at least `FUZZ_HEADER_SIZE`
+ * @param stats: output statistics of the parsing
+ */
+static void
+fuzz_one(const uint8_t *data, size_t size, fuzz_stats_t *stats)
+{
+    static mv_parser_state st;
+    const uint8_t *payload   = data + FUZZ_HEADER_SIZE;
+    size_t         len       = size - FUZZ_HEADER_SIZE;
+    bool           micheline = (data[0] & FUZZ_MICHELINE) != 0;
+    uint32_t       seed      = 0x9e3779b9u ^ data[1];
+    size_t         olen      = 1 + (data[2] % MAX_OLEN);
+    size_t         max_steps = MAX_STEPS_PER_BYTE * (len + 1);
+    size_t         ofs       = 0;
+    char          *obuf      = calloc(olen + 1, 1);
+    uint8_t       *chunk     = NULL;
+
+    memset(stats, 0, sizeof(*stats));
+    stats->bytes = len;
+    memset(&st, 0, sizeof(st));
+
+    if (micheline) {
+        mv_parser_init(&st);
+        mv_micheline_parser_init(&st);
+    } else {
+        mv_operation_parser_init(&st, (uint16_t)len, false);
+        mv_operation_parser_set_validate_only(
+            &st, (data[0] & FUZZ_VALIDATE_ONLY) != 0);
+    }
+    mv_parser_refill(&st, NULL, 0);
+    mv_parser_flush(&st, obuf, olen);
+
+    while (true) {
+        size_t steps = 0;
+
+        do {
+            if (++steps > max_steps) {
+                fprintf(stderr, "parser stuck after %zu steps in %s\n",
+                        stats->steps + steps,
+                        mv_parser_result_name(st.errno));
+                abort();
+            }
+            if (micheline) {
+                mv_micheline_parser_step(&st);
+            } else {
+                mv_operation_parser_step(&st);
+            }
+            record_depth(&st, stats);
+        } while (!MV_IS_BLOCKED(st.errno));
+        stats->steps += steps;
+
+        if ((st.errno == MV_BLO_FEED_ME) && (ofs < len)) {
+            size_t n = MIN(next_chunk_size(&seed), len - ofs);
+
+            free(chunk);
+            chunk = malloc(n);
+            memcpy(chunk, payload + ofs, n);
+            mv_parser_refill(&st, chunk, n);
+            ofs += n;
+            stats->feed_me++;
+        } else if (st.errno == MV_BLO_IM_FULL) {
+            mv_parser_flush(&st, obuf, olen);
+            stats->im_full++;
+        } else {
+            break;
+        }
+    }
+
+    stats->result = st.errno;
+    free(chunk);
+    free(obuf);
+}
+
+/**
+ * @brief Save an input in the benchmark corpus
+ *
+ * @param data: input
+ * @param size: size of the input
+ * @param kind: record the input sets, used as file name prefix
+ * @param value: value of the record
+ */
+static void
+save_record(const uint8_t *data, size_t size, const char *kind,
+            double value)
+{
+    const char *dir  = getenv("FUZZ_BENCH_CORPUS");
+    uint32_t    hash = 2166136261u;
+    char        path[512];
+    FILE       *file;
+    size_t      i;
+
+    for (i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    snprintf(path, sizeof(path), "%s/%s-%.2f-%08x",
+             (dir != NULL) ? dir : "bench_corpus", kind, value, hash);
+
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        return;
+    }
+    fwrite(data, 1, size, file);
+    fclose(file);
+    fprintf(stderr, "new %s record %.2f: %s\n", kind, value, path);
+}
+
+/**
+ * @brief Save an input if it sets a new performance record
+ *
+ * @param data: input
+ * @param size: size of the input
+ * @param stats: statistics of the parsing of the input
+ */
+static void
+check_records(const uint8_t *data, size_t size, const fuzz_stats_t *stats)
+{
+    double steps_per_byte;
+
+    if (stats->bytes >= MIN_RECORD_SIZE) {
+        steps_per_byte = (double)stats->steps / (double)stats->bytes;
+        if (steps_per_byte > best_steps_per_byte) {
+            best_steps_per_byte = steps_per_byte;
+            save_record(data, size, "steps", steps_per_byte);
+        }
+    }
+    if (stats->depth > best_depth) {
+        best_depth = stats->depth;
+        save_record(data, size, "depth", (double)stats->depth);
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_stats_t stats;
+
+    if ((size < FUZZ_HEADER_SIZE)
+        || ((size - FUZZ_HEADER_SIZE) > UINT16_MAX)) {
+        return 0;
+    }
+    fuzz_one(data, size, &stats);
+    check_records(data, size, &stats);
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+/**
+ * @brief Run an input file and print its statistics
+ *
+ * @param name: name of the input
+ * @param file: input file
+ * @return int: 0 on success
+ */
+static int
+run_file(const char *name, FILE *file)
+{
+    static uint8_t data[MAX_INPUT_SIZE];
+    size_t         size = fread(data, 1, sizeof(data), file);
+    fuzz_stats_t   stats;
+
+    if (size < FUZZ_HEADER_SIZE) {
+        fprintf(stderr, "%s: input too short\n", name);
+        return 1;
+    }
+    fuzz_one(data, size, &stats);
+    printf("%-40s %-9s %6zu %8zu %8.2f %6u %7zu %7zu %s\n", name,
+           (data[0] & FUZZ_MICHELINE) ? "micheline" : "operation",
+           stats.bytes, stats.steps,
+           stats.bytes ? (double)stats.steps / (double)stats.bytes : 0.0,
+           stats.depth, stats.feed_me, stats.im_full,
+           mv_parser_result_name(stats.result));
+    return 0;
+}
+
+int
+main(int argc, const char *argv[])
+{
+    int ret = 0;
+    int i;
+
+    printf("%-40s %-9s %6s %8s %8s %6s %7s %7s %s\n", "input", "parser",
+           "bytes", "steps", "steps/B", "depth", "feed_me", "im_full",
+           "result");
+    if (argc == 1) {
+        return run_file("<stdin>", stdin);
+    }
+    for (i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+
+        if (file == NULL) {
+            perror(argv[i]);
+            ret = 1;
+            continue;
+        }
+        ret |= run_file(argv[i], file);
+        fclose(file);
+    }
+    return ret;
+}
+#endif
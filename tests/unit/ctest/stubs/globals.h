@@ -0,0 +1,44 @@
+/* Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Host stub of the app `globals.h`: only the error handling state used
+ * by the `MV_*` macros and the UI strings are kept. */
+
+#pragma once
+
+#include <string.h>
+
+#include "exception.h"
+#include "ui_strings.h"
+
+#define PRINTF(...)
+#define FUNC_ENTER(x)
+#define FUNC_LEAVE()
+
+#ifdef MIN
+#undef MIN
+#endif
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+typedef enum {
+    ST_IDLE,
+    ST_ERROR
+} main_step_t;
+
+typedef struct {
+    main_step_t step;
+} globals_t;
+
+extern globals_t global;
+extern mv_ui_strings_t bench_strings;
@@ -0,0 +1,24 @@
+/* Copyright 2025 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+/* Host stub of the SDK `os.h`, to build app sources off the device. */
+
+#pragma once
+
+#include <stddef.h>
+
+typedef int cx_err_t;
+#define CX_OK 0
+
+size_t strlcpy(char *dst, const char *src, size_t size);
@@ -0,0 +1,94 @@
+/* Copyright 2024 Functori <contact@functori.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ctest.h"
+#include "mavryk_host.h"
+
+#define BRANCH_HEX                                                         \
+    "030000000000000000000000000000000000000000000000000000000000000000"
+#define TRANSACTION_HEX                                                    \
+    "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"   \
+    "0000000000000000000000000000000000000000"
+
+/**
+ * @brief Decode a branch followed by `repeat` times some contents
+ *
+ * @param contents: hex contents
+ * @param repeat: number of times the contents are repeated
+ * @param len: output length of the message
+ * @return uint8_t*: message, to be freed by the caller
+ */
+static uint8_t *
+decode_message(const char *contents, size_t repeat, size_t *len)
+{
+    size_t   branch_len   = strlen(BRANCH_HEX) / 2;
+    size_t   contents_len = strlen(contents) / 2;
+    uint8_t *msg          = malloc(branch_len + (contents_len * repeat));
+    size_t   ofs          = 0;
+    size_t   i;
+    size_t   r;
+
+    for (i = 0; i < branch_len; i++) {
+        sscanf(BRANCH_HEX + (2 * i), "%2hhx", &msg[ofs++]);
+    }
+    for (r = 0; r < repeat; r++) {
+        for (i = 0; i < contents_len; i++) {
+            sscanf(contents + (2 * i), "%2hhx", &msg[ofs++]);
+        }
+    }
+    *len = ofs;
+    return msg;
+}
+
+CTEST(host, check_preflight)
+{
+    mv_host_preflight preflight;
+    size_t            len;
+    uint8_t          *msg;
+
+    ASSERT_EQUAL(MV_HOST_API_VERSION, mv_host_api_version());
+
+    msg = decode_message(TRANSACTION_HEX, 1, &len);
+    ASSERT_EQUAL(0, mv_host_preflight_message(msg, len, MV_HOST_DEVICE_NANOS,
+                                              &preflight));
+    ASSERT_EQUAL(MV_HOST_REVIEW_CLEAR, preflight.review);
+    ASSERT_STR("DONE", mv_host_result_name(preflight.result));
+    ASSERT_EQUAL(8, preflight.nb_screens);
+    ASSERT_EQUAL(1, preflight.nb_operations);
+    ASSERT_EQUAL_U(500000, preflight.total_fee);
+    ASSERT_EQUAL_U(10000, preflight.total_amount);
+
+    // Truncated
+    ASSERT_EQUAL(0, mv_host_preflight_message(
+                        msg, len - 3, MV_HOST_DEVICE_STAX, &preflight));
+    ASSERT_EQUAL(MV_HOST_REVIEW_REJECT, preflight.review);
+
+    ASSERT_EQUAL(-1, mv_host_preflight_message(msg, len, 5, &preflight));
+    free(msg);
+
+    // Too many screens for the first packet on Nano X, not on Stax
+    msg = decode_message(TRANSACTION_HEX, 3, &len);
+    ASSERT_EQUAL(0, mv_host_preflight_message(msg, len, MV_HOST_DEVICE_NANOX,
+                                              &preflight));
+    ASSERT_EQUAL(MV_HOST_REVIEW_SUMMARY, preflight.review);
+    ASSERT_EQUAL(3, preflight.nb_operations);
+    ASSERT_EQUAL_U(1500000, preflight.total_fee);
+    ASSERT_EQUAL(0, mv_host_preflight_message(msg, len, MV_HOST_DEVICE_STAX,
+                                              &preflight));
+    ASSERT_EQUAL(MV_HOST_REVIEW_CLEAR, preflight.review);
+    free(msg);
+}
@@ -14,6 +14,7 @@
 
 #include <stdlib.h>
 #include "ctest.h"
+#include "num_parser.h"
 #include "operation_parser.h"
 
 CTEST_DATA(operation_parser)
@@ -58,7 +59,7 @@ refill(struct ctest_operation_parser_data *data)
 {
     data->ilen = 0;
     while (
-        ((data->str_ofs < data->str_len) || (data->ilen < data->max_ilen))
+        (data->ilen < data->max_ilen)
         && sscanf(data->str + data->str_ofs, "%2hhx", &data->ibuf[data->ilen])
                == 1) {
         data->str_ofs += 2;
@@ -261,6 +262,28 @@ CTEST2(operation_parser, check_transaction_complexity)
     check_field_complexity(data, str, fields_check, sizeof(fields_check));
 }
 
+CTEST2(operation_parser, check_fa12_transfer_complexity)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "00000000000000000000000000000000000000ffff087472616e73666572000000"
+          "3d07070a000000160000ffdd6102321bc251e4a5190ad5b12b251069d9b407070a"
+          "00000016016e8874874d31c3fbd636e924d5a036a43ec8faa70000a80f";
+    const mv_fields_check fields_check[] = {
+        {"Source",        false, 1 },
+        {"Fee",           false, 2 },
+        {"Storage limit", false, 3 },
+        {"Amount",        false, 4 },
+        {"Destination",   false, 5 },
+        {"Entrypoint",    false, 8 },
+        {"Sender",        true,  9 },
+        {"Recipient",     true,  10},
+        {"Token amount",  true,  11},
+    };
+    check_field_complexity(data, str, fields_check, sizeof(fields_check));
+}
+
 CTEST2(operation_parser, check_double_transaction_complexity)
 {
     char str[]
@@ -553,3 +576,906 @@ CTEST2(operation_parser, check_sc_rollup_originate_complexity)
     };
     check_field_complexity(data, str, fields_check, sizeof(fields_check));
 }
+
+static size_t
+count_screens(struct ctest_operation_parser_data *data, char *str,
+              bool lookahead)
+{
+    mv_parser_state *st         = data->state;
+    size_t           nb_screens = 0;
+
+    fill_data_str(data, str);
+    mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+    mv_operation_parser_set_lookahead(st, lookahead);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, data->obuf, data->olen);
+
+    while (true) {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+            // Loop while the result is successful and not blocking
+        }
+
+        switch (st->errno) {
+        case MV_BLO_FEED_ME:
+            refill(data);
+            mv_parser_refill(st, data->ibuf, data->ilen);
+            continue;
+        case MV_BLO_IM_FULL:
+            nb_screens++;
+            mv_parser_flush(st, data->obuf, data->olen);
+            continue;
+        case MV_BLO_DONE:
+            return nb_screens + ((st->regs.oofs != 0) ? 1 : 0);
+        default:
+            CTEST_ERR("%s:%d parsing error: %s", __FILE__, __LINE__,
+                      mv_parser_result_name(st->errno));
+        }
+    }
+}
+
+CTEST2(operation_parser, check_lookahead_screens)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "0000000000000000000000000000000000000000"
+          "6c016e8874874d31c3fbd636e924d5a036a43ec8faa7d0860308362d80d30e0100"
+          "0000000000000000000000000000000000000000ff02000000020316"
+          "c800ffdd6102321bc251e4a5190ad5b12b251069d9b4904e02030400000000c639"
+          "663039663239353264333435323863373333663934363135636663333962633535"
+          "353631396663353530646434613637626132323038636538653836376161336431"
+          "336136656639396466626533326336393734616139613231353064323165636132"
+          "396333333439653539633133623930383166316331316234343061633464333435"
+          "356465646265346565306465313561386166363230643463383632343764396431"
+          "333264653162623664613233643566663964386466666461323262613961383400"
+          "00000a07070100000001310002ff0000003f00ffdd6102321bc251e4a5190ad5b1"
+          "2b251069d9b401f6552df4f5ff51c3d13347cab045cfdb8b9bd8030278eb8b6ab9"
+          "a768579cd5146b480789650c83f28e";
+    size_t nb_screens = count_screens(data, str, false);
+
+    ASSERT_EQUAL_U(nb_screens, count_screens(data, str, true));
+    ASSERT_TRUE(nb_screens > 0);
+}
+
+/**
+ * @brief Write the hexadecimal of a micheline expression made of
+ *        `depth` nested sequences around an integer
+ *
+ * @param str: output buffer, of at least 10 * `depth` + 7 bytes
+ * @param depth: number of nested sequences
+ */
+static void
+nested_sequences_hex(char *str, size_t depth)
+{
+    size_t i;
+    size_t ofs = 0;
+
+    ofs += sprintf(str + ofs, "05");
+    for (i = 0; i < depth; i++) {
+        // size of the sequences and of the integer inside
+        ofs += sprintf(str + ofs, "02%08x",
+                       (unsigned)(2 + (5 * (depth - i - 1))));
+    }
+    sprintf(str + ofs, "002a");
+}
+
+static mv_parser_result
+parse_str(struct ctest_operation_parser_data *data, char *str)
+{
+    mv_parser_state *st = data->state;
+
+    fill_data_str(data, str);
+    mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, data->obuf, data->olen);
+
+    while (true) {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+            // Loop while the result is successful and not blocking
+        }
+
+        switch (st->errno) {
+        case MV_BLO_FEED_ME:
+            refill(data);
+            mv_parser_refill(st, data->ibuf, data->ilen);
+            continue;
+        case MV_BLO_IM_FULL:
+            mv_parser_flush(st, data->obuf, data->olen);
+            continue;
+        default:
+            return st->errno;
+        }
+    }
+}
+
+CTEST2(operation_parser, check_micheline_depth)
+{
+    char str[(10 * (MV_MICHELINE_STACK_DEPTH + 1)) + 7];
+
+    // Twice the depth handled with the former frames
+    nested_sequences_hex(str, 90);
+    ASSERT_EQUAL(MV_BLO_DONE, parse_str(data, str));
+
+    nested_sequences_hex(str, MV_MICHELINE_STACK_DEPTH + 1);
+    ASSERT_EQUAL(MV_ERR_TOO_DEEP, parse_str(data, str));
+}
+
+#define SNAPSHOT_SIZE sizeof(mv_parser_state)
+
+/**
+ * @brief Resume the parsing from a snapshot of the current state
+ *
+ *        The state is restored in a fresh garbage state that replaces
+ *        the current one.
+ *
+ * @param data: test data
+ * @param blob: snapshot buffer, must stay valid until the next refill
+ */
+static void
+resume_from_snapshot(struct ctest_operation_parser_data *data, uint8_t *blob)
+{
+    mv_parser_state *st   = malloc(sizeof(mv_parser_state));
+    size_t           size = mv_parser_snapshot_size(data->state);
+
+    ASSERT_TRUE(size < SNAPSHOT_SIZE);
+    ASSERT_EQUAL(MV_ERR_TOO_LARGE,
+                 mv_parser_snapshot(data->state, blob, size - 1));
+    ASSERT_EQUAL(MV_CONTINUE, mv_parser_snapshot(data->state, blob, size));
+
+    memset(st, 0xA5, sizeof(mv_parser_state));
+    ASSERT_EQUAL(MV_ERR_INVALID_STATE,
+                 mv_parser_restore(st, blob, size + 1, data->obuf,
+                                   data->olen));
+    ASSERT_EQUAL(MV_CONTINUE, mv_parser_restore(st, blob, size, data->obuf,
+                                                data->olen));
+
+    memset(data->state, 0xA5, sizeof(mv_parser_state));
+    free(data->state);
+    data->state = st;
+}
+
+/**
+ * @brief Parse an operation and concatenate its output
+ *
+ * @param data: test data
+ * @param str: hexadecimal of the operation
+ * @param out: output buffer, of at least `out_len` bytes
+ * @param out_len: size of the output buffer
+ * @param resume: resume from a snapshot at each block
+ * @return mv_parser_result: the final result of the parsing
+ */
+static mv_parser_result
+parse_output(struct ctest_operation_parser_data *data, char *str, char *out,
+             size_t out_len, bool resume)
+{
+    static uint8_t blobs[2][SNAPSHOT_SIZE];
+    size_t         nb_blocks = 0;
+
+    fill_data_str(data, str);
+    mv_operation_parser_init(data->state, (uint16_t)data->str_len, false);
+    mv_parser_refill(data->state, NULL, 0);
+    mv_parser_flush(data->state, data->obuf, data->olen);
+    out[0] = '\0';
+
+    while (true) {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(data->state))) {
+            // Loop while the result is successful and not blocking
+        }
+
+        if (resume) {
+            // The pending input stays in the snapshot until the next
+            // refill, alternate between two blobs
+            resume_from_snapshot(data, blobs[nb_blocks++ % 2]);
+        }
+
+        switch (data->state->errno) {
+        case MV_BLO_FEED_ME:
+            refill(data);
+            mv_parser_refill(data->state, data->ibuf, data->ilen);
+            break;
+        case MV_BLO_IM_FULL:
+            strncat(out, data->obuf, out_len - strlen(out) - 1);
+            strncat(out, "\n", out_len - strlen(out) - 1);
+            mv_parser_flush(data->state, data->obuf, data->olen);
+            break;
+        case MV_BLO_DONE:
+            strncat(out, data->obuf, out_len - strlen(out) - 1);
+            return MV_BLO_DONE;
+        default:
+            return data->state->errno;
+        }
+
+        if (resume) {
+            resume_from_snapshot(data, blobs[nb_blocks++ % 2]);
+        }
+    }
+}
+
+CTEST2(operation_parser, check_snapshot_restore)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "0000000000000000000000000000000000000000"
+          "6c016e8874874d31c3fbd636e924d5a036a43ec8faa7d0860308362d80d30e0100"
+          "0000000000000000000000000000000000000000ff02000000020316"
+          "c800ffdd6102321bc251e4a5190ad5b12b251069d9b4904e02030400000000c639"
+          "663039663239353264333435323863373333663934363135636663333962633535"
+          "353631396663353530646434613637626132323038636538653836376161336431"
+          "336136656639396466626533326336393734616139613231353064323165636132"
+          "396333333439653539633133623930383166316331316234343061633464333435"
+          "356465646265346565306465313561386166363230643463383632343764396431"
+          "333264653162623664613233643566663964386466666461323262613961383400"
+          "00000a07070100000001310002ff0000003f00ffdd6102321bc251e4a5190ad5b1"
+          "2b251069d9b401f6552df4f5ff51c3d13347cab045cfdb8b9bd8030278eb8b6ab9"
+          "a768579cd5146b480789650c83f28e";
+    static char expected[4096];
+    static char resumed[4096];
+    size_t      ilens[] = {1, 7, 235};
+    size_t      i;
+
+    ASSERT_EQUAL(MV_BLO_DONE, parse_output(data, str, expected,
+                                           sizeof(expected), false));
+    ASSERT_TRUE(strlen(expected) > 0);
+
+    // Small inputs block in the middle of every step
+    for (i = 0; i < (sizeof(ilens) / sizeof(ilens[0])); i++) {
+        data->max_ilen = ilens[i];
+        ASSERT_EQUAL(MV_BLO_DONE, parse_output(data, str, resumed,
+                                               sizeof(resumed), true));
+        ASSERT_STR(expected, resumed);
+    }
+}
+
+CTEST2(operation_parser, check_validate_only)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "0000000000000000000000000000000000000000"
+          "6c016e8874874d31c3fbd636e924d5a036a43ec8faa7d0860308362d80d30e0100"
+          "0000000000000000000000000000000000000000ff02000000020316";
+    mv_operation_state expected;
+    mv_parser_state   *st = data->state;
+
+    ASSERT_EQUAL(MV_BLO_DONE, parse_str(data, str));
+    memcpy(&expected, &st->operation, sizeof(expected));
+
+    fill_data_str(data, str);
+    mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+    mv_operation_parser_set_validate_only(st, true);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, data->obuf, data->olen);
+    do {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+            // Loop while the result is successful and not blocking
+        }
+        // Nothing is printed
+        ASSERT_NOT_EQUAL(MV_BLO_IM_FULL, st->errno);
+        if (st->errno == MV_BLO_FEED_ME) {
+            refill(data);
+            mv_parser_refill(st, data->ibuf, data->ilen);
+        }
+    } while (st->errno == MV_BLO_FEED_ME);
+
+    ASSERT_EQUAL(MV_BLO_DONE, st->errno);
+    ASSERT_EQUAL_U(0, st->regs.oofs);
+    ASSERT_EQUAL_U(expected.batch_index, st->operation.batch_index);
+    ASSERT_DATA((const uint8_t *)&expected.summary, sizeof(expected.summary),
+                (const uint8_t *)&st->operation.summary,
+                sizeof(st->operation.summary));
+    ASSERT_DATA(expected.source, 22, st->operation.source, 22);
+    ASSERT_DATA(expected.destination, 22, st->operation.destination, 22);
+
+    // The tags are still checked: invalid source tag
+    str[(1 + 32 + 1) * 2]       = '0';
+    str[((1 + 32 + 1) * 2) + 1] = '9';
+    fill_data_str(data, str);
+    mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+    mv_operation_parser_set_validate_only(st, true);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, data->obuf, data->olen);
+    refill(data);
+    mv_parser_refill(st, data->ibuf, data->ilen);
+    while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+        // Loop while the result is successful and not blocking
+    }
+    ASSERT_EQUAL(MV_ERR_INVALID_TAG, st->errno);
+}
+
+/**
+ * @brief Parse an operation in validate-only mode, expecting an operation
+ *
+ * @param data: test data
+ * @param str: operation, in hexadecimal
+ * @param expected: operation expected
+ * @return mv_parser_result: parser result
+ */
+static mv_parser_result
+parse_expected(struct ctest_operation_parser_data *data, char *str,
+               const mv_operation_expected *expected)
+{
+    mv_parser_state *st = data->state;
+
+    fill_data_str(data, str);
+    mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+    mv_operation_parser_set_validate_only(st, true);
+    mv_operation_parser_set_expected(st, expected);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, data->obuf, data->olen);
+    do {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+            // Loop while the result is successful and not blocking
+        }
+        if (st->errno == MV_BLO_FEED_ME) {
+            refill(data);
+            mv_parser_refill(st, data->ibuf, data->ilen);
+        }
+    } while (st->errno == MV_BLO_FEED_ME);
+    return st->errno;
+}
+
+CTEST2(operation_parser, check_expected_operation)
+{
+    // Transaction of 0.01 to KT18amZmM5W7qDWVt2pH6uj7sCEd3kbzLrHT, with
+    // 0.5 of fee
+    static const char transaction[]
+        = "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "0000000000000000000000000000000000000000";
+    static const char reveal[]
+        = "6b00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e02030400"
+          "0000000000000000000000000000000000000000000000000000000000000000";
+    static const uint8_t destination[22] = {0x01};
+    static char          str[1024];
+    const char          *branch
+        = "030000000000000000000000000000000000000000000000000000000000000000";
+    mv_operation_expected expected = {.amount = 10000, .fee = 1000000};
+    mv_parser_state      *st       = data->state;
+
+    ASSERT_EQUAL(0, mv_format_address(destination, 22, expected.destination,
+                                      sizeof(expected.destination)));
+
+    snprintf(str, sizeof(str), "%s%s%s", branch, reveal, transaction);
+    ASSERT_EQUAL(MV_BLO_DONE, parse_expected(data, str, &expected));
+    ASSERT_EQUAL_U(expected.fee, st->operation.summary.total_fee);
+    ASSERT_EQUAL_U(expected.amount, st->operation.summary.total_amount);
+
+    // The fees exceed the expected one from the transaction on
+    expected.fee = 999999;
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    ASSERT_EQUAL_U(2, st->operation.summary.nb_operations);
+    // Or are short of it once the fee of the transaction is read
+    expected.fee = 1000001;
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    ASSERT_EQUAL_U(0, st->operation.summary.total_amount);
+    expected.fee = 1000000;
+
+    // Without reveal, only the fee of the transaction
+    snprintf(str, sizeof(str), "%s%s", branch, transaction);
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    expected.fee = 500000;
+    ASSERT_EQUAL(MV_BLO_DONE, parse_expected(data, str, &expected));
+
+    // Another amount, more or less
+    expected.amount = 20000;
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    ASSERT_EQUAL_U(expected.fee, st->operation.summary.total_fee);
+    expected.amount = 9999;
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    expected.amount = 10000;
+
+    // Another destination
+    expected.destination[3] ^= 1;
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    expected.destination[3] ^= 1;
+
+    // Destination read across packets, in the capture buffer
+    data->max_ilen = 7;
+    ASSERT_EQUAL(MV_BLO_DONE, parse_expected(data, str, &expected));
+    expected.destination[3] ^= 1;
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    expected.destination[3] ^= 1;
+    data->max_ilen = 235;
+
+    // Only one transaction, after at most one reveal
+    snprintf(str, sizeof(str), "%s%s%s", branch, transaction, transaction);
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    snprintf(str, sizeof(str), "%s%s%s", branch, transaction, reveal);
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+    snprintf(str, sizeof(str), "%s%s%s%s", branch, reveal, reveal,
+             transaction);
+    ASSERT_EQUAL(MV_ERR_UNEXPECTED, parse_expected(data, str, &expected));
+
+    // Any operation is accepted without expected operation
+    ASSERT_EQUAL(MV_BLO_DONE, parse_expected(data, str, NULL));
+}
+
+CTEST2(operation_parser, check_operation_summary)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "0000000000000000000000000000000000000000"
+          "6c016e8874874d31c3fbd636e924d5a036a43ec8faa7d0860308362d80d30e0100"
+          "0000000000000000000000000000000000000000ff02000000020316";
+    mv_operation_summary *summary = &data->state->operation.summary;
+    mv_operation_summary  total;
+    mv_operation_summary  other;
+
+    ASSERT_EQUAL(MV_BLO_DONE, parse_str(data, str));
+    ASSERT_EQUAL_U(2, summary->nb_operations);
+    ASSERT_EQUAL_U(2, mv_operation_summary_nb_kind(
+                          summary, MV_OPERATION_TAG_TRANSACTION));
+    ASSERT_EQUAL_U(
+        0, mv_operation_summary_nb_kind(summary, MV_OPERATION_TAG_REVEAL));
+    ASSERT_EQUAL_U(550000, summary->total_fee);
+    ASSERT_EQUAL_U(250000, summary->total_amount);
+    ASSERT_EQUAL_U(2, summary->nb_destination);
+    ASSERT_FALSE(summary->several_destinations);
+
+    memcpy(&total, summary, sizeof(total));
+    ASSERT_TRUE(mv_operation_summary_merge(&total, summary));
+    ASSERT_EQUAL_U(4, total.nb_operations);
+    ASSERT_EQUAL_U(1100000, total.total_fee);
+    ASSERT_EQUAL_U(4, total.nb_destination);
+    ASSERT_FALSE(total.several_destinations);
+
+    memcpy(&other, summary, sizeof(other));
+    other.destination[1] = 0x42;
+    ASSERT_TRUE(mv_operation_summary_merge(&total, &other));
+    ASSERT_EQUAL_U(4, total.nb_destination);
+    ASSERT_TRUE(total.several_destinations);
+
+    // Overflowing totals are rejected
+    other.total_amount = UINT64_MAX;
+    ASSERT_FALSE(mv_operation_summary_merge(&total, &other));
+    ASSERT_EQUAL_U(6, total.nb_operations);
+}
+
+CTEST2(operation_parser, check_parameter_hints)
+{
+    // Transaction to `transfer` or `update_operators`, up to the
+    // entrypoint
+    static const char prefix[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "00000000000000000000000000000000000000ffff";
+    static const struct {
+        const char *parameter;
+        const char *fields;
+    } cases[] = {
+        // FA1.2 transfer
+        {"087472616e736665720000003d07070a000000160000ffdd6102321bc251e4a519"
+         "0ad5b12b251069d9b407070a00000016016e8874874d31c3fbd636e924d5a036a4"
+         "3ec8faa70000a80f",
+         "mv1XLPWJhfrKw1f3B6t2jQX6Dfx9ByyozxsF\n"
+         "KT1JfDMwSrH8ijv4C5vMTsBwFzYtyiZiAWum\n1000"},
+        // FA2 transfer
+        {"087472616e736665720000004b020000004607070a000000160000ffdd6102321b"
+         "c251e4a5190ad5b12b251069d9b4020000002407070a00000016016e8874874d31"
+         "c3fbd636e924d5a036a43ec8faa7000707000000a80f",
+         "mv1XLPWJhfrKw1f3B6t2jQX6Dfx9ByyozxsF\n"
+         "KT1JfDMwSrH8ijv4C5vMTsBwFzYtyiZiAWum\n0\n1000"},
+        // FA2 update_operators
+        {"107570646174655f6f70657261746f727300000081020000007c050507070a0000"
+         "00160000ffdd6102321bc251e4a5190ad5b12b251069d9b407070a00000016016e"
+         "8874874d31c3fbd636e924d5a036a43ec8faa7000001050807070a000000160000"
+         "ffdd6102321bc251e4a5190ad5b12b251069d9b407070a00000016016e8874874d"
+         "31c3fbd636e924d5a036a43ec8faa7000001",
+         "Add\nmv1XLPWJhfrKw1f3B6t2jQX6Dfx9ByyozxsF\n"
+         "KT1JfDMwSrH8ijv4C5vMTsBwFzYtyiZiAWum\n1\n"
+         "Remove\nmv1XLPWJhfrKw1f3B6t2jQX6Dfx9ByyozxsF\n"
+         "KT1JfDMwSrH8ijv4C5vMTsBwFzYtyiZiAWum\n1"},
+        // `Pair 1 2` does not match the hints of `transfer`
+        {"087472616e7366657200000006070700010002", "Pair 1 2"},
+    };
+    static char str[1024];
+    static char expected[4096];
+    static char resumed[4096];
+    size_t      ilens[] = {1, 7, 235};
+    size_t      i;
+    size_t      j;
+
+    for (i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        snprintf(str, sizeof(str), "%s%s", prefix, cases[i].parameter);
+        data->max_ilen = 235;
+        ASSERT_EQUAL(MV_BLO_DONE, parse_output(data, str, expected,
+                                               sizeof(expected), false));
+        ASSERT_NOT_NULL(strstr(expected, cases[i].fields));
+
+        for (j = 0; j < (sizeof(ilens) / sizeof(ilens[0])); j++) {
+            data->max_ilen = ilens[j];
+            ASSERT_EQUAL(MV_BLO_DONE, parse_output(data, str, resumed,
+                                                   sizeof(resumed), true));
+            ASSERT_STR(expected, resumed);
+        }
+    }
+}
+
+CTEST2(operation_parser, check_packed_hints)
+{
+    static const struct {
+        const char *packed;
+        const char *fields;
+    } cases[] = {
+        // Pair "domain" "example.com", the titles never come from the
+        // data
+        {"0507070100000006646f6d61696e010000000b6578616d706c652e636f6d",
+         "First: \"domain\"\nSecond: \"example.com\"\n"},
+        // Pair 0x0102 "abc"
+        {"0507070a0000000201020100000003616263",
+         "First: 0x0102\nSecond: \"abc\"\n"},
+        // { Elt "nonce" 0x00ff ; Elt "to" "x" }
+        {"050200000022070401000000056e6f6e63650a0000000200ff07040100000002"
+         "746f010000000178",
+         "Key: \"nonce\"\nValue: 0x00FF\nKey: \"to\"\nValue: \"x\"\n"},
+        // { Elt 0x01 "a" }
+        {"05020000000e07040a0000000101010000000161",
+         "Key: 0x01\nValue: \"a\"\n"},
+        // Strings with quotes are displayed as expressions
+        {"05070701000000016101000000026222",
+         "Expression: Pair \"a\" \"b\\\"\"\n"},
+        // Any other shape too
+        {"05070700010002", "Expression: Pair 1 2\n"},
+    };
+    static char      str[1024];
+    static char      fields[4096];
+    mv_parser_state *st = data->state;
+    size_t           i;
+
+    for (i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        snprintf(str, sizeof(str), "%s", cases[i].packed);
+        fill_data_str(data, str);
+        mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+        mv_parser_refill(st, NULL, 0);
+        mv_parser_flush(st, data->obuf, data->olen);
+        fields[0] = '\0';
+        do {
+            while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+                // Loop while the result is successful and not blocking
+            }
+            if (st->errno == MV_BLO_FEED_ME) {
+                refill(data);
+                mv_parser_refill(st, data->ibuf, data->ilen);
+            } else if ((st->errno == MV_BLO_IM_FULL)
+                       || ((st->errno == MV_BLO_DONE)
+                           && (st->regs.oofs > 0))) {
+                snprintf(fields + strlen(fields),
+                         sizeof(fields) - strlen(fields), "%s: %s\n",
+                         st->field_info.field_name, data->obuf);
+                mv_parser_flush(st, data->obuf, data->olen);
+            }
+        } while (st->errno != MV_BLO_DONE && !MV_IS_ERR(st->errno));
+        ASSERT_EQUAL(MV_BLO_DONE, st->errno);
+        ASSERT_STR(cases[i].fields, fields);
+    }
+}
+
+CTEST2(operation_parser, check_base58check_memo)
+{
+    const uint8_t hash[20]
+        = {0xdd, 0x61, 0x02, 0x32, 0x1b, 0xc2, 0x51, 0xe4, 0xa5, 0x19,
+           0x0a, 0xd5, 0xb1, 0x2b, 0x25, 0x10, 0x69, 0xd9, 0xb4, 0xa0};
+    char   mv1[MV_BASE58CHECK_BUFFER_SIZE(20, 3)];
+    char   kt1[MV_BASE58CHECK_BUFFER_SIZE(20, 3)];
+    char   again[MV_BASE58CHECK_BUFFER_SIZE(20, 3)];
+    size_t i;
+
+    mv_format_base58check_reset_memo();
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_MV1, hash,
+                                                 20, mv1, sizeof(mv1)));
+    // Same hash, other prefix
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_KT1, hash,
+                                                 20, kt1, sizeof(kt1)));
+    ASSERT_NOT_EQUAL(0, strcmp(mv1, kt1));
+
+    // Found in the memo
+    for (i = 0; i < 8; i++) {
+        ASSERT_EQUAL(0, mv_format_base58check_prefix(
+                            MV_B58_PREFIX_MV1, hash, 20, again,
+                            sizeof(again)));
+        ASSERT_STR(mv1, again);
+    }
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_KT1, hash,
+                                                 20, again, sizeof(again)));
+    ASSERT_STR(kt1, again);
+
+    // The size of the output buffer is still checked
+    ASSERT_NOT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_MV1,
+                                                     hash, 20, again, 20));
+}
+
+CTEST2(operation_parser, check_base58check_memo_aliased)
+{
+    const uint8_t hash[20]
+        = {0xdd, 0x61, 0x02, 0x32, 0x1b, 0xc2, 0x51, 0xe4, 0xa5, 0x19,
+           0x0a, 0xd5, 0xb1, 0x2b, 0x25, 0x10, 0x69, 0xd9, 0xb4, 0xa0};
+    // Formatted in place, as the fields read in several packets are
+    // formatted from the capture buffer
+    char    capture[MV_BASE58CHECK_BUFFER_SIZE(20, 3)];
+    uint8_t other[20];
+    char    expected[MV_BASE58CHECK_BUFFER_SIZE(20, 3)];
+    char    again[MV_BASE58CHECK_BUFFER_SIZE(20, 3)];
+
+    mv_format_base58check_reset_memo();
+    memcpy(capture, hash, sizeof(hash));
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(
+                        MV_B58_PREFIX_MV1, (const uint8_t *)capture, 20,
+                        capture, sizeof(capture)));
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_MV1, hash,
+                                                 20, again, sizeof(again)));
+    ASSERT_STR(capture, again);
+
+    // A hash equal to the beginning of the text is not the hash memoized
+    memcpy(other, capture, sizeof(other));
+    mv_format_base58check_reset_memo();
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_MV1, other,
+                                                 20, expected,
+                                                 sizeof(expected)));
+    mv_format_base58check_reset_memo();
+    memcpy(capture, hash, sizeof(hash));
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(
+                        MV_B58_PREFIX_MV1, (const uint8_t *)capture, 20,
+                        capture, sizeof(capture)));
+    ASSERT_EQUAL(0, mv_format_base58check_prefix(MV_B58_PREFIX_MV1, other,
+                                                 20, again, sizeof(again)));
+    ASSERT_STR(expected, again);
+}
+
+CTEST2(operation_parser, check_batch_run)
+{
+    // Transactions from mv1XLPWJhfrKw1f3B6t2jQX6Dfx9ByyozxsF
+    static const char same[]
+        = "6c00ffdd6102321bc251e4a5190ad5b12b251069d9b4a0c21e020304904e010000"
+          "0000000000000000000000000000000000000000";
+    // Transaction from another source
+    static const char other[]
+        = "6c016e8874874d31c3fbd636e924d5a036a43ec8faa7d0860308362d80d30e0100"
+          "0000000000000000000000000000000000000000ff02000000020316";
+    static char str[2048];
+    static char output[4096];
+    const char *source = "mv1XLPWJhfrKw1f3B6t2jQX6Dfx9ByyozxsF";
+    const char *p;
+    size_t      nb_sources    = 0;
+    size_t      nb_operations = 0;
+
+    snprintf(str, sizeof(str),
+             "030000000000000000000000000000000000000000000000000000000000000"
+             "000%s%s%s%s%s%s",
+             same, same, same, same, other, same);
+    ASSERT_EQUAL(MV_BLO_DONE,
+                 parse_output(data, str, output, sizeof(output), false));
+
+    // The source of the fourth operation is not displayed again, the
+    // run restarts with the other source
+    for (p = strstr(output, source); p != NULL;
+         p = strstr(p + 1, source)) {
+        nb_sources++;
+    }
+    ASSERT_EQUAL_U(4, nb_sources);
+    p = strstr(output, "Same as previous");
+    ASSERT_NOT_NULL(p);
+    ASSERT_NULL(strstr(p + 1, "Same as previous"));
+
+    // The other fields are still displayed
+    for (p = strstr(output, "Transaction"); p != NULL;
+         p = strstr(p + 1, "Transaction")) {
+        nb_operations++;
+    }
+    ASSERT_EQUAL_U(6, nb_operations);
+}
+
+CTEST2(operation_parser, check_num_parser_decimal)
+{
+    static mv_num_parser_buffer buffers;
+    mv_num_parser_regs          regs;
+    char                        expected[sizeof(buffers.decimal)];
+    uint8_t                     n[MV_NUM_BUFFER_SIZE / 8];
+    size_t                      len;
+    size_t                      bits;
+    size_t                      i;
+    size_t                      k;
+
+    srand(42);
+    for (k = 0; k < 256; k++) {
+        // Random numbers of every size, up to 2^256 - 1
+        len = 1 + (k % sizeof(n));
+        memset(n, 0, sizeof(n));
+        for (i = 0; i < len; i++) {
+            n[i] = (k < 8) ? 0xFF : (uint8_t)rand();
+        }
+        ASSERT_EQUAL(0, mv_format_decimal(n, sizeof(n), expected,
+                                          sizeof(expected)));
+
+        // Zarith encoding, by groups of 7 bits
+        mv_parse_num_state_init(&buffers, &regs);
+        for (bits = 0; !regs.stop; bits += 7) {
+            uint8_t b = 0;
+
+            for (i = 0; i < 7; i++) {
+                if (((bits + i) / 8) < len) {
+                    b |= ((n[(bits + i) / 8] >> ((bits + i) % 8)) & 1)
+                         << i;
+                }
+            }
+            if ((bits + 7) < (len * 8)) {
+                b |= 0x80;
+            }
+            ASSERT_EQUAL(MV_CONTINUE, mv_parse_nat_step(&buffers, &regs, b));
+        }
+        ASSERT_STR(expected, buffers.decimal);
+    }
+}
+
+CTEST2(operation_parser, check_format_mumav)
+{
+    static const struct {
+        uint64_t    amount;
+        const char *str;
+    } cases[] = {
+        {0,                   "0"                    },
+        {1,                   "0.000001"             },
+        {500000,              "0.5"                  },
+        {1000000,             "1"                    },
+        {1010000,             "1.01"                 },
+        {123456789012345678u, "123456789012.345678"  },
+        {UINT64_MAX,          "18446744073709.551615"},
+    };
+    char     str[MV_MUMAV_BUFFER_SIZE];
+    uint64_t amount;
+    size_t   i;
+
+    for (i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++) {
+        ASSERT_EQUAL(0, mv_format_mumav(cases[i].amount, str, sizeof(str)));
+        ASSERT_STR(cases[i].str, str);
+    }
+    ASSERT_NOT_EQUAL(0, mv_format_mumav(1010000, str, 4));
+
+    ASSERT_TRUE(mv_string_to_mumav("18446744073709551615", &amount));
+    ASSERT_TRUE(amount == UINT64_MAX);
+    ASSERT_FALSE(mv_string_to_mumav("18446744073709551616", &amount));
+    ASSERT_FALSE(mv_string_to_mumav("", &amount));
+    ASSERT_FALSE(mv_string_to_mumav("1.5", &amount));
+}
+
+CTEST2(operation_parser, check_format_hex)
+{
+    static const uint8_t bytes[] = {0x00, 0x9A, 0xBC, 0xFF, 0x5E};
+    char                 str[11];
+
+    memset(str, 0, sizeof(str));
+    ASSERT_EQUAL(5, mv_format_hex(bytes, sizeof(bytes), str, 10, false));
+    ASSERT_STR("009ABCFF5E", str);
+    ASSERT_EQUAL(5, mv_format_hex(bytes, sizeof(bytes), str, 10, true));
+    ASSERT_STR("009abcff5e", str);
+
+    // only the whole bytes that fit are formatted
+    memset(str, 0, sizeof(str));
+    ASSERT_EQUAL(2, mv_format_hex(bytes, sizeof(bytes), str, 5, false));
+    ASSERT_STR("009A", str);
+    ASSERT_EQUAL(0, mv_format_hex(bytes, sizeof(bytes), str, 1, false));
+}
+
+CTEST2(operation_parser, check_binary_digest)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "c800ffdd6102321bc251e4a5190ad5b12b251069d9b4904e02030400000000c639"
+          "663039663239353264333435323863373333663934363135636663333962633535"
+          "353631396663353530646434613637626132323038636538653836376161336431"
+          "336136656639396466626533326336393734616139613231353064323165636132"
+          "396333333439653539633133623930383166316331316234343061633464333435"
+          "356465646265346565306465313561386166363230643463383632343764396431"
+          "333264653162623664613233643566663964386466666461323262613961383400"
+          "00000a07070100000001310002ff0000003f00ffdd6102321bc251e4a5190ad5b1"
+          "2b251069d9b401f6552df4f5ff51c3d13347cab045cfdb8b9bd8030278eb8b6ab9"
+          "a768579cd5146b480789650c83f28e";
+    mv_parser_state *st = data->state;
+    char             kernel[128];
+
+    memset(kernel, 0, sizeof(kernel));
+    fill_data_str(data, str);
+    mv_operation_parser_set_size(st, (uint16_t)data->str_len);
+
+    while (true) {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+            // Loop while the result is successful and not blocking
+        }
+        if (st->errno == MV_BLO_FEED_ME) {
+            refill(data);
+            mv_parser_refill(st, data->ibuf, data->ilen);
+            continue;
+        }
+        ASSERT_EQUAL(MV_BLO_IM_FULL, st->errno);
+        if (strcmp(st->field_info.field_name, "Kernel") == 0) {
+            strncat(kernel, data->obuf, st->regs.oofs);
+        } else if (kernel[0] != '\0') {
+            break;
+        }
+        mv_parser_flush(st, data->obuf, data->olen);
+    }
+
+    // the 198 bytes of the kernel are displayed by their digest
+    ASSERT_STR("198 bytes, blake2b 56374e89f1b0ea52f3022c6d1565be4a6c614c3d"
+               "1a2cd0a3645df9850ae5af72",
+               kernel);
+}
+
+/**
+ * @brief Parse an operation in collapse mode and collect what is printed
+ *        for one field
+ *
+ * @param data: test data
+ * @param str: operation, in hexadecimal
+ * @param name: name of the field
+ * @param expand: whether the field is expanded once folded
+ * @param out: output, for what is printed for the field
+ * @param out_size: size of the output
+ */
+static void
+parse_collapsed(struct ctest_operation_parser_data *data, char *str,
+                const char *name, bool expand, char *out, size_t out_size)
+{
+    mv_parser_state *st = data->state;
+
+    memset(out, 0, out_size);
+    fill_data_str(data, str);
+    mv_operation_parser_init(st, (uint16_t)data->str_len, false);
+    mv_operation_parser_set_collapse(st, true);
+    mv_parser_refill(st, NULL, 0);
+    mv_parser_flush(st, data->obuf, data->olen);
+    while (true) {
+        while (!MV_IS_BLOCKED(mv_operation_parser_step(st))) {
+            // Loop while the result is successful and not blocking
+        }
+        if (st->errno == MV_BLO_FEED_ME) {
+            refill(data);
+            mv_parser_refill(st, data->ibuf, data->ilen);
+            continue;
+        }
+        if (st->errno != MV_BLO_IM_FULL) {
+            break;
+        }
+        if (strcmp(st->field_info.field_name, name) == 0) {
+            strncat(out, data->obuf,
+                    MIN(st->regs.oofs, out_size - strlen(out) - 1));
+            if (st->field_info.is_field_folded) {
+                strncat(out, " | ", out_size - strlen(out) - 1);
+                if (expand) {
+                    ASSERT_TRUE(mv_operation_parser_expand(st));
+                    // Only once
+                    ASSERT_FALSE(mv_operation_parser_expand(st));
+                }
+            }
+        }
+        mv_parser_flush(st, data->obuf, data->olen);
+    }
+    ASSERT_EQUAL(MV_BLO_DONE, st->errno);
+}
+
+CTEST2(operation_parser, check_collapse_expression)
+{
+    char str[]
+        = "030000000000000000000000000000000000000000000000000000000000000000"
+          "6d00ffdd6102321bc251e4a5190ad5b12b251069d9b4904e020304a0c21e000000"
+          "006902000000640000000000000000000000000000000000000000000000000000"
+          "000000000000000000000000000000000000000000000000000000000000000000"
+          "000000000000000000000000000000000000000000000000000000000000000000"
+          "00000000000000000000000a07650100000001310002";
+    char code[256];
+    char storage[64];
+
+    // The code is folded, and then only read
+    parse_collapsed(data, str, "Code", false, code, sizeof(code));
+    ASSERT_STR("105 bytes | ", code);
+
+    // The code is expanded
+    parse_collapsed(data, str, "Code", true, code, sizeof(code));
+    ASSERT_STR("105 bytes | {0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;"
+               "0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0;0}",
+               code);
+
+    // The small expressions are still printed at once
+    parse_collapsed(data, str, "Storage", false, storage, sizeof(storage));
+    ASSERT_STR("pair \"1\" 2", storage);
+}
@@ -18,9 +18,33 @@
 #include <caml/alloc.h>
 #include <caml/fail.h>
 
+#include <stdlib.h>
+
 #include "micheline_parser.h"
 #include "operation_parser.h"
 
+/// parser steps run since the last call to `cparse_steps`
+static long steps = 0;
+
+CAMLprim value
+cparse_steps(value unit)
+{
+    CAMLparam1(unit);
+    long r = steps;
+    steps  = 0;
+    CAMLreturn(Val_long(r));
+}
+
+CAMLprim value
+micheline_cparse_free(value mlstate)
+{
+    CAMLparam1(mlstate);
+    mv_parser_state **state = Data_abstract_val(mlstate);
+    free(*state);
+    *state = NULL;
+    CAMLreturn(Val_unit);
+}
+
 CAMLprim value
 micheline_cparse_capture_name(value mlstate)
 {
@@ -72,9 +96,9 @@ micheline_cparse_step(value mlstate, value input, value output)
     state->regs.oofs = oofs;
     state->regs.olen = olen;
 
-    while (!MV_IS_BLOCKED(mv_micheline_parser_step(state))) {
-        // Loop while the result is successful and not blocking
-    }
+    do {
+        steps++;
+    } while (!MV_IS_BLOCKED(mv_micheline_parser_step(state)));
 
     int read    = ilen - state->regs.ilen;
     int written = olen - state->regs.olen;
@@ -139,9 +163,9 @@ operation_cparse_step(value mlstate, value input, value output)
     state->regs.oofs = oofs;
     state->regs.olen = olen;
 
-    while (!MV_IS_BLOCKED(mv_operation_parser_step(state))) {
-        // Loop while the result is successful and not blocking
-    }
+    do {
+        steps++;
+    } while (!MV_IS_BLOCKED(mv_operation_parser_step(state)));
 
     int read    = ilen - state->regs.ilen;
     int written = olen - state->regs.olen;
@@ -26,12 +26,27 @@ let read_hex_file ~encoding path =
     close_in fp;
     None
 
-let pp_c_bin ~(cparse_step : cparse_step) ppf bytes =
+type blocking = { mutable feed_me : int; mutable im_full : int }
+(** Number of times the parser blocked, and was resumed *)
+
+(** Print the C parsing of [bytes].
+
+    Each step is given a chunk of input and an output buffer of
+    random sizes, or of the [sizes] given. The blockings of the
+    parser are counted in [blocking]. *)
+let pp_c_bin ?sizes ?blocking ~(cparse_step : cparse_step) ppf bytes =
   let len = Bytes.length bytes in
   let state = cparse_init len in
+  let count f = Option.iter f blocking in
   let rec screen_by_screen ofs =
-    let input_len = 1 + Random.int 234 in
-    let output_len = 1 + Random.int 100 in
+    let input_len, output_len =
+      match sizes with
+      | Some sizes -> sizes
+      | None ->
+          let input_len = 1 + Random.int 234 in
+          let output_len = 1 + Random.int 100 in
+          (input_len, output_len)
+    in
     let buf = Bytes.make output_len ' ' in
     let read, written, st =
       cparse_step state
@@ -41,14 +56,20 @@ let pp_c_bin ~(cparse_step : cparse_step) ppf bytes =
     if written > 0 then
       Format.fprintf ppf "%s" (Bytes.to_string (Bytes.sub buf 0 written));
     match st with
-    | FEED_ME -> if len - ofs > 0 then screen_by_screen (ofs + read)
-    | IM_FULL -> screen_by_screen (ofs + read)
+    | FEED_ME ->
+        count (fun b -> b.feed_me <- b.feed_me + 1);
+        if len - ofs > 0 then screen_by_screen (ofs + read)
+    | IM_FULL ->
+        count (fun b -> b.im_full <- b.im_full + 1);
+        screen_by_screen (ofs + read)
     | DONE -> ()
   in
+  Fun.protect ~finally:(fun () -> cparse_free state) @@ fun () ->
   screen_by_screen 0
 
 let pp_c ~to_bytes ~cparse_step input =
-  try Format.asprintf "%a" (pp_c_bin ~cparse_step) @@ to_bytes input
+  try Format.asprintf "%a" (fun ppf -> pp_c_bin ~cparse_step ppf)
+      @@ to_bytes input
   with exn -> Printexc.to_string exn
 
 let check ~to_string ~to_bytes ~cparse_step inputs =
@@ -61,6 +82,52 @@ let check ~to_string ~to_bytes ~cparse_step inputs =
   in
   Seq.fold_lefti aux (0, 0, []) inputs
 
+(** The input chunk sizes of the profiling, up to the APDU payload *)
+let chunk_sizes = [ 1; 2; 4; 8; 16; 32; 64; 128; 235 ]
+
+(** The output sizes of the profiling, up to [max_output]: the powers
+    of two and the screen contents of the nanos (19), of the touch
+    devices (20) and of the nanosp/nanox (76). *)
+let output_sizes max_output =
+  List.sort_uniq compare
+  @@ List.filter (fun size -> size <= max_output)
+  @@ (max_output :: [ 1; 2; 4; 8; 16; 19; 20; 32; 64; 76 ])
+
+(** Parse all [inputs] for each chunk size and output size, and
+    report the average number of parser steps, and of resumptions
+    after a [FEED_ME] or an [IM_FULL], per input. *)
+let profile ~to_bytes ~cparse_step ~max_output inputs =
+  let inputs = List.of_seq @@ Seq.map to_bytes inputs in
+  let per_input n =
+    float_of_int n /. float_of_int (max 1 (List.length inputs))
+  in
+  Format.printf "%d inputs@.%6s %6s %12s %12s %12s %12s@."
+    (List.length inputs) "chunk" "output" "steps" "resumptions" "feed_me"
+    "im_full";
+  chunk_sizes
+  |> List.iter @@ fun chunk_size ->
+     output_sizes max_output
+     |> List.iter @@ fun output_size ->
+        let blocking = { feed_me = 0; im_full = 0 } in
+        ignore (cparse_steps ());
+        List.iter
+          (fun bytes ->
+            try
+              ignore
+              @@ Format.asprintf "%a"
+                   (fun ppf ->
+                     pp_c_bin ~sizes:(chunk_size, output_size) ~blocking
+                       ~cparse_step ppf)
+                   bytes
+            with _ -> ())
+          inputs;
+        let steps = cparse_steps () in
+        Format.printf "%6d %6d %12.1f %12.1f %12.1f %12.1f@." chunk_size
+          output_size (per_input steps)
+          (per_input (blocking.feed_me + blocking.im_full))
+          (per_input blocking.feed_me)
+          (per_input blocking.im_full)
+
 let divider =
   let columns = Option.value ~default:80 @@ Terminal_size.get_columns () in
   String.make columns '-'
@@ -109,7 +176,25 @@ let () =
       in
       display_failed failed;
       Format.printf "Result: %d test were run, %d failed.@." (nfail + nok) nfail
+  | [| _; "profile"; (("micheline" | "operations") as kind); path |]
+  | [| _; "profile"; (("micheline" | "operations") as kind); path; _ |] ->
+      let max_output =
+        if Array.length Sys.argv = 5 then int_of_string Sys.argv.(4) else 76
+      in
+      if kind = "micheline" then
+        profile ~max_output
+          ~to_bytes:Test_micheline_c_parser.to_bytes
+          ~cparse_step:Test_micheline_c_parser.cparse_step
+        @@ read_hex_file ~encoding:Protocol.Script_repr.expr_encoding path
+      else
+        profile ~max_output
+          ~to_bytes:Test_operations_c_parser.to_bytes
+          ~cparse_step:Test_operations_c_parser.cparse_step
+        @@ read_hex_file
+             ~encoding:Protocol.Alpha_context.Operation.unsigned_encoding path
   | _ ->
-      Format.eprintf "Usage: %s <micheline|operations> <path>@."
-        Sys.executable_name;
+      Format.eprintf
+        "Usage: %s <micheline|operations> <path>@.       %s profile \
+         <micheline|operations> <path> [max_output]@."
+        Sys.executable_name Sys.executable_name;
       exit 1
@@ -18,6 +18,10 @@ type cparse_state
 [@@@ocaml.warning "-37"]
 
 external cparse_init : int -> cparse_state = "micheline_cparse_init"
+external cparse_free : cparse_state -> unit = "micheline_cparse_free"
+
+external cparse_steps : unit -> int = "cparse_steps"
+(** Number of parser steps run since its last call *)
 
 type st = DONE | FEED_ME | IM_FULL
 
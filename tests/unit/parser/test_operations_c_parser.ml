@@ -25,7 +25,13 @@ let pp_lazy_expr ppf lazy_expr =
   let expr = Result.get_ok @@ Protocol.Script_repr.force_decode lazy_expr in
   Format.fprintf ppf "%s" @@ Test_micheline_c_parser.to_string expr
 
-let pp_string_binary ppf s = Format.fprintf ppf "%a" Hex.pp (Hex.of_string s)
+(* Binaries longer than [MV_OPERATION_BINARY_DIGEST_SIZE] are displayed
+   by their length and digest *)
+let pp_string_binary ppf s =
+  if String.length s > 128 then
+    Format.fprintf ppf "%d bytes, blake2b %a" (String.length s) Hex.pp
+      (Hex.of_string Mavryk_crypto.Blake2B.(to_string (hash_string [ s ])))
+  else Format.fprintf ppf "%a" Hex.pp (Hex.of_string s)
 
 let pp_serialized_proof ppf proof =
   let proof =